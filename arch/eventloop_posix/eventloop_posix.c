@@ -121,6 +121,77 @@ processDelayed(UA_EventLoopPOSIX *el) {
     }
 }
 
+/*************/
+/* Self-Pipe */
+/*************/
+
+#ifndef _WIN32
+
+static void
+selfpipeCallback(UA_EventSource *es, UA_RegisteredFD *rfd, short event) {
+    /* Drain the pipe. Several cancel calls are handled at once. */
+    char buf[128];
+    while(read(rfd->fd, buf, sizeof(buf)) > 0) {}
+}
+
+static UA_StatusCode
+openSelfpipe(UA_EventLoopPOSIX *el) {
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+    int fds[2];
+    if(pipe(fds) != 0) {
+        UA_LOG_SOCKET_ERRNO_WRAP(
+           UA_LOG_WARNING(el->eventLoop.logger, UA_LOGCATEGORY_EVENTLOOP,
+                          "Eventloop\t| Could not create the self-pipe (%s)",
+                          errno_str));
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    UA_EventLoopPOSIX_setNonBlocking(fds[0]);
+    UA_EventLoopPOSIX_setNonBlocking(fds[1]);
+
+    memset(&el->selfpipe, 0, sizeof(UA_RegisteredFD));
+    el->selfpipe.fd = fds[0];
+    el->selfpipe.listenEvents = UA_FDEVENT_IN;
+    el->selfpipe.eventSourceCB = selfpipeCallback;
+    el->selfpipeWrite = fds[1];
+
+    UA_StatusCode res = UA_EventLoopPOSIX_registerFD(el, &el->selfpipe);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_close(fds[0]);
+        UA_close(fds[1]);
+        el->selfpipe.fd = UA_INVALID_FD;
+        el->selfpipeWrite = UA_INVALID_FD;
+    }
+    return res;
+}
+
+static void
+closeSelfpipe(UA_EventLoopPOSIX *el) {
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+    if(el->selfpipeWrite == UA_INVALID_FD)
+        return;
+    UA_EventLoopPOSIX_deregisterFD(el, &el->selfpipe);
+    UA_close(el->selfpipe.fd);
+    UA_close(el->selfpipeWrite);
+    el->selfpipe.fd = UA_INVALID_FD;
+    el->selfpipeWrite = UA_INVALID_FD;
+}
+
+#endif
+
+static void
+UA_EventLoopPOSIX_cancel(UA_EventLoopPOSIX *el) {
+#ifndef _WIN32
+    /* Writing to the pipe is async-signal-safe and needs no lock. A full pipe
+     * already wakes up the EventLoop. */
+    UA_FD fd = el->selfpipeWrite;
+    if(fd == UA_INVALID_FD)
+        return;
+    char c = 0;
+    ssize_t res = write(fd, &c, 1);
+    (void)res;
+#endif
+}
+
 /***********************/
 /* EventLoop Lifecycle */
 /***********************/
@@ -178,6 +249,11 @@ UA_EventLoopPOSIX_start(UA_EventLoopPOSIX *el) {
     }
 #endif
 
+#ifndef _WIN32
+    /* The EventLoop can also run without being interruptible */
+    openSelfpipe(el);
+#endif
+
     UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_EventSource *es = el->eventLoop.eventSources;
     while(es) {
@@ -214,6 +290,10 @@ checkClosed(UA_EventLoopPOSIX *el) {
     *(UA_EventLoopState*)(uintptr_t)&el->eventLoop.state =
         UA_EVENTLOOPSTATE_STOPPED;
 
+#ifndef _WIN32
+    closeSelfpipe(el);
+#endif
+
     /* Close the epoll/IOCP socket once all EventSources have shut down */
 #ifdef UA_HAVE_EPOLL
     close(el->epollfd);
@@ -489,6 +569,10 @@ UA_EventLoop_new_POSIX(const UA_Logger *logger) {
 
     UA_LOCK_INIT(&el->elMutex);
     UA_Timer_init(&el->timer);
+#ifndef _WIN32
+    el->selfpipe.fd = UA_INVALID_FD;
+    el->selfpipeWrite = UA_INVALID_FD;
+#endif
 
 #ifdef _WIN32
     /* Start the WSA networking subsystem on Windows */
@@ -502,6 +586,7 @@ UA_EventLoop_new_POSIX(const UA_Logger *logger) {
     el->eventLoop.start = (UA_StatusCode (*)(UA_EventLoop*))UA_EventLoopPOSIX_start;
     el->eventLoop.stop = (void (*)(UA_EventLoop*))UA_EventLoopPOSIX_stop;
     el->eventLoop.run = (UA_StatusCode (*)(UA_EventLoop*, UA_UInt32))UA_EventLoopPOSIX_run;
+    el->eventLoop.cancel = (void (*)(UA_EventLoop*))UA_EventLoopPOSIX_cancel;
     el->eventLoop.free = (UA_StatusCode (*)(UA_EventLoop*))UA_EventLoopPOSIX_free;
 
     el->eventLoop.dateTime_now = UA_EventLoopPOSIX_DateTime_now;
@@ -558,6 +643,75 @@ UA_EventLoopPOSIX_freeNetworkBuffer(UA_ConnectionManager *cm,
         UA_ByteString_clear(buf);
 }
 
+UA_StatusCode
+UA_EventLoopPOSIX_registerNetworkBuffer(UA_ConnectionManager *cm,
+                                        uintptr_t connectionId,
+                                        UA_ByteString *buf,
+                                        size_t bufSize) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_StatusCode res = UA_ByteString_allocBuffer(buf, bufSize);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    UA_LOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+    UA_ByteString *reg = (UA_ByteString*)
+        UA_realloc(pcm->txRegistered,
+                   sizeof(UA_ByteString) * (pcm->txRegisteredSize + 1));
+    if(!reg) {
+        UA_UNLOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+        UA_ByteString_clear(buf);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    reg[pcm->txRegisteredSize] = *buf;
+    pcm->txRegistered = reg;
+    pcm->txRegisteredSize++;
+    UA_UNLOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_EventLoopPOSIX_unregisterNetworkBuffer(UA_ConnectionManager *cm,
+                                          uintptr_t connectionId,
+                                          UA_ByteString *buf) {
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_LOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+    for(size_t i = 0; i < pcm->txRegisteredSize; i++) {
+        UA_ByteString *reg = &pcm->txRegistered[i];
+        if(buf->data < reg->data || buf->data >= reg->data + reg->length)
+            continue;
+        UA_ByteString_clear(reg);
+        pcm->txRegisteredSize--;
+        pcm->txRegistered[i] = pcm->txRegistered[pcm->txRegisteredSize];
+        if(pcm->txRegisteredSize == 0) {
+            UA_free(pcm->txRegistered);
+            pcm->txRegistered = NULL;
+        }
+        break;
+    }
+    UA_UNLOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+    UA_ByteString_init(buf);
+}
+
+UA_Boolean
+UA_EventLoopPOSIX_isRegisteredBuffer(UA_POSIXConnectionManager *pcm,
+                                     const UA_ByteString *buf) {
+    for(size_t i = 0; i < pcm->txRegisteredSize; i++) {
+        const UA_ByteString *reg = &pcm->txRegistered[i];
+        if(buf->data >= reg->data && buf->data < reg->data + reg->length)
+            return true;
+    }
+    return false;
+}
+
+void
+UA_EventLoopPOSIX_clearRegisteredBuffers(UA_POSIXConnectionManager *pcm) {
+    for(size_t i = 0; i < pcm->txRegisteredSize; i++)
+        UA_ByteString_clear(&pcm->txRegistered[i]);
+    UA_free(pcm->txRegistered);
+    pcm->txRegistered = NULL;
+    pcm->txRegisteredSize = 0;
+}
+
 UA_StatusCode
 UA_EventLoopPOSIX_allocateStaticBuffers(UA_POSIXConnectionManager *pcm) {
     UA_StatusCode res = UA_STATUSCODE_GOOD;
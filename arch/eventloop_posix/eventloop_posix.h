@@ -169,7 +169,14 @@ typedef SSIZE_T ssize_t;
 /* General Definitions */
 /***********************/
 
+/* Pending connections on a listen socket. Use the system maximum if defined
+ * (clamped by the kernel configuration). With a short backlog the connection
+ * attempts that overflow are only retried by the clients after a timeout. */
+#ifdef SOMAXCONN
+#define UA_MAXBACKLOG SOMAXCONN
+#else
 #define UA_MAXBACKLOG 100
+#endif
 #define UA_MAXHOSTNAME_LENGTH 256
 #define UA_MAXPORTSTR_LENGTH 6
 
@@ -227,6 +234,11 @@ typedef struct {
     UA_ByteString rxBuffer;
     UA_ByteString txBuffer;
 
+    /* Registered send buffers. They are not released after sending. Protected
+     * by the EventLoop mutex. */
+    size_t txRegisteredSize;
+    UA_ByteString *txRegistered;
+
     /* Sorted tree of the FDs */
     size_t fdsSize;
     UA_FDTree fds;
@@ -258,6 +270,13 @@ typedef struct {
     size_t fdsSize;
 #endif
 
+#ifndef _WIN32
+    /* Self-pipe to interrupt the EventLoop from another thread. The read-end
+     * is registered like the fd of an EventSource. */
+    UA_RegisteredFD selfpipe;
+    UA_FD selfpipeWrite;
+#endif
+
 #if UA_MULTITHREADING >= 100
     UA_Lock elMutex;
 #endif
@@ -296,6 +315,27 @@ UA_EventLoopPOSIX_freeNetworkBuffer(UA_ConnectionManager *cm,
                                     uintptr_t connectionId,
                                     UA_ByteString *buf);
 
+UA_StatusCode
+UA_EventLoopPOSIX_registerNetworkBuffer(UA_ConnectionManager *cm,
+                                        uintptr_t connectionId,
+                                        UA_ByteString *buf,
+                                        size_t bufSize);
+
+void
+UA_EventLoopPOSIX_unregisterNetworkBuffer(UA_ConnectionManager *cm,
+                                          uintptr_t connectionId,
+                                          UA_ByteString *buf);
+
+/* Is the buffer (or a part of it) a registered send buffer? The EventLoop
+ * mutex must be held. */
+UA_Boolean
+UA_EventLoopPOSIX_isRegisteredBuffer(UA_POSIXConnectionManager *pcm,
+                                     const UA_ByteString *buf);
+
+/* Free the remaining registered buffers when the ConnectionManager is deleted */
+void
+UA_EventLoopPOSIX_clearRegisteredBuffers(UA_POSIXConnectionManager *pcm);
+
 /* Set the socket non-blocking. If the listen-socket is nonblocking, incoming
  * connections inherit this state. */
 UA_StatusCode
@@ -227,6 +227,31 @@ ETH_allocNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
     return res;
 }
 
+static UA_StatusCode
+ETH_registerNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
+                          UA_ByteString *buf, size_t bufSize) {
+    /* Get the ETH_FD */
+    UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
+    UA_FD fd = (UA_FD)connectionId;
+    UA_LOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+    ETH_FD *erfd = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
+    size_t headerSize = (erfd) ? erfd->headerSize : 0;
+    UA_UNLOCK(&((UA_EventLoopPOSIX*)cm->eventSource.eventLoop)->elMutex);
+    if(!erfd)
+        return UA_STATUSCODE_BADCONNECTIONREJECTED;
+
+    /* Register the buffer with the hidden Ethernet header in front. The
+     * buffer is found by its address range when it is unregistered. */
+    UA_StatusCode res =
+        UA_EventLoopPOSIX_registerNetworkBuffer(cm, connectionId, buf,
+                                                bufSize + headerSize);
+    if(UA_LIKELY(res == UA_STATUSCODE_GOOD)) {
+        buf->data   += headerSize;
+        buf->length -= headerSize;
+    }
+    return res;
+}
+
 static void
 ETH_freeNetworkBuffer(UA_ConnectionManager *cm, uintptr_t connectionId,
                       UA_ByteString *buf) {
@@ -892,12 +917,16 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
 
     UA_LOCK(&el->elMutex);
 
+    /* Registered buffers are kept after sending */
+    UA_Boolean registered = UA_EventLoopPOSIX_isRegisteredBuffer(pcm, buf);
+
     /* Get the ETH_FD */
     UA_FD fd = (UA_FD)connectionId;
     ETH_FD *conn = (ETH_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
     if(!conn) {
         UA_UNLOCK(&el->elMutex);
-        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        if(!registered)
+            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADCONNECTIONREJECTED;
     }
 
@@ -919,7 +948,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                      "ETH %u\t| txtime was not configured for the connection",
                      (unsigned)connectionId);
         UA_UNLOCK(&el->elMutex);
-        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        if(!registered)
+            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
@@ -960,7 +990,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                     (unsigned)connectionId, errno_str));
                     ETH_shutdown(pcm, conn);
                     UA_UNLOCK(&el->elMutex);
-                    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                    if(!registered)
+                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
                     return UA_STATUSCODE_BADCONNECTIONCLOSED;
                 }
 
@@ -976,7 +1007,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                         (unsigned)connectionId, errno_str));
                         ETH_shutdown(pcm, conn);
                         UA_UNLOCK(&el->elMutex);
-                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                        if(!registered)
+                            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
                         return UA_STATUSCODE_BADCONNECTIONCLOSED;
                     }
                 } while(poll_ret <= 0);
@@ -987,7 +1019,8 @@ ETH_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
 
     /* Free the buffer */
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    if(!registered)
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -1068,6 +1101,7 @@ ETH_eventSourceDelete(UA_ConnectionManager *cm) {
     UA_KeyValueMap_clear(&cm->eventSource.params);
     UA_ByteString_clear(&pcm->rxBuffer);
     UA_ByteString_clear(&pcm->txBuffer);
+    UA_EventLoopPOSIX_clearRegisteredBuffers(pcm);
     UA_String_clear(&cm->eventSource.name);
     UA_free(cm);
     return UA_STATUSCODE_GOOD;
@@ -1091,6 +1125,8 @@ UA_ConnectionManager_new_POSIX_Ethernet(const UA_String eventSourceName) {
     cm->cm.openConnection = ETH_openConnection;
     cm->cm.allocNetworkBuffer = ETH_allocNetworkBuffer;
     cm->cm.freeNetworkBuffer = ETH_freeNetworkBuffer;
+    cm->cm.registerNetworkBuffer = ETH_registerNetworkBuffer;
+    cm->cm.unregisterNetworkBuffer = UA_EventLoopPOSIX_unregisterNetworkBuffer;
     cm->cm.sendWithConnection = ETH_sendWithConnection;
     cm->cm.closeConnection = ETH_shutdownConnection;
     return &cm->cm;
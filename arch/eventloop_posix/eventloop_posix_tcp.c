@@ -32,6 +32,11 @@ static UA_KeyValueRestriction tcpConnectionParams[TCP_PARAMETERSSIZE] = {
     {{0, UA_STRING_STATIC("reuse")}, &UA_TYPES[UA_TYPES_BOOLEAN], false, true, false}
 };
 
+/* Limit the work done for a single event of a socket. Then return to the
+ * EventLoop so that other sockets are not starved. */
+#define TCP_MAXACCEPT 32 /* Connections accepted per event of the listen-socket */
+#define TCP_MAXRECV 4 /* Receive again if the buffer was filled completely */
+
 typedef struct {
     UA_RegisteredFD rfd;
 
@@ -187,66 +192,79 @@ TCP_connectionSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn,
 
     /* Use the already allocated receive-buffer */
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
-    UA_ByteString response = pcm->rxBuffer;
 
-    /* Receive */
+    /* If the receive-buffer was filled completely, more data is probably
+     * pending on the socket. Then receive again right away instead of waiting
+     * for the next poll of the EventLoop. */
+    for(size_t i = 0; i < TCP_MAXRECV; i++) {
+        UA_ByteString response = pcm->rxBuffer;
+
+        /* Receive */
 #ifndef _WIN32
-    ssize_t ret = UA_recv(conn->rfd.fd, (char*)response.data,
-                          response.length, MSG_DONTWAIT);
+        ssize_t ret = UA_recv(conn->rfd.fd, (char*)response.data,
+                              response.length, MSG_DONTWAIT);
 #else
-    int ret = UA_recv(conn->rfd.fd, (char*)response.data,
-                      response.length, MSG_DONTWAIT);
+        int ret = UA_recv(conn->rfd.fd, (char*)response.data,
+                          response.length, MSG_DONTWAIT);
 #endif
 
-    /* Receive has failed */
-    if(ret <= 0) {
-        if(UA_ERRNO == UA_INTERRUPTED ||
-           UA_ERRNO == UA_WOULDBLOCK ||
-           UA_ERRNO == UA_AGAIN)
-            return; /* Temporary error on an non-blocking socket */
+        /* Receive has failed */
+        if(ret <= 0) {
+            /* Temporary error on an non-blocking socket. The errno is only
+             * set for ret < 0. Zero means the orderly shutdown. */
+            if(ret < 0 &&
+               (UA_ERRNO == UA_INTERRUPTED ||
+                UA_ERRNO == UA_WOULDBLOCK ||
+                UA_ERRNO == UA_AGAIN))
+                return;
+
+            /* Orderly shutdown of the socket */
+            UA_LOG_SOCKET_ERRNO_WRAP(
+               UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                            "TCP %u\t| recv signaled the socket was shutdown (%s)",
+                            (unsigned)conn->rfd.fd, errno_str));
+            TCP_shutdown(cm, conn);
+            return;
+        }
 
-        /* Orderly shutdown of the socket */
-        UA_LOG_SOCKET_ERRNO_WRAP(
-           UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                        "TCP %u\t| recv signaled the socket was shutdown (%s)",
-                        (unsigned)conn->rfd.fd, errno_str));
-        TCP_shutdown(cm, conn);
-        return;
-    }
+        UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                     "TCP %u\t| Received message of size %u",
+                     (unsigned)conn->rfd.fd, (unsigned)ret);
 
-    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                 "TCP %u\t| Received message of size %u",
-                 (unsigned)conn->rfd.fd, (unsigned)ret);
+        /* Callback to the application layer */
+        response.length = (size_t)ret; /* Set the length of the received buffer */
+        UA_UNLOCK(&el->elMutex);
+        conn->applicationCB(cm, (uintptr_t)conn->rfd.fd,
+                            conn->application, &conn->context,
+                            UA_CONNECTIONSTATE_ESTABLISHED,
+                            &UA_KEYVALUEMAP_NULL, response);
+        UA_LOCK(&el->elMutex);
 
-    /* Callback to the application layer */
-    response.length = (size_t)ret; /* Set the length of the received buffer */
-    UA_UNLOCK(&el->elMutex);
-    conn->applicationCB(cm, (uintptr_t)conn->rfd.fd,
-                        conn->application, &conn->context,
-                        UA_CONNECTIONSTATE_ESTABLISHED,
-                        &UA_KEYVALUEMAP_NULL, response);
-    UA_LOCK(&el->elMutex);
+        /* Nothing more pending or the connection was closed in the callback */
+        if(response.length < pcm->rxBuffer.length || conn->rfd.dc.callback)
+            return;
+    }
 }
 
-/* Gets called when a new connection opens or if the listenSocket is closed */
-static void
-TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
+/* Accept a pending connection on the listen-socket. Returns true if a
+ * connection was accepted and more might be pending. */
+static UA_Boolean
+TCP_acceptConnection(UA_ConnectionManager *cm, TCP_FD *conn) {
     UA_POSIXConnectionManager *pcm = (UA_POSIXConnectionManager*)cm;
     UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
     UA_LOCK_ASSERT(&el->elMutex, 1);
 
-    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
-                 "TCP %u\t| Callback on server socket",
-                 (unsigned)conn->rfd.fd);
-
     /* Try to accept a new connection */
     struct sockaddr_storage remote;
     socklen_t remote_size = sizeof(remote);
     UA_FD newsockfd = accept(conn->rfd.fd, (struct sockaddr*)&remote, &remote_size);
     if(newsockfd == UA_INVALID_FD) {
-        /* Temporary error -- retry */
-        if(UA_ERRNO == UA_INTERRUPTED)
-            return;
+        /* Temporary error -- retry. Or no more pending connections on the
+         * non-blocking listen-socket. */
+        if(UA_ERRNO == UA_INTERRUPTED ||
+           UA_ERRNO == UA_WOULDBLOCK ||
+           UA_ERRNO == UA_AGAIN)
+            return false;
 
         /* Close the listen socket */
         if(cm->eventSource.state != UA_EVENTSOURCESTATE_STOPPING) {
@@ -257,7 +275,7 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
         }
 
         TCP_shutdown(cm, conn);
-        return;
+        return false;
     }
 
     /* Log the name of the remote host */
@@ -287,7 +305,7 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
                            (unsigned)newsockfd, errno_str));
         /* Close the new socket */
         UA_close(newsockfd);
-        return;
+        return false;
     }
 
     /* Allocate the UA_RegisteredFD */
@@ -297,7 +315,7 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
                        "TCP %u\t| Error allocating memory for the socket",
                        (unsigned)newsockfd);
         UA_close(newsockfd);
-        return;
+        return false;
     }
 
     newConn->rfd.fd = newsockfd;
@@ -316,7 +334,7 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
                        (unsigned)newsockfd);
         UA_free(newConn);
         UA_close(newsockfd);
-        return;
+        return false;
     }
 
     /* Register internally in the EventSource */
@@ -340,6 +358,29 @@ TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
                            UA_CONNECTIONSTATE_ESTABLISHED,
                            &kvm, UA_BYTESTRING_NULL);
     UA_LOCK(&el->elMutex);
+    return true;
+}
+
+/* Gets called when a new connection opens or if the listenSocket is closed.
+ * Several pending connections are accepted per event. This saves a roundtrip
+ * through the EventLoop for every connection if many clients connect at the
+ * same time. */
+static void
+TCP_listenSocketCallback(UA_ConnectionManager *cm, TCP_FD *conn, short event) {
+    UA_EventLoopPOSIX *el = (UA_EventLoopPOSIX*)cm->eventSource.eventLoop;
+    UA_LOCK_ASSERT(&el->elMutex, 1);
+
+    UA_LOG_DEBUG(el->eventLoop.logger, UA_LOGCATEGORY_NETWORK,
+                 "TCP %u\t| Callback on server socket",
+                 (unsigned)conn->rfd.fd);
+
+    for(size_t i = 0; i < TCP_MAXACCEPT; i++) {
+        if(!TCP_acceptConnection(cm, conn))
+            return;
+        /* The listen-socket was closed in the application callback */
+        if(conn->rfd.dc.callback)
+            return;
+    }
 }
 
 static UA_StatusCode
@@ -854,12 +854,16 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
 
     UA_LOCK(&el->elMutex);
 
+    /* Registered buffers are kept after sending */
+    UA_Boolean registered = UA_EventLoopPOSIX_isRegisteredBuffer(pcm, buf);
+
     /* Look up the registered UDP socket */
     UA_FD fd = (UA_FD)connectionId;
     UDP_FD *conn = (UDP_FD*)ZIP_FIND(UA_FDTree, &pcm->fds, &fd);
     if(!conn) {
         UA_UNLOCK(&el->elMutex);
-        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+        if(!registered)
+            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
@@ -888,7 +892,8 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                     (unsigned)connectionId, errno_str));
                     UA_UNLOCK(&el->elMutex);
                     UDP_shutdownConnection(cm, connectionId);
-                    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                    if(!registered)
+                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
                     return UA_STATUSCODE_BADCONNECTIONCLOSED;
                 }
 
@@ -906,7 +911,8 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
                                         UA_LOGCATEGORY_NETWORK,
                                         "UDP %u\t| Send failed with error %s",
                                         (unsigned)connectionId, errno_str));
-                        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+                        if(!registered)
+                            UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
                         UDP_shutdown(cm, &conn->rfd);
                         UA_UNLOCK(&el->elMutex);
                         return UA_STATUSCODE_BADCONNECTIONCLOSED;
@@ -919,7 +925,8 @@ UDP_sendWithConnection(UA_ConnectionManager *cm, uintptr_t connectionId,
 
     /* Free the buffer */
     UA_UNLOCK(&el->elMutex);
-    UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
+    if(!registered)
+        UA_EventLoopPOSIX_freeNetworkBuffer(cm, connectionId, buf);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -1232,6 +1239,7 @@ UDP_eventSourceDelete(UA_ConnectionManager *cm) {
 
     UA_ByteString_clear(&pcm->rxBuffer);
     UA_ByteString_clear(&pcm->txBuffer);
+    UA_EventLoopPOSIX_clearRegisteredBuffers(pcm);
     UA_KeyValueMap_clear(&cm->eventSource.params);
     UA_String_clear(&cm->eventSource.name);
     UA_free(cm);
@@ -1257,6 +1265,8 @@ UA_ConnectionManager_new_POSIX_UDP(const UA_String eventSourceName) {
     cm->cm.openConnection = UDP_openConnection;
     cm->cm.allocNetworkBuffer = UA_EventLoopPOSIX_allocNetworkBuffer;
     cm->cm.freeNetworkBuffer = UA_EventLoopPOSIX_freeNetworkBuffer;
+    cm->cm.registerNetworkBuffer = UA_EventLoopPOSIX_registerNetworkBuffer;
+    cm->cm.unregisterNetworkBuffer = UA_EventLoopPOSIX_unregisterNetworkBuffer;
     cm->cm.sendWithConnection = UDP_sendWithConnection;
     cm->cm.closeConnection = UDP_shutdownConnection;
     return &cm->cm;
@@ -116,6 +116,12 @@ struct UA_EventLoop {
      * processed. */
     UA_StatusCode (*run)(UA_EventLoop *el, UA_UInt32 timeout);
 
+    /* Interrupt the waiting for events in the current (or the next) run of
+     * the EventLoop. Can be called from any thread. For example to have
+     * delayed callbacks processed right away that were added from another
+     * thread. Can be NULL if not supported by the EventLoop. */
+    void (*cancel)(UA_EventLoop *el);
+
     /* Clean up the EventLoop and free allocated memory. Can fail if the
      * EventLoop is not stopped. */
     UA_StatusCode (*free)(UA_EventLoop *el);
@@ -374,6 +380,21 @@ struct UA_ConnectionManager {
     void
     (*freeNetworkBuffer)(UA_ConnectionManager *cm, uintptr_t connectionId,
                          UA_ByteString *buf);
+
+    /* Registered Send Buffers
+     * ~~~~~~~~~~~~~~~~~~~~~~~
+     * Optional, can be NULL. A registered buffer is owned by the
+     * ConnectionManager until it is unregistered. It is not released by
+     * `sendWithConnection` and its content stays in place after sending. So
+     * a precomputed message can be updated and sent repeatedly without an
+     * allocation or copy per message. The buffer must not be modified while
+     * a send with the buffer is ongoing. */
+    UA_StatusCode
+    (*registerNetworkBuffer)(UA_ConnectionManager *cm, uintptr_t connectionId,
+                             UA_ByteString *buf, size_t bufSize);
+    void
+    (*unregisterNetworkBuffer)(UA_ConnectionManager *cm, uintptr_t connectionId,
+                               UA_ByteString *buf);
 };
 
 /**
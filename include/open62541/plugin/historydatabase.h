@@ -14,6 +14,22 @@ _UA_BEGIN_DECLS
 
 typedef struct UA_HistoryDatabase UA_HistoryDatabase;
 
+/* Cursor over the result values of a raw history read for one node. See
+ * openRawCursor below. The cursor is used with the server lock held. So
+ * getValue must not call the server API. */
+typedef struct UA_HistoryDataCursor UA_HistoryDataCursor;
+struct UA_HistoryDataCursor {
+    void *context;
+    size_t size; /* Number of values */
+
+    /* Returns the value at 0 <= index < size. The value remains valid until
+     * the cursor is closed. */
+    const UA_DataValue *
+    (*getValue)(UA_HistoryDataCursor *cursor, size_t index);
+
+    void (*close)(UA_HistoryDataCursor *cursor);
+};
+
 struct UA_HistoryDatabase {
     void *context;
 
@@ -178,6 +194,30 @@ struct UA_HistoryDatabase {
                          const UA_DeleteRawModifiedDetails *details,
                          UA_HistoryUpdateResult *result);
 
+    /* Optional. Opens a cursor over the values of a raw read for one node
+     * (isReadModified set to false). With cursors for all nodes of the request,
+     * the server encodes the values directly into the chunks of the response
+     * message. Large results are then never copied into the response.
+     *
+     * The server iterates over the values twice. First to compute the size of
+     * the encoded result, then to encode the values.
+     *
+     * Return UA_STATUSCODE_BADNOTSUPPORTED if the result cannot be returned by
+     * a cursor. For example because a continuation point is required. The
+     * server then falls back to readRaw for the entire request. Other bad
+     * StatusCodes are returned as the StatusCode of the HistoryReadResult. The
+     * cursor is only closed if UA_STATUSCODE_GOOD was returned. */
+    UA_StatusCode
+    (*openRawCursor)(UA_Server *server,
+                     void *hdbContext,
+                     const UA_NodeId *sessionId,
+                     void *sessionContext,
+                     const UA_RequestHeader *requestHeader,
+                     const UA_ReadRawModifiedDetails *historyReadDetails,
+                     UA_TimestampsToReturn timestampsToReturn,
+                     const UA_HistoryReadValueId *nodeToRead,
+                     UA_HistoryDataCursor *cursor);
+
     /* Add more function pointer here.
      * For example for read_event, read_annotation, update_details */
 };
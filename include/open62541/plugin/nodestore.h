@@ -568,11 +568,90 @@ typedef struct {
                                const UA_DataValue *data);
 } UA_ExternalValueCallback;
 
+/**
+ * .. _batched-data-source:
+ *
+ * Batched Data Source
+ * ~~~~~~~~~~~~~~~~~~~
+ * A batched DataSource reads the values of several nodes in one call. The Read
+ * service collects all operations of a ReadRequest whose nodes use the same
+ * batched read callback and calls it once. For example, a DataSource backed by
+ * a PLC can then fetch all values with a single fieldbus transaction. Reads of
+ * a single value (local API, MonitoredItem sampling) call the callback with
+ * one node.
+ *
+ * Writes are batched in the same way. The Write service calls the batched
+ * write callback once with all WriteValues of a WriteRequest for the nodes of
+ * the backend. The backend can complete the writes asynchronously, for example
+ * when the fieldbus transaction is still in flight. The WriteResponse is then
+ * sent once the results are submitted with ``UA_Server_setAsyncWriteResults``.
+ * Asynchronous completion requires ``UA_MULTITHREADING >= 100``. */
+typedef struct {
+    /* Copies the data from the source into the provided values. The memory
+     * handling of the values is the same as for the read callback of the
+     * normal DataSource (see above). The access rights of the session are
+     * checked before the callback for every node.
+     *
+     * @param server The server executing the callback
+     * @param sessionId The identifier of the session
+     * @param sessionContext Additional data attached to the session in the
+     *        access control layer
+     * @param nodesSize The number of nodes that are read
+     * @param nodeIds The identifiers of the nodes being read from
+     * @param nodeContexts Additional data attached to the nodes by the user
+     * @param includeSourceTimeStamp If true, then the datasource is expected to
+     *        set the source timestamp in the returned values
+     * @param ranges For every node, the numeric range that shall be returned
+     *        or NULL
+     * @param values The (non-null) DataValues that are returned to the client.
+     *        Operation-level errors are set as the status of the value.
+     * @return Returns a status code for logging. Error codes intended for the
+     *         original caller are set in the values. */
+    UA_StatusCode (*read)(UA_Server *server, const UA_NodeId *sessionId,
+                          void *sessionContext, size_t nodesSize,
+                          const UA_NodeId *nodeIds, void * const *nodeContexts,
+                          UA_Boolean includeSourceTimeStamp,
+                          const UA_NumericRange * const *ranges,
+                          UA_DataValue *values);
+
+    /* Write into the data source. Can be NULL if the operation is
+     * unsupported. The access rights of the session and the type of the
+     * values are checked before the callback for every node. The values are
+     * only valid during the callback.
+     *
+     * @param server The server executing the callback
+     * @param sessionId The identifier of the session
+     * @param sessionContext Additional data attached to the session in the
+     *        access control layer
+     * @param nodesSize The number of nodes that are written
+     * @param nodeIds The identifiers of the nodes being written to
+     * @param nodeContexts Additional data attached to the nodes by the user
+     * @param ranges For every node, the numeric range that shall be written
+     *        or NULL
+     * @param values The DataValues that are written
+     * @param asyncContext Context to complete the writes asynchronously. NULL
+     *        if the caller needs the results right away (local API, server
+     *        built without multithreading).
+     * @param results The (non-null) results for every node
+     * @return Returns UA_STATUSCODE_GOOD if the results are set. Returns
+     *         UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY (only if the
+     *         asyncContext is non-NULL) if the results are submitted later
+     *         with UA_Server_setAsyncWriteResults. Otherwise the returned
+     *         error is the result for all nodes. */
+    UA_StatusCode (*write)(UA_Server *server, const UA_NodeId *sessionId,
+                           void *sessionContext, size_t nodesSize,
+                           const UA_NodeId *nodeIds, void * const *nodeContexts,
+                           const UA_NumericRange * const *ranges,
+                           const UA_DataValue *values, void *asyncContext,
+                           UA_StatusCode *results);
+} UA_DataSourceBatch;
+
 typedef enum {
     UA_VALUEBACKENDTYPE_NONE,
     UA_VALUEBACKENDTYPE_INTERNAL,
     UA_VALUEBACKENDTYPE_DATA_SOURCE_CALLBACK,
-    UA_VALUEBACKENDTYPE_EXTERNAL
+    UA_VALUEBACKENDTYPE_EXTERNAL,
+    UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH
 } UA_ValueBackendType;
 
 typedef struct {
@@ -587,6 +666,7 @@ typedef struct {
             UA_DataValue **value;
             UA_ExternalValueCallback callback;
         } external;
+        UA_DataSourceBatch dataSourceBatch;
     } backend;
 } UA_ValueBackend;
 
@@ -622,6 +702,9 @@ typedef struct {
                            * background. Only dynamic variables conserve source
                            * and server timestamp for the value attribute.
                            * Static variables have timestamps of "now". */
+    UA_UInt64 valueVersion; /* Set to a new server-wide unique version when the
+                             * node is added and for every write of the
+                             * internal value. Zero if unknown. */
 } UA_VariableNode;
 
 /**
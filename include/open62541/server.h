@@ -180,6 +180,18 @@ struct UA_ServerConfig {
                               * (default: 0 -> unbounded) */
     UA_Boolean tcpReuseAddr;
 
+    /* With reactors configured, the TCP connections are not handled by the
+     * configured EventLoop. Every reactor runs its own EventLoop in a separate
+     * thread and listens on the server port with SO_REUSEPORT. The kernel
+     * distributes the new connections among the reactors. Receiving,
+     * decrypting and decoding the requests of a SecureChannel is done in the
+     * thread of its reactor. The services are executed with the server lock.
+     * Only available for POSIX architectures. */
+#if UA_MULTITHREADING >= 100
+    UA_UInt16 tcpReactors; /* Number of reactor threads. 0 => disabled
+                            * (default) */
+#endif
+
     /**
      * Security and Encryption
      * ^^^^^^^^^^^^^^^^^^^^^^^ */
@@ -269,6 +281,26 @@ struct UA_ServerConfig {
     UA_Server_AsyncOperationNotifyCallback asyncOperationNotifyCallback;
 #endif
 
+    /**
+     * Parallel Services
+     * ^^^^^^^^^^^^^^^^^
+     * The read-only services (Read, Browse, BrowseNext and
+     * TranslateBrowsePathsToNodeIds) can be executed by a pool of worker
+     * threads. The workers run concurrently with each other, but never
+     * concurrently with services that modify the server. The requests of a
+     * session are still processed one after the other. Decoding, encoding and
+     * sending of the messages stays in the EventLoop thread. HistoryRead is not
+     * executed by the workers, as its results are streamed into the
+     * SecureChannel while they are read from the HistoryDatabase.
+     *
+     * With service workers enabled, the user callbacks invoked from these
+     * services (AccessControl, DataSources and onRead of value callbacks) may
+     * run concurrently in several threads and must be thread-safe. */
+#if UA_MULTITHREADING >= 100
+    UA_UInt16 serviceWorkers; /* Number of worker threads. 0 => disabled
+                               * (default) */
+#endif
+
     /**
      * Discovery
      * ^^^^^^^^^ */
@@ -1927,6 +1959,10 @@ UA_Server_getNamespaceByIndex(UA_Server *server, const size_t namespaceIndex,
  * ready. See the examples in ``/examples/tutorial_server_method_async.c`` for
  * the usage.
  *
+ * Batched writes into a ``UA_DataSourceBatch`` backend are not queued for the
+ * workers. They are handed to the write callback of the backend directly. The
+ * backend can complete them later with ``UA_Server_setAsyncWriteResults``.
+ *
  * Note that the operation can time out (see the asyncOperationTimeout setting in
  * the server config) also when it has been retrieved by the worker. */
 
@@ -1939,9 +1975,9 @@ UA_Server_setMethodNodeAsync(UA_Server *server, const UA_NodeId id,
 
 typedef enum {
     UA_ASYNCOPERATIONTYPE_INVALID, /* 0, the default */
-    UA_ASYNCOPERATIONTYPE_CALL
+    UA_ASYNCOPERATIONTYPE_CALL,
     /* UA_ASYNCOPERATIONTYPE_READ, */
-    /* UA_ASYNCOPERATIONTYPE_WRITE, */
+    UA_ASYNCOPERATIONTYPE_WRITE /* Batched writes. Not handed to the workers. */
 } UA_AsyncOperationType;
 
 typedef union {
@@ -1988,6 +2024,16 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
                                   const UA_AsyncOperationResponse *response,
                                   void *context);
 
+/* Submit the results of a batched write that completes asynchronously (see
+ * the write callback of UA_DataSourceBatch). Can be called from any thread.
+ *
+ * @param server The server object
+ * @param asyncContext The asyncContext from the write callback
+ * @param results One result for every node of the batched write */
+void UA_EXPORT
+UA_Server_setAsyncWriteResults(UA_Server *server, void *asyncContext,
+                               const UA_StatusCode *results);
+
 #endif /* !UA_MULTITHREADING >= 100 */
 
 /**
@@ -2004,6 +2050,51 @@ typedef struct {
 UA_ServerStatistics UA_EXPORT
 UA_Server_getStatistics(UA_Server *server);
 
+/* The latency of a service is measured from the reception of the request until
+ * the service returns. This includes the decoding of the request, the
+ * dispatching and (for the service workers) the time in the queue. Sending the
+ * response is not included. Asynchronous operations are not measured. */
+#ifdef UA_ENABLE_DIAGNOSTICS
+
+#define UA_SERVICELATENCY_BUCKETS 13
+
+typedef struct {
+    UA_UInt64 count;        /* Number of measured requests */
+    UA_DateTime totalTime;  /* Sum of the latencies */
+    UA_DateTime maxTime;
+    /* The upper bound of histogram bucket i is 10us * 2^i. The last bucket
+     * counts everything above 20ms. */
+    UA_UInt64 histogram[UA_SERVICELATENCY_BUCKETS];
+} UA_ServiceLatency;
+
+/* Get the latency statistics for the service of the given request type
+ * (e.g. &UA_TYPES[UA_TYPES_READREQUEST]) */
+UA_StatusCode UA_EXPORT
+UA_Server_getServiceLatency(UA_Server *server, const UA_DataType *requestType,
+                            UA_ServiceLatency *latency);
+
+/* MonitoredItems with the same (positive) sampling interval are sampled
+ * together from a single timer in the EventLoop. A sampling batch samples all
+ * MonitoredItems of one sampling interval. */
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+
+typedef struct {
+    size_t samplingTimers;       /* Number of timers for the sampling (one per
+                                  * sampling interval) */
+    size_t monitoredItems;       /* Number of cyclically sampled MonitoredItems */
+    UA_UInt64 batches;           /* Number of executed sampling batches */
+    UA_DateTime lastBatchTime;   /* Duration of the last batch */
+    UA_DateTime maxBatchTime;
+    UA_DateTime totalBatchTime;
+} UA_SamplingStatistics;
+
+void UA_EXPORT
+UA_Server_getSamplingStatistics(UA_Server *server, UA_SamplingStatistics *stats);
+
+#endif
+
+#endif
+
 /**
  * Reverse Connect
  * ---------------
@@ -440,6 +440,9 @@ typedef struct {
                                           UA_UInt64 callbackId, UA_Double interval_ms,
                                           UA_DateTime *baseTime, UA_TimerPolicy timerPolicy);
 
+    /* A cycle that already runs may still be in flight when
+     * removeCustomCallback returns. But the callback must not be started
+     * anymore afterwards, as its data can be freed. */
     void (*removeCustomCallback)(UA_Server *server, UA_NodeId identifier, UA_UInt64 callbackId);
 
 } UA_PubSub_CallbackLifecycle;
@@ -470,20 +473,28 @@ typedef enum {
  * ---> Description: Default "none-RT" Mode
  * ---> Requirements: -
  * ---> Restrictions: -
- * UA_PUBSUB_RT_DIRECT_VALUE_ACCESS (Preview - not implemented)
+ * UA_PUBSUB_RT_DIRECT_VALUE_ACCESS
  * ---> Description: Normally, the latest value for each DataSetField is read out of the information model. Within this RT-mode, the
- * value source of each field configured as static pointer to an DataValue. The publish cycle won't use call the server read function.
- * ---> Requirements: All fields must be configured with a 'staticValueSource'.
- * ---> Restrictions: -
- * UA_PUBSUB_RT_FIXED_LENGTH (Preview - not implemented)
+ * value source of each field is configured as static pointer to a DataValue. The pointer is resolved when the configuration is frozen
+ * and the publish cycle neither calls the server read function nor looks up the nodestore. The value can be double-buffered by
+ * atomically swapping the DataValue pointer (e.g. with UA_atomic_xchg) between two preallocated DataValues.
+ * ---> Requirements: All fields must be configured with a 'staticValueSource' or an information model node with external value backend.
+ * ---> Restrictions: Combined with UA_PUBSUB_RT_FIXED_SIZE and without message security, the frozen WriterGroup publishes without
+ * taking the server lock. The publish callback can then run in a dedicated (realtime) thread, e.g. via the pubsubManagerCallback.
+ * Unfreezing or disabling the WriterGroup waits until a publish cycle in flight has finished. The values swapped in must keep the
+ * type and size of the value at freeze time.
+ * UA_PUBSUB_RT_FIXED_SIZE
  * ---> Description: All DataSetFields have a known, non-changing length. The server will pre-generate some
- * buffers and use only memcopy operations to generate requested PubSub packages.
+ * buffers and use only memcopy operations to generate requested PubSub packages. If the ConnectionManager supports registered
+ * send buffers, the message is updated in place in a ring of such buffers and sent without a copy.
  * ---> Requirements: DataSetFields with variable size cannot be used within this mode.
  * ---> Restrictions: The configuration must be frozen and changes are not allowed while the WriterGroup is 'Operational'.
- * UA_PUBSUB_RT_DETERMINISTIC (Preview - not implemented)
- * ---> Description: -
- * ---> Requirements: -
- * ---> Restrictions: -
+ * UA_PUBSUB_RT_DETERMINISTIC
+ * ---> Description: Implies UA_PUBSUB_RT_FIXED_SIZE and UA_PUBSUB_RT_DIRECT_VALUE_ACCESS. The write position of every field in the
+ * send buffer is computed when the configuration is frozen. Each cycle only copies the raw value bytes to these positions. The publish
+ * timer is aligned to the configured base time instead of drifting with the callback execution time.
+ * ---> Requirements: All fields must be scalars of a fixed-size type. The fields must be encoded as Variant or RawData.
+ * ---> Restrictions: Same as for UA_PUBSUB_RT_FIXED_SIZE.
  *
  * WARNING! For hard real time requirements the underlying system must be rt-capable.
  *
@@ -808,7 +819,16 @@ UA_Server_removeStandaloneSubscribedDataSet(UA_Server *server,
  * - PUBSUB_CONFIG_FASTPATH_FIXED_OFFSETS: Extends PubSub RT functionality and
  *   implements fast path message decoding in the Subscriber. Uses a buffered
  *   network message and only decodes the necessary offsets stored in an offset
- *   buffer. */
+ *   buffer.
+ *
+ * A frozen fixed-size ReaderGroup matches received messages to its
+ * DataSetReaders with a lookup table on (PublisherId, WriterGroupId,
+ * DataSetWriterId). The cost does not depend on the number of readers. This
+ * requires numeric PublisherIds, no message security and a single
+ * DataSetMessage per NetworkMessage. Otherwise the headers are decoded and
+ * every reader is checked. After the first message, a reader with only scalar
+ * numeric or Boolean fields (and no beforeWrite callback) copies the received
+ * values directly into the external value backends of the target variables. */
 
 /* ReaderGroup configuration */
 typedef struct {
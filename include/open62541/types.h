@@ -730,9 +730,13 @@ typedef struct UA_DataType UA_DataType;
 
 typedef enum {
     UA_VARIANT_DATA,         /* The data has the same lifecycle as the variant */
-    UA_VARIANT_DATA_NODELETE /* The data is "borrowed" by the variant and is
-                              * not deleted when the variant is cleared up.
-                              * The array dimensions also borrowed. */
+    UA_VARIANT_DATA_NODELETE, /* The data is "borrowed" by the variant and is
+                               * not deleted when the variant is cleared up.
+                               * The array dimensions also borrowed. */
+    UA_VARIANT_DATA_SHARED   /* The data is held in a reference-counted buffer.
+                              * Copies of the variant share the buffer. It is
+                              * deleted when the last copy is cleared up. See
+                              * UA_Variant_makeShared. */
 } UA_VariantStorageType;
 
 typedef struct {
@@ -827,6 +831,36 @@ UA_StatusCode UA_EXPORT
 UA_Variant_setArrayCopy(UA_Variant *v, const void * UA_RESTRICT array,
                         size_t arraySize, const UA_DataType *type);
 
+/* Move the data of the variant into a reference-counted buffer. Afterwards,
+ * copying the variant (also as part of a DataValue or a Read response) only
+ * increases the reference count instead of copying the data. This is useful
+ * for large values that are copied to many readers, e.g. the value of a
+ * VariableNode that is monitored by many clients.
+ *
+ * The shared data must not be modified in-place. Call
+ * UA_Variant_makeWritable first, which creates a private copy if the buffer
+ * is shared with other variants (copy-on-write).
+ *
+ * Sharing is opt-in. The server never makes values shared on its own, as
+ * existing code may modify node values in-place. A shared value written into a
+ * VariableNode (e.g. with UA_Server_writeValue) stays shared. Then the Read
+ * results and the samples of the MonitoredItems reference the same buffer.
+ *
+ * @param v The variant
+ * @return Indicates whether the operation succeeded or returns an error code */
+UA_StatusCode UA_EXPORT
+UA_Variant_makeShared(UA_Variant *v);
+
+/* Ensure that the data of the variant can be modified in-place. If the data is
+ * held in a shared buffer, it is moved (last reference) or copied into a
+ * buffer owned by the variant alone. The storage type is then
+ * UA_VARIANT_DATA.
+ *
+ * @param v The variant
+ * @return Indicates whether the operation succeeded or returns an error code */
+UA_StatusCode UA_EXPORT
+UA_Variant_makeWritable(UA_Variant *v);
+
 /* Copy the variant, but use only a subset of the (multidimensional) array into
  * a variant. Returns an error code if the variant is not an array or if the
  * indicated range does not fit.
@@ -842,6 +876,7 @@ UA_Variant_copyRange(const UA_Variant *src, UA_Variant * UA_RESTRICT dst,
 /* Insert a range of data into an existing variant. The data array cannot be
  * reused afterwards if it contains types without a fixed size (e.g. strings)
  * since the members are moved into the variant and take on its lifecycle.
+ * Shared variant data is made writable first (see UA_Variant_makeWritable).
  *
  * @param v The variant
  * @param dataArray The data array. The type must match the variant
@@ -22,31 +22,48 @@ swapBuffers(UA_ByteString *const bufA, UA_ByteString *const bufB) {
     *bufB = tmp;
 }
 
+static const mbedtls_md_info_t *
+getMdInfo(const mbedtls_md_context_t *context) {
+#if MBEDTLS_VERSION_NUMBER >= 0x02060000 && MBEDTLS_VERSION_NUMBER < 0x03000000
+    return context->md_info;
+#else
+    return context->private_md_info;
+#endif
+}
+
 UA_StatusCode
 mbedtls_hmac(mbedtls_md_context_t *context, const UA_ByteString *key,
              const UA_ByteString *in, unsigned char *out) {
-
-    if(mbedtls_md_hmac_starts(context, key->data, key->length) != 0)
-        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
-
-    if(mbedtls_md_hmac_update(context, in->data, in->length) != 0)
+#if UA_MULTITHREADING >= 100
+    /* The context is shared by all channels of the SecurityPolicy. The
+     * channels can be processed in parallel threads. So the context only
+     * selects the hash function. The HMAC is computed in a local context. */
+    mbedtls_md_context_t localContext;
+    mbedtls_md_init(&localContext);
+    if(mbedtls_md_setup(&localContext, getMdInfo(context), 1) != 0) {
+        mbedtls_md_free(&localContext);
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    }
+    context = &localContext;
+#endif
 
-    if(mbedtls_md_hmac_finish(context, out) != 0)
-        return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    UA_StatusCode res = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+    if(mbedtls_md_hmac_starts(context, key->data, key->length) == 0 &&
+       mbedtls_md_hmac_update(context, in->data, in->length) == 0 &&
+       mbedtls_md_hmac_finish(context, out) == 0)
+        res = UA_STATUSCODE_GOOD;
 
-    return UA_STATUSCODE_GOOD;
+#if UA_MULTITHREADING >= 100
+    mbedtls_md_free(&localContext);
+#endif
+    return res;
 }
 
 UA_StatusCode
 mbedtls_generateKey(mbedtls_md_context_t *context,
                     const UA_ByteString *secret, const UA_ByteString *seed,
                     UA_ByteString *out) {
-#if MBEDTLS_VERSION_NUMBER >= 0x02060000 && MBEDTLS_VERSION_NUMBER < 0x03000000
-    size_t hashLen = (size_t)mbedtls_md_get_size(context->md_info);
-#else
-    size_t hashLen = (size_t)mbedtls_md_get_size(context->private_md_info);
-#endif
+    size_t hashLen = (size_t)mbedtls_md_get_size(getMdInfo(context));
 
     UA_ByteString A_and_seed;
     UA_ByteString_allocBuffer(&A_and_seed, hashLen + seed->length);
@@ -454,6 +454,60 @@ deleteRawModified_service_default(UA_Server *server,
                                                           details->endTime);
 }
 
+/* Checks whether the node can be read. Returns the historizing settings of
+ * the node. */
+static UA_StatusCode
+checkReadRaw_service_default(UA_Server *server,
+                             UA_HistoryDatabaseContext_default *ctx,
+                             const UA_NodeId *sessionId,
+                             void *sessionContext,
+                             const UA_ReadRawModifiedDetails *historyReadDetails,
+                             UA_TimestampsToReturn timestampsToReturn,
+                             const UA_HistoryReadValueId *nodeToRead,
+                             const UA_HistorizingNodeIdSettings **outSetting)
+{
+    UA_Byte accessLevel = 0;
+    UA_Server_readAccessLevel(server,
+                              nodeToRead->nodeId,
+                              &accessLevel);
+    if (!(accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD))
+        return UA_STATUSCODE_BADUSERACCESSDENIED;
+
+    UA_Boolean historizing = false;
+    UA_Server_readHistorizing(server,
+                              nodeToRead->nodeId,
+                              &historizing);
+    if (!historizing)
+        return UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+
+    const UA_HistorizingNodeIdSettings *setting = ctx->gathering.getHistorizingSetting(
+                server,
+                ctx->gathering.context,
+                &nodeToRead->nodeId);
+    if (!setting)
+        return UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+
+    if (historyReadDetails->returnBounds && !setting->historizingBackend.boundSupported(
+                server,
+                setting->historizingBackend.context,
+                sessionId,
+                sessionContext,
+                &nodeToRead->nodeId))
+        return UA_STATUSCODE_BADBOUNDNOTSUPPORTED;
+
+    if (!setting->historizingBackend.timestampsToReturnSupported(
+                server,
+                setting->historizingBackend.context,
+                sessionId,
+                sessionContext,
+                &nodeToRead->nodeId,
+                timestampsToReturn))
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+
+    *outSetting = setting;
+    return UA_STATUSCODE_GOOD;
+}
+
 static void
 readRaw_service_default(UA_Server *server,
                         void *context,
@@ -470,52 +524,13 @@ readRaw_service_default(UA_Server *server,
 {
     UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
     for (size_t i = 0; i < nodesToReadSize; ++i) {
-        UA_Byte accessLevel = 0;
-        UA_Server_readAccessLevel(server,
-                                  nodesToRead[i].nodeId,
-                                  &accessLevel);
-        if (!(accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD)) {
-            response->results[i].statusCode = UA_STATUSCODE_BADUSERACCESSDENIED;
-            continue;
-        }
-
-        UA_Boolean historizing = false;
-        UA_Server_readHistorizing(server,
-                                  nodesToRead[i].nodeId,
-                                  &historizing);
-        if (!historizing) {
-            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
-            continue;
-        }
-
-        const UA_HistorizingNodeIdSettings *setting = ctx->gathering.getHistorizingSetting(
-                    server,
-                    ctx->gathering.context,
-                    &nodesToRead[i].nodeId);
-
-        if (!setting) {
-            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
-            continue;
-        }
-
-        if (historyReadDetails->returnBounds && !setting->historizingBackend.boundSupported(
-                    server,
-                    setting->historizingBackend.context,
-                    sessionId,
-                    sessionContext,
-                    &nodesToRead[i].nodeId)) {
-            response->results[i].statusCode = UA_STATUSCODE_BADBOUNDNOTSUPPORTED;
-            continue;
-        }
-
-        if (!setting->historizingBackend.timestampsToReturnSupported(
-                    server,
-                    setting->historizingBackend.context,
-                    sessionId,
-                    sessionContext,
-                    &nodesToRead[i].nodeId,
-                    timestampsToReturn)) {
-            response->results[i].statusCode = UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+        const UA_HistorizingNodeIdSettings *setting = NULL;
+        UA_StatusCode checkStatusCode =
+            checkReadRaw_service_default(server, ctx, sessionId, sessionContext,
+                                         historyReadDetails, timestampsToReturn,
+                                         &nodesToRead[i], &setting);
+        if (checkStatusCode != UA_STATUSCODE_GOOD) {
+            response->results[i].statusCode = checkStatusCode;
             continue;
         }
 
@@ -578,6 +593,121 @@ readRaw_service_default(UA_Server *server,
     return;
 }
 
+/* The cursor points into the backend. Only results that are returned in full
+ * (without bounds and continuation points) are provided by a cursor. The
+ * values are the same that getHistoryData_service_default copies. */
+typedef struct {
+    const UA_HistoryDataBackend *backend;
+    UA_Server *server;
+    const UA_NodeId *sessionId;
+    void *sessionContext;
+    UA_NodeId nodeId;
+    size_t startIndex;
+    UA_Boolean reverse;
+} UA_HistoryDataCursorContext_default;
+
+static const UA_DataValue *
+cursorGetValue_service_default(UA_HistoryDataCursor *cursor, size_t index)
+{
+    UA_HistoryDataCursorContext_default *cc =
+        (UA_HistoryDataCursorContext_default*)cursor->context;
+    size_t storeIndex = (cc->reverse) ? cc->startIndex - index : cc->startIndex + index;
+    return cc->backend->getDataValue(cc->server, cc->backend->context, cc->sessionId,
+                                     cc->sessionContext, &cc->nodeId, storeIndex);
+}
+
+static void
+cursorClose_service_default(UA_HistoryDataCursor *cursor)
+{
+    UA_HistoryDataCursorContext_default *cc =
+        (UA_HistoryDataCursorContext_default*)cursor->context;
+    UA_NodeId_clear(&cc->nodeId);
+    UA_free(cc);
+    cursor->context = NULL;
+}
+
+static UA_StatusCode
+openRawCursor_service_default(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_RequestHeader *requestHeader,
+                              const UA_ReadRawModifiedDetails *historyReadDetails,
+                              UA_TimestampsToReturn timestampsToReturn,
+                              const UA_HistoryReadValueId *nodeToRead,
+                              UA_HistoryDataCursor *cursor)
+{
+    /* Bounds, index ranges and continuation points are handled by readRaw */
+    if (historyReadDetails->returnBounds || nodeToRead->indexRange.length > 0 ||
+        nodeToRead->continuationPoint.length > 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    const UA_HistorizingNodeIdSettings *setting = NULL;
+    UA_StatusCode res =
+        checkReadRaw_service_default(server, ctx, sessionId, sessionContext,
+                                     historyReadDetails, timestampsToReturn,
+                                     nodeToRead, &setting);
+    if (res != UA_STATUSCODE_GOOD)
+        return res;
+
+    const UA_HistoryDataBackend *backend = &setting->historizingBackend;
+    if (backend->getHistoryData)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    size_t startIndex;
+    size_t endIndex;
+    UA_Boolean addFirst;
+    UA_Boolean addLast;
+    UA_Boolean reverse;
+    size_t size = getResultSize_service_default(backend,
+                                                server,
+                                                sessionId,
+                                                sessionContext,
+                                                &nodeToRead->nodeId,
+                                                historyReadDetails->startTime,
+                                                historyReadDetails->endTime,
+                                                0,
+                                                false,
+                                                &startIndex,
+                                                &endIndex,
+                                                &addFirst,
+                                                &addLast,
+                                                &reverse);
+
+    /* The result does not fit into a single response */
+    if ((historyReadDetails->numValuesPerNode != 0 && size > historyReadDetails->numValuesPerNode) ||
+        size > setting->maxHistoryDataResponseSize)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    size_t storeEnd = backend->getEnd(server, backend->context, sessionId, sessionContext,
+                                      &nodeToRead->nodeId);
+    if (startIndex == storeEnd || endIndex == storeEnd)
+        size = 0;
+
+    UA_HistoryDataCursorContext_default *cc = (UA_HistoryDataCursorContext_default*)
+        UA_calloc(1, sizeof(UA_HistoryDataCursorContext_default));
+    if (!cc)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    res = UA_NodeId_copy(&nodeToRead->nodeId, &cc->nodeId);
+    if (res != UA_STATUSCODE_GOOD) {
+        UA_free(cc);
+        return res;
+    }
+    cc->backend = backend;
+    cc->server = server;
+    cc->sessionId = sessionId;
+    cc->sessionContext = sessionContext;
+    cc->startIndex = startIndex;
+    cc->reverse = reverse;
+
+    cursor->context = cc;
+    cursor->size = size;
+    cursor->getValue = cursorGetValue_service_default;
+    cursor->close = cursorClose_service_default;
+    return UA_STATUSCODE_GOOD;
+}
+
 static void
 setValue_service_default(UA_Server *server,
                          void *context,
@@ -619,6 +749,7 @@ UA_HistoryDatabase_default(UA_HistoryDataGathering gathering)
     context->gathering = gathering;
     hdb.context = context;
     hdb.readRaw = &readRaw_service_default;
+    hdb.openRawCursor = &openRawCursor_service_default;
     hdb.setValue = &setValue_service_default;
     hdb.updateData = &updateData_service_default;
     hdb.deleteRawModified = &deleteRawModified_service_default;
@@ -18,6 +18,15 @@ _UA_BEGIN_DECLS
 UA_EXPORT UA_StatusCode
 UA_Nodestore_HashMap(UA_Nodestore *ns);
 
+/* The concurrent HashMap Nodestore splits the nodes over several hash-maps
+ * (shards) with a lock each. Nodes can be looked up and released from several
+ * threads at the same time. Also while other threads add, replace or remove
+ * nodes. Releasing a node does not take a lock. Use this Nodestore if nodes are
+ * accessed directly from threads other than the server (without holding the
+ * server lock). */
+UA_EXPORT UA_StatusCode
+UA_Nodestore_ConcurrentHashMap(UA_Nodestore *ns);
+
 /* The ZipTree Nodestore holds all nodes in RAM in a tree structure. The lookup
  * time is about O(log n). Adding/removing nodes does not require resizing of
  * the underlying array with the linear overhead.
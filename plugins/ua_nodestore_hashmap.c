@@ -23,7 +23,9 @@
 
 typedef struct UA_NodeMapEntry {
     struct UA_NodeMapEntry *orig; /* the version this is a copy from (or NULL) */
-    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_UInt32 refCount; /* How many consumers have a reference to the node?
+                         * Changed atomically, as nodes can be read from
+                         * several threads in parallel. */
     UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
     UA_Node node;
 } UA_NodeMapEntry;
@@ -41,12 +43,20 @@ typedef struct {
     UA_UInt32 size;
     UA_UInt32 count;
     UA_UInt32 sizePrimeIndex;
-
-    /* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
-    UA_NodeId referenceTypeIds[UA_REFERENCETYPESET_MAX];
-    UA_Byte referenceTypeCounter;
 } UA_NodeMap;
 
+/* Maps ReferenceTypeIndex to the NodeId of the ReferenceType */
+typedef struct {
+    UA_NodeId ids[UA_REFERENCETYPESET_MAX];
+    UA_Byte counter;
+} UA_NodeMapRefTypes;
+
+typedef struct {
+    UA_NodeMap map; /* Must be the first member. The context pointer is cast
+                     * to the UA_NodeMap directly. */
+    UA_NodeMapRefTypes refTypes;
+} UA_NodeMapStore;
+
 /*********************/
 /* HashMap Utilities */
 /*********************/
@@ -148,6 +158,17 @@ expand(UA_NodeMap *ns) {
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+initNodeMap(UA_NodeMap *ns) {
+    ns->sizePrimeIndex = higher_prime_index(UA_NODEMAP_MINSIZE);
+    ns->size = primes[ns->sizePrimeIndex];
+    ns->count = 0;
+    ns->slots = (UA_NodeMapSlot*)UA_calloc(ns->size, sizeof(UA_NodeMapSlot));
+    if(!ns->slots)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_NodeMapEntry *
 createEntry(UA_NodeClass nodeClass) {
     size_t size = sizeof(UA_NodeMapEntry) - sizeof(UA_Node);
@@ -194,19 +215,56 @@ deleteNodeMapEntry(UA_NodeMapEntry *entry) {
 
 static void
 cleanupNodeMapEntry(UA_NodeMapEntry *entry) {
-    if(entry->refCount > 0)
+    if(entry->refCount > 0 || !entry->deleted)
         return;
-    if(entry->deleted) {
-        deleteNodeMapEntry(entry);
-        return;
-    }
-    for(size_t i = 0; i < entry->node.head.referencesSize; i++) {
-        UA_NodeReferenceKind *rk = &entry->node.head.references[i];
+    deleteNodeMapEntry(entry);
+}
+
+/* Switch large reference arrays to the tree representation before the node
+ * becomes visible. Nodes in the map are not modified in-place afterwards. So
+ * they can be read from several threads in parallel. */
+static void
+prepareNodeMapEntry(UA_Node *node) {
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &node->head.references[i];
         if(rk->targetsSize > 16 && !rk->hasRefTree)
             UA_NodeReferenceKind_switch(rk);
     }
 }
 
+/* For new ReferenceTypeNodes add to the index map */
+static UA_StatusCode
+addReferenceType(UA_NodeMapRefTypes *rt, UA_Node *node) {
+    if(node->head.nodeClass != UA_NODECLASS_REFERENCETYPE)
+        return UA_STATUSCODE_GOOD;
+    if(rt->counter >= UA_REFERENCETYPESET_MAX)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_StatusCode retval = UA_NodeId_copy(&node->head.nodeId, &rt->ids[rt->counter]);
+    if(retval != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    /* Assign the ReferenceTypeIndex to the new ReferenceTypeNode */
+    UA_ReferenceTypeNode *refNode = &node->referenceTypeNode;
+    refNode->referenceTypeIndex = rt->counter;
+    refNode->subTypes = UA_REFTYPESET(rt->counter);
+    rt->counter++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_NodeId *
+getReferenceType(const UA_NodeMapRefTypes *rt, UA_Byte refTypeIndex) {
+    if(refTypeIndex >= rt->counter)
+        return NULL;
+    return &rt->ids[refTypeIndex];
+}
+
+static void
+clearReferenceTypes(UA_NodeMapRefTypes *rt) {
+    for(size_t i = 0; i < rt->counter; i++)
+        UA_NodeId_clear(&rt->ids[i]);
+    rt->counter = 0;
+}
+
 static UA_NodeMapSlot *
 findOccupiedSlot(const UA_NodeMap *ns, const UA_NodeId *nodeid) {
     UA_UInt32 h = UA_NodeId_hash(nodeid);
@@ -262,7 +320,7 @@ UA_NodeMap_getNode(void *context, const UA_NodeId *nodeid,
     UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
     if(!slot)
         return NULL;
-    ++slot->entry->refCount;
+    UA_atomic_addUInt32(&slot->entry->refCount, 1);
     return &slot->entry->node;
 }
 
@@ -284,7 +342,8 @@ UA_NodeMap_releaseNode(void *context, const UA_Node *node) {
     UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
     UA_assert(&entry->node == node);
     UA_assert(entry->refCount > 0);
-    --entry->refCount;
+    if(UA_atomic_subUInt32(&entry->refCount, 1) > 0)
+        return;
     cleanupNodeMapEntry(entry);
 }
 
@@ -395,27 +454,16 @@ UA_NodeMap_insertNode(void *context, UA_Node *node,
     }
 
     /* For new ReferencetypeNodes add to the index map */
-    if(node->head.nodeClass == UA_NODECLASS_REFERENCETYPE) {
-        UA_ReferenceTypeNode *refNode = &node->referenceTypeNode;
-        if(ns->referenceTypeCounter >= UA_REFERENCETYPESET_MAX) {
-            deleteNodeMapEntry(container_of(node, UA_NodeMapEntry, node));
-            return UA_STATUSCODE_BADINTERNALERROR;
-        }
-
-        retval = UA_NodeId_copy(&node->head.nodeId, &ns->referenceTypeIds[ns->referenceTypeCounter]);
-        if(retval != UA_STATUSCODE_GOOD) {
-            deleteNodeMapEntry(container_of(node, UA_NodeMapEntry, node));
-            return UA_STATUSCODE_BADINTERNALERROR;
-        }
-
-        /* Assign the ReferenceTypeIndex to the new ReferenceTypeNode */
-        refNode->referenceTypeIndex = ns->referenceTypeCounter;
-        refNode->subTypes = UA_REFTYPESET(ns->referenceTypeCounter);
-
-        ns->referenceTypeCounter++;
+    retval = addReferenceType(&((UA_NodeMapStore*)context)->refTypes, node);
+    if(retval != UA_STATUSCODE_GOOD) {
+        if(addedNodeId)
+            UA_NodeId_clear(addedNodeId);
+        deleteNodeMapEntry(container_of(node, UA_NodeMapEntry, node));
+        return retval;
     }
 
     /* Insert the node */
+    prepareNodeMapEntry(node);
     UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
     slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
     slot->entry = newEntry;
@@ -443,6 +491,7 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
     }
 
     /* Replace the entry */
+    prepareNodeMapEntry(node);
     slot->entry = newEntry;
     oldEntry->deleted = true;
     cleanupNodeMapEntry(oldEntry);
@@ -451,10 +500,8 @@ UA_NodeMap_replaceNode(void *context, UA_Node *node) {
 
 static const UA_NodeId *
 UA_NodeMap_getReferenceTypeId(void *nsCtx, UA_Byte refTypeIndex) {
-    UA_NodeMap *ns = (UA_NodeMap*)nsCtx;
-    if(refTypeIndex >= ns->referenceTypeCounter)
-        return NULL;
-    return &ns->referenceTypeIds[refTypeIndex];
+    UA_NodeMapStore *store = (UA_NodeMapStore*)nsCtx;
+    return getReferenceType(&store->refTypes, refTypeIndex);
 }
 
 static void
@@ -465,10 +512,11 @@ UA_NodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
         UA_NodeMapSlot *slot = &ns->slots[i];
         if(slot->entry > UA_NODEMAP_TOMBSTONE) {
             /* The visitor can delete the node. So refcount here. */
-            slot->entry->refCount++;
-            visitor(visitorContext, &slot->entry->node);
-            slot->entry->refCount--;
-            cleanupNodeMapEntry(slot->entry);
+            UA_NodeMapEntry *entry = slot->entry;
+            UA_atomic_addUInt32(&entry->refCount, 1);
+            visitor(visitorContext, &entry->node);
+            UA_atomic_subUInt32(&entry->refCount, 1);
+            cleanupNodeMapEntry(entry);
         }
     }
 }
@@ -493,32 +541,26 @@ UA_NodeMap_delete(void *context) {
     UA_free(ns->slots);
 
     /* Clean up the ReferenceTypes index array */
-    for(size_t i = 0; i < ns->referenceTypeCounter; i++)
-        UA_NodeId_clear(&ns->referenceTypeIds[i]);
+    clearReferenceTypes(&((UA_NodeMapStore*)context)->refTypes);
 
-    UA_free(ns);
+    UA_free(context);
 }
 
 UA_StatusCode
 UA_Nodestore_HashMap(UA_Nodestore *ns) {
     /* Allocate and initialize the nodemap */
-    UA_NodeMap *nodemap = (UA_NodeMap*)UA_malloc(sizeof(UA_NodeMap));
-    if(!nodemap)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    nodemap->sizePrimeIndex = higher_prime_index(UA_NODEMAP_MINSIZE);
-    nodemap->size = primes[nodemap->sizePrimeIndex];
-    nodemap->count = 0;
-    nodemap->slots = (UA_NodeMapSlot*)
-        UA_calloc(nodemap->size, sizeof(UA_NodeMapSlot));
-    if(!nodemap->slots) {
-        UA_free(nodemap);
+    UA_NodeMapStore *store = (UA_NodeMapStore*)UA_malloc(sizeof(UA_NodeMapStore));
+    if(!store)
         return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = initNodeMap(&store->map);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(store);
+        return res;
     }
-
-    nodemap->referenceTypeCounter = 0;
+    store->refTypes.counter = 0;
 
     /* Populate the nodestore */
-    ns->context = nodemap;
+    ns->context = store;
     ns->clear = UA_NodeMap_delete;
     ns->newNode = UA_NodeMap_newNode;
     ns->deleteNode = UA_NodeMap_deleteNode;
@@ -533,3 +575,358 @@ UA_Nodestore_HashMap(UA_Nodestore *ns) {
     ns->iterate = UA_NodeMap_iterate;
     return UA_STATUSCODE_GOOD;
 }
+
+/**********************/
+/* Concurrent HashMap */
+/**********************/
+
+/* The concurrent variant splits the NodeIds over shards according to their
+ * hash. Every shard is a UA_NodeMap with a lock that is held only for the
+ * lookup and modification of the shard. So threads working on different
+ * shards don't block each other.
+ *
+ * The map itself holds a reference to every entry. The reference is released
+ * when the entry is removed or replaced. Whoever releases the last reference
+ * deletes the entry. So releaseNode does not need to take a lock. */
+
+#define UA_NODEMAP_SHARDS 32
+
+typedef struct {
+#if UA_MULTITHREADING >= 100
+    UA_Lock lock;
+#endif
+    UA_NodeMap map;
+} UA_NodeMapShard;
+
+typedef struct {
+    UA_NodeMapShard shards[UA_NODEMAP_SHARDS];
+    UA_UInt32 lastId; /* To generate NodeIds */
+#if UA_MULTITHREADING >= 100
+    UA_Lock refTypesLock;
+#endif
+    /* ReferenceTypes are added when the information model is set up.
+     * Entries below the counter are never modified. So they are read without
+     * taking the lock. */
+    UA_NodeMapRefTypes refTypes;
+} UA_ConcurrentNodeMap;
+
+static UA_NodeMapShard *
+getShard(UA_ConcurrentNodeMap *cm, const UA_NodeId *nodeId) {
+    return &cm->shards[UA_NodeId_hash(nodeId) % UA_NODEMAP_SHARDS];
+}
+
+static void
+releaseConcurrentEntry(UA_NodeMapEntry *entry) {
+    UA_assert(entry->refCount > 0);
+    if(UA_atomic_subUInt32(&entry->refCount, 1) > 0)
+        return;
+    deleteNodeMapEntry(entry);
+}
+
+static const UA_Node *
+UA_ConcurrentNodeMap_getNode(void *context, const UA_NodeId *nodeid,
+                             UA_UInt32 attributeMask,
+                             UA_ReferenceTypeSet references,
+                             UA_BrowseDirection referenceDirections) {
+    UA_NodeMapShard *shard = getShard((UA_ConcurrentNodeMap*)context, nodeid);
+    UA_LOCK(&shard->lock);
+    UA_NodeMapSlot *slot = findOccupiedSlot(&shard->map, nodeid);
+    if(!slot) {
+        UA_UNLOCK(&shard->lock);
+        return NULL;
+    }
+    UA_NodeMapEntry *entry = slot->entry;
+    UA_atomic_addUInt32(&entry->refCount, 1);
+    UA_UNLOCK(&shard->lock);
+    return &entry->node;
+}
+
+static const UA_Node *
+UA_ConcurrentNodeMap_getNodeFromPtr(void *context, UA_NodePointer ptr,
+                                    UA_UInt32 attributeMask,
+                                    UA_ReferenceTypeSet references,
+                                    UA_BrowseDirection referenceDirections) {
+    if(!UA_NodePointer_isLocal(ptr))
+        return NULL;
+    UA_NodeId id = UA_NodePointer_toNodeId(ptr);
+    return UA_ConcurrentNodeMap_getNode(context, &id, attributeMask,
+                                        references, referenceDirections);
+}
+
+static void
+UA_ConcurrentNodeMap_releaseNode(void *context, const UA_Node *node) {
+    if(!node)
+        return;
+    UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
+    UA_assert(&entry->node == node);
+    releaseConcurrentEntry(entry);
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_getNodeCopy(void *context, const UA_NodeId *nodeid,
+                                 UA_Node **outNode) {
+    const UA_Node *node =
+        UA_ConcurrentNodeMap_getNode(context, nodeid, UA_NODEATTRIBUTESMASK_ALL,
+                                     UA_REFERENCETYPESET_ALL,
+                                     UA_BROWSEDIRECTION_BOTH);
+    if(!node)
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    UA_NodeMapEntry *entry = container_of(node, UA_NodeMapEntry, node);
+    UA_NodeMapEntry *newItem = createEntry(node->head.nodeClass);
+    if(!newItem) {
+        releaseConcurrentEntry(entry);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_StatusCode retval = UA_Node_copy(node, &newItem->node);
+    if(retval == UA_STATUSCODE_GOOD) {
+        newItem->orig = entry; /* Store the pointer to the original */
+        *outNode = &newItem->node;
+    } else {
+        deleteNodeMapEntry(newItem);
+    }
+    releaseConcurrentEntry(entry);
+    return retval;
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_removeNode(void *context, const UA_NodeId *nodeid) {
+    UA_NodeMapShard *shard = getShard((UA_ConcurrentNodeMap*)context, nodeid);
+    UA_LOCK(&shard->lock);
+    UA_NodeMap *ns = &shard->map;
+    UA_NodeMapSlot *slot = findOccupiedSlot(ns, nodeid);
+    if(!slot) {
+        UA_UNLOCK(&shard->lock);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+    UA_NodeMapEntry *entry = slot->entry;
+    slot->entry = UA_NODEMAP_TOMBSTONE;
+    --ns->count;
+    /* Downsize the hashmap if it is very empty */
+    if(ns->count * 8 < ns->size && ns->size > UA_NODEMAP_MINSIZE)
+        expand(ns); /* Can fail. Just continue with the bigger hashmap. */
+    UA_UNLOCK(&shard->lock);
+
+    /* Release the reference of the map */
+    releaseConcurrentEntry(entry);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Returns the shard with the lock taken and the free slot. Or NULL if no free
+ * slot was found. Generates a random NodeId for numeric NodeIds with zero
+ * identifier. */
+static UA_NodeMapShard *
+findFreeShardSlot(UA_ConcurrentNodeMap *cm, UA_Node *node,
+                  UA_NodeMapSlot **outSlot) {
+    UA_NodeId *nodeId = &node->head.nodeId;
+    UA_Boolean generate = (nodeId->identifierType == UA_NODEIDTYPE_NUMERIC &&
+                           nodeId->identifier.numeric == 0);
+    UA_UInt32 tries = (generate) ? UA_UINT32_MAX : 1;
+    for(UA_UInt32 i = 0; i < tries; i++) {
+        if(generate) {
+            /* Start at least with 50,000 to make sure we don't conflict with
+             * nodes from the spec */
+            UA_UInt32 identifier = UA_atomic_addUInt32(&cm->lastId, 1);
+#if SIZE_MAX <= UA_UINT32_MAX
+            /* See the comment in UA_NodeMap_insertNode */
+            identifier = identifier % ((0x01 << 24) - 50000);
+#else
+            identifier = identifier % (UA_UINT32_MAX - 50000);
+#endif
+            nodeId->identifier.numeric = 50000 + identifier;
+        }
+
+        UA_NodeMapShard *shard = getShard(cm, nodeId);
+        UA_LOCK(&shard->lock);
+        UA_NodeMap *ns = &shard->map;
+        if(ns->size * 3 <= ns->count * 4 &&
+           expand(ns) != UA_STATUSCODE_GOOD) {
+            UA_UNLOCK(&shard->lock);
+            return NULL;
+        }
+        UA_NodeMapSlot *slot = findFreeSlot(ns, nodeId);
+        if(slot) {
+            *outSlot = slot;
+            return shard;
+        }
+        UA_UNLOCK(&shard->lock);
+    }
+    return NULL;
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_insertNode(void *context, UA_Node *node,
+                                UA_NodeId *addedNodeId) {
+    UA_ConcurrentNodeMap *cm = (UA_ConcurrentNodeMap*)context;
+    UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
+
+    /* Find a free slot. The shard is locked afterwards. */
+    UA_NodeMapSlot *slot = NULL;
+    UA_NodeMapShard *shard = findFreeShardSlot(cm, node, &slot);
+    if(!shard) {
+        deleteNodeMapEntry(newEntry);
+        return UA_STATUSCODE_BADNODEIDEXISTS;
+    }
+
+    /* Copy the NodeId */
+    UA_StatusCode retval = UA_STATUSCODE_GOOD;
+    if(addedNodeId) {
+        retval = UA_NodeId_copy(&node->head.nodeId, addedNodeId);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_UNLOCK(&shard->lock);
+            deleteNodeMapEntry(newEntry);
+            return retval;
+        }
+    }
+
+    /* For new ReferencetypeNodes add to the index map */
+    UA_LOCK(&cm->refTypesLock);
+    retval = addReferenceType(&cm->refTypes, node);
+    UA_UNLOCK(&cm->refTypesLock);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_UNLOCK(&shard->lock);
+        if(addedNodeId)
+            UA_NodeId_clear(addedNodeId);
+        deleteNodeMapEntry(newEntry);
+        return retval;
+    }
+
+    /* Insert the node. The map holds the first reference. */
+    prepareNodeMapEntry(node);
+    newEntry->refCount = 1;
+    slot->nodeIdHash = UA_NodeId_hash(&node->head.nodeId);
+    slot->entry = newEntry;
+    ++shard->map.count;
+    UA_UNLOCK(&shard->lock);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+UA_ConcurrentNodeMap_replaceNode(void *context, UA_Node *node) {
+    UA_NodeMapEntry *newEntry = container_of(node, UA_NodeMapEntry, node);
+    prepareNodeMapEntry(node);
+    newEntry->refCount = 1;
+
+    /* Find the node */
+    UA_NodeMapShard *shard =
+        getShard((UA_ConcurrentNodeMap*)context, &node->head.nodeId);
+    UA_LOCK(&shard->lock);
+    UA_NodeMapSlot *slot = findOccupiedSlot(&shard->map, &node->head.nodeId);
+    if(!slot) {
+        UA_UNLOCK(&shard->lock);
+        deleteNodeMapEntry(newEntry);
+        return UA_STATUSCODE_BADNODEIDUNKNOWN;
+    }
+
+    /* The node was already updated since the copy was made? */
+    UA_NodeMapEntry *oldEntry = slot->entry;
+    if(oldEntry != newEntry->orig) {
+        UA_UNLOCK(&shard->lock);
+        deleteNodeMapEntry(newEntry);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Replace the entry and release the reference of the map */
+    slot->entry = newEntry;
+    UA_UNLOCK(&shard->lock);
+    releaseConcurrentEntry(oldEntry);
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_NodeId *
+UA_ConcurrentNodeMap_getReferenceTypeId(void *nsCtx, UA_Byte refTypeIndex) {
+    UA_ConcurrentNodeMap *cm = (UA_ConcurrentNodeMap*)nsCtx;
+    return getReferenceType(&cm->refTypes, refTypeIndex);
+}
+
+static void
+UA_ConcurrentNodeMap_iterate(void *context, UA_NodestoreVisitor visitor,
+                             void *visitorContext) {
+    UA_ConcurrentNodeMap *cm = (UA_ConcurrentNodeMap*)context;
+    for(size_t i = 0; i < UA_NODEMAP_SHARDS; i++) {
+        UA_NodeMapShard *shard = &cm->shards[i];
+        /* The visitor can modify the shard. So don't hold the lock while the
+         * visitor is called. */
+        for(UA_UInt32 j = 0; ; j++) {
+            UA_LOCK(&shard->lock);
+            if(j >= shard->map.size) {
+                UA_UNLOCK(&shard->lock);
+                break;
+            }
+            UA_NodeMapEntry *entry = shard->map.slots[j].entry;
+            if(entry <= UA_NODEMAP_TOMBSTONE) {
+                UA_UNLOCK(&shard->lock);
+                continue;
+            }
+            UA_atomic_addUInt32(&entry->refCount, 1);
+            UA_UNLOCK(&shard->lock);
+            visitor(visitorContext, &entry->node);
+            releaseConcurrentEntry(entry);
+        }
+    }
+}
+
+static void
+UA_ConcurrentNodeMap_delete(void *context) {
+    /* Already cleaned up? */
+    if(!context)
+        return;
+
+    UA_ConcurrentNodeMap *cm = (UA_ConcurrentNodeMap*)context;
+    for(size_t i = 0; i < UA_NODEMAP_SHARDS; i++) {
+        UA_NodeMap *ns = &cm->shards[i].map;
+        for(UA_UInt32 j = 0; j < ns->size; ++j) {
+            UA_NodeMapEntry *entry = ns->slots[j].entry;
+            if(entry <= UA_NODEMAP_TOMBSTONE)
+                continue;
+            /* On debugging builds, check that all nodes were released */
+            UA_assert(entry->refCount == 1);
+            deleteNodeMapEntry(entry);
+        }
+        UA_free(ns->slots);
+        UA_LOCK_DESTROY(&cm->shards[i].lock);
+    }
+
+    /* Clean up the ReferenceTypes index array */
+    clearReferenceTypes(&cm->refTypes);
+    UA_LOCK_DESTROY(&cm->refTypesLock);
+
+    UA_free(cm);
+}
+
+UA_StatusCode
+UA_Nodestore_ConcurrentHashMap(UA_Nodestore *ns) {
+    /* Allocate and initialize the shards */
+    UA_ConcurrentNodeMap *cm = (UA_ConcurrentNodeMap*)
+        UA_calloc(1, sizeof(UA_ConcurrentNodeMap));
+    if(!cm)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < UA_NODEMAP_SHARDS; i++) {
+        UA_StatusCode res = initNodeMap(&cm->shards[i].map);
+        if(res != UA_STATUSCODE_GOOD) {
+            for(size_t j = 0; j < i; j++) {
+                UA_free(cm->shards[j].map.slots);
+                UA_LOCK_DESTROY(&cm->shards[j].lock);
+            }
+            UA_free(cm);
+            return res;
+        }
+        UA_LOCK_INIT(&cm->shards[i].lock);
+    }
+    UA_LOCK_INIT(&cm->refTypesLock);
+
+    /* Populate the nodestore */
+    ns->context = cm;
+    ns->clear = UA_ConcurrentNodeMap_delete;
+    ns->newNode = UA_NodeMap_newNode;
+    ns->deleteNode = UA_NodeMap_deleteNode;
+    ns->getNode = UA_ConcurrentNodeMap_getNode;
+    ns->getNodeFromPtr = UA_ConcurrentNodeMap_getNodeFromPtr;
+    ns->releaseNode = UA_ConcurrentNodeMap_releaseNode;
+    ns->getNodeCopy = UA_ConcurrentNodeMap_getNodeCopy;
+    ns->insertNode = UA_ConcurrentNodeMap_insertNode;
+    ns->replaceNode = UA_ConcurrentNodeMap_replaceNode;
+    ns->removeNode = UA_ConcurrentNodeMap_removeNode;
+    ns->getReferenceTypeId = UA_ConcurrentNodeMap_getReferenceTypeId;
+    ns->iterate = UA_ConcurrentNodeMap_iterate;
+    return UA_STATUSCODE_GOOD;
+}
@@ -21,7 +21,9 @@ typedef struct NodeEntry NodeEntry;
 struct NodeEntry {
     ZIP_ENTRY(NodeEntry) zipfields;
     UA_UInt32 nodeIdHash;
-    UA_UInt16 refCount; /* How many consumers have a reference to the node? */
+    UA_UInt32 refCount; /* How many consumers have a reference to the node?
+                         * Changed atomically, as nodes can be read from
+                         * several threads in parallel. */
     UA_Boolean deleted; /* Node was marked as deleted and can be deleted when refCount == 0 */
     NodeEntry *orig;    /* If a copy is made to replace a node, track that we
                          * replace only the node from which the copy was made.
@@ -105,12 +107,16 @@ deleteEntry(NodeEntry *entry) {
 
 static void
 cleanupEntry(NodeEntry *entry) {
-    if(entry->refCount > 0)
+    if(entry->refCount > 0 || !entry->deleted)
         return;
-    if(entry->deleted) {
-        deleteEntry(entry);
-        return;
-    }
+    deleteEntry(entry);
+}
+
+/* Switch large reference arrays to the tree representation before the node
+ * becomes visible. Nodes in the tree are not modified in-place afterwards. So
+ * they can be read from several threads in parallel. */
+static void
+prepareEntry(NodeEntry *entry) {
     UA_NodeHead *head = (UA_NodeHead*)&entry->nodeId;
     for(size_t i = 0; i < head->referencesSize; i++) {
         UA_NodeReferenceKind *rk = &head->references[i];
@@ -150,7 +156,7 @@ zipNsGetNode(void *nsCtx, const UA_NodeId *nodeId,
     NodeEntry *entry = ZIP_FIND(NodeTree, &ns->root, &dummy);
     if(!entry)
         return NULL;
-    ++entry->refCount;
+    UA_atomic_addUInt32(&entry->refCount, 1);
     return (const UA_Node*)&entry->nodeId;
 }
 
@@ -172,7 +178,8 @@ zipNsReleaseNode(void *nsCtx, const UA_Node *node) {
         return;
     NodeEntry *entry = container_of(node, NodeEntry, nodeId);
     UA_assert(entry->refCount > 0);
-    --entry->refCount;
+    if(UA_atomic_subUInt32(&entry->refCount, 1) > 0)
+        return;
     cleanupEntry(entry);
 }
 
@@ -272,6 +279,7 @@ zipNsInsertNode(void *nsCtx, UA_Node *node, UA_NodeId *addedNodeId) {
     }
 
     /* Insert the node */
+    prepareEntry(entry);
     entry->nodeIdHash = dummy.nodeIdHash;
     ZIP_INSERT(NodeTree, &ns->root, entry);
     return UA_STATUSCODE_GOOD;
@@ -301,6 +309,7 @@ zipNsReplaceNode(void *nsCtx, UA_Node *node) {
     /* Replace */
     ZipContext *ns = (ZipContext*)nsCtx;
     ZIP_REMOVE(NodeTree, &ns->root, oldEntry);
+    prepareEntry(entry);
     entry->nodeIdHash = oldEntry->nodeIdHash;
     ZIP_INSERT(NodeTree, &ns->root, entry);
     oldEntry->deleted = true;
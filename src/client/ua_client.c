@@ -388,7 +388,7 @@ serviceFaultId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_SERVICEFAULT_ENCODING_DEFA
 /* Look for the async callback in the linked list, execute and delete it */
 static UA_StatusCode
 processMSGResponse(UA_Client *client, UA_UInt32 requestId,
-                   const UA_ByteString *msg) {
+                   const UA_ByteString *msg, size_t slicesSize) {
     /* Find the callback */
     AsyncServiceCall *ac;
     LIST_FOREACH(ac, &client->asyncServiceCalls, pointers) {
@@ -414,10 +414,13 @@ processMSGResponse(UA_Client *client, UA_UInt32 requestId,
     /* Dequeue ac. We might disconnect the client (remove all ac) in the callback. */
     LIST_REMOVE(ac, pointers);
 
-    /* Decode the response type */
+    /* Decode the response type. The message can be split into several slices
+     * (one for each chunk). */
     size_t offset = 0;
     UA_NodeId responseTypeId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(msg, &offset, &responseTypeId);
+    UA_StatusCode retval =
+        UA_decodeBinarySlicesInternal(msg, slicesSize, &offset, &responseTypeId,
+                                      &UA_TYPES[UA_TYPES_NODEID], NULL, NULL);
     if(retval != UA_STATUSCODE_GOOD)
         goto process;
 
@@ -449,8 +452,9 @@ processMSGResponse(UA_Client *client, UA_UInt32 requestId,
                  "Decode a message of type %" PRIu32,
                  responseTypeId.identifier.numeric);
 #endif
-    retval = UA_decodeBinaryInternal(msg, &offset, response, responseType,
-                                     client->config.customDataTypes);
+    retval = UA_decodeBinarySlicesInternal(msg, slicesSize, &offset, response,
+                                           responseType,
+                                           client->config.customDataTypes, NULL);
 
  process:
     /* Process the received MSG response */
@@ -506,7 +510,7 @@ processMSGResponse(UA_Client *client, UA_UInt32 requestId,
 UA_StatusCode
 processServiceResponse(void *application, UA_SecureChannel *channel,
                        UA_MessageType messageType, UA_UInt32 requestId,
-                       UA_ByteString *message) {
+                       UA_ByteString *message, size_t slicesSize) {
     UA_Client *client = (UA_Client*)application;
 
     if(!UA_SecureChannel_isConnected(channel)) {
@@ -541,7 +545,7 @@ processServiceResponse(void *application, UA_SecureChannel *channel,
     case UA_MESSAGETYPE_MSG:
         UA_LOG_DEBUG_CHANNEL(client->config.logging, channel, "Process MSG message "
                              "with RequestId %u", requestId);
-        return processMSGResponse(client, requestId, message);
+        return processMSGResponse(client, requestId, message, slicesSize);
     default:
         UA_LOG_TRACE_CHANNEL(client->config.logging, channel,
                              "Invalid message type");
@@ -193,7 +193,7 @@ __Client_renewSecureChannel(UA_Client *client);
 UA_StatusCode
 processServiceResponse(void *application, UA_SecureChannel *channel,
                        UA_MessageType messageType, UA_UInt32 requestId,
-                       UA_ByteString *message);
+                       UA_ByteString *message, size_t slicesSize);
 
 UA_StatusCode connectInternal(UA_Client *client, UA_Boolean async);
 UA_StatusCode connectSecureChannel(UA_Client *client, const char *endpointUrl);
@@ -22,6 +22,7 @@
 #include "open62541_queue.h"
 #include "ziptree.h"
 #include "mp_printf.h"
+#include "util/ua_util_internal.h"
 #include "ua_pubsub_networkmessage.h"
 
 #ifdef UA_ENABLE_PUBSUB_SKS
@@ -382,6 +383,26 @@ UA_DataSetWriter_remove(UA_Server *server, UA_DataSetWriter *dataSetWriter);
 /*               WriterGroup                  */
 /**********************************************/
 
+/* Number of send buffers that are registered with the ConnectionManager for a
+ * frozen WriterGroup. The message is written in place and the send buffer
+ * remains untouched until its next turn. */
+#define UA_WRITERGROUP_SENDRINGSIZE 4
+
+/* The lock-free publish callback can run in a different thread. It gets its
+ * own context for every registration instead of the WriterGroup. Removing the
+ * callback sets the stop flag and waits until the cycles in flight are done.
+ * Only then the message buffer can be modified. A cycle that was dispatched
+ * before the removal, but did not yet enter, sees only the stop flag. So the
+ * context is freed in a delayed callback of the EventLoop of the
+ * PubSubConnection, after the cycles dispatched by that EventLoop. */
+typedef struct {
+    UA_DelayedCallback dc;
+    UA_WriterGroup *wg;
+    UA_NodeId wgId;
+    volatile UA_UInt32 stop;
+    volatile UA_UInt32 inFlight;
+} UA_WriterGroupLockFreeCycle;
+
 struct UA_WriterGroup {
     UA_PubSubComponentEnumType componentType;
     UA_WriterGroupConfig config;
@@ -393,8 +414,21 @@ struct UA_WriterGroup {
     UA_UInt32 writersCount;
 
     UA_UInt64 publishCallbackId; /* registered if != 0 */
+
+    /* Set while the lock-free publish callback is registered */
+    UA_WriterGroupLockFreeCycle *lockFree;
+
     UA_PubSubState state;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
+
+    /* Registered send buffers for the frozen configuration. Set up with the
+     * first publish cycle and released when unfreezing. */
+    UA_ByteString sendRing[UA_WRITERGROUP_SENDRINGSIZE];
+    size_t sendRingSize; /* 0 if not set up */
+    size_t sendRingNext;
+    uintptr_t sendRingChannel;
+    UA_Boolean sendRingUnavailable; /* Don't try again until unfrozen */
+
     UA_UInt16 sequenceNumber; /* Increased after every succressuly sent message */
     UA_Boolean configurationFrozen;
     UA_DateTime lastPublishTimeStamp;
@@ -505,6 +539,7 @@ typedef struct UA_DataSetField {
     UA_UInt64 sampleCallbackId;
     UA_Boolean sampleCallbackIsRegistered;
     UA_Boolean configurationFrozen;
+    UA_DataValue **valueSource; /* Direct value access, resolved during freeze */
 } UA_DataSetField;
 
 UA_StatusCode
@@ -522,6 +557,11 @@ UA_DataSetField_create(UA_Server *server, const UA_NodeId publishedDataSet,
                        const UA_DataSetFieldConfig *fieldConfig,
                        UA_NodeId *fieldIdentifier);
 
+/* Resolve the RT value source of the field when the configuration is frozen.
+ * Afterwards the value is sampled without a lookup in the nodestore. */
+void
+UA_DataSetField_freezeValueSource(UA_Server *server, UA_DataSetField *field);
+
 void
 UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
                                   UA_DataValue *value);
@@ -542,6 +582,8 @@ typedef struct UA_DataSetReader {
     UA_PubSubState state;
     UA_Boolean configurationFrozen;
     UA_NetworkMessageOffsetBuffer bufferedMessage;
+    UA_Boolean directValueAccess; /* The payload offsets of the bufferedMessage
+                                   * are bound to the target variables */
 
 #ifdef UA_ENABLE_PUBSUB_MONITORING
     /* MessageReceiveTimeout handling */
@@ -625,6 +667,13 @@ UA_DataSetReader_setPubSubState(UA_Server *server, UA_DataSetReader *dsr,
 /*                ReaderGroup                 */
 /**********************************************/
 
+/* Entry in the lookup table from the message identifiers to the DataSetReader.
+ * Empty slots have no reader. */
+typedef struct {
+    UA_NetworkMessageIdentifiers ids;
+    UA_DataSetReader *reader;
+} UA_ReaderGroupMatcherEntry;
+
 struct UA_ReaderGroup {
     UA_PubSubComponentEnumType componentType;
     UA_ReaderGroupConfig config;
@@ -639,6 +688,17 @@ struct UA_ReaderGroup {
     UA_Boolean configurationFrozen;
     UA_Boolean hasReceived; /* Received a message since the last _connect */
 
+    /* Lookup table for the DataSetReaders of a frozen RT ReaderGroup. Open
+     * addressing with linear probing. The size is a power of two and at least
+     * twice the number of readers. */
+    UA_ReaderGroupMatcherEntry *matcher;
+    size_t matcherSize;
+
+    /* Memory for decoding the headers of received RT messages. Reset after
+     * every message. Messages are received under the server lock. So the
+     * arena is never used by two threads at the same time. */
+    UA_Arena decodeArena;
+
     /* The ConnectionManager pointer is stored in the Connection. The channels 
      * are either stored here or in the Connection, but never both. */
     UA_PubSubConnection *linkedConnection;
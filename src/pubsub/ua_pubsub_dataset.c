@@ -579,6 +579,25 @@ UA_DataSetFieldConfig_clear(UA_DataSetFieldConfig *dataSetFieldConfig) {
     }
 }
 
+void
+UA_DataSetField_freezeValueSource(UA_Server *server, UA_DataSetField *field) {
+    const UA_DataSetVariableConfig *var = &field->config.field.variable;
+    field->valueSource = NULL;
+    if(var->rtValueSource.rtInformationModelNode) {
+        /* Use the value of the external backend */
+        const UA_Node *node =
+            UA_NODESTORE_GET(server, &var->publishParameters.publishedVariable);
+        if(!node)
+            return;
+        if(node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+           node->variableNode.valueBackend.backendType == UA_VALUEBACKENDTYPE_EXTERNAL)
+            field->valueSource = node->variableNode.valueBackend.backend.external.value;
+        UA_NODESTORE_RELEASE(server, node);
+    } else if(var->rtValueSource.rtFieldSourceEnabled) {
+        field->valueSource = var->rtValueSource.staticValueSource;
+    }
+}
+
 /* Obtain the latest value for a specific DataSetField. This method is currently
  * called inside the DataSetMessage generation process. */
 void
@@ -587,7 +606,11 @@ UA_PubSubDataSetField_sampleValue(UA_Server *server, UA_DataSetField *field,
     UA_PublishedVariableDataType *params = &field->config.field.variable.publishParameters;
 
     /* Read the value */
-    if(field->config.field.variable.rtValueSource.rtInformationModelNode) {
+    if(field->valueSource) {
+        /* Resolved during freeze. The pointer can be swapped concurrently. */
+        *value = **(UA_DataValue * const volatile *)field->valueSource;
+        value->value.storageType = UA_VARIANT_DATA_NODELETE;
+    } else if(field->config.field.variable.rtValueSource.rtInformationModelNode) {
         const UA_VariableNode *rtNode = (const UA_VariableNode *)
             UA_NODESTORE_GET(server, &params->publishedVariable);
         *value = **rtNode->valueBackend.backend.external.value;
@@ -58,13 +58,45 @@ static UA_Boolean UA_NetworkMessage_ExtendedFlags1Enabled(const UA_NetworkMessag
 static UA_Boolean UA_NetworkMessage_ExtendedFlags2Enabled(const UA_NetworkMessage* src);
 static UA_Boolean UA_DataSetMessageHeader_DataSetFlags2Enabled(const UA_DataSetMessageHeader* src);
 
+/* Direct value access. Take the current value from the bound source. The type
+ * and the encoding flags (and thereby the encoded size) remain those of the
+ * value that was used to compute the offsets. */
+static UA_StatusCode
+syncValueSource(UA_NetworkMessageOffset *nmo) {
+    /* Load the pointer only once. It can be swapped concurrently. */
+    const UA_DataValue *src = *(UA_DataValue * const volatile *)nmo->valueSource;
+    UA_DataValue *dst = &nmo->content.value;
+    if(!src || src->value.type != dst->value.type ||
+       src->value.arrayLength != dst->value.arrayLength ||
+       src->value.arrayDimensionsSize != dst->value.arrayDimensionsSize ||
+       UA_Variant_isScalar(&src->value) != UA_Variant_isScalar(&dst->value))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    dst->value.data = src->value.data;
+    dst->value.arrayDimensions = src->value.arrayDimensions;
+    dst->status = src->status;
+    dst->sourceTimestamp = src->sourceTimestamp;
+    dst->serverTimestamp = src->serverTimestamp;
+    dst->sourcePicoseconds = src->sourcePicoseconds;
+    dst->serverPicoseconds = src->serverPicoseconds;
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer) {
+    return UA_NetworkMessage_updateBufferedMessageIn(buffer, &buffer->buffer);
+}
+
+UA_StatusCode
+UA_NetworkMessage_updateBufferedMessageIn(UA_NetworkMessageOffsetBuffer *buffer,
+                                          UA_ByteString *dst) {
+    if(dst->length < buffer->buffer.length)
+        return UA_STATUSCODE_BADINTERNALERROR;
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
-    const UA_Byte *bufEnd = &buffer->buffer.data[buffer->buffer.length];
+    const UA_Byte *bufEnd = &dst->data[buffer->buffer.length];
     for(size_t i = 0; i < buffer->offsetsSize; ++i) {
         UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
-        UA_Byte *bufPos = &buffer->buffer.data[nmo->offset];
+        UA_Byte *bufPos = &dst->data[nmo->offset];
+        const UA_DataType *type;
         switch(nmo->contentType) {
             case UA_PUBSUB_OFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
             case UA_PUBSUB_OFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
@@ -72,24 +104,72 @@ UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer) {
                 nmo->content.sequenceNumber++;
                 break;
             case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
-                rv = UA_DataValue_encodeBinary(&nmo->content.value, &bufPos, bufEnd);
+                if(nmo->valueSource)
+                    rv = syncValueSource(nmo);
+                if(rv == UA_STATUSCODE_GOOD)
+                    rv = UA_DataValue_encodeBinary(&nmo->content.value, &bufPos, bufEnd);
                 break;
             case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
-                rv = UA_Variant_encodeBinary(&nmo->content.value.value, &bufPos, bufEnd);
+                if(nmo->valueSource)
+                    rv = syncValueSource(nmo);
+                if(rv == UA_STATUSCODE_GOOD)
+                    rv = UA_Variant_encodeBinary(&nmo->content.value.value, &bufPos, bufEnd);
                 break;
             case UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW:
-                rv = UA_encodeBinaryInternal(nmo->content.value.value.data,
-                                             nmo->content.value.value.type,
-                                             &bufPos, &bufEnd, NULL, NULL);
+                if(nmo->valueSource)
+                    rv = syncValueSource(nmo);
+                if(rv == UA_STATUSCODE_GOOD)
+                    rv = UA_encodeBinaryInternal(nmo->content.value.value.data,
+                                                 nmo->content.value.value.type,
+                                                 &bufPos, &bufEnd, NULL, NULL);
+                break;
+            case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT:
+                rv = syncValueSource(nmo);
+                if(rv != UA_STATUSCODE_GOOD)
+                    break;
+                type = nmo->content.value.value.type;
+                if(type->overlayable)
+                    memcpy(bufPos, nmo->content.value.value.data, type->memSize);
+                else
+                    rv = UA_encodeBinaryInternal(nmo->content.value.value.data, type,
+                                                 &bufPos, &bufEnd, NULL, NULL);
                 break;
             default:
                 break; /* The other fields are assumed to not change between messages.
                         * Only used for RT decoding (not encoding). */
         }
+        if(rv != UA_STATUSCODE_GOOD)
+            return rv;
     }
     return rv;
 }
 
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_precomputeDirect(UA_NetworkMessageOffsetBuffer *buffer) {
+    for(size_t i = 0; i < buffer->offsetsSize; ++i) {
+        UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
+        if(nmo->contentType != UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT &&
+           nmo->contentType != UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW) {
+            if(nmo->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE)
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+            continue;
+        }
+
+        /* Only bound scalars with a fixed encoded size */
+        const UA_Variant *v = &nmo->content.value.value;
+        if(!nmo->valueSource || !v->type || !v->type->pointerFree ||
+           !UA_Variant_isScalar(v))
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+
+        /* The variant header is constant. The value is encoded at the end. */
+        if(nmo->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT)
+            nmo->offset += UA_calcSizeBinary(v, &UA_TYPES[UA_TYPES_VARIANT]) -
+                UA_calcSizeBinary(v->data, v->type);
+        nmo->contentType = UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
                                           const UA_ByteString *src, size_t *bufferPosition) {
@@ -192,6 +272,224 @@ UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
     return rv;
 }
 
+/* Numeric and Boolean scalars have the same encoded size for every value. The
+ * builtin types are at the beginning of UA_TYPES, indexed by the typeKind. */
+static UA_Boolean
+isFixedSizeBuiltin(const UA_DataType *type) {
+    return (type && type->typeKind <= UA_DATATYPEKIND_DOUBLE &&
+            type == &UA_TYPES[type->typeKind]);
+}
+
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_precomputeDirectRead(UA_NetworkMessageOffsetBuffer *buffer,
+                                                   UA_DataValue ***targets,
+                                                   size_t targetsSize) {
+    UA_NetworkMessage *nm = buffer->nm;
+    if(!nm || !nm->payload.dataSetPayload.dataSetMessages || targetsSize == 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    if(nm->payloadHeaderEnabled && nm->payloadHeader.dataSetPayloadHeader.count != 1)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    UA_DataSetMessage *dsm = nm->payload.dataSetPayload.dataSetMessages;
+    if(dsm->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    /* Check the targets */
+    size_t rawLength = 0;
+    for(size_t i = 0; i < targetsSize; i++) {
+        const UA_DataValue *dv = (targets[i]) ? *targets[i] : NULL;
+        if(!dv || !UA_Variant_isScalar(&dv->value) ||
+           !isFixedSizeBuiltin(dv->value.type))
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        rawLength += dv->value.type->memSize;
+    }
+
+    /* Check the payload offsets. Variant fields have one offset each. All raw
+     * fields share a single offset. */
+    size_t payloadCount = 0;
+    size_t rawIndex = buffer->offsetsSize;
+    for(size_t i = 0; i < buffer->offsetsSize; i++) {
+        const UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
+        switch(nmo->contentType) {
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT:
+            if(payloadCount >= targetsSize ||
+               !UA_Variant_isScalar(&nmo->content.value.value) ||
+               nmo->content.value.value.type != (*targets[payloadCount])->value.type)
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+            payloadCount++;
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW:
+            if(payloadCount > 0 || buffer->rawMessageLength != rawLength ||
+               dsm->header.fieldEncoding != UA_FIELDENCODING_RAWDATA)
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+            rawIndex = i;
+            payloadCount = targetsSize;
+            break;
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE:
+        case UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT:
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+        default:
+            break;
+        }
+    }
+    if(payloadCount != targetsSize)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    /* Variant encoding. Keep the offset at the encoding byte for checking. */
+    if(rawIndex == buffer->offsetsSize) {
+        size_t field = 0;
+        for(size_t i = 0; i < buffer->offsetsSize; i++) {
+            if(buffer->offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT)
+                buffer->offsets[i].valueSource = targets[field++];
+        }
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Raw encoding. Split into one direct offset per field. */
+    UA_NetworkMessageOffset *offsets = (UA_NetworkMessageOffset *)
+        UA_realloc(buffer->offsets, sizeof(UA_NetworkMessageOffset) *
+                   (buffer->offsetsSize + targetsSize - 1));
+    if(!offsets)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    buffer->offsets = offsets;
+
+    size_t pos = offsets[rawIndex].offset;
+    for(size_t i = 0; i < targetsSize; i++) {
+        UA_NetworkMessageOffset *nmo = (i == 0) ?
+            &offsets[rawIndex] : &offsets[buffer->offsetsSize + i - 1];
+        const UA_DataType *type = (*targets[i])->value.type;
+        memset(nmo, 0, sizeof(UA_NetworkMessageOffset));
+        UA_Variant_setScalar(&nmo->content.value.value, NULL, type);
+        nmo->content.value.value.storageType = UA_VARIANT_DATA_NODELETE;
+        nmo->contentType = UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT;
+        nmo->offset = pos;
+        nmo->valueSource = targets[i];
+        pos += type->memSize;
+    }
+    buffer->offsetsSize += targetsSize - 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_NetworkMessage_readBufferedMessageDirect(const UA_NetworkMessageOffsetBuffer *buffer,
+                                            const UA_ByteString *src) {
+    /* Check the layout. The encoding byte of a builtin scalar in a Variant is
+     * the type id. */
+    for(size_t i = 0; i < buffer->offsetsSize; i++) {
+        const UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
+        if(!nmo->valueSource)
+            continue;
+        const UA_DataType *type = nmo->content.value.value.type;
+        size_t pos = nmo->offset;
+        if(nmo->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT) {
+            if(pos >= src->length ||
+               src->data[pos] != (UA_Byte)type->typeId.identifier.numeric)
+                return UA_STATUSCODE_BADDECODINGERROR;
+            pos++;
+        }
+        if(pos + type->memSize > src->length)
+            return UA_STATUSCODE_BADDECODINGERROR;
+    }
+
+    /* Copy the values into the targets */
+    for(size_t i = 0; i < buffer->offsetsSize; i++) {
+        const UA_NetworkMessageOffset *nmo = &buffer->offsets[i];
+        if(!nmo->valueSource)
+            continue;
+        const UA_DataType *type = nmo->content.value.value.type;
+        size_t pos = nmo->offset;
+        if(nmo->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT)
+            pos++;
+        void *dst = (*nmo->valueSource)->value.data;
+        if(type->overlayable) {
+            memcpy(dst, &src->data[pos], type->memSize);
+            continue;
+        }
+        UA_StatusCode rv = UA_decodeBinaryInternal(src, &pos, dst, type, NULL);
+        UA_CHECK_STATUS(rv, return rv);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_NetworkMessage_decodeIdentifiers(const UA_ByteString *src,
+                                    UA_NetworkMessageIdentifiers *ids) {
+    /* UADP flags */
+    size_t pos = 0;
+    UA_Byte flags = 0, flags1 = 0, flags2 = 0;
+    UA_StatusCode rv = UA_Byte_decodeBinary(src, &pos, &flags);
+    if((flags & NM_EXTENDEDFLAGS1_ENABLED_MASK) != 0) {
+        rv |= UA_Byte_decodeBinary(src, &pos, &flags1);
+        if((flags1 & NM_EXTENDEDFLAGS2_ENABLED_MASK) != 0)
+            rv |= UA_Byte_decodeBinary(src, &pos, &flags2);
+    }
+    UA_CHECK_STATUS(rv, return rv);
+
+    /* Messages that need the full decoding */
+    if((flags & NM_PUBLISHER_ID_ENABLED_MASK) == 0 ||
+       (flags & NM_GROUP_HEADER_ENABLED_MASK) == 0 ||
+       (flags & NM_PAYLOAD_HEADER_ENABLED_MASK) == 0 ||
+       (flags1 & NM_SECURITY_ENABLED_MASK) != 0 ||
+       (flags2 & (NM_CHUNK_MESSAGE_MASK | NM_PROMOTEDFIELDS_ENABLED_MASK |
+                  NM_NETWORK_MSG_TYPE_MASK)) != 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    /* PublisherId */
+    ids->publisherIdType = (UA_PublisherIdType)(flags1 & NM_PUBLISHER_ID_MASK);
+    switch(ids->publisherIdType) {
+    case UA_PUBLISHERIDTYPE_BYTE: {
+        UA_Byte id = 0;
+        rv = UA_Byte_decodeBinary(src, &pos, &id);
+        ids->publisherId = id;
+        break;
+    }
+    case UA_PUBLISHERIDTYPE_UINT16: {
+        UA_UInt16 id = 0;
+        rv = UA_UInt16_decodeBinary(src, &pos, &id);
+        ids->publisherId = id;
+        break;
+    }
+    case UA_PUBLISHERIDTYPE_UINT32: {
+        UA_UInt32 id = 0;
+        rv = UA_UInt32_decodeBinary(src, &pos, &id);
+        ids->publisherId = id;
+        break;
+    }
+    case UA_PUBLISHERIDTYPE_UINT64:
+        rv = UA_UInt64_decodeBinary(src, &pos, &ids->publisherId);
+        break;
+    default:
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+    UA_CHECK_STATUS(rv, return rv);
+
+    /* Skip the DataSetClassId */
+    if((flags1 & NM_DATASET_CLASSID_ENABLED_MASK) != 0)
+        pos += 16;
+
+    /* GroupHeader. Skip the fields behind the WriterGroupId. */
+    UA_Byte groupFlags = 0;
+    rv = UA_Byte_decodeBinary(src, &pos, &groupFlags);
+    UA_CHECK_STATUS(rv, return rv);
+    if((groupFlags & GROUP_HEADER_WRITER_GROUPID_ENABLED) == 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    rv = UA_UInt16_decodeBinary(src, &pos, &ids->writerGroupId);
+    UA_CHECK_STATUS(rv, return rv);
+    if((groupFlags & GROUP_HEADER_GROUP_VERSION_ENABLED) != 0)
+        pos += 4;
+    if((groupFlags & GROUP_HEADER_NM_NUMBER_ENABLED) != 0)
+        pos += 2;
+    if((groupFlags & GROUP_HEADER_SEQUENCE_NUMBER_ENABLED) != 0)
+        pos += 2;
+
+    /* PayloadHeader */
+    UA_Byte count = 0;
+    rv = UA_Byte_decodeBinary(src, &pos, &count);
+    UA_CHECK_STATUS(rv, return rv);
+    if(count != 1)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+    return UA_UInt16_decodeBinary(src, &pos, &ids->dataSetWriterId);
+}
+
 static UA_StatusCode
 UA_NetworkMessageHeader_encodeBinary(EncodeCtx *ctx,
                                      const UA_NetworkMessage *src) {
@@ -505,9 +803,39 @@ UA_NetworkMessage_encodeBinary(const UA_NetworkMessage* src, UA_Byte **bufPos,
     return rv;
 }
 
-UA_StatusCode
-UA_NetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
-                                     UA_NetworkMessage *dst) {
+/* Allocate memory for decoding. The memory is taken from the arena if one is
+ * set. Then the decoded message must not be cleared with _clear. */
+static void *
+decodeCalloc(UA_Arena *arena, size_t nelem, size_t elsize) {
+    if(arena)
+        return UA_Arena_calloc(arena, nelem, elsize);
+    return UA_calloc(nelem, elsize);
+}
+
+static void *
+decodeArrayNew(UA_Arena *arena, size_t size, const UA_DataType *type) {
+    if(!arena)
+        return UA_Array_new(size, type);
+    if(size == 0)
+        return UA_EMPTY_ARRAY_SENTINEL;
+    return UA_Arena_calloc(arena, size, type->memSize);
+}
+
+/* The arena cannot grow an allocation in place. Copy to a new allocation
+ * instead. The old memory is released with the arena. */
+static void *
+decodeRealloc(UA_Arena *arena, void *p, size_t oldSize, size_t newSize) {
+    if(!arena)
+        return UA_realloc(p, newSize);
+    void *n = UA_Arena_calloc(arena, 1, newSize);
+    if(n && oldSize > 0)
+        memcpy(n, p, oldSize);
+    return n;
+}
+
+static UA_StatusCode
+NetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
+                                  UA_NetworkMessage *dst, UA_Arena *arena) {
     UA_Byte decoded = 0;
     UA_StatusCode rv = UA_Byte_decodeBinary(src, offset, &decoded);
     UA_CHECK_STATUS(rv, return rv);
@@ -577,7 +905,9 @@ UA_NetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
                 break;
 
             case UA_PUBLISHERIDTYPE_STRING:
-                rv = UA_String_decodeBinary(src, offset, &dst->publisherId.string);
+                rv = UA_decodeBinaryInternalArena(src, offset, &dst->publisherId.string,
+                                                  &UA_TYPES[UA_TYPES_STRING],
+                                                  NULL, arena);
                 break;
 
             default:
@@ -594,6 +924,12 @@ UA_NetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_NetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
+                                     UA_NetworkMessage *dst) {
+    return NetworkMessageHeader_decodeBinary(src, offset, dst, NULL);
+}
+
 static UA_StatusCode
 UA_GroupHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
                          UA_NetworkMessage* dst) {
@@ -625,7 +961,7 @@ UA_GroupHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
 
 static UA_StatusCode
 UA_PayloadHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
-                              UA_NetworkMessage* dst) {
+                              UA_NetworkMessage* dst, UA_Arena *arena) {
     if(dst->networkMessageType != UA_NETWORKMESSAGE_DATASET)
         return UA_STATUSCODE_BADNOTIMPLEMENTED;
 
@@ -636,7 +972,8 @@ UA_PayloadHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
     if(h->count == 0)
         return UA_STATUSCODE_GOOD;
 
-    h->dataSetWriterIds = (UA_UInt16*)UA_Array_new(h->count, &UA_TYPES[UA_TYPES_UINT16]);
+    h->dataSetWriterIds = (UA_UInt16*)
+        decodeArrayNew(arena, h->count, &UA_TYPES[UA_TYPES_UINT16]);
     if(!h->dataSetWriterIds) {
         h->count = 0;
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -650,7 +987,7 @@ UA_PayloadHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
 
 static UA_StatusCode
 UA_ExtendedNetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
-                                             UA_NetworkMessage* dst) {
+                                             UA_NetworkMessage* dst, UA_Arena *arena) {
     UA_StatusCode rv;
 
     /* Timestamp*/
@@ -679,14 +1016,16 @@ UA_ExtendedNetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *o
     unsigned int counter = 0;
     do {
         UA_Variant *tmp = (UA_Variant*)
-            UA_realloc(dst->promotedFields, (size_t)
-                       UA_TYPES[UA_TYPES_VARIANT].memSize * (counter + 1));
+            decodeRealloc(arena, dst->promotedFields,
+                          sizeof(UA_Variant) * counter,
+                          sizeof(UA_Variant) * (counter + 1));
         UA_CHECK_MEM(tmp, return UA_STATUSCODE_BADOUTOFMEMORY);
         dst->promotedFields = tmp;
         dst->promotedFieldsSize = (UA_UInt16) (counter + 1);
 
         UA_Variant_init(&dst->promotedFields[counter]);
-        rv = UA_Variant_decodeBinary(src, offset, &dst->promotedFields[counter]);
+        rv = UA_decodeBinaryInternalArena(src, offset, &dst->promotedFields[counter],
+                                          &UA_TYPES[UA_TYPES_VARIANT], NULL, arena);
         UA_CHECK_STATUS(rv, return rv);
 
         counter++;
@@ -744,9 +1083,9 @@ UA_SecurityHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
 }
 
 UA_StatusCode
-UA_NetworkMessage_decodeHeaders(const UA_ByteString *src, size_t *offset,
-                                UA_NetworkMessage *dst) {
-    UA_StatusCode rv = UA_NetworkMessageHeader_decodeBinary(src, offset, dst);
+UA_NetworkMessage_decodeHeadersArena(const UA_ByteString *src, size_t *offset,
+                                     UA_NetworkMessage *dst, UA_Arena *arena) {
+    UA_StatusCode rv = NetworkMessageHeader_decodeBinary(src, offset, dst, arena);
     UA_CHECK_STATUS(rv, return rv);
 
     if(dst->groupHeaderEnabled) {
@@ -755,11 +1094,11 @@ UA_NetworkMessage_decodeHeaders(const UA_ByteString *src, size_t *offset,
     }
 
     if(dst->payloadHeaderEnabled) {
-        rv = UA_PayloadHeader_decodeBinary(src, offset, dst);
+        rv = UA_PayloadHeader_decodeBinary(src, offset, dst, arena);
         UA_CHECK_STATUS(rv, return rv);
     }
 
-    rv = UA_ExtendedNetworkMessageHeader_decodeBinary(src, offset, dst);
+    rv = UA_ExtendedNetworkMessageHeader_decodeBinary(src, offset, dst, arena);
     UA_CHECK_STATUS(rv, return rv);
 
     if(dst->securityEnabled) {
@@ -771,8 +1110,21 @@ UA_NetworkMessage_decodeHeaders(const UA_ByteString *src, size_t *offset,
 }
 
 UA_StatusCode
-UA_NetworkMessage_decodePayload(const UA_ByteString *src, size_t *offset, UA_NetworkMessage *dst,
-                                const UA_DataTypeArray *customTypes, UA_DataSetMetaDataType *dsm) {
+UA_NetworkMessage_decodeHeaders(const UA_ByteString *src, size_t *offset,
+                                UA_NetworkMessage *dst) {
+    return UA_NetworkMessage_decodeHeadersArena(src, offset, dst, NULL);
+}
+
+static UA_StatusCode
+DataSetMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
+                            UA_DataSetMessage* dst, UA_UInt16 dsmSize,
+                            const UA_DataTypeArray *customTypes,
+                            UA_DataSetMetaDataType *dsm, UA_Arena *arena);
+
+static UA_StatusCode
+NetworkMessage_decodePayload(const UA_ByteString *src, size_t *offset,
+                             UA_NetworkMessage *dst, const UA_DataTypeArray *customTypes,
+                             UA_DataSetMetaDataType *dsm, UA_Arena *arena) {
     // Payload
     if(dst->networkMessageType != UA_NETWORKMESSAGE_DATASET)
         return UA_STATUSCODE_BADNOTIMPLEMENTED;
@@ -784,7 +1136,9 @@ UA_NetworkMessage_decodePayload(const UA_ByteString *src, size_t *offset, UA_Net
         count = dst->payloadHeader.dataSetPayloadHeader.count;
         if(count > 1) {
             dst->payload.dataSetPayload.sizes = (UA_UInt16 *)
-                UA_Array_new(count, &UA_TYPES[UA_TYPES_UINT16]);
+                decodeArrayNew(arena, count, &UA_TYPES[UA_TYPES_UINT16]);
+            UA_CHECK_MEM(dst->payload.dataSetPayload.sizes,
+                         return UA_STATUSCODE_BADOUTOFMEMORY);
             for(UA_Byte i = 0; i < count; i++) {
                 rv = UA_UInt16_decodeBinary(src, offset,
                                             &dst->payload.dataSetPayload.sizes[i]);
@@ -794,20 +1148,20 @@ UA_NetworkMessage_decodePayload(const UA_ByteString *src, size_t *offset, UA_Net
     }
 
     dst->payload.dataSetPayload.dataSetMessages = (UA_DataSetMessage*)
-        UA_calloc(count, sizeof(UA_DataSetMessage));
+        decodeCalloc(arena, count, sizeof(UA_DataSetMessage));
     UA_CHECK_MEM(dst->payload.dataSetPayload.dataSetMessages,
                  return UA_STATUSCODE_BADOUTOFMEMORY);
 
     if(count == 1) {
-        rv = UA_DataSetMessage_decodeBinary(src, offset,
-                                            &dst->payload.dataSetPayload.dataSetMessages[0],
-                                            0, customTypes, dsm);
+        rv = DataSetMessage_decodeBinary(src, offset,
+                                         &dst->payload.dataSetPayload.dataSetMessages[0],
+                                         0, customTypes, dsm, arena);
     } else {
         for(UA_Byte i = 0; i < count; i++) {
-            rv = UA_DataSetMessage_decodeBinary(src, offset,
-                                                &dst->payload.dataSetPayload.dataSetMessages[i],
-                                                dst->payload.dataSetPayload.sizes[i], customTypes,
-                                                dsm);
+            rv = DataSetMessage_decodeBinary(src, offset,
+                                             &dst->payload.dataSetPayload.dataSetMessages[i],
+                                             dst->payload.dataSetPayload.sizes[i], customTypes,
+                                             dsm, arena);
         }
     }
     UA_CHECK_STATUS(rv, return rv);
@@ -821,8 +1175,14 @@ UA_NetworkMessage_decodePayload(const UA_ByteString *src, size_t *offset, UA_Net
 }
 
 UA_StatusCode
-UA_NetworkMessage_decodeFooters(const UA_ByteString *src, size_t *offset,
-                                UA_NetworkMessage *dst) {
+UA_NetworkMessage_decodePayload(const UA_ByteString *src, size_t *offset, UA_NetworkMessage *dst,
+                                const UA_DataTypeArray *customTypes, UA_DataSetMetaDataType *dsm) {
+    return NetworkMessage_decodePayload(src, offset, dst, customTypes, dsm, NULL);
+}
+
+static UA_StatusCode
+NetworkMessage_decodeFooters(const UA_ByteString *src, size_t *offset,
+                             UA_NetworkMessage *dst, UA_Arena *arena) {
     if(!dst->securityEnabled)
         return UA_STATUSCODE_GOOD;
 
@@ -830,9 +1190,10 @@ UA_NetworkMessage_decodeFooters(const UA_ByteString *src, size_t *offset,
     UA_StatusCode rv = UA_STATUSCODE_GOOD;
     if(dst->securityHeader.securityFooterEnabled &&
        dst->securityHeader.securityFooterSize > 0) {
-        rv = UA_ByteString_allocBuffer(&dst->securityFooter,
-                                       dst->securityHeader.securityFooterSize);
-        UA_CHECK_STATUS(rv, return rv);
+        dst->securityFooter.data = (UA_Byte*)
+            decodeCalloc(arena, dst->securityHeader.securityFooterSize, 1);
+        UA_CHECK_MEM(dst->securityFooter.data, return UA_STATUSCODE_BADOUTOFMEMORY);
+        dst->securityFooter.length = dst->securityHeader.securityFooterSize;
 
         for(UA_UInt16 i = 0; i < dst->securityHeader.securityFooterSize; i++) {
             rv |= UA_Byte_decodeBinary(src, offset, &dst->securityFooter.data[i]);
@@ -842,9 +1203,16 @@ UA_NetworkMessage_decodeFooters(const UA_ByteString *src, size_t *offset,
 }
 
 UA_StatusCode
-UA_NetworkMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
-                               UA_NetworkMessage* dst,
-                               const UA_DataTypeArray *customTypes) {
+UA_NetworkMessage_decodeFooters(const UA_ByteString *src, size_t *offset,
+                                UA_NetworkMessage *dst) {
+    return NetworkMessage_decodeFooters(src, offset, dst, NULL);
+}
+
+UA_StatusCode
+UA_NetworkMessage_decodeBinaryArena(const UA_ByteString *src, size_t *offset,
+                                    UA_NetworkMessage* dst,
+                                    const UA_DataTypeArray *customTypes,
+                                    UA_Arena *arena) {
     /* headers only need to be decoded when not in encryption mode
      * because headers are already decoded when encryption mode is enabled
      * to check for security parameters and decrypt/verify
@@ -859,18 +1227,25 @@ UA_NetworkMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
     // }
     // #endif
 
-    UA_StatusCode rv = UA_NetworkMessage_decodeHeaders(src, offset, dst);
+    UA_StatusCode rv = UA_NetworkMessage_decodeHeadersArena(src, offset, dst, arena);
     UA_CHECK_STATUS(rv, return rv);
 
-    rv = UA_NetworkMessage_decodePayload(src, offset, dst, customTypes, NULL);
+    rv = NetworkMessage_decodePayload(src, offset, dst, customTypes, NULL, arena);
     UA_CHECK_STATUS(rv, return rv);
 
-    rv = UA_NetworkMessage_decodeFooters(src, offset, dst);
+    rv = NetworkMessage_decodeFooters(src, offset, dst, arena);
     UA_CHECK_STATUS(rv, return rv);
 
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_NetworkMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
+                               UA_NetworkMessage* dst,
+                               const UA_DataTypeArray *customTypes) {
+    return UA_NetworkMessage_decodeBinaryArena(src, offset, dst, customTypes, NULL);
+}
+
 static UA_Boolean
 increaseOffsetArray(UA_NetworkMessageOffsetBuffer *offsetBuffer) {
     UA_NetworkMessageOffset *tmpOffsets = (UA_NetworkMessageOffset *)
@@ -880,6 +1255,8 @@ increaseOffsetArray(UA_NetworkMessageOffsetBuffer *offsetBuffer) {
     UA_CHECK_MEM(tmpOffsets, return false);
 
     offsetBuffer->offsets = tmpOffsets;
+    memset(&offsetBuffer->offsets[offsetBuffer->offsetsSize], 0,
+           sizeof(UA_NetworkMessageOffset));
     offsetBuffer->offsetsSize++;
     return true;
 }
@@ -1028,6 +1405,13 @@ UA_NetworkMessage_calcSizeBinary(UA_NetworkMessage *p,
             size += (size_t)(2LU * count); /* uint16 */
     }
     for(size_t i = 0; i < count; i++) {
+        /* Reuse the size computed for the payload header */
+        if(!offsetBuffer && p->payload.dataSetPayload.sizesComputed &&
+           p->payload.dataSetPayload.sizes &&
+           p->payload.dataSetPayload.sizes[i] != 0) {
+            size += p->payload.dataSetPayload.sizes[i];
+            continue;
+        }
         UA_DataSetMessage *dsm = &p->payload.dataSetPayload.dataSetMessages[i];
         size = UA_DataSetMessage_calcSizeBinary(dsm, offsetBuffer, size);
     }
@@ -1441,7 +1825,7 @@ static UA_StatusCode
 UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset,
                                         size_t initialOffset, UA_DataSetMessage* dst,
                                         UA_UInt16 dsmSize, const UA_DataTypeArray *customTypes,
-                                        UA_DataSetMetaDataType *dsm) {
+                                        UA_DataSetMetaDataType *dsm, UA_Arena *arena) {
     if(*offset == src->length)
         return UA_STATUSCODE_GOOD; /* Messages ends after the header --> Heartbeat */
 
@@ -1453,8 +1837,7 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
         UA_CHECK_STATUS(rv, return rv);
 
         kfd->dataSetFields = (UA_DataValue *)
-            UA_Array_new(dst->data.keyFrameData.fieldCount,
-                         &UA_TYPES[UA_TYPES_DATAVALUE]);
+            decodeArrayNew(arena, kfd->fieldCount, &UA_TYPES[UA_TYPES_DATAVALUE]);
         if(!kfd->dataSetFields) {
             kfd->fieldCount = 0;
             return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -1462,8 +1845,9 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
 
         for(UA_UInt16 i = 0; i < kfd->fieldCount; i++) {
             UA_DataValue_init(&kfd->dataSetFields[i]);
-            rv = UA_decodeBinaryInternal(src, offset, &kfd->dataSetFields[i].value,
-                                         &UA_TYPES[UA_TYPES_VARIANT], customTypes);
+            rv = UA_decodeBinaryInternalArena(src, offset, &kfd->dataSetFields[i].value,
+                                              &UA_TYPES[UA_TYPES_VARIANT], customTypes,
+                                              arena);
             UA_CHECK_STATUS(rv, return rv);
             kfd->dataSetFields[i].hasValue = true;
         }
@@ -1474,15 +1858,16 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
         UA_CHECK_STATUS(rv, return rv);
 
         kfd->dataSetFields = (UA_DataValue *)
-            UA_Array_new(kfd->fieldCount, &UA_TYPES[UA_TYPES_DATAVALUE]);
+            decodeArrayNew(arena, kfd->fieldCount, &UA_TYPES[UA_TYPES_DATAVALUE]);
         if(!kfd->dataSetFields) {
             kfd->fieldCount = 0;
             return UA_STATUSCODE_BADOUTOFMEMORY;
         }
 
         for(UA_UInt16 i = 0; i < kfd->fieldCount; i++) {
-            rv = UA_decodeBinaryInternal(src, offset, &kfd->dataSetFields[i],
-                                         &UA_TYPES[UA_TYPES_DATAVALUE], customTypes);
+            rv = UA_decodeBinaryInternalArena(src, offset, &kfd->dataSetFields[i],
+                                              &UA_TYPES[UA_TYPES_DATAVALUE], customTypes,
+                                              arena);
             UA_CHECK_STATUS(rv, return rv);
         }
         break;
@@ -1516,9 +1901,9 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
                 return UA_STATUSCODE_BADINTERNALERROR;
             dst->data.keyFrameData.rawFields.length += type->memSize;
             UA_STACKARRAY(UA_Byte, value, type->memSize);
-            rv = UA_decodeBinaryInternal(&dst->data.keyFrameData.rawFields,
-                                         &tmpOffset, value, type, NULL);
-            UA_CHECK_STATUS(rv, return rv); 
+            rv = UA_decodeBinaryInternalArena(&dst->data.keyFrameData.rawFields,
+                                              &tmpOffset, value, type, NULL, arena);
+            UA_CHECK_STATUS(rv, return rv);
             if(dsm->fields[i].maxStringLength != 0) {
                 if(type->typeKind == UA_DATATYPEKIND_STRING ||
                    type->typeKind == UA_DATATYPEKIND_BYTESTRING) {
@@ -1530,7 +1915,8 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
                     dst->data.keyFrameData.rawFields.length += lengthDifference;
                 }
             }
-            UA_clear(value, type);
+            if(!arena)
+                UA_clear(value, type);
         }
         break;
 
@@ -1544,7 +1930,8 @@ UA_DataSetMessage_keyFrame_decodeBinary(const UA_ByteString *src, size_t *offset
 static UA_StatusCode
 UA_DataSetMessage_deltaFrame_decodeBinary(const UA_ByteString *src, size_t *offset,
                                           UA_DataSetMessage* dst, UA_UInt16 dsmSize,
-                                          const UA_DataTypeArray *customTypes) {
+                                          const UA_DataTypeArray *customTypes,
+                                          UA_Arena *arena) {
     if(dst->header.fieldEncoding == UA_FIELDENCODING_RAWDATA)
         return UA_STATUSCODE_BADNOTIMPLEMENTED;
 
@@ -1557,7 +1944,7 @@ UA_DataSetMessage_deltaFrame_decodeBinary(const UA_ByteString *src, size_t *offs
     UA_CHECK_STATUS(rv, return rv);
 
     dfd->deltaFrameFields = (UA_DataSetMessage_DeltaFrameField*)
-        UA_calloc(dfd->fieldCount, sizeof(UA_DataSetMessage_DeltaFrameField));
+        decodeCalloc(arena, dfd->fieldCount, sizeof(UA_DataSetMessage_DeltaFrameField));
     if(!dst->data.deltaFrameData.deltaFrameFields) {
         dfd->fieldCount = 0;
         return UA_STATUSCODE_BADOUTOFMEMORY;
@@ -1568,15 +1955,17 @@ UA_DataSetMessage_deltaFrame_decodeBinary(const UA_ByteString *src, size_t *offs
         UA_CHECK_STATUS(rv, return rv);
 
         if(dst->header.fieldEncoding == UA_FIELDENCODING_VARIANT) {
-            rv = UA_decodeBinaryInternal(src, offset,
-                                         &dfd->deltaFrameFields[i].fieldValue.value,
-                                         &UA_TYPES[UA_TYPES_VARIANT], customTypes);
+            rv = UA_decodeBinaryInternalArena(src, offset,
+                                              &dfd->deltaFrameFields[i].fieldValue.value,
+                                              &UA_TYPES[UA_TYPES_VARIANT], customTypes,
+                                              arena);
             UA_CHECK_STATUS(rv, return rv);
             dfd->deltaFrameFields[i].fieldValue.hasValue = true;
         } else {
-            rv = UA_decodeBinaryInternal(src, offset,
-                                         &dfd->deltaFrameFields[i].fieldValue,
-                                         &UA_TYPES[UA_TYPES_DATAVALUE], customTypes);
+            rv = UA_decodeBinaryInternalArena(src, offset,
+                                              &dfd->deltaFrameFields[i].fieldValue,
+                                              &UA_TYPES[UA_TYPES_DATAVALUE], customTypes,
+                                              arena);
             UA_CHECK_STATUS(rv, return rv);
         }
     }
@@ -1584,10 +1973,11 @@ UA_DataSetMessage_deltaFrame_decodeBinary(const UA_ByteString *src, size_t *offs
     return rv;
 }
 
-UA_StatusCode
-UA_DataSetMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
-                               UA_DataSetMessage* dst, UA_UInt16 dsmSize,
-                               const UA_DataTypeArray *customTypes, UA_DataSetMetaDataType *dsm) {
+static UA_StatusCode
+DataSetMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
+                            UA_DataSetMessage* dst, UA_UInt16 dsmSize,
+                            const UA_DataTypeArray *customTypes,
+                            UA_DataSetMetaDataType *dsm, UA_Arena *arena) {
     size_t initialOffset = *offset;
     memset(dst, 0, sizeof(UA_DataSetMessage));
     UA_StatusCode rv = UA_DataSetMessageHeader_decodeBinary(src, offset, &dst->header);
@@ -1596,11 +1986,11 @@ UA_DataSetMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
     switch(dst->header.dataSetMessageType) {
     case UA_DATASETMESSAGE_DATAKEYFRAME:
         rv = UA_DataSetMessage_keyFrame_decodeBinary(src, offset, initialOffset, dst,
-                                                     dsmSize, customTypes, dsm);
+                                                     dsmSize, customTypes, dsm, arena);
         break;
     case UA_DATASETMESSAGE_DATADELTAFRAME:
         rv = UA_DataSetMessage_deltaFrame_decodeBinary(src, offset, dst,
-                                                       dsmSize, customTypes);
+                                                       dsmSize, customTypes, arena);
         break;
     case UA_DATASETMESSAGE_KEEPALIVE:
         break; /* Keep-Alive Message contains no Payload Data */
@@ -1611,6 +2001,13 @@ UA_DataSetMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
     return rv;
 }
 
+UA_StatusCode
+UA_DataSetMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
+                               UA_DataSetMessage* dst, UA_UInt16 dsmSize,
+                               const UA_DataTypeArray *customTypes, UA_DataSetMetaDataType *dsm) {
+    return DataSetMessage_decodeBinary(src, offset, dst, dsmSize, customTypes, dsm, NULL);
+}
+
 size_t
 UA_DataSetMessage_calcSizeBinary(UA_DataSetMessage* p,
                                  UA_NetworkMessageOffsetBuffer *offsetBuffer,
@@ -1812,10 +2209,6 @@ UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob) {
         UA_free(nmob->nm);
     }
 
-#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    UA_ByteString_clear(&nmob->encryptBuffer);
-#endif
-
     if(nmob->offsetsSize == 0)
         return;
 
@@ -1823,7 +2216,8 @@ UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob) {
         UA_NetworkMessageOffset *offset = &nmob->offsets[i];
         if(offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT ||
            offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE ||
-           offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW) {
+           offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW ||
+           offset->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT) {
             UA_DataValue_clear(&offset->content.value);
             continue;
         }
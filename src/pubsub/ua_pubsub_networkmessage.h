@@ -97,6 +97,10 @@ typedef struct {
 typedef struct {
     UA_UInt16* sizes;
     UA_DataSetMessage* dataSetMessages;
+    /* The sizes were computed from the dataSetMessages when the message was
+     * generated and are reused by UA_NetworkMessage_calcSizeBinary. Otherwise
+     * (e.g. sizes from a decoded message) the sizes are computed again. */
+    UA_Boolean sizesComputed;
 } UA_DataSetPayload;
 
 typedef enum {
@@ -189,6 +193,8 @@ typedef enum {
     UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE,
     UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT,
     UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW,
+    UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT, /* Fixed-size scalar written directly
+                                          * from the value source */
     /* For subscriber RT */
     UA_PUBSUB_OFFSETTYPE_PUBLISHERID,
     UA_PUBSUB_OFFSETTYPE_WRITERGROUPID,
@@ -203,6 +209,10 @@ typedef struct {
         UA_DataValue value;
     } content;
     size_t offset;
+    /* Direct value access. If set, the value is taken from the source in every
+     * cycle. The source pointer can be swapped atomically (double-buffering).
+     * The type and encoded size must remain those of the frozen value. */
+    UA_DataValue **valueSource;
 } UA_NetworkMessageOffset;
 
 typedef struct {
@@ -212,9 +222,6 @@ typedef struct {
     UA_NetworkMessage *nm; /* The precomputed NetworkMessage for subscriber */
     size_t rawMessageLength;
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    UA_ByteString encryptBuffer; /* The precomputed message buffer is copied
-                                  * into the encrypt buffer for encryption and
-                                  * signing*/
     UA_Byte *payloadPosition; /* Payload Position of the message to encrypt*/
 #endif
 } UA_NetworkMessageOffsetBuffer;
@@ -225,10 +232,57 @@ UA_NetworkMessageOffsetBuffer_clear(UA_NetworkMessageOffsetBuffer *nmob);
 UA_StatusCode
 UA_NetworkMessage_updateBufferedMessage(UA_NetworkMessageOffsetBuffer *buffer);
 
+/* Update the offsets in a copy of the precomputed message buffer. For example
+ * a send buffer that was initialized with the buffer content. The fields
+ * without offset are not written. */
+UA_StatusCode
+UA_NetworkMessage_updateBufferedMessageIn(UA_NetworkMessageOffsetBuffer *buffer,
+                                          UA_ByteString *dst);
+
+/* Convert the payload offsets into direct writes at the precomputed position
+ * of the value. Requires that all payload offsets are bound to a value source
+ * and contain a scalar with a fixed encoded size (raw or variant encoding). */
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_precomputeDirect(UA_NetworkMessageOffsetBuffer *buffer);
+
 UA_StatusCode
 UA_NetworkMessage_updateBufferedNwMessage(UA_NetworkMessageOffsetBuffer *buffer,
                                           const UA_ByteString *src, size_t *bufferPosition);
 
+/* Bind the payload offsets of a received message (subscriber side) to the
+ * targets for direct value access. targets[i] receives the value of the i-th
+ * payload field. Requires a single KeyFrame DataSetMessage with Variant or
+ * RawData encoding where every field is a scalar of the target's numeric or
+ * Boolean type. Otherwise the offsets are left unchanged. */
+UA_StatusCode
+UA_NetworkMessageOffsetBuffer_precomputeDirectRead(UA_NetworkMessageOffsetBuffer *buffer,
+                                                   UA_DataValue ***targets,
+                                                   size_t targetsSize);
+
+/* Copy the payload values of a received message into the targets bound with
+ * _precomputeDirectRead. The field positions and Variant encoding bytes are
+ * checked against the frozen layout before the first value is written. */
+UA_StatusCode
+UA_NetworkMessage_readBufferedMessageDirect(const UA_NetworkMessageOffsetBuffer *buffer,
+                                            const UA_ByteString *src);
+
+/* The identifiers that match a NetworkMessage to a DataSetReader */
+typedef struct {
+    UA_PublisherIdType publisherIdType;
+    UA_UInt64 publisherId;
+    UA_UInt16 writerGroupId;
+    UA_UInt16 dataSetWriterId;
+} UA_NetworkMessageIdentifiers;
+
+/* Read the identifiers from the UADP headers without decoding the
+ * NetworkMessage. Does not allocate memory. Returns UA_STATUSCODE_BADNOTSUPPORTED
+ * if the message does not contain a numeric PublisherId, a WriterGroupId and
+ * exactly one DataSetWriterId, or if it has a security header, promoted fields
+ * or is chunked. Such messages need the full header decoding. */
+UA_StatusCode
+UA_NetworkMessage_decodeIdentifiers(const UA_ByteString *src,
+                                    UA_NetworkMessageIdentifiers *ids);
+
 /**
  * DataSetMessage
  * ^^^^^^^^^^^^^^ */
@@ -301,6 +355,23 @@ UA_NetworkMessage_decodeFooters(const UA_ByteString *src, size_t *offset,
 UA_StatusCode
 UA_NetworkMessage_decodeBinary(const UA_ByteString *src, size_t *offset,
                                UA_NetworkMessage* dst, const UA_DataTypeArray *customTypes);
+
+/* Same as the above. But all memory of the decoded message is taken from the
+ * arena (see ua_util_internal.h). Then decoding does not touch the heap once
+ * the arena has grown to the size of the messages. The message must not be
+ * cleared with UA_NetworkMessage_clear. It is released with the arena. The
+ * arena can be NULL to allocate on the heap. */
+struct UA_Arena;
+
+UA_StatusCode
+UA_NetworkMessage_decodeHeadersArena(const UA_ByteString *src, size_t *offset,
+                                     UA_NetworkMessage *dst, struct UA_Arena *arena);
+
+UA_StatusCode
+UA_NetworkMessage_decodeBinaryArena(const UA_ByteString *src, size_t *offset,
+                                    UA_NetworkMessage* dst,
+                                    const UA_DataTypeArray *customTypes,
+                                    struct UA_Arena *arena);
                                
 UA_StatusCode
 UA_NetworkMessageHeader_decodeBinary(const UA_ByteString *src, size_t *offset,
@@ -22,10 +22,6 @@
 
 #include "ua_types_encoding_binary.h"
 
-#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
-#include "ua_pubsub_bufmalloc.h"
-#endif
-
 #ifdef UA_ENABLE_PUBSUB_MONITORING
 static void
 UA_DataSetReader_checkMessageReceiveTimeout(UA_Server *server, UA_DataSetReader *dsr);
@@ -1175,15 +1171,88 @@ UA_DataSetReader_prepareOffsetBuffer(UA_Server *server, UA_DataSetReader *reader
     return rv;
 }
 
+/* Bind the payload of the prepared offset buffer to the target variables. Then
+ * the received values are copied into the targets without decoding the
+ * DataSetMessage. Requires the target type for every field and no beforeWrite
+ * callback (which gets the decoded value). */
+static void
+DataSetReader_prepareDirectValueAccess(UA_Server *server, UA_DataSetReader *dsr) {
+    size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+    UA_TargetVariables *tvs = &dsr->config.subscribedDataSet.subscribedDataSetTarget;
+    if(fieldsSize == 0 || tvs->targetVariablesSize != fieldsSize)
+        return;
+
+    UA_STACKARRAY(UA_DataValue**, targets, fieldsSize);
+    for(size_t i = 0; i < fieldsSize; i++) {
+        UA_FieldTargetVariable *tv = &tvs->targetVariables[i];
+        if(tv->beforeWrite || !tv->externalDataValue || !*tv->externalDataValue ||
+           tv->targetVariable.attributeId != UA_ATTRIBUTEID_VALUE ||
+           tv->targetVariable.receiverIndexRange.length > 0)
+            return;
+        const UA_DataType *type =
+            UA_findDataTypeWithCustom(&dsr->config.dataSetMetaData.fields[i].dataType,
+                                      server->config.customDataTypes);
+        if(type != (*tv->externalDataValue)->value.type)
+            return;
+        targets[i] = tv->externalDataValue;
+    }
+
+    UA_StatusCode rv =
+        UA_NetworkMessageOffsetBuffer_precomputeDirectRead(&dsr->bufferedMessage,
+                                                           targets, fieldsSize);
+    if(rv != UA_STATUSCODE_GOOD)
+        return;
+    dsr->directValueAccess = true;
+    UA_LOG_DEBUG_READER(server->config.logging, dsr,
+                        "Received values are written directly to the targets");
+}
+
+static void
+DataSetReader_processDirect(UA_Server *server, UA_DataSetReader *dsr,
+                            const UA_ByteString *buf) {
+    UA_StatusCode rv =
+        UA_NetworkMessage_readBufferedMessageDirect(&dsr->bufferedMessage, buf);
+    if(rv != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO_READER(server->config.logging, dsr,
+                           "PubSub decoding failed. The message does not match "
+                           "the frozen layout.");
+        return;
+    }
+
+    if(dsr->state == UA_PUBSUBSTATE_PREOPERATIONAL)
+        UA_DataSetReader_setPubSubState(server, dsr, UA_PUBSUBSTATE_OPERATIONAL);
+
+    UA_TargetVariables *tvs = &dsr->config.subscribedDataSet.subscribedDataSetTarget;
+    for(size_t i = 0; i < tvs->targetVariablesSize; i++) {
+        UA_FieldTargetVariable *tv = &tvs->targetVariables[i];
+        if(tv->afterWrite)
+            tv->afterWrite(server, &dsr->identifier, &dsr->linkedReaderGroup->identifier,
+                           &tv->targetVariable.targetNodeId,
+                           tv->targetVariableContext, tv->externalDataValue);
+    }
+
+#ifdef UA_ENABLE_PUBSUB_MONITORING
+    UA_DataSetReader_checkMessageReceiveTimeout(server, dsr);
+#endif
+}
+
 void
 UA_DataSetReader_decodeAndProcessRT(UA_Server *server, UA_DataSetReader *dsr,
                                     UA_ByteString *buf) {
+    if(dsr->directValueAccess) {
+        DataSetReader_processDirect(server, dsr, buf);
+        return;
+    }
+
     size_t pos = 0;
     UA_StatusCode rv;
     if(!dsr->bufferedMessage.nm) {
         /* This is the first message being received for the RT fastpath.
-         * Prepare the offset buffer. */
+         * Prepare the offset buffer. The following messages are processed
+         * with direct value access if possible. */
         rv = UA_DataSetReader_prepareOffsetBuffer(server, dsr, buf, &pos);
+        if(rv == UA_STATUSCODE_GOOD)
+            DataSetReader_prepareDirectValueAccess(server, dsr);
     } else {
         /* Decode with offset information and update the networkMessage */
         rv = UA_NetworkMessage_updateBufferedNwMessage(&dsr->bufferedMessage, buf, &pos);
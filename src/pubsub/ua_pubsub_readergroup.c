@@ -262,6 +262,7 @@ UA_ReaderGroup_remove(UA_Server *server, UA_ReaderGroup *rg) {
         UA_ReaderGroupConfig_clear(&rg->config);
         UA_NodeId_clear(&rg->identifier);
         UA_String_clear(&rg->logIdString);
+        UA_Arena_clear(&rg->decodeArena);
         UA_free(rg);
     }
 
@@ -490,45 +491,8 @@ UA_Server_setReaderGroupEncryptionKeys(UA_Server *server,
 
 /* Freezing of the configuration */
 
-UA_StatusCode
-UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    if(rg->configurationFrozen)
-        return UA_STATUSCODE_GOOD;
-
-    /* PubSubConnection freezeCounter++ */
-    UA_PubSubConnection *pubSubConnection = rg->linkedConnection;
-    pubSubConnection->configurationFreezeCounter++;
-
-    /* ReaderGroup freeze */
-    /* TODO: Clarify on the freeze functionality in multiple DSR, multiple
-     * networkMessage conf in a RG */
-    rg->configurationFrozen = true;
-
-    /* DataSetReader freeze */
-    UA_DataSetReader *dsr;
-    UA_UInt16 dsrCount = 0;
-    LIST_FOREACH(dsr, &rg->readers, listEntry){
-        dsr->configurationFrozen = true;
-        dsrCount++;
-        /* TODO: Configuration frozen for subscribedDataSet once
-         * UA_Server_DataSetReader_addTargetVariables API modified to support
-         * adding target variable one by one or in a group stored in a list. */
-    }
-
-    /* Not rt, we don't have to adjust anything */
-    if(rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
-        return UA_STATUSCODE_GOOD;
-
-    if(dsrCount > 1) {
-        UA_LOG_WARNING_READERGROUP(server->config.logging, rg,
-                                   "Mutiple DSR in a readerGroup not supported in RT "
-                                   "fixed size configuration");
-        return UA_STATUSCODE_BADNOTIMPLEMENTED;
-    }
-
-    dsr = LIST_FIRST(&rg->readers);
-
+static UA_StatusCode
+UA_DataSetReader_freezeRT(UA_Server *server, UA_DataSetReader *dsr) {
     /* Support only to UADP encoding */
     if(dsr->config.messageSettings.content.decoded.type !=
        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE]) {
@@ -586,6 +550,147 @@ UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
      * settings which headers are present, etc. Until then the ReaderGroup is
      * "PreOperational". */
     UA_NetworkMessageOffsetBuffer_clear(&dsr->bufferedMessage);
+    dsr->directValueAccess = false;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_UInt32
+matcherHash(const UA_NetworkMessageIdentifiers *ids) {
+    UA_Byte key[13];
+    key[0] = (UA_Byte)ids->publisherIdType;
+    for(size_t i = 0; i < 8; i++)
+        key[1 + i] = (UA_Byte)(ids->publisherId >> (8 * i));
+    key[9] = (UA_Byte)ids->writerGroupId;
+    key[10] = (UA_Byte)(ids->writerGroupId >> 8);
+    key[11] = (UA_Byte)ids->dataSetWriterId;
+    key[12] = (UA_Byte)(ids->dataSetWriterId >> 8);
+    return UA_ByteString_hash(0, key, sizeof(key));
+}
+
+static UA_Boolean
+matcherIdsEqual(const UA_NetworkMessageIdentifiers *a,
+                const UA_NetworkMessageIdentifiers *b) {
+    return (a->publisherIdType == b->publisherIdType &&
+            a->publisherId == b->publisherId &&
+            a->writerGroupId == b->writerGroupId &&
+            a->dataSetWriterId == b->dataSetWriterId);
+}
+
+/* Returns the slot with the identifiers or the empty slot where they would be
+ * inserted. There is always an empty slot as the table is at most half full. */
+static UA_ReaderGroupMatcherEntry *
+matcherFind(const UA_ReaderGroup *rg, const UA_NetworkMessageIdentifiers *ids) {
+    size_t mask = rg->matcherSize - 1;
+    size_t i = matcherHash(ids) & mask;
+    while(rg->matcher[i].reader && !matcherIdsEqual(&rg->matcher[i].ids, ids))
+        i = (i + 1) & mask;
+    return &rg->matcher[i];
+}
+
+static UA_Boolean
+readerIdentifiers(const UA_DataSetReader *dsr, UA_NetworkMessageIdentifiers *ids) {
+    const UA_Variant *pid = &dsr->config.publisherId;
+    if(!UA_Variant_isScalar(pid))
+        return false;
+    if(pid->type == &UA_TYPES[UA_TYPES_BYTE]) {
+        ids->publisherIdType = UA_PUBLISHERIDTYPE_BYTE;
+        ids->publisherId = *(UA_Byte*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_UINT16]) {
+        ids->publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+        ids->publisherId = *(UA_UInt16*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_UINT32]) {
+        ids->publisherIdType = UA_PUBLISHERIDTYPE_UINT32;
+        ids->publisherId = *(UA_UInt32*)pid->data;
+    } else if(pid->type == &UA_TYPES[UA_TYPES_UINT64]) {
+        ids->publisherIdType = UA_PUBLISHERIDTYPE_UINT64;
+        ids->publisherId = *(UA_UInt64*)pid->data;
+    } else {
+        return false;
+    }
+    ids->writerGroupId = dsr->config.writerGroupId;
+    ids->dataSetWriterId = dsr->config.dataSetWriterId;
+    return true;
+}
+
+static void
+UA_ReaderGroup_clearMatcher(UA_ReaderGroup *rg) {
+    UA_free(rg->matcher);
+    rg->matcher = NULL;
+    rg->matcherSize = 0;
+}
+
+/* Build the lookup table from the (PublisherId, WriterGroupId, DataSetWriterId)
+ * of received messages to the DataSetReader. Without a table, the messages are
+ * matched by decoding the headers and checking every reader. */
+static void
+UA_ReaderGroup_buildMatcher(UA_Server *server, UA_ReaderGroup *rg) {
+    /* Signed and encrypted messages need the decoded headers for verification */
+    if(rg->config.securityMode == UA_MESSAGESECURITYMODE_SIGN ||
+       rg->config.securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT)
+        return;
+
+    size_t size = 2;
+    while(size < 2 * (size_t)rg->readersCount)
+        size <<= 1;
+    rg->matcher = (UA_ReaderGroupMatcherEntry*)
+        UA_calloc(size, sizeof(UA_ReaderGroupMatcherEntry));
+    if(!rg->matcher)
+        return;
+    rg->matcherSize = size;
+
+    /* Readers without a numeric PublisherId never match a message from the
+     * table. A message that matches more than one reader is not supported. */
+    UA_DataSetReader *dsr;
+    UA_NetworkMessageIdentifiers ids;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        if(!readerIdentifiers(dsr, &ids))
+            continue;
+        UA_ReaderGroupMatcherEntry *entry = matcherFind(rg, &ids);
+        if(entry->reader) {
+            UA_LOG_DEBUG_READERGROUP(server->config.logging, rg,
+                                     "Multiple DataSetReaders for the same "
+                                     "DataSetWriter. Match by the decoded headers.");
+            UA_ReaderGroup_clearMatcher(rg);
+            return;
+        }
+        entry->ids = ids;
+        entry->reader = dsr;
+    }
+}
+
+UA_StatusCode
+UA_ReaderGroup_freezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    if(rg->configurationFrozen)
+        return UA_STATUSCODE_GOOD;
+
+    /* PubSubConnection freezeCounter++ */
+    UA_PubSubConnection *pubSubConnection = rg->linkedConnection;
+    pubSubConnection->configurationFreezeCounter++;
+
+    /* ReaderGroup freeze */
+    rg->configurationFrozen = true;
+
+    /* DataSetReader freeze */
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry){
+        dsr->configurationFrozen = true;
+        /* TODO: Configuration frozen for subscribedDataSet once
+         * UA_Server_DataSetReader_addTargetVariables API modified to support
+         * adding target variable one by one or in a group stored in a list. */
+    }
+
+    /* Not rt, we don't have to adjust anything */
+    if(rg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
+        return UA_STATUSCODE_GOOD;
+
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        UA_StatusCode res = UA_DataSetReader_freezeRT(server, dsr);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+
+    UA_ReaderGroup_buildMatcher(server, rg);
 
     /* Set the current state again. This can move the state from Operational to
      * PreOperational. */
@@ -618,11 +723,13 @@ UA_ReaderGroup_unfreezeConfiguration(UA_Server *server, UA_ReaderGroup *rg) {
 
     /* ReaderGroup unfreeze */
     rg->configurationFrozen = false;
+    UA_ReaderGroup_clearMatcher(rg);
 
     /* DataSetReader unfreeze */
     UA_DataSetReader *dataSetReader;
     LIST_FOREACH(dataSetReader, &rg->readers, listEntry) {
         dataSetReader->configurationFrozen = false;
+        dataSetReader->directValueAccess = false;
         UA_NetworkMessageOffsetBuffer_clear(&dataSetReader->bufferedMessage);
     }
 
@@ -707,24 +814,38 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *rg,
     if(rg->state == UA_PUBSUBSTATE_PREOPERATIONAL)
         UA_ReaderGroup_setPubSubState(server, rg, UA_PUBSUBSTATE_OPERATIONAL);
 
+    /* Match the reader by the identifiers in the headers. This takes constant
+     * time independent of the number of readers. Messages that cannot be
+     * matched from the identifiers alone fall through to the full decoding. */
+    if(rg->matcher) {
+        UA_NetworkMessageIdentifiers ids;
+        if(UA_NetworkMessage_decodeIdentifiers(buf, &ids) == UA_STATUSCODE_GOOD) {
+            UA_DataSetReader *dsr = matcherFind(rg, &ids)->reader;
+            if(!dsr) {
+                UA_LOG_DEBUG_READERGROUP(server->config.logging, rg,
+                                         "PubSub receive. No reader for the message.");
+                return false;
+            }
+            if(dsr->state != UA_PUBSUBSTATE_OPERATIONAL &&
+               dsr->state != UA_PUBSUBSTATE_PREOPERATIONAL)
+                return false;
+            UA_DataSetReader_decodeAndProcessRT(server, dsr, buf);
+            return true;
+        }
+    }
+
     UA_Boolean processed = false;
     UA_NetworkMessage currentNetworkMessage;
     memset(&currentNetworkMessage, 0, sizeof(UA_NetworkMessage));
 
-    /* Decode headers necessary for matching identifiers. This can use malloc.
-     * So enable membufAlloc if you need RT timings. Reset back to the normal
-     * malloc before processing the message. The userland (callbacks) below
-     * might rely on that. It needs to be ensured that the membuf-memory is not
-     * reset (zeroed out) in "useNormalAlloc". So the decoded memory can be used
-     * until the end of this method. */
-#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
-    useMembufAlloc();
-#endif
+    /* Decode headers necessary for matching identifiers. The memory is taken
+     * from the arena of the ReaderGroup. After the first messages the arena
+     * has grown to fit the headers and decoding no longer uses malloc. The
+     * allocator of other threads is not affected. */
     size_t pos = 0;
-    UA_StatusCode rv = UA_NetworkMessage_decodeHeaders(buf, &pos, &currentNetworkMessage);
-#ifdef UA_ENABLE_PUBSUB_BUFMALLOC
-    useNormalAlloc();
-#endif
+    UA_StatusCode rv =
+        UA_NetworkMessage_decodeHeadersArena(buf, &pos, &currentNetworkMessage,
+                                             &rg->decodeArena);
     if(rv != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_READERGROUP(server->config.logging, rg,
                               "PubSub receive. decoding headers failed");
@@ -766,9 +887,8 @@ UA_ReaderGroup_decodeAndProcessRT(UA_Server *server, UA_ReaderGroup *rg,
     }
 
  cleanup:
-#ifndef UA_ENABLE_PUBSUB_BUFMALLOC
-    UA_NetworkMessage_clear(&currentNetworkMessage);
-#endif
+    /* The decoded headers are released with the arena. Don't _clear. */
+    UA_Arena_reset(&rg->decodeArena);
     return processed;
 }
 
@@ -332,6 +332,7 @@ UA_DataSetWriter_freezeConfiguration(UA_Server *server,
         UA_DataSetField *dsf;
         TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
             dsf->configurationFrozen = true;
+            UA_DataSetField_freezeValueSource(server, dsf);
         }
     }
     dsw->configurationFrozen = true;
@@ -348,6 +349,7 @@ UA_DataSetWriter_unfreezeConfiguration(UA_Server *server,
             UA_DataSetField *dsf;
             TAILQ_FOREACH(dsf, &pds->fields, listEntry){
                 dsf->configurationFrozen = false;
+                dsf->valueSource = NULL;
             }
         }
         dsw->configurationFrozen = false;
@@ -24,6 +24,23 @@
 
 #define UA_MAX_STACKBUF 128 /* Max size of network messages on the stack */
 
+/* The RT levels are flags. Deterministic publishing builds upon the
+ * fixed-size message and the direct value access. */
+#define UA_WG_FIXEDSIZE(wg) \
+    ((wg)->config.rtLevel & (UA_PUBSUB_RT_FIXED_SIZE | UA_PUBSUB_RT_DETERMINISTIC))
+#define UA_WG_DIRECTACCESS(wg) \
+    ((wg)->config.rtLevel & (UA_PUBSUB_RT_DIRECT_VALUE_ACCESS | UA_PUBSUB_RT_DETERMINISTIC))
+
+/* The precomputed message of a frozen WriterGroup with direct value access is
+ * published without taking the server lock. Not for encrypted messages, as the
+ * keys can be rolled over concurrently. */
+static UA_Boolean
+publishesLockFree(const UA_WriterGroup *wg) {
+    return wg->configurationFrozen && UA_WG_FIXEDSIZE(wg) &&
+        UA_WG_DIRECTACCESS(wg) &&
+        wg->config.securityMode <= UA_MESSAGESECURITYMODE_NONE;
+}
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
 static UA_StatusCode
 encryptAndSign(UA_WriterGroup *wg, const UA_NetworkMessage *nm,
@@ -39,6 +56,9 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
                        UA_ExtensionObject *transportSettings,
                        UA_NetworkMessage *networkMessage);
 
+static void
+publishCallbackLockFree(UA_Server *server, UA_WriterGroupLockFreeCycle *lf);
+
 UA_Boolean
 UA_WriterGroup_canConnect(UA_WriterGroup *wg) {
     /* Already connected */
@@ -61,28 +81,66 @@ UA_WriterGroup_addPublishCallback(UA_Server *server, UA_WriterGroup *wg) {
     if(wg->publishCallbackId != 0)
         return UA_STATUSCODE_GOOD;
 
+    /* Deterministic publishing stays in the grid of the publishing interval
+     * when a cycle is missed */
+    UA_TimerPolicy timerPolicy = UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME;
+    if(wg->config.rtLevel & UA_PUBSUB_RT_DETERMINISTIC)
+        timerPolicy = UA_TIMER_HANDLE_CYCLEMISS_WITH_BASETIME;
+
+    /* The callback is registered again when the configuration is (un)frozen.
+     * Every registration of the lock-free callback gets a fresh context. */
+    UA_ServerCallback cb = (UA_ServerCallback)UA_WriterGroup_publishCallback;
+    void *data = wg;
+    if(publishesLockFree(wg)) {
+        UA_WriterGroupLockFreeCycle *lf = (UA_WriterGroupLockFreeCycle*)
+            UA_calloc(1, sizeof(UA_WriterGroupLockFreeCycle));
+        if(!lf)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        UA_StatusCode res = UA_NodeId_copy(&wg->identifier, &lf->wgId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(lf);
+            return res;
+        }
+        lf->wg = wg;
+        cb = (UA_ServerCallback)publishCallbackLockFree;
+        data = lf;
+    }
+
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(wg->config.pubsubManagerCallback.addCustomCallback) {
         /* Use configured mechanism for cyclic callbacks */
         retval = wg->config.pubsubManagerCallback.
-            addCustomCallback(server, wg->identifier,
-                              (UA_ServerCallback)UA_WriterGroup_publishCallback,
-                              wg, wg->config.publishingInterval,
-                              NULL, UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,
-                              &wg->publishCallbackId);
+            addCustomCallback(server, wg->identifier, cb,
+                              data, wg->config.publishingInterval,
+                              NULL, timerPolicy, &wg->publishCallbackId);
     } else {
         /* Use EventLoop for cyclic callbacks */
         UA_EventLoop *el = UA_PubSubConnection_getEL(server, wg->linkedConnection);
-        retval = el->addCyclicCallback(el, (UA_Callback)UA_WriterGroup_publishCallback,
-                                       server, wg, wg->config.publishingInterval,
-                                       NULL /* TODO: use basetime */,
-                                       UA_TIMER_HANDLE_CYCLEMISS_WITH_CURRENTTIME,
+        retval = el->addCyclicCallback(el, (UA_Callback)cb,
+                                       server, data, wg->config.publishingInterval,
+                                       NULL /* TODO: use basetime */, timerPolicy,
                                        &wg->publishCallbackId);
     }
 
+    if(data != wg) {
+        if(retval == UA_STATUSCODE_GOOD) {
+            wg->lockFree = (UA_WriterGroupLockFreeCycle*)data;
+        } else {
+            UA_NodeId_clear(&((UA_WriterGroupLockFreeCycle*)data)->wgId);
+            UA_free(data);
+        }
+    }
+
     return retval;
 }
 
+static void
+freeLockFreeCycle(void *application, void *context) {
+    UA_WriterGroupLockFreeCycle *lf = (UA_WriterGroupLockFreeCycle*)context;
+    UA_NodeId_clear(&lf->wgId);
+    UA_free(lf);
+}
+
 static void
 UA_WriterGroup_removePublishCallback(UA_Server *server, UA_WriterGroup *wg) {
     if(wg->publishCallbackId == 0)
@@ -95,6 +153,62 @@ UA_WriterGroup_removePublishCallback(UA_Server *server, UA_WriterGroup *wg) {
         el->removeCyclicCallback(el, wg->publishCallbackId);
     }
     wg->publishCallbackId = 0;
+
+    /* The lock-free callback might have been started before it was removed.
+     * Wait until it is done. It never takes the server lock while in flight.
+     * Cycles that were dispatched but did not enter yet only see the stop
+     * flag. Release their context after them. */
+    UA_WriterGroupLockFreeCycle *lf = wg->lockFree;
+    if(lf) {
+        UA_atomic_addUInt32(&lf->stop, 1);
+        while(UA_atomic_addUInt32(&lf->inFlight, 0) > 0) {}
+        wg->lockFree = NULL;
+        UA_EventLoop *el = UA_PubSubConnection_getEL(server, wg->linkedConnection);
+        lf->dc.callback = freeLockFreeCycle;
+        lf->dc.application = server;
+        lf->dc.context = lf;
+        el->addDelayedCallback(el, &lf->dc);
+    }
+}
+
+static void
+releaseSendRing(UA_WriterGroup *wg) {
+    UA_ConnectionManager *cm = (wg->linkedConnection) ? wg->linkedConnection->cm : NULL;
+    for(size_t i = 0; i < wg->sendRingSize; i++) {
+        if(cm)
+            cm->unregisterNetworkBuffer(cm, wg->sendRingChannel, &wg->sendRing[i]);
+    }
+    wg->sendRingSize = 0;
+    wg->sendRingNext = 0;
+    wg->sendRingChannel = 0;
+}
+
+/* Register send buffers with the ConnectionManager that each hold a copy of
+ * the precomputed message. Returns false if the ConnectionManager does not
+ * support registered buffers. */
+static UA_Boolean
+setupSendRing(UA_WriterGroup *wg, UA_ConnectionManager *cm, uintptr_t sendChannel) {
+    if(wg->sendRingSize > 0 && wg->sendRingChannel == sendChannel)
+        return true;
+    releaseSendRing(wg);
+    if(!wg->configurationFrozen || wg->sendRingUnavailable ||
+       !cm->registerNetworkBuffer || !cm->unregisterNetworkBuffer)
+        return false;
+
+    const UA_ByteString *msg = &wg->bufferedMessage.buffer;
+    wg->sendRingChannel = sendChannel;
+    for(size_t i = 0; i < UA_WRITERGROUP_SENDRINGSIZE; i++) {
+        UA_StatusCode res =
+            cm->registerNetworkBuffer(cm, sendChannel, &wg->sendRing[i], msg->length);
+        if(res != UA_STATUSCODE_GOOD) {
+            releaseSendRing(wg);
+            wg->sendRingUnavailable = true;
+            return false;
+        }
+        memcpy(wg->sendRing[i].data, msg->data, msg->length);
+        wg->sendRingSize++;
+    }
+    return true;
 }
 
 UA_StatusCode
@@ -338,6 +452,35 @@ UA_Server_removeWriterGroup(UA_Server *server, const UA_NodeId writerGroup) {
     return res;
 }
 
+/* Bind the payload offsets to the value sources of the DataSetFields. The
+ * offsets are generated in the order of the writers and their fields. */
+static UA_StatusCode
+bindValueSources(UA_Server *server, UA_WriterGroup *wg) {
+    UA_NetworkMessageOffsetBuffer *mb = &wg->bufferedMessage;
+    size_t pos = 0;
+    UA_DataSetWriter *dsw;
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        UA_PublishedDataSet *pds =
+            UA_PublishedDataSet_findPDSbyId(server, dsw->connectedDataSet);
+        if(!pds)
+            continue; /* Heartbeat */
+        UA_DataSetField *dsf;
+        TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
+            for(; pos < mb->offsetsSize; pos++) {
+                UA_NetworkMessageOffsetType t = mb->offsets[pos].contentType;
+                if(t == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE ||
+                   t == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT ||
+                   t == UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW)
+                    break;
+            }
+            if(pos == mb->offsetsSize || !dsf->valueSource)
+                return UA_STATUSCODE_BADCONFIGURATIONERROR;
+            mb->offsets[pos++].valueSource = dsf->valueSource;
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 UA_StatusCode
 UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
@@ -359,7 +502,7 @@ UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     }
 
     /* Enabling RT? */
-    if(wg->config.rtLevel != UA_PUBSUB_RT_FIXED_SIZE)
+    if(!UA_WG_FIXEDSIZE(wg))
         return UA_STATUSCODE_GOOD;
 
     /* Check if RT is possible */
@@ -410,6 +553,32 @@ UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     memset(&wg->bufferedMessage, 0, sizeof(UA_NetworkMessageOffsetBuffer));
     msgSize = UA_NetworkMessage_calcSizeBinary(&networkMessage, &wg->bufferedMessage);
 
+    /* Take the payload directly from the value sources in every cycle */
+    if(UA_WG_DIRECTACCESS(wg)) {
+        res = bindValueSources(server, wg);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING_WRITERGROUP(server->config.logging, wg,
+                                       "PubSub-RT configuration fail: "
+                                       "Field without direct value access");
+            UA_WriterGroup_unfreezeConfiguration(server, wg);
+            goto cleanup;
+        }
+    }
+
+    /* Precompute the position of every value in the message. Then the publish
+     * cycle only copies the values into place. */
+    if(wg->config.rtLevel & UA_PUBSUB_RT_DETERMINISTIC) {
+        res = UA_NetworkMessageOffsetBuffer_precomputeDirect(&wg->bufferedMessage);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING_WRITERGROUP(server->config.logging, wg,
+                                       "PubSub-RT configuration fail: Deterministic "
+                                       "publishing requires scalar fields with a "
+                                       "fixed size and raw or variant encoding");
+            UA_WriterGroup_unfreezeConfiguration(server, wg);
+            goto cleanup;
+        }
+    }
+
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
     if(wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
         UA_PubSubSecurityPolicy *sp = wg->config.securityPolicy;
@@ -434,13 +603,18 @@ UA_WriterGroup_freezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
 
         wg->bufferedMessage.nm = (UA_NetworkMessage *)UA_calloc(1,sizeof(UA_NetworkMessage));
         wg->bufferedMessage.nm->securityHeader = networkMessage.securityHeader;
-        UA_ByteString_allocBuffer(&wg->bufferedMessage.encryptBuffer, msgSize);
     }
 #endif
 
     if(wg->config.securityMode <= UA_MESSAGESECURITYMODE_NONE)
         UA_NetworkMessage_encodeBinary(&networkMessage, &bufPos, bufEnd, NULL);
 
+    /* The message is complete. Publish without the server lock from now on. */
+    if(wg->publishCallbackId != 0 && publishesLockFree(wg)) {
+        UA_WriterGroup_removePublishCallback(server, wg);
+        res = UA_WriterGroup_addPublishCallback(server, wg);
+    }
+
  cleanup:
     UA_free(networkMessage.payload.dataSetPayload.sizes);
 
@@ -480,6 +654,12 @@ UA_WriterGroup_unfreezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
     if(!wg->configurationFrozen)
         return UA_STATUSCODE_GOOD;
 
+    /* Stop publishing without the server lock before the message buffer is
+     * released. The callback is registered again afterwards. */
+    UA_Boolean reregister = (wg->publishCallbackId != 0 && publishesLockFree(wg));
+    if(reregister)
+        UA_WriterGroup_removePublishCallback(server, wg);
+
     UA_PubSubConnection *pubSubConnection =  wg->linkedConnection;
     pubSubConnection->configurationFreezeCounter--;
 
@@ -489,9 +669,13 @@ UA_WriterGroup_unfreezeConfiguration(UA_Server *server, UA_WriterGroup *wg) {
         UA_DataSetWriter_unfreezeConfiguration(server, dsw);
     }
 
+    releaseSendRing(wg);
+    wg->sendRingUnavailable = false;
     UA_NetworkMessageOffsetBuffer_clear(&wg->bufferedMessage);
     wg->configurationFrozen = false;
 
+    if(reregister)
+        return UA_WriterGroup_addPublishCallback(server, wg);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -1107,12 +1291,17 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
     if(networkMessage->groupHeader.groupVersionEnabled)
         networkMessage->groupHeader.groupVersion = wgm->groupVersion;
 
-    /* Compute the length of the dsm separately for the header */
+    /* Compute the length of the dsm separately for the header. The lengths are
+     * reused for the size of the NetworkMessage. Zero if the length does not
+     * fit into the header field. */
     UA_UInt16 *dsmLengths = (UA_UInt16 *) UA_calloc(dsmCount, sizeof(UA_UInt16));
     if(!dsmLengths)
         return UA_STATUSCODE_BADOUTOFMEMORY;
-    for(UA_Byte i = 0; i < dsmCount; i++)
-        dsmLengths[i] = (UA_UInt16) UA_DataSetMessage_calcSizeBinary(&dsm[i], NULL, 0);
+    for(UA_Byte i = 0; i < dsmCount; i++) {
+        size_t dsmLength = UA_DataSetMessage_calcSizeBinary(&dsm[i], NULL, 0);
+        if(dsmLength <= UA_UINT16_MAX)
+            dsmLengths[i] = (UA_UInt16)dsmLength;
+    }
 
     networkMessage->payloadHeader.dataSetPayloadHeader.count = dsmCount;
     networkMessage->payloadHeader.dataSetPayloadHeader.dataSetWriterIds = writerIds;
@@ -1120,6 +1309,7 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
     /* number of the NetworkMessage inside a PublishingInterval */
     networkMessage->groupHeader.networkMessageNumber = 1;
     networkMessage->payload.dataSetPayload.sizes = dsmLengths;
+    networkMessage->payload.dataSetPayload.sizesComputed = true;
     networkMessage->payload.dataSetPayload.dataSetMessages = dsm;
     return UA_STATUSCODE_GOOD;
 }
@@ -1182,72 +1372,136 @@ sendNetworkMessageBinary(UA_Server *server, UA_PubSubConnection *connection, UA_
     return UA_STATUSCODE_GOOD;
 }
 
-static void
-publishRT(UA_Server *server, UA_WriterGroup *writerGroup, UA_PubSubConnection *connection) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+/* Publish the precomputed message. Returns the status of the send. If not
+ * locked, the caller handles a failed send.
+ *
+ * The message is written into a registered send buffer of the
+ * ConnectionManager if possible. Then the offsets are updated in place and the
+ * buffer is sent without a copy. Encrypted messages are copied once from the
+ * precomputed buffer and encrypted in place. */
+static UA_StatusCode
+publishRT(UA_Server *server, UA_WriterGroup *writerGroup,
+          UA_PubSubConnection *connection, UA_Boolean locked) {
+    UA_ConnectionManager *cm = connection->cm;
+    if(!cm)
+        return UA_STATUSCODE_GOOD;
+
+    /* Select the wg sendchannel if configured */
+    uintptr_t sendChannel = connection->sendChannel;
+    if(writerGroup->sendChannel != 0)
+        sendChannel = writerGroup->sendChannel;
+    if(sendChannel == 0) {
+        UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
+                                 "Cannot send, no open connection");
+        return UA_STATUSCODE_GOOD;
+    }
 
-    UA_StatusCode res =
-        UA_NetworkMessage_updateBufferedMessage(&writerGroup->bufferedMessage);
+    UA_NetworkMessageOffsetBuffer *bm = &writerGroup->bufferedMessage;
+    UA_Boolean encrypt = false;
+#ifdef UA_ENABLE_PUBSUB_ENCRYPTION
+    encrypt = (writerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE);
+#endif
+
+    /* Take the next buffer from the ring or allocate */
+    UA_ByteString outBuf;
+    UA_StatusCode res;
+    UA_Boolean ring = setupSendRing(writerGroup, cm, sendChannel);
+    if(ring) {
+        outBuf = writerGroup->sendRing[writerGroup->sendRingNext];
+        writerGroup->sendRingNext =
+            (writerGroup->sendRingNext + 1) % writerGroup->sendRingSize;
+    } else {
+        res = cm->allocNetworkBuffer(cm, sendChannel, &outBuf, bm->buffer.length);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
+                                     "PubSub message memory allocation failed");
+            return UA_STATUSCODE_GOOD;
+        }
+    }
 
+    /* Update the message in place or copy from the precomputed buffer */
+    if(ring && !encrypt) {
+        res = UA_NetworkMessage_updateBufferedMessageIn(bm, &outBuf);
+    } else {
+        res = UA_NetworkMessage_updateBufferedMessage(bm);
+        if(res == UA_STATUSCODE_GOOD)
+            memcpy(outBuf.data, bm->buffer.data, bm->buffer.length);
+    }
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_DEBUG_WRITERGROUP(server->config.logging, writerGroup,
                                  "PubSub sending. Unknown field type.");
-        return;
+        if(!ring)
+            cm->freeNetworkBuffer(cm, sendChannel, &outBuf);
+        return UA_STATUSCODE_GOOD;
     }
 
-    UA_ByteString *buf = &writerGroup->bufferedMessage.buffer;
-
 #ifdef UA_ENABLE_PUBSUB_ENCRYPTION
-    /* Send the encrypted buffered message if PubSub encryption is enabled */
-    if(writerGroup->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+    /* Encrypt and sign in place */
+    if(encrypt) {
         size_t sigSize = writerGroup->config.securityPolicy->symmetricModule.cryptoModule.
             signatureAlgorithm.getLocalSignatureSize(writerGroup->securityPolicyContext);
-
-        UA_Byte payloadOffset = (UA_Byte)(writerGroup->bufferedMessage.payloadPosition -
-                                          writerGroup->bufferedMessage.buffer.data);
-        memcpy(writerGroup->bufferedMessage.encryptBuffer.data,
-               writerGroup->bufferedMessage.buffer.data,
-               writerGroup->bufferedMessage.buffer.length);
-        res = encryptAndSign(writerGroup, writerGroup->bufferedMessage.nm,
-                             writerGroup->bufferedMessage.encryptBuffer.data,
-                             writerGroup->bufferedMessage.encryptBuffer.data + payloadOffset,
-                             writerGroup->bufferedMessage.encryptBuffer.data +
-                                 writerGroup->bufferedMessage.encryptBuffer.length - sigSize);
-
+        size_t payloadOffset = (size_t)(bm->payloadPosition - bm->buffer.data);
+        res = encryptAndSign(writerGroup, bm->nm, outBuf.data,
+                             outBuf.data + payloadOffset,
+                             outBuf.data + outBuf.length - sigSize);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
                                      "PubSub Encryption failed");
-            return;
+            if(!ring)
+                cm->freeNetworkBuffer(cm, sendChannel, &outBuf);
+            return UA_STATUSCODE_GOOD;
         }
-
-        buf = &writerGroup->bufferedMessage.encryptBuffer;
     }
 #endif
 
-    UA_ConnectionManager *cm = connection->cm;
-    if(!cm)
-        return;
+    /* Registered buffers are not released by sending */
+    if(locked) {
+        sendNetworkMessageBuffer(server, writerGroup, connection, sendChannel, &outBuf);
+        return UA_STATUSCODE_GOOD;
+    }
+    return cm->sendWithConnection(cm, sendChannel, &UA_KEYVALUEMAP_NULL, &outBuf);
+}
 
-    /* Select the wg sendchannel if configured */
-    uintptr_t sendChannel = connection->sendChannel;
-    if(writerGroup->sendChannel != 0)
-        sendChannel = writerGroup->sendChannel;
-    if(sendChannel == 0) {
-        UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
-                                 "Cannot send, no open connection");
+/* Registered instead of UA_WriterGroup_publishCallback while publishesLockFree
+ * holds. Can be called from a dedicated (realtime) thread, for example with
+ * the pubsubManagerCallback of the WriterGroup or a separate EventLoop of the
+ * PubSubConnection. The message buffer and the value sources do not change
+ * while the cycle is in flight (see UA_WriterGroup_removePublishCallback). The
+ * WriterGroup is accessed only after entering the cycle. */
+static void
+publishCallbackLockFree(UA_Server *server, UA_WriterGroupLockFreeCycle *lf) {
+    /* The order matters. The remover sets the stop flag before it checks the
+     * in-flight counter. */
+    UA_atomic_addUInt32(&lf->inFlight, 1);
+    if(UA_atomic_addUInt32(&lf->stop, 0) > 0 || lf->wg->writersCount == 0) {
+        UA_atomic_subUInt32(&lf->inFlight, 1);
         return;
     }
 
-    /* Copy into the network buffer */
-    UA_ByteString outBuf;
-    res = cm->allocNetworkBuffer(cm, sendChannel, &outBuf, buf->length);
-    if(res != UA_STATUSCODE_GOOD) {
-        UA_LOG_ERROR_WRITERGROUP(server->config.logging, writerGroup,
-                                 "PubSub message memory allocation failed");
+    UA_StatusCode res = publishRT(server, lf->wg, lf->wg->linkedConnection, false);
+    if(res == UA_STATUSCODE_GOOD) {
+        UA_atomic_subUInt32(&lf->inFlight, 1);
         return;
     }
-    memcpy(outBuf.data, buf->data, buf->length);
-    sendNetworkMessageBuffer(server, writerGroup, connection, sendChannel, &outBuf);
+
+    /* Sending failed. Leave the cycle before taking the server lock, as the
+     * lock holder might wait for the cycle to finish. The WriterGroup can be
+     * removed in between. Look it up again by its identifier. */
+    UA_NodeId wgId;
+    UA_NodeId_copy(&lf->wgId, &wgId);
+    UA_atomic_subUInt32(&lf->inFlight, 1);
+    UA_LOCK(&server->serviceMutex);
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, wgId);
+    UA_NodeId_clear(&wgId);
+    if(wg && wg->lockFree) {
+        UA_LOG_ERROR_WRITERGROUP(server->config.logging, wg,
+                                 "Sending NetworkMessage failed with status code %s",
+                                 UA_StatusCode_name(res));
+        UA_WriterGroup_setPubSubState(server, wg, UA_PUBSUBSTATE_ERROR);
+        UA_PubSubConnection_setPubSubState(server, wg->linkedConnection,
+                                           UA_PUBSUBSTATE_ERROR);
+    }
+    UA_UNLOCK(&server->serviceMutex);
 }
 
 static void
@@ -1305,8 +1559,8 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
     }
 
     /* Realtime path - update the buffer message and send directly */
-    if(writerGroup->config.rtLevel == UA_PUBSUB_RT_FIXED_SIZE) {
-        publishRT(server, writerGroup, connection);
+    if(UA_WG_FIXEDSIZE(writerGroup)) {
+        publishRT(server, writerGroup, connection, true);
         UA_UNLOCK(&server->serviceMutex);
         return;
     }
@@ -1361,7 +1615,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
                                &dsWriterIds[dsmCount], 1);
 
             /* Clean up the current store entry */
-            if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DIRECT_VALUE_ACCESS &&
+            if(UA_WG_DIRECTACCESS(writerGroup) &&
                dsmStore[dsmCount].header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME) {
                 for(size_t i = 0; i < dsmStore[dsmCount].data.keyFrameData.fieldCount; ++i) {
                     dsmStore[dsmCount].data.keyFrameData.dataSetFields[i].value.data = NULL;
@@ -1388,7 +1642,7 @@ UA_WriterGroup_publishCallback(UA_Server *server, UA_WriterGroup *writerGroup) {
 
     /* Clean up DSM */
     for(size_t i = 0; i < dsmCount; i++) {
-        if(writerGroup->config.rtLevel == UA_PUBSUB_RT_DIRECT_VALUE_ACCESS &&
+        if(UA_WG_DIRECTACCESS(writerGroup) &&
            dsmStore[i].header.dataSetMessageType == UA_DATASETMESSAGE_DATAKEYFRAME) {
             for(size_t j = 0; j < dsmStore[i].data.keyFrameData.fieldCount; ++j) {
                 dsmStore[i].data.keyFrameData.dataSetFields[j].value.data = NULL;
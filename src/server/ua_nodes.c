@@ -477,6 +477,7 @@ UA_VariableNode_copy(const UA_VariableNode *src, UA_VariableNode *dst) {
     dst->minimumSamplingInterval = src->minimumSamplingInterval;
     dst->historizing = src->historizing;
     dst->isDynamic = src->isDynamic;
+    dst->valueVersion = src->valueVersion;
     return UA_CommonVariableNode_copy(src, dst);
 }
 
@@ -255,6 +255,10 @@ UA_Server_delete(UA_Server *server) {
 
     UA_LOCK(&server->serviceMutex);
 
+#if UA_MULTITHREADING >= 100
+    UA_ServerReactors_stop(server);
+#endif
+
     session_list_entry *current, *temp;
     LIST_FOREACH_SAFE(current, &server->sessions, pointers, temp) {
         UA_Server_removeSession(server, current, UA_SHUTDOWNREASON_CLOSE);
@@ -280,6 +284,7 @@ UA_Server_delete(UA_Server *server) {
 
 #if UA_MULTITHREADING >= 100
     UA_AsyncManager_clear(&server->asyncManager, server);
+    UA_ServiceWorkers_delete(server);
 #endif
 
     /* Clean up the Admin Session */
@@ -372,6 +377,8 @@ UA_Server_init(UA_Server *server) {
 
     /* Initialize Session Management */
     LIST_INIT(&server->sessions);
+    ZIP_INIT(&server->sessionsById);
+    ZIP_INIT(&server->sessionsByToken);
     server->sessionCount = 0;
 
 #if UA_MULTITHREADING >= 100
@@ -577,8 +584,10 @@ UA_Server_updateCertificate(UA_Server *server,
         UA_ServerComponent *binaryProtocolManager =
             getServerComponentByName(server, UA_STRING("binary"));
         if(binaryProtocolManager) {
+            UA_LOCK(&server->serviceMutex);
             binaryProtocolManager->notifyState = notifySecureChannelsStopped;
             binaryProtocolManager->stop(server, binaryProtocolManager);
+            UA_UNLOCK(&server->serviceMutex);
         }
     }
 
@@ -744,6 +753,17 @@ UA_Server_run_startup(UA_Server *server) {
 #if UA_MULTITHREADING >= 100
     /* Add regulare callback for async operation processing */
     UA_AsyncManager_start(&server->asyncManager, server);
+
+    /* Start the threads for the parallel execution of read-only services */
+    retVal = UA_ServiceWorkers_start(server);
+    UA_CHECK_STATUS(retVal, UA_AsyncManager_stop(&server->asyncManager, server);
+                    UA_UNLOCK(&server->serviceMutex); return retVal);
+
+    /* Start the reactor threads before the server sockets are opened */
+    retVal = UA_ServerReactors_start(server);
+    UA_CHECK_STATUS(retVal, UA_ServiceWorkers_stop(server);
+                    UA_AsyncManager_stop(&server->asyncManager, server);
+                    UA_UNLOCK(&server->serviceMutex); return retVal);
 #endif
 
     /* Are there enough SecureChannels possible for the max number of sessions? */
@@ -875,6 +895,9 @@ UA_Server_run_shutdown(UA_Server *server) {
 #if UA_MULTITHREADING >= 100
     /* Stop regular callback for async operation processing */
     UA_AsyncManager_stop(&server->asyncManager, server);
+
+    /* Join the service workers */
+    UA_ServiceWorkers_stop(server);
 #endif
 
     /* Stop the regular housekeeping tasks */
@@ -897,7 +920,8 @@ UA_Server_run_shutdown(UA_Server *server) {
         setServerLifecycleState(server, UA_LIFECYCLESTATE_STOPPED);
     }
 
-    /* Only stop the EventLoop if it is coupled to the server lifecycle  */
+    /* Only stop the EventLoop if it is coupled to the server lifecycle. The
+     * reactors are then stopped in UA_Server_delete. */
     if(server->config.externalEventLoop) {
         UA_UNLOCK(&server->serviceMutex);
         return UA_STATUSCODE_GOOD;
@@ -913,6 +937,11 @@ UA_Server_run_shutdown(UA_Server *server) {
         UA_LOCK(&server->serviceMutex);
     }
 
+#if UA_MULTITHREADING >= 100
+    /* All connections are closed. Stop the reactors. */
+    UA_ServerReactors_stop(server);
+#endif
+
     /* Stop the EventLoop. Iterate until stopped. */
     el->stop(el);
     while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
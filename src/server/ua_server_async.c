@@ -17,6 +17,13 @@ UA_AsyncOperation_delete(UA_AsyncOperation *ar) {
     UA_free(ar);
 }
 
+static const UA_DataType *
+asyncResponseType(const UA_AsyncResponse *ar) {
+    if(ar->operationType == UA_ASYNCOPERATIONTYPE_WRITE)
+        return &UA_TYPES[UA_TYPES_WRITERESPONSE];
+    return &UA_TYPES[UA_TYPES_CALLRESPONSE];
+}
+
 static void
 UA_AsyncManager_sendAsyncResponse(UA_AsyncManager *am, UA_Server *server,
                                   UA_AsyncResponse *ar) {
@@ -54,7 +61,7 @@ UA_AsyncManager_sendAsyncResponse(UA_AsyncManager *am, UA_Server *server,
     /* Send the Response */
     UA_StatusCode res =
         sendResponse(server, channel, ar->requestId,
-                     (UA_Response*)&ar->response, &UA_TYPES[UA_TYPES_CALLRESPONSE]);
+                     (UA_Response*)&ar->response, asyncResponseType(ar));
     if(res != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_SESSION(server->config.logging, session,
                                "Async Response for Req# %" PRIu32 " failed "
@@ -82,12 +89,22 @@ integrateOperationResult(UA_AsyncManager *am, UA_Server *server,
                  "Return result in the server thread with %" PRIu32 " remaining",
                  ar->opCountdown);
 
-    /* Move the UA_CallMethodResult to UA_CallResponse */
-    ar->response.callResponse.results[ao->index] = ao->response;
-    UA_CallMethodResult_init(&ao->response);
+    if(ar->operationType == UA_ASYNCOPERATIONTYPE_WRITE) {
+        /* Set the results of the batched write */
+        UA_StatusCode *results = ar->response.writeResponse.results;
+        UA_StatusCode res = ao->response.statusCode;
+        for(size_t i = 0; i < ao->batchSize; i++)
+            results[ao->batchIndex[i]] = (res != UA_STATUSCODE_GOOD) ?
+                res : ao->batchResults[i];
+    } else {
+        /* Move the UA_CallMethodResult to UA_CallResponse */
+        ar->response.callResponse.results[ao->index] = ao->response;
+        UA_CallMethodResult_init(&ao->response);
+    }
 
-    /* Done with all operations -> send the response */
-    UA_Boolean done = (ar->opCountdown == 0);
+    /* Done with all operations -> send the response. If the service is still
+     * running, it sends the response when it returns. */
+    UA_Boolean done = (ar->opCountdown == 0 && !ar->inService);
     if(done)
         UA_AsyncManager_sendAsyncResponse(am, server, ar);
     return done;
@@ -119,8 +136,8 @@ processAsyncResults(UA_Server *server) {
 }
 
 /* Check if any operations have timed out */
-static void
-checkTimeouts(UA_Server *server, void *_) {
+void
+UA_AsyncManager_checkTimeouts(UA_Server *server, void *_) {
     /* Timeouts are not configured */
     if(server->config.asyncOperationTimeout <= 0.0)
         return;
@@ -181,7 +198,7 @@ UA_AsyncManager_init(UA_AsyncManager *am, UA_Server *server) {
 void UA_AsyncManager_start(UA_AsyncManager *am, UA_Server *server) {
     /* Add a regular callback for checking timeouts and sending finished
      * responses at a 100ms interval. */
-    addRepeatedCallback(server, (UA_ServerCallback)checkTimeouts,
+    addRepeatedCallback(server, (UA_ServerCallback)UA_AsyncManager_checkTimeouts,
                         NULL, 100.0, &am->checkTimeoutCallbackId);
 }
 
@@ -242,6 +259,7 @@ UA_AsyncManager_createAsyncResponse(UA_AsyncManager *am, UA_Server *server,
     am->asyncResponsesCount += 1;
     newentry->requestId = requestId;
     newentry->requestHandle = requestHandle;
+    newentry->operationType = operationType;
     newentry->timeout = el->dateTime_nowMonotonic(el);
     if(server->config.asyncOperationTimeout > 0.0)
         newentry->timeout += (UA_DateTime)
@@ -257,7 +275,7 @@ void
 UA_AsyncManager_removeAsyncResponse(UA_AsyncManager *am, UA_AsyncResponse *ar) {
     TAILQ_REMOVE(&am->asyncResponses, ar, pointers);
     am->asyncResponsesCount -= 1;
-    UA_CallResponse_clear(&ar->response.callResponse);
+    UA_clear(&ar->response, asyncResponseType(ar));
     UA_NodeId_clear(&ar->sessionId);
     UA_free(ar);
 }
@@ -306,6 +324,69 @@ UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Enqueue a batched write in the dispatched queue. The batch arrays are
+ * allocated together with the operation. */
+UA_StatusCode
+UA_AsyncManager_createAsyncWriteOp(UA_AsyncManager *am, UA_Server *server,
+                                   UA_AsyncResponse *ar, size_t batchSize,
+                                   const size_t *batchIndex,
+                                   UA_AsyncOperation **outOp) {
+    if(server->config.maxAsyncOperationQueueSize != 0 &&
+       am->opsCount >= server->config.maxAsyncOperationQueueSize)
+        return UA_STATUSCODE_BADTOOMANYOPERATIONS;
+
+    UA_AsyncOperation *ao = (UA_AsyncOperation*)
+        UA_calloc(1, sizeof(UA_AsyncOperation) +
+                  batchSize * (sizeof(size_t) + sizeof(UA_StatusCode)));
+    if(!ao)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ao->batchSize = batchSize;
+    ao->batchIndex = (size_t*)&ao[1];
+    ao->batchResults = (UA_StatusCode*)&ao->batchIndex[batchSize];
+    memcpy(ao->batchIndex, batchIndex, batchSize * sizeof(size_t));
+    ao->parent = ar;
+
+    UA_LOCK(&am->queueLock);
+    TAILQ_INSERT_TAIL(&am->dispatchedQueue, ao, pointers);
+    am->opsCount++;
+    ar->opCountdown++;
+    UA_UNLOCK(&am->queueLock);
+
+    *outOp = ao;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Is the operation still in the dispatched queue? Otherwise it has been
+ * removed due to a timeout.
+ *
+ * TODO: Add a tree-structure for the dispatch queue. The linear lookup does
+ * not scale. */
+static UA_Boolean
+isDispatched(UA_AsyncManager *am, const UA_AsyncOperation *ao) {
+    UA_LOCK_ASSERT(&am->queueLock, 1);
+    UA_AsyncOperation *op = NULL;
+    TAILQ_FOREACH(op, &am->dispatchedQueue, pointers) {
+        if(op == ao)
+            return true;
+    }
+    return false;
+}
+
+UA_Boolean
+UA_AsyncManager_removeAsyncWriteOp(UA_AsyncManager *am, UA_AsyncOperation *ao) {
+    UA_LOCK(&am->queueLock);
+    UA_Boolean found = isDispatched(am, ao);
+    if(found) {
+        TAILQ_REMOVE(&am->dispatchedQueue, ao, pointers);
+        am->opsCount--;
+        ao->parent->opCountdown--;
+    }
+    UA_UNLOCK(&am->queueLock);
+    if(found)
+        UA_AsyncOperation_delete(ao);
+    return found;
+}
+
 /* Get and remove next Method Call Request */
 UA_Boolean
 UA_Server_getAsyncOperationNonBlocking(UA_Server *server, UA_AsyncOperationType *type,
@@ -349,17 +430,8 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
 
     UA_LOCK(&am->queueLock);
 
-    /* See if the operation is still in the dispatched queue. Otherwise it has
-     * been removed due to a timeout.
-     *
-     * TODO: Add a tree-structure for the dispatch queue. The linear lookup does
-     * not scale. */
-    UA_AsyncOperation *op = NULL;
-    TAILQ_FOREACH(op, &am->dispatchedQueue, pointers) {
-        if(op == ao)
-            break;
-    }
-    if(!op) {
+    /* See if the operation is still in the dispatched queue */
+    if(!isDispatched(am, ao)) {
         UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                        "UA_Server_SetAsyncMethodResult: The operation has timed out");
         UA_UNLOCK(&am->queueLock);
@@ -385,6 +457,37 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
                  "Set the result from the worker thread");
 }
 
+/* Backend submits the results of a batched write */
+void
+UA_Server_setAsyncWriteResults(UA_Server *server, void *asyncContext,
+                               const UA_StatusCode *results) {
+    UA_AsyncManager *am = &server->asyncManager;
+
+    UA_AsyncOperation *ao = (UA_AsyncOperation*)asyncContext;
+    if(!ao) {
+        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                       "UA_Server_setAsyncWriteResults: Invalid context");
+        return;
+    }
+
+    UA_LOCK(&am->queueLock);
+
+    /* See if the operation is still in the dispatched queue */
+    if(!isDispatched(am, ao)) {
+        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                       "UA_Server_setAsyncWriteResults: The operation has timed out");
+        UA_UNLOCK(&am->queueLock);
+        return;
+    }
+
+    /* Copy the results and move to the result queue */
+    memcpy(ao->batchResults, results, ao->batchSize * sizeof(UA_StatusCode));
+    TAILQ_REMOVE(&am->dispatchedQueue, ao, pointers);
+    TAILQ_INSERT_TAIL(&am->resultQueue, ao, pointers);
+
+    UA_UNLOCK(&am->queueLock);
+}
+
 /******************/
 /* Server Methods */
 /******************/
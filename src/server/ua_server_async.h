@@ -21,11 +21,11 @@
 
 _UA_BEGIN_DECLS
 
-#if UA_MULTITHREADING >= 100
-
 struct UA_AsyncResponse;
 typedef struct UA_AsyncResponse UA_AsyncResponse;
 
+#if UA_MULTITHREADING >= 100
+
 /* A single operation (of a larger request) */
 typedef struct UA_AsyncOperation {
     TAILQ_ENTRY(UA_AsyncOperation) pointers;
@@ -33,6 +33,11 @@ typedef struct UA_AsyncOperation {
     UA_CallMethodResult	response;
     size_t index;             /* Index of the operation in the array of ops in
                                * request/response */
+    /* Batched write. The results are set for the operations at the indices.
+     * A bad statusCode in the response (timeout, cancel) replaces them. */
+    size_t batchSize;
+    size_t *batchIndex;
+    UA_StatusCode *batchResults;
     UA_AsyncResponse *parent; /* Always non-NULL. The parent is only removed
                                * when its operations are removed */
 } UA_AsyncOperation;
@@ -51,6 +56,9 @@ struct UA_AsyncResponse {
     } response;
     UA_UInt32 opCountdown; /* Counter for outstanding operations. The AR can
                             * only be deleted when all have returned. */
+    UA_Boolean inService;  /* The service is still adding operations. The
+                            * response is not sent before the service returns.
+                            * The server lock might be released in between. */
 };
 
 typedef TAILQ_HEAD(UA_AsyncOperationQueue, UA_AsyncOperation) UA_AsyncOperationQueue;
@@ -98,6 +106,26 @@ UA_AsyncManager_createAsyncOp(UA_AsyncManager *am, UA_Server *server,
                               UA_AsyncResponse *ar, size_t opIndex,
                               const UA_CallMethodRequest *opRequest);
 
+/* Create the operation for a batched write. The operation is dispatched to
+ * the backend right away and not queued for the workers. */
+UA_StatusCode
+UA_AsyncManager_createAsyncWriteOp(UA_AsyncManager *am, UA_Server *server,
+                                   UA_AsyncResponse *ar, size_t batchSize,
+                                   const size_t *batchIndex,
+                                   UA_AsyncOperation **outOp);
+
+/* Remove the operation of a batched write that has completed synchronously.
+ * Returns false if the results have already been submitted. Then the operation
+ * is integrated like the asynchronous results. */
+UA_Boolean
+UA_AsyncManager_removeAsyncWriteOp(UA_AsyncManager *am, UA_AsyncOperation *ao);
+
+/* Move timed out operations to the results, integrate the results and send
+ * out the completed responses. Called regularly from a timer callback. Takes
+ * the server lock. */
+void
+UA_AsyncManager_checkTimeouts(UA_Server *server, void *_);
+
 /* Send out the response with status set. Also removes all outstanding
  * operations from the dispatch queue. The queuelock needs to be taken before
  * calling _cancel. */
@@ -43,8 +43,9 @@ void UA_debug_dumpCompleteChunk(UA_Server *const server, UA_Connection *const co
 /* Binary Protocol Server Component */
 /************************************/
 
-/* Maximum numbers of sockets to listen on */
-#define UA_MAXSERVERCONNECTIONS 16
+/* Maximum numbers of sockets to listen on. With reactors, every reactor opens
+ * its own sockets. */
+#define UA_MAXSERVERCONNECTIONS 64
 
 /* SecureChannel Linked List */
 typedef struct channel_entry {
@@ -148,6 +149,10 @@ deleteServerSecureChannel(UA_BinaryProtocolManager *bpm,
      * First detach all Sessions from the SecureChannel. This also removes
      * outstanding Publish requests whose RequestId is valid only for the
      * SecureChannel. */
+    UA_LOCK_ASSERT(&bpm->server->serviceMutex, 1);
+#if UA_MULTITHREADING >= 100
+    UA_ServiceWorkers_removeChannel(bpm->server, channel);
+#endif
     while(channel->sessions)
         UA_Session_detachFromSecureChannel(channel->sessions);
     UA_SecureChannel_clear(channel);
@@ -214,16 +219,18 @@ sendServiceFault(UA_Server *server, UA_SecureChannel *channel,
 /* This is not an ERR message, the connection is not closed afterwards */
 static UA_StatusCode
 decodeHeaderSendServiceFault(UA_Server *server, UA_SecureChannel *channel,
-                             const UA_ByteString *msg, size_t offset,
-                             const UA_DataType *responseType, UA_UInt32 requestId,
-                             UA_StatusCode error) {
+                             const UA_ByteString *msg, size_t slicesSize,
+                             size_t offset, const UA_DataType *responseType,
+                             UA_UInt32 requestId, UA_StatusCode error) {
     UA_RequestHeader requestHeader;
     UA_StatusCode retval =
-        UA_decodeBinaryInternal(msg, &offset, &requestHeader,
-                                &UA_TYPES[UA_TYPES_REQUESTHEADER], NULL);
+        UA_decodeBinarySlicesInternal(msg, slicesSize, &offset, &requestHeader,
+                                      &UA_TYPES[UA_TYPES_REQUESTHEADER], NULL, NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
+    UA_LOCK(&server->serviceMutex);
     retval = sendServiceFault(server, channel, requestId, requestHeader.requestHandle, error);
+    UA_UNLOCK(&server->serviceMutex);
     UA_RequestHeader_clear(&requestHeader);
     return retval;
 }
@@ -410,6 +417,32 @@ sendResponse(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
     return UA_MessageContext_finish(&mc);
 }
 
+/* The responseHeader must have the requestHandle already set */
+UA_StatusCode
+beginStreamedResponse(UA_Server *server, UA_SecureChannel *channel,
+                      UA_UInt32 requestId, UA_ResponseHeader *responseHeader,
+                      const UA_DataType *responseType, UA_MessageContext *mc) {
+    if(!channel)
+        return UA_STATUSCODE_BADINTERNALERROR;
+
+    UA_EventLoop *el = server->config.eventLoop;
+    responseHeader->timestamp = el->dateTime_now(el);
+
+    UA_StatusCode retval = UA_MessageContext_begin(mc, channel, requestId,
+                                                   UA_MESSAGETYPE_MSG);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Encode the response type and the ResponseHeader. The remaining members
+     * are encoded by the service. */
+    retval = UA_MessageContext_encode(mc, &responseType->binaryEncodingId,
+                                      &UA_TYPES[UA_TYPES_NODEID]);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    return UA_MessageContext_encode(mc, responseHeader,
+                                    &UA_TYPES[UA_TYPES_RESPONSEHEADER]);
+}
+
 /* A Session is "bound" to a SecureChannel if it was created by the
  * SecureChannel or if it was activated on it. A Session can only be bound to
  * one SecureChannel. A Session can only be closed from the SecureChannel to
@@ -449,14 +482,26 @@ getBoundSession(UA_Server *server, const UA_SecureChannel *channel,
 }
 
 static UA_StatusCode
-processMSG(UA_Server *server, UA_SecureChannel *channel,
-           UA_UInt32 requestId, const UA_ByteString *msg) {
+processMSG(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
+           const UA_ByteString *msg, size_t slicesSize) {
     if(channel->state != UA_SECURECHANNELSTATE_OPEN)
         return UA_STATUSCODE_BADINTERNALERROR;
-    /* Decode the nodeid */
+
+    /* Measure the service latency from the reception */
+#ifdef UA_ENABLE_DIAGNOSTICS
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime received = el->dateTime_nowMonotonic(el);
+#else
+    UA_DateTime received = 0;
+#endif
+
+    /* Decode the nodeid. The message can be split into several slices (one
+     * for each chunk). */
     size_t offset = 0;
     UA_NodeId requestTypeId;
-    UA_StatusCode retval = UA_NodeId_decodeBinary(msg, &offset, &requestTypeId);
+    UA_StatusCode retval =
+        UA_decodeBinarySlicesInternal(msg, slicesSize, &offset, &requestTypeId,
+                                      &UA_TYPES[UA_TYPES_NODEID], NULL, NULL);
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
     if(requestTypeId.namespaceIndex != 0 ||
@@ -476,22 +521,27 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
                                 "Unknown request with type identifier %" PRIi32,
                                 requestTypeId.identifier.numeric);
         }
-        return decodeHeaderSendServiceFault(server, channel, msg, offset,
+        return decodeHeaderSendServiceFault(server, channel, msg, slicesSize, offset,
                                             &UA_TYPES[UA_TYPES_SERVICEFAULT],
                                             requestId, UA_STATUSCODE_BADSERVICEUNSUPPORTED);
     }
 
-    /* Decode the request */
+    /* Decode the request. The memory of the request is taken from the arena
+     * of the SecureChannel. */
     UA_Request request;
     size_t requestPos = offset; /* Store the offset (for sendServiceFault) */
-    retval = UA_decodeBinaryInternal(msg, &offset, &request,
-                                     sd->requestType, server->config.customDataTypes);
+    retval = UA_decodeBinarySlicesInternal(msg, slicesSize, &offset, &request,
+                                           sd->requestType,
+                                           server->config.customDataTypes,
+                                           &channel->requestArena);
     if(retval != UA_STATUSCODE_GOOD) {
+        UA_Arena_reset(&channel->requestArena);
         UA_LOG_DEBUG_CHANNEL(server->config.logging, channel,
                              "Could not decode the request with StatusCode %s",
                              UA_StatusCode_name(retval));
-        return decodeHeaderSendServiceFault(server, channel, msg, requestPos,
-                                            sd->responseType, requestId, retval);
+        return decodeHeaderSendServiceFault(server, channel, msg, slicesSize,
+                                            requestPos, sd->responseType,
+                                            requestId, retval);
     }
 
     /* Initialize the response */
@@ -499,47 +549,81 @@ processMSG(UA_Server *server, UA_SecureChannel *channel,
     UA_init(&response, sd->responseType);
     response.responseHeader.requestHandle = request.requestHeader.requestHandle;
 
-    /* Process the request */
+#if UA_MULTITHREADING >= 100
+    /* Hand read-only services to the service workers. The request (with the
+     * arena) and the response are moved into the job and must not be cleaned
+     * up here. */
+    if(sd->parallel &&
+       UA_ServiceWorkers_enqueue(server, channel, requestId, sd, &request,
+                                 &channel->requestArena, &response, received))
+        return UA_STATUSCODE_GOOD;
+#endif
+
+    /* Process the request. The response is sent with the lock, as other
+     * threads can send on the SecureChannel as well. */
     UA_LOCK(&server->serviceMutex);
+
+#if UA_MULTITHREADING >= 100
+    /* Keep the order behind the requests of the session with the workers */
+    if(UA_ServiceWorkers_defer(server, channel, requestId, sd, &request,
+                               &channel->requestArena, &response, received)) {
+        UA_UNLOCK(&server->serviceMutex);
+        return UA_STATUSCODE_GOOD;
+    }
+#endif
+
     UA_Boolean async =
         UA_Server_processRequest(server, channel, requestId, sd, &request, &response);
-    UA_UNLOCK(&server->serviceMutex);
+#ifdef UA_ENABLE_DIAGNOSTICS
+    if(!async)
+        UA_Server_updateServiceLatency(server, sd,
+                                       el->dateTime_nowMonotonic(el) - received);
+#endif
 
     /* Send response if not async */
     if(UA_LIKELY(!async)) {
         retval = sendResponse(server, channel, requestId, &response, sd->responseType);
     }
+    UA_UNLOCK(&server->serviceMutex);
 
-    /* Clean up */
-    UA_clear(&request, sd->requestType);
+    /* Clean up. The request is released with the arena. */
+    UA_Arena_reset(&channel->requestArena);
     UA_clear(&response, sd->responseType);
     return retval;
 }
 
-/* Takes decoded messages starting at the nodeid of the content type. */
+/* Takes decoded messages starting at the nodeid of the content type. Called
+ * without the service lock (see the processLock of the SecureChannel). Only
+ * the decoding of MSG requests is done without the lock. */
 static UA_StatusCode
 processSecureChannelMessage(void *application, UA_SecureChannel *channel,
                             UA_MessageType messagetype, UA_UInt32 requestId,
-                            UA_ByteString *message) {
+                            UA_ByteString *message, size_t slicesSize) {
     UA_Server *server = (UA_Server*)application;
 
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     switch(messagetype) {
     case UA_MESSAGETYPE_HEL:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process a HEL message");
+        UA_LOCK(&server->serviceMutex);
         retval = processHEL(server, channel, message);
+        UA_UNLOCK(&server->serviceMutex);
         break;
     case UA_MESSAGETYPE_OPN:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process an OPN message");
+        UA_LOCK(&server->serviceMutex);
         retval = processOPN(server, channel, requestId, message);
+        UA_UNLOCK(&server->serviceMutex);
         break;
     case UA_MESSAGETYPE_MSG:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process a MSG");
-        retval = processMSG(server, channel, requestId, message);
+        retval = processMSG(server, channel, requestId, message, slicesSize);
         break;
     case UA_MESSAGETYPE_CLO:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Process a CLO");
+        UA_LOCK(&server->serviceMutex);
         Service_CloseSecureChannel(server, channel); /* Regular close */
+        UA_UNLOCK(&server->serviceMutex);
         break;
     default:
         UA_LOG_TRACE_CHANNEL(server->config.logging, channel, "Invalid message type");
@@ -547,10 +631,12 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
         break;
     }
     if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOCK(&server->serviceMutex);
         if(!UA_SecureChannel_isConnected(channel)) {
             UA_LOG_INFO_CHANNEL(server->config.logging, channel,
                                 "Processing the message failed. Channel already closed "
                                 "with StatusCode %s. ", UA_StatusCode_name(retval));
+            UA_UNLOCK(&server->serviceMutex);
             return retval;
         }
 
@@ -576,6 +662,7 @@ processSecureChannelMessage(void *application, UA_SecureChannel *channel,
             break;
         }
         UA_SecureChannel_shutdown(channel, reason);
+        UA_UNLOCK(&server->serviceMutex);
     }
 
     return retval;
@@ -674,6 +761,9 @@ createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *c
     entry->channel.processOPNHeader = configServerSecureChannel;
     entry->channel.connectionManager = cm;
     entry->channel.connectionId = connectionId;
+#if UA_MULTITHREADING >= 100
+    entry->channel.processLock = &server->serviceMutex;
+#endif
 
     /* Set the SecureChannel identifier already here. So we get the right
      * identifier for logging right away. The rest of the SecurityToken is set
@@ -701,14 +791,10 @@ createServerSecureChannel(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *c
     return UA_STATUSCODE_GOOD;
 }
 
-/* Callback of a TCP socket (server socket or an active connection) */
-void
-serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
-                      void *application, void **connectionContext,
-                      UA_ConnectionState state,
-                      const UA_KeyValueMap *params,
-                      UA_ByteString msg) {
-    UA_BinaryProtocolManager *bpm = (UA_BinaryProtocolManager*)application;
+static void
+serverNetworkCallbackLocked(UA_BinaryProtocolManager *bpm, UA_ConnectionManager *cm,
+                            uintptr_t connectionId, void **connectionContext,
+                            UA_ConnectionState state, UA_ByteString msg) {
 
     /* A server socket that is not yet registered in the server. Register it and
      * set the connection context to the pointer in the
@@ -823,6 +909,22 @@ serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     }
 }
 
+/* Callback of a TCP socket (server socket or an active connection). Can be
+ * called from the reactor threads. The service lock is released while the
+ * messages are decrypted and decoded. */
+void
+serverNetworkCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+                      void *application, void **connectionContext,
+                      UA_ConnectionState state,
+                      const UA_KeyValueMap *params,
+                      UA_ByteString msg) {
+    UA_BinaryProtocolManager *bpm = (UA_BinaryProtocolManager*)application;
+    UA_LOCK(&bpm->server->serviceMutex);
+    serverNetworkCallbackLocked(bpm, cm, connectionId, connectionContext,
+                                state, msg);
+    UA_UNLOCK(&bpm->server->serviceMutex);
+}
+
 static UA_StatusCode
 createServerConnection(UA_BinaryProtocolManager *bpm, const UA_String *serverUrl) {
     UA_Server *server = bpm->server;
@@ -838,82 +940,101 @@ createServerConnection(UA_BinaryProtocolManager *bpm, const UA_String *serverUrl
     if(res != UA_STATUSCODE_GOOD)
         return res;
 
-    UA_String tcpString = UA_STRING("tcp");
-    for(UA_EventSource *es = config->eventLoop->eventSources;
-        es != NULL; es = es->next) {
-        /* Is this a usable connection manager? */
-        if(es->eventSourceType != UA_EVENTSOURCETYPE_CONNECTIONMANAGER)
-            continue;
-        UA_ConnectionManager *cm = (UA_ConnectionManager*)es;
-        if(!UA_String_equal(&tcpString, &cm->protocol))
-            continue;
-
-        /* Set up the parameters */
-        UA_KeyValuePair params[4];
-        size_t paramsSize = 3;
+    /* Set up the parameters */
+    UA_KeyValuePair params[4];
+    size_t paramsSize = 3;
 
-        params[0].key = UA_QUALIFIEDNAME(0, "port");
-        UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
 
-        UA_Boolean listen = true;
-        params[1].key = UA_QUALIFIEDNAME(0, "listen");
-        UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_Boolean listen = true;
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
 
-        UA_Boolean reuseaddr = config->tcpReuseAddr;
-        params[2].key = UA_QUALIFIEDNAME(0, "reuse");
-        UA_Variant_setScalar(&params[2].value, &reuseaddr, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_Boolean reuseaddr = config->tcpReuseAddr;
+    params[2].key = UA_QUALIFIEDNAME(0, "reuse");
+    UA_Variant_setScalar(&params[2].value, &reuseaddr, &UA_TYPES[UA_TYPES_BOOLEAN]);
 
-        if(hostname.length > 0) {
-            /* The hostname is non-empty */
-            params[3].key = UA_QUALIFIEDNAME(0, "address");
-            UA_Variant_setArray(&params[3].value, &hostname, 1, &UA_TYPES[UA_TYPES_STRING]);
-            paramsSize = 4;
-        } else {
-            /* Add DiscoveryServerUrl */
-            char hostnamestr[1024];
-            hostnamestr[1023] = '\0';
+    if(hostname.length > 0) {
+        /* The hostname is non-empty */
+        params[3].key = UA_QUALIFIEDNAME(0, "address");
+        UA_Variant_setArray(&params[3].value, &hostname, 1, &UA_TYPES[UA_TYPES_STRING]);
+        paramsSize = 4;
+    } else {
+        /* Add DiscoveryServerUrl */
+        char hostnamestr[1024];
+        hostnamestr[1023] = '\0';
 #ifdef _WIN32
-            WSADATA wsaData;
-            WSAStartup(MAKEWORD(2, 2), &wsaData);
+        WSADATA wsaData;
+        WSAStartup(MAKEWORD(2, 2), &wsaData);
 #endif
-            gethostname(hostnamestr, 1023);
+        gethostname(hostnamestr, 1023);
 #ifdef _WIN32
-            WSACleanup();
+        WSACleanup();
 #endif
 
-            char urlstr[1024];
-            mp_snprintf(urlstr, 1024, "opc.tcp://%s:%d", hostnamestr, port);
-            UA_String discoveryServerUrl = UA_STRING(urlstr);
-
-            /* Check if the ServerUrl is already present in the DiscoveryUrl array.
-             * Add if not already there. */
-            bool isContaining = false;
-            for(size_t i = 0; i < config->applicationDescription.discoveryUrlsSize; i++) {
-                if(UA_String_equal(&discoveryServerUrl,
-                                   &config->applicationDescription.discoveryUrls[i])) {
-                    isContaining = true;
-                }
+        char urlstr[1024];
+        mp_snprintf(urlstr, 1024, "opc.tcp://%s:%d", hostnamestr, port);
+        UA_String discoveryServerUrl = UA_STRING(urlstr);
+
+        /* Check if the ServerUrl is already present in the DiscoveryUrl array.
+         * Add if not already there. */
+        bool isContaining = false;
+        for(size_t i = 0; i < config->applicationDescription.discoveryUrlsSize; i++) {
+            if(UA_String_equal(&discoveryServerUrl,
+                               &config->applicationDescription.discoveryUrls[i])) {
+                isContaining = true;
             }
-            if(!isContaining) {
-                if(config->applicationDescription.discoveryUrls == NULL) {
-                    config->applicationDescription.discoveryUrls = (UA_String*)UA_Array_new(1, &UA_TYPES[UA_TYPES_STRING]);
-                    config->applicationDescription.discoveryUrlsSize = 0;
-                }
-                UA_StatusCode retval = UA_STATUSCODE_GOOD;
-                retval = UA_Array_appendCopy((void **)&config->applicationDescription.discoveryUrls,
-                                             &config->applicationDescription.discoveryUrlsSize,
-                                             &discoveryServerUrl, &UA_TYPES[UA_TYPES_STRING]);
-                if(retval != UA_STATUSCODE_GOOD)
-                    return retval;
+        }
+        if(!isContaining) {
+            if(config->applicationDescription.discoveryUrls == NULL) {
+                config->applicationDescription.discoveryUrls = (UA_String*)UA_Array_new(1, &UA_TYPES[UA_TYPES_STRING]);
+                config->applicationDescription.discoveryUrlsSize = 0;
             }
+            UA_StatusCode retval = UA_STATUSCODE_GOOD;
+            retval = UA_Array_appendCopy((void **)&config->applicationDescription.discoveryUrls,
+                                         &config->applicationDescription.discoveryUrlsSize,
+                                         &discoveryServerUrl, &UA_TYPES[UA_TYPES_STRING]);
+            if(retval != UA_STATUSCODE_GOOD)
+                return retval;
+        }
+    }
+
+    UA_KeyValueMap paramsMap;
+    paramsMap.map = params;
+    paramsMap.mapSize = paramsSize;
+
+#if UA_MULTITHREADING >= 100
+    /* Every reactor opens its own server socket. They share the port. */
+    if(UA_ServerReactors_getConnectionManager(server, 0)) {
+        reuseaddr = true;
+        UA_ConnectionManager *rcm;
+        for(size_t i = 0; (rcm = UA_ServerReactors_getConnectionManager(server, i)); i++) {
+            UA_UNLOCK(&server->serviceMutex);
+            res = rcm->openConnection(rcm, &paramsMap, bpm, NULL, serverNetworkCallback);
+            UA_LOCK(&server->serviceMutex);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
         }
+        return UA_STATUSCODE_GOOD;
+    }
+#endif
 
-        UA_KeyValueMap paramsMap;
-        paramsMap.map = params;
-        paramsMap.mapSize = paramsSize;
+    UA_String tcpString = UA_STRING("tcp");
+    for(UA_EventSource *es = config->eventLoop->eventSources;
+        es != NULL; es = es->next) {
+        /* Is this a usable connection manager? */
+        if(es->eventSourceType != UA_EVENTSOURCETYPE_CONNECTIONMANAGER)
+            continue;
+        UA_ConnectionManager *cm = (UA_ConnectionManager*)es;
+        if(!UA_String_equal(&tcpString, &cm->protocol))
+            continue;
 
-        /* Open the server connection */
+        /* Open the server connection. The network callback is called right
+         * away for the new socket and takes the service lock. */
+        UA_UNLOCK(&server->serviceMutex);
         res = cm->openConnection(cm, &paramsMap, bpm, NULL, serverNetworkCallback);
+        UA_LOCK(&server->serviceMutex);
         if(res == UA_STATUSCODE_GOOD)
             return res;
     }
@@ -1083,9 +1204,12 @@ attemptReverseConnect(UA_BinaryProtocolManager *bpm, reverse_connect_context *co
                              &UA_TYPES[UA_TYPES_UINT16]);
         UA_KeyValueMap kvm = {2, params};
 
-        /* Open the connection */
+        /* Open the connection. The network callback is called right away for
+         * the new socket and takes the service lock. */
+        UA_UNLOCK(&server->serviceMutex);
         UA_StatusCode res = cm->openConnection(cm, &kvm, bpm, context,
                                                serverReverseConnectCallback);
+        UA_LOCK(&server->serviceMutex);
         if(res != UA_STATUSCODE_GOOD) {
             UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                            "Failed to create connection for reverse connect: %s\n",
@@ -1199,13 +1323,11 @@ UA_Server_removeReverseConnect(UA_Server *server, UA_UInt64 handle) {
     return result;
 }
 
-void
-serverReverseConnectCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
-                             void *application, void **connectionContext,
-                             UA_ConnectionState state, const UA_KeyValueMap *params,
-                             UA_ByteString msg) {
-    (void)params;
-    UA_BinaryProtocolManager *bpm = (UA_BinaryProtocolManager*)application;
+static void
+serverReverseConnectCallbackLocked(UA_BinaryProtocolManager *bpm,
+                                   UA_ConnectionManager *cm, uintptr_t connectionId,
+                                   void **connectionContext,
+                                   UA_ConnectionState state, UA_ByteString msg) {
     UA_LOG_DEBUG(bpm->logging, UA_LOGCATEGORY_SERVER,
                  "Activity for reverse connect %lu with state %d",
                  (long unsigned)connectionId, state);
@@ -1315,6 +1437,19 @@ serverReverseConnectCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
     setReverseConnectState(bpm->server, context, context->channel->state);
 }
 
+void
+serverReverseConnectCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+                             void *application, void **connectionContext,
+                             UA_ConnectionState state, const UA_KeyValueMap *params,
+                             UA_ByteString msg) {
+    (void)params;
+    UA_BinaryProtocolManager *bpm = (UA_BinaryProtocolManager*)application;
+    UA_LOCK(&bpm->server->serviceMutex);
+    serverReverseConnectCallbackLocked(bpm, cm, connectionId,
+                                       connectionContext, state, msg);
+    UA_UNLOCK(&bpm->server->serviceMutex);
+}
+
 /***************************/
 /* Binary Protocol Manager */
 /***************************/
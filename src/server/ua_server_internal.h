@@ -26,6 +26,8 @@
 #include "ua_session.h"
 #include "ua_services.h"
 #include "ua_server_async.h"
+#include "ua_server_workers.h"
+#include "ua_server_reactors.h"
 #include "util/ua_util_internal.h"
 #include "ziptree.h"
 
@@ -120,9 +122,24 @@ getServerComponentByName(UA_Server *server, UA_String name);
 typedef struct session_list_entry {
     UA_DelayedCallback cleanupCallback;
     LIST_ENTRY(session_list_entry) pointers;
+    ZIP_ENTRY(session_list_entry) idTreeEntry;
+    ZIP_ENTRY(session_list_entry) tokenTreeEntry;
     UA_Session session;
 } session_list_entry;
 
+enum ZIP_CMP
+cmpSessionNodeId(const UA_NodeId *a, const UA_NodeId *b);
+
+/* The sessions are indexed by their SessionId and AuthenticationToken. So the
+ * lookup for every request does not scale with the number of sessions. */
+typedef ZIP_HEAD(UA_SessionIdTree, session_list_entry) UA_SessionIdTree;
+ZIP_FUNCTIONS(UA_SessionIdTree, session_list_entry, idTreeEntry,
+              UA_NodeId, session.sessionId, cmpSessionNodeId)
+
+typedef ZIP_HEAD(UA_SessionTokenTree, session_list_entry) UA_SessionTokenTree;
+ZIP_FUNCTIONS(UA_SessionTokenTree, session_list_entry, tokenTreeEntry,
+              UA_NodeId, session.authenticationToken, cmpSessionNodeId)
+
 struct UA_Server {
     /* Config */
     UA_ServerConfig config;
@@ -140,10 +157,14 @@ struct UA_Server {
 
 #if UA_MULTITHREADING >= 100
     UA_AsyncManager asyncManager;
+    UA_ServiceWorkers *serviceWorkers; /* NULL if never started */
+    UA_ServerReactors *reactors; /* NULL if not running */
 #endif
 
     /* Session Management */
     LIST_HEAD(session_list, session_list_entry) sessions;
+    UA_SessionIdTree sessionsById;
+    UA_SessionTokenTree sessionsByToken;
     UA_UInt32 sessionCount;
     UA_UInt32 activeSessionCount;
 
@@ -151,6 +172,9 @@ struct UA_Server {
      * equipped with all possible access rights (Session Id: 1). */
     UA_Session adminSession;
 
+    /* The last version assigned to the internal value of a VariableNode */
+    UA_UInt64 lastValueVersion;
+
     /* Namespaces */
     size_t namespacesSize;
     UA_String *namespaces;
@@ -171,6 +195,11 @@ struct UA_Server {
     LIST_HEAD(, UA_Subscription) subscriptions; /* All subscriptions in the
                                                  * server. They may be detached
                                                  * from a session. */
+    UA_ServerSubscriptionTree subscriptionsById;
+    UA_SamplingGroupTree samplingGroups; /* Cyclic sampling of MonitoredItems */
+#ifdef UA_ENABLE_DIAGNOSTICS
+    UA_SamplingStatistics samplingStatistics;
+#endif
     UA_UInt32 lastSubscriptionId; /* To generate unique SubscriptionIds */
 
 # ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
@@ -191,6 +220,10 @@ struct UA_Server {
     /* Statistics */
     UA_SecureChannelStatistics secureChannelStatistics;
     UA_ServerDiagnosticsSummaryDataType serverDiagnosticsSummary;
+#ifdef UA_ENABLE_DIAGNOSTICS
+    /* Indexed in parallel to the service table */
+    UA_ServiceLatency serviceLatency[UA_SERVICETABLE_SIZE];
+#endif
 };
 
 /***********************/
@@ -362,10 +395,47 @@ UA_Server_processRequest(UA_Server *server, UA_SecureChannel *channel,
                          UA_UInt32 requestId, UA_ServiceDescription *sd,
                          const UA_Request *request, UA_Response *response);
 
+#if UA_MULTITHREADING >= 100
+/* Checks whether a request for a parallel service can be handed to the service
+ * workers. Returns the session or NULL if the request has to be processed with
+ * the exclusive lock. That is also the case if the checks fail, so that errors
+ * are handled in the normal processing. Requires a shared lock. The session
+ * lifetime is not updated. */
+UA_Session *
+UA_Server_prepareParallelRequest(UA_Server *server, UA_SecureChannel *channel,
+                                 const UA_ServiceDescription *sd,
+                                 const UA_Request *request);
+
+/* Executes the service prepared with UA_Server_prepareParallelRequest. Only
+ * one request is executed at a time per session. Requires a shared lock. */
+void
+UA_Server_processParallelRequest(UA_Server *server, UA_Session *session,
+                                 const UA_ServiceDescription *sd,
+                                 const UA_Request *request,
+                                 UA_Response *response);
+#endif
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+/* Add a latency measurement for the service. Requires the service lock. */
+void
+UA_Server_updateServiceLatency(UA_Server *server, const UA_ServiceDescription *sd,
+                               UA_DateTime latency);
+#endif
+
 UA_StatusCode
 sendResponse(UA_Server *server, UA_SecureChannel *channel, UA_UInt32 requestId,
              UA_Response *response, const UA_DataType *responseType);
 
+/* Begins a response that is encoded while it is produced. The response type
+ * and the ResponseHeader are encoded right away. The service then encodes the
+ * remaining members with UA_MessageContext_encode and sends the last chunk with
+ * UA_MessageContext_finish. Full chunks are sent out along the way. So only
+ * the current chunk is held in memory, not the entire response. */
+UA_StatusCode
+beginStreamedResponse(UA_Server *server, UA_SecureChannel *channel,
+                      UA_UInt32 requestId, UA_ResponseHeader *responseHeader,
+                      const UA_DataType *responseType, UA_MessageContext *mc);
+
 /* Many services come as an array of operations. This function generalizes the
  * processing of the operations. */
 typedef void (*UA_ServiceOperation)(UA_Server *server, UA_Session *session,
@@ -467,6 +537,16 @@ readWithSession(UA_Server *server, UA_Session *session,
                 const UA_ReadValueId *item,
                 UA_TimestampsToReturn timestampsToReturn);
 
+/* Read for sampling. The value attribute of a VariableNode with an internal
+ * value is not read if its version is still *version. Then false is returned.
+ * Otherwise the DataValue is read and *version is set to the current version
+ * (zero if the read result is not covered by the version). */
+UA_Boolean
+readWithSessionIfChanged(UA_Server *server, UA_Session *session,
+                         const UA_ReadValueId *item,
+                         UA_TimestampsToReturn timestampsToReturn,
+                         UA_UInt64 *version, UA_DataValue *dv);
+
 UA_StatusCode
 readWithReadValue(UA_Server *server, const UA_NodeId *nodeId,
                   const UA_AttributeId attributeId, void *v);
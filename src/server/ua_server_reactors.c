@@ -0,0 +1,174 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *    Copyright 2024 (c) open62541 contributors
+ */
+
+#include "ua_server_internal.h"
+
+#if UA_MULTITHREADING >= 100
+
+#if defined(UA_ARCHITECTURE_POSIX)
+
+#include <pthread.h>
+
+typedef struct {
+    UA_ServerReactors *rs;
+    UA_EventLoop *el;
+    UA_ConnectionManager *cm;
+    pthread_t thread;
+    UA_Boolean threadStarted;
+} UA_ServerReactor;
+
+struct UA_ServerReactors {
+    volatile UA_Boolean running;
+    size_t reactorsSize;
+    UA_ServerReactor *reactors;
+};
+
+static void *
+reactorThread(void *arg) {
+    UA_ServerReactor *r = (UA_ServerReactor*)arg;
+    while(r->rs->running)
+        r->el->run(r->el, 100);
+    return NULL;
+}
+
+static UA_StatusCode
+startReactor(UA_Server *server, UA_ServerReactor *r) {
+    r->el = UA_EventLoop_new_POSIX(server->config.logging);
+    if(!r->el)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* The ConnectionManager is freed with the EventLoop once registered */
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcp"));
+    if(!cm)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res = r->el->registerEventSource(r->el, &cm->eventSource);
+    if(res != UA_STATUSCODE_GOOD) {
+        cm->eventSource.free(&cm->eventSource);
+        return res;
+    }
+    r->cm = cm;
+
+    res = r->el->start(r->el);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    if(pthread_create(&r->thread, NULL, reactorThread, r) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    r->threadStarted = true;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_ServerReactors_start(UA_Server *server) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_UInt16 reactorsSize = server->config.tcpReactors;
+    if(reactorsSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    UA_assert(!server->reactors);
+    UA_ServerReactors *rs = (UA_ServerReactors*)
+        UA_calloc(1, sizeof(UA_ServerReactors));
+    if(!rs)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    rs->reactors = (UA_ServerReactor*)
+        UA_calloc(reactorsSize, sizeof(UA_ServerReactor));
+    if(!rs->reactors) {
+        UA_free(rs);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    rs->reactorsSize = reactorsSize;
+    rs->running = true;
+    server->reactors = rs;
+
+    for(size_t i = 0; i < reactorsSize; i++) {
+        rs->reactors[i].rs = rs;
+        UA_StatusCode res = startReactor(server, &rs->reactors[i]);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
+                         "Could not start the reactors with StatusCode %s",
+                         UA_StatusCode_name(res));
+            UA_ServerReactors_stop(server);
+            return res;
+        }
+    }
+
+    UA_LOG_INFO(server->config.logging, UA_LOGCATEGORY_SERVER,
+                "Started %u reactors", (unsigned)reactorsSize);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ServerReactors_stop(UA_Server *server) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_ServerReactors *rs = server->reactors;
+    if(!rs)
+        return;
+    server->reactors = NULL;
+
+    /* Join the threads. The network callbacks in the reactor threads need the
+     * service lock to finish. */
+    UA_UNLOCK(&server->serviceMutex);
+    rs->running = false;
+    for(size_t i = 0; i < rs->reactorsSize; i++) {
+        UA_ServerReactor *r = &rs->reactors[i];
+        if(!r->threadStarted)
+            continue;
+        r->el->cancel(r->el);
+        pthread_join(r->thread, NULL);
+    }
+
+    /* Stop and free the EventLoops from this thread */
+    for(size_t i = 0; i < rs->reactorsSize; i++) {
+        UA_EventLoop *el = rs->reactors[i].el;
+        if(!el)
+            continue;
+        if(el->state != UA_EVENTLOOPSTATE_FRESH &&
+           el->state != UA_EVENTLOOPSTATE_STOPPED) {
+            el->stop(el);
+            while(el->state != UA_EVENTLOOPSTATE_STOPPED) {
+                if(el->run(el, 100) != UA_STATUSCODE_GOOD)
+                    break;
+            }
+        }
+        el->free(el);
+    }
+    UA_LOCK(&server->serviceMutex);
+
+    UA_free(rs->reactors);
+    UA_free(rs);
+}
+
+UA_ConnectionManager *
+UA_ServerReactors_getConnectionManager(UA_Server *server, size_t index) {
+    UA_ServerReactors *rs = server->reactors;
+    if(!rs || index >= rs->reactorsSize)
+        return NULL;
+    return rs->reactors[index].cm;
+}
+
+#else /* !defined(UA_ARCHITECTURE_POSIX) */
+
+UA_StatusCode
+UA_ServerReactors_start(UA_Server *server) {
+    if(server->config.tcpReactors > 0)
+        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                       "Reactors are not supported on this architecture. "
+                       "The connections are handled by the server EventLoop.");
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ServerReactors_stop(UA_Server *server) {}
+
+UA_ConnectionManager *
+UA_ServerReactors_getConnectionManager(UA_Server *server, size_t index) {
+    return NULL;
+}
+
+#endif /* !defined(UA_ARCHITECTURE_POSIX) */
+
+#endif /* UA_MULTITHREADING >= 100 */
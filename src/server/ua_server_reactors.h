@@ -0,0 +1,50 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *    Copyright 2024 (c) open62541 contributors
+ */
+
+#ifndef UA_SERVER_REACTORS_H_
+#define UA_SERVER_REACTORS_H_
+
+#include <open62541/server.h>
+
+_UA_BEGIN_DECLS
+
+#if UA_MULTITHREADING >= 100
+
+/* The reactors handle the TCP connections of the server. Every reactor has its
+ * own EventLoop with a TCP ConnectionManager and runs it in a separate thread.
+ * The reactors listen on the same port (SO_REUSEPORT). So the kernel
+ * distributes the new connections among them.
+ *
+ * The network callbacks of the connections are executed in the reactor
+ * thread. They take the service lock, except for the decryption of symmetric
+ * chunks and the decoding of the requests (see the processLock of the
+ * SecureChannel). The server EventLoop keeps all other tasks (timers,
+ * subscriptions, reverse connect, ...). */
+
+struct UA_ServerReactors;
+typedef struct UA_ServerReactors UA_ServerReactors;
+
+/* Starts the reactors according to config.tcpReactors. Nothing is started if
+ * no reactors are configured. */
+UA_StatusCode
+UA_ServerReactors_start(UA_Server *server);
+
+/* Stops the EventLoops of the reactors and joins the threads. Must be called
+ * once the BinaryProtocolManager has closed all connections. */
+void
+UA_ServerReactors_stop(UA_Server *server);
+
+/* Returns the TCP ConnectionManager of the reactor with the index. NULL if the
+ * reactors are not running or the index is out of range. */
+UA_ConnectionManager *
+UA_ServerReactors_getConnectionManager(UA_Server *server, size_t index);
+
+#endif /* UA_MULTITHREADING >= 100 */
+
+_UA_END_DECLS
+
+#endif /* UA_SERVER_REACTORS_H_ */
@@ -0,0 +1,600 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *    Copyright 2024 (c) open62541 contributors
+ */
+
+#include "ua_server_internal.h"
+
+#if UA_MULTITHREADING >= 100
+
+#if defined(UA_ARCHITECTURE_WIN32)
+typedef HANDLE UA_WorkerThread;
+#else
+#include <pthread.h>
+typedef pthread_t UA_WorkerThread;
+#endif
+
+typedef struct UA_ServiceJob {
+    TAILQ_ENTRY(UA_ServiceJob) pointers;
+    UA_SecureChannel *channel; /* NULL if the SecureChannel was closed */
+    UA_Session *session;       /* NULL if the Session was removed */
+    UA_UInt32 requestId;
+    UA_DateTime received; /* For the latency statistics */
+    UA_DateTime finished;
+    const UA_ServiceDescription *sd;
+    UA_Request request;
+    UA_Arena requestArena; /* Memory of the request */
+    UA_Response response;
+} UA_ServiceJob;
+
+typedef TAILQ_HEAD(UA_ServiceJobQueue, UA_ServiceJob) UA_ServiceJobQueue;
+
+typedef struct {
+    UA_ServiceWorkers *sw;
+    UA_WorkerThread thread;
+    UA_ServiceJob *job;        /* Currently processed job or NULL */
+    const UA_Session *session; /* Session of the current job. Kept when the job
+                                * is detached from the session. */
+} UA_ServiceWorker;
+
+struct UA_ServiceWorkers {
+    UA_Server *server;
+
+    /* Only the mutex and the condition of the queueLock are used. The worker
+     * threads wait on the condition for new jobs. */
+    UA_Lock queueLock;
+    UA_Boolean running;
+    UA_ServiceJobQueue jobs;     /* Waiting to be processed */
+    UA_ServiceJobQueue results;  /* Waiting for the response to be sent */
+    UA_ServiceJobQueue deferred; /* Waiting for the earlier requests of the
+                                  * session to be answered */
+
+    /* Sends the results from the EventLoop thread */
+    UA_DelayedCallback dc;
+    UA_Boolean dcPending;
+
+    size_t workersSize;
+    size_t threadsSize; /* Number of started threads */
+    UA_ServiceWorker *workers;
+};
+
+static void
+UA_ServiceJob_delete(UA_ServiceJob *job) {
+    UA_Arena_clear(&job->requestArena);
+    UA_clear(&job->response, job->sd->responseType);
+    UA_free(job);
+}
+
+/* Discard the jobs. They are no longer pending for their session. */
+static void
+clearJobQueue(UA_ServiceJobQueue *queue, UA_Boolean deferred) {
+    UA_ServiceJob *job, *job_tmp;
+    TAILQ_FOREACH_SAFE(job, queue, pointers, job_tmp) {
+        TAILQ_REMOVE(queue, job, pointers);
+        if(job->session) {
+            if(deferred)
+                job->session->deferredJobs--;
+            else
+                job->session->serviceJobs--;
+        }
+        UA_ServiceJob_delete(job);
+    }
+}
+
+/* Move the request and response into a new job */
+static UA_ServiceJob *
+newJob(UA_SecureChannel *channel, UA_Session *session, UA_UInt32 requestId,
+       const UA_ServiceDescription *sd, UA_Request *request,
+       UA_Arena *requestArena, UA_Response *response, UA_DateTime received) {
+    UA_ServiceJob *job = (UA_ServiceJob*)UA_malloc(sizeof(UA_ServiceJob));
+    if(!job)
+        return NULL;
+    job->channel = channel;
+    job->session = session;
+    job->requestId = requestId;
+    job->received = received;
+    job->sd = sd;
+    memcpy(&job->request, request, sd->requestType->memSize);
+    job->requestArena = *requestArena;
+    memset(requestArena, 0, sizeof(UA_Arena));
+    memcpy(&job->response, response, sd->responseType->memSize);
+    return job;
+}
+
+static UA_Boolean
+sessionBusy(UA_ServiceWorkers *sw, const UA_Session *session) {
+    for(size_t i = 0; i < sw->workersSize; i++) {
+        if(sw->workers[i].job && sw->workers[i].session == session)
+            return true;
+    }
+    return false;
+}
+
+/* Get the first job whose session is not processed by another worker. This
+ * keeps the order of the requests within a session. */
+static UA_ServiceJob *
+nextJob(UA_ServiceWorkers *sw) {
+    UA_ServiceJob *job;
+    TAILQ_FOREACH(job, &sw->jobs, pointers) {
+        if(!job->session || !sessionBusy(sw, job->session))
+            return job;
+    }
+    return NULL;
+}
+
+/* Process a deferred request like a request that was not handed to the
+ * workers. With the service lock. */
+static void
+processDeferredJob(UA_Server *server, UA_ServiceJob *job) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    if(!job->channel)
+        return;
+
+    UA_Boolean async =
+        UA_Server_processRequest(server, job->channel, job->requestId,
+                                 (UA_ServiceDescription*)(uintptr_t)job->sd,
+                                 &job->request, &job->response);
+    if(async || !job->channel)
+        return;
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_Server_updateServiceLatency(server, job->sd,
+                                   el->dateTime_nowMonotonic(el) - job->received);
+#endif
+    UA_StatusCode res = sendResponse(server, job->channel, job->requestId,
+                                     &job->response, job->sd->responseType);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING_CHANNEL(server->config.logging, job->channel,
+                               "Could not send the response for "
+                               "Req# %" PRIu32 " with StatusCode %s",
+                               job->requestId, UA_StatusCode_name(res));
+}
+
+/* Continue with the deferred requests of the sessions that have no more
+ * requests with the workers. A deferred parallel request goes to the workers
+ * and the following requests of the session wait again. The others are
+ * processed in the current thread. */
+static void
+processDeferred(UA_Server *server, UA_ServiceWorkers *sw) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    UA_ServiceJob *job = TAILQ_FIRST(&sw->deferred);
+    while(job) {
+        UA_ServiceJob *next = TAILQ_NEXT(job, pointers);
+        UA_Session *session = job->session;
+        if(session && session->serviceJobs > 0) {
+            job = next;
+            continue;
+        }
+
+        if(session && job->sd->parallel && sw->running) {
+            TAILQ_REMOVE(&sw->deferred, job, pointers);
+            session->deferredJobs--;
+            TAILQ_INSERT_TAIL(&sw->jobs, job, pointers);
+            session->serviceJobs++;
+            UA_LOCK_MUTEX_BROADCAST(&sw->queueLock);
+            job = next;
+            continue;
+        }
+
+        /* The job stays in the queue while it is processed. So it is detached
+         * when the session or channel is removed. And requests that arrive
+         * while the service lock is released in between line up behind. */
+        UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+        processDeferredJob(server, job);
+        UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+        TAILQ_REMOVE(&sw->deferred, job, pointers);
+        if(job->session)
+            job->session->deferredJobs--;
+        UA_ServiceJob_delete(job);
+        job = TAILQ_FIRST(&sw->deferred); /* Start over */
+    }
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+}
+
+/* Executed in the EventLoop thread with the service lock. The SecureChannels
+ * can be closed and used for sending by the reactor threads. */
+static void
+sendResultsLocked(UA_Server *server, UA_ServiceWorkers *sw) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_ServiceJob *job, *job_tmp;
+    UA_ServiceJobQueue results;
+    TAILQ_INIT(&results);
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    while((job = TAILQ_FIRST(&sw->results))) {
+        TAILQ_REMOVE(&sw->results, job, pointers);
+        TAILQ_INSERT_TAIL(&results, job, pointers);
+        if(job->session)
+            job->session->serviceJobs--;
+    }
+    sw->dcPending = false;
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+
+    /* Update the session lifetime. Not done by the workers, as the session
+     * diagnostics can be read concurrently. */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime now = el->dateTime_now(el);
+    UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
+    TAILQ_FOREACH(job, &results, pointers) {
+        if(job->session)
+            UA_Session_updateLifetime(job->session, now, nowMonotonic);
+    }
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+    /* Update the latency statistics. Once for all results. */
+    TAILQ_FOREACH(job, &results, pointers) {
+        UA_Server_updateServiceLatency(server, job->sd, job->finished - job->received);
+    }
+#endif
+
+    TAILQ_FOREACH_SAFE(job, &results, pointers, job_tmp) {
+        TAILQ_REMOVE(&results, job, pointers);
+        if(job->channel) {
+            UA_StatusCode res = sendResponse(server, job->channel, job->requestId,
+                                             &job->response, job->sd->responseType);
+            if(res != UA_STATUSCODE_GOOD)
+                UA_LOG_WARNING_CHANNEL(server->config.logging, job->channel,
+                                       "Could not send the response for "
+                                       "Req# %" PRIu32 " with StatusCode %s",
+                                       job->requestId, UA_StatusCode_name(res));
+        }
+        UA_ServiceJob_delete(job);
+    }
+
+    processDeferred(server, sw);
+}
+
+static void
+sendResults(UA_Server *server, UA_ServiceWorkers *sw) {
+    UA_LOCK(&server->serviceMutex);
+    sendResultsLocked(server, sw);
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+static void
+processJobs(UA_ServiceWorker *w) {
+    UA_ServiceWorkers *sw = w->sw;
+    UA_Server *server = sw->server;
+    UA_EventLoop *el = server->config.eventLoop;
+
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    while(true) {
+        /* Wait for a job */
+        UA_ServiceJob *job = NULL;
+        while(sw->running && !(job = nextJob(sw)))
+            UA_LOCK_MUTEX_WAIT(&sw->queueLock);
+        if(!sw->running)
+            break;
+        TAILQ_REMOVE(&sw->jobs, job, pointers);
+        w->job = job;
+        w->session = job->session;
+        UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+
+        /* Execute the service. The session can only be removed while the
+         * shared lock is released. Then job->session is set to NULL. */
+        UA_LOCK_SHARED(&server->serviceMutex);
+        if(job->session) {
+            UA_Server_processParallelRequest(server, job->session, job->sd,
+                                             &job->request, &job->response);
+        } else {
+            job->response.responseHeader.serviceResult =
+                UA_STATUSCODE_BADSESSIONIDINVALID;
+        }
+        UA_UNLOCK_SHARED(&server->serviceMutex);
+#ifdef UA_ENABLE_DIAGNOSTICS
+        job->finished = el->dateTime_nowMonotonic(el);
+#endif
+
+        /* Move to the results. Wake up the other workers, they might be
+         * waiting for the session to become available. */
+        UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+        w->job = NULL;
+        w->session = NULL;
+        TAILQ_INSERT_TAIL(&sw->results, job, pointers);
+        UA_Boolean wake = !sw->dcPending;
+        sw->dcPending = true;
+        if(!TAILQ_EMPTY(&sw->jobs))
+            UA_LOCK_MUTEX_BROADCAST(&sw->queueLock);
+        UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+
+        /* Send the results from the EventLoop. Don't wait for the next
+         * network event to wake up the EventLoop. */
+        if(wake) {
+            el->addDelayedCallback(el, &sw->dc);
+            if(el->cancel)
+                el->cancel(el);
+        }
+
+        UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    }
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+}
+
+#if defined(UA_ARCHITECTURE_WIN32)
+static DWORD WINAPI
+workerThread(LPVOID arg) {
+    processJobs((UA_ServiceWorker*)arg);
+    return 0;
+}
+#else
+static void *
+workerThread(void *arg) {
+    processJobs((UA_ServiceWorker*)arg);
+    return NULL;
+}
+#endif
+
+UA_StatusCode
+UA_ServiceWorkers_start(UA_Server *server) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_UInt16 workersSize = server->config.serviceWorkers;
+    if(workersSize == 0)
+        return UA_STATUSCODE_GOOD;
+
+    /* Allocate once and reuse for restarts of the server */
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw) {
+        sw = (UA_ServiceWorkers*)UA_calloc(1, sizeof(UA_ServiceWorkers));
+        if(!sw)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        UA_LOCK_INIT(&sw->queueLock);
+        TAILQ_INIT(&sw->jobs);
+        TAILQ_INIT(&sw->results);
+        TAILQ_INIT(&sw->deferred);
+        sw->server = server;
+        sw->dc.callback = (UA_Callback)sendResults;
+        sw->dc.application = server;
+        sw->dc.context = sw;
+        server->serviceWorkers = sw;
+    }
+
+    UA_assert(!sw->running && !sw->workers);
+    sw->workers = (UA_ServiceWorker*)
+        UA_calloc(workersSize, sizeof(UA_ServiceWorker));
+    if(!sw->workers)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    sw->workersSize = workersSize;
+
+    /* Start the threads */
+    sw->running = true;
+    for(; sw->threadsSize < workersSize; sw->threadsSize++) {
+        UA_ServiceWorker *w = &sw->workers[sw->threadsSize];
+        w->sw = sw;
+#if defined(UA_ARCHITECTURE_WIN32)
+        w->thread = CreateThread(NULL, 0, workerThread, w, 0, NULL);
+        if(!w->thread)
+            break;
+#else
+        if(pthread_create(&w->thread, NULL, workerThread, w) != 0)
+            break;
+#endif
+    }
+
+    if(sw->threadsSize < workersSize) {
+        UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_SERVER,
+                     "Could not start the service workers");
+        UA_ServiceWorkers_stop(server);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    UA_LOG_INFO(server->config.logging, UA_LOGCATEGORY_SERVER,
+                "Started %u service workers", (unsigned)workersSize);
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ServiceWorkers_stop(UA_Server *server) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw || !sw->workers)
+        return;
+
+    /* Signal the workers to stop */
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    sw->running = false;
+    UA_LOCK_MUTEX_BROADCAST(&sw->queueLock);
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+
+    /* Join the threads. The workers need the service lock to finish the
+     * current job. */
+    UA_UNLOCK(&server->serviceMutex);
+    for(size_t i = 0; i < sw->threadsSize; i++) {
+#if defined(UA_ARCHITECTURE_WIN32)
+        WaitForSingleObject(sw->workers[i].thread, INFINITE);
+        CloseHandle(sw->workers[i].thread);
+#else
+        pthread_join(sw->workers[i].thread, NULL);
+#endif
+    }
+
+    UA_LOCK(&server->serviceMutex);
+
+    /* Discard the jobs that were not started and the requests deferred behind
+     * them */
+    clearJobQueue(&sw->jobs, false);
+    clearJobQueue(&sw->deferred, true);
+
+    /* Send the finished results */
+    UA_EventLoop *el = server->config.eventLoop;
+    if(sw->dcPending)
+        el->removeDelayedCallback(el, &sw->dc);
+    sendResultsLocked(server, sw);
+
+    UA_free(sw->workers);
+    sw->workers = NULL;
+    sw->workersSize = 0;
+    sw->threadsSize = 0;
+}
+
+void
+UA_ServiceWorkers_delete(UA_Server *server) {
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw)
+        return;
+    UA_assert(!sw->workers);
+    UA_LOCK_DESTROY(&sw->queueLock);
+    UA_free(sw);
+    server->serviceWorkers = NULL;
+}
+
+UA_Boolean
+UA_ServiceWorkers_enqueue(UA_Server *server, UA_SecureChannel *channel,
+                          UA_UInt32 requestId, const UA_ServiceDescription *sd,
+                          UA_Request *request, UA_Arena *requestArena,
+                          UA_Response *response, UA_DateTime received) {
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw || !sw->running)
+        return false;
+
+    UA_LOCK_SHARED(&server->serviceMutex);
+    UA_Session *session =
+        UA_Server_prepareParallelRequest(server, channel, sd, request);
+    if(!session) {
+        UA_UNLOCK_SHARED(&server->serviceMutex);
+        return false;
+    }
+
+    UA_ServiceJob *job = newJob(channel, session, requestId, sd, request,
+                                requestArena, response, received);
+    if(!job) {
+        UA_UNLOCK_SHARED(&server->serviceMutex);
+        return false;
+    }
+
+    /* Stay behind the deferred requests of the session */
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    if(session->deferredJobs > 0) {
+        TAILQ_INSERT_TAIL(&sw->deferred, job, pointers);
+        session->deferredJobs++;
+    } else {
+        TAILQ_INSERT_TAIL(&sw->jobs, job, pointers);
+        session->serviceJobs++;
+        UA_LOCK_MUTEX_BROADCAST(&sw->queueLock);
+    }
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+
+    UA_UNLOCK_SHARED(&server->serviceMutex);
+    return true;
+}
+
+UA_Boolean
+UA_ServiceWorkers_defer(UA_Server *server, UA_SecureChannel *channel,
+                        UA_UInt32 requestId, const UA_ServiceDescription *sd,
+                        UA_Request *request, UA_Arena *requestArena,
+                        UA_Response *response, UA_DateTime received) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw)
+        return false;
+
+    /* Find the session bound to the SecureChannel. Requests without a session
+     * are not ordered. */
+    const UA_NodeId *token = &request->requestHeader.authenticationToken;
+    UA_Session *session = channel->sessions;
+    for(; session; session = session->next) {
+        if(UA_NodeId_equal(token, &session->authenticationToken))
+            break;
+    }
+    if(!session)
+        return false;
+
+    /* The counters are only increased with the service lock */
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    UA_Boolean pending = (session->serviceJobs > 0 || session->deferredJobs > 0);
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+    if(!pending)
+        return false;
+
+    UA_ServiceJob *job = newJob(channel, session, requestId, sd, request,
+                                requestArena, response, received);
+    if(!job)
+        return false;
+
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    TAILQ_INSERT_TAIL(&sw->deferred, job, pointers);
+    session->deferredJobs++;
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+    return true;
+}
+
+void
+UA_ServiceWorkers_removeSession(UA_Server *server, UA_Session *session) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw)
+        return;
+    UA_ServiceJob *job;
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    TAILQ_FOREACH(job, &sw->jobs, pointers) {
+        if(job->session == session)
+            job->session = NULL;
+    }
+    TAILQ_FOREACH(job, &sw->results, pointers) {
+        if(job->session == session)
+            job->session = NULL;
+    }
+    TAILQ_FOREACH(job, &sw->deferred, pointers) {
+        if(job->session == session)
+            job->session = NULL;
+    }
+    for(size_t i = 0; i < sw->workersSize; i++) {
+        job = sw->workers[i].job;
+        if(job && job->session == session)
+            job->session = NULL;
+    }
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+}
+
+void
+UA_ServiceWorkers_removeChannel(UA_Server *server, UA_SecureChannel *channel) {
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw)
+        return;
+    UA_ServiceJob *job;
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    TAILQ_FOREACH(job, &sw->jobs, pointers) {
+        if(job->channel == channel)
+            job->channel = NULL;
+    }
+    TAILQ_FOREACH(job, &sw->results, pointers) {
+        if(job->channel == channel)
+            job->channel = NULL;
+    }
+    TAILQ_FOREACH(job, &sw->deferred, pointers) {
+        if(job->channel == channel)
+            job->channel = NULL;
+    }
+    for(size_t i = 0; i < sw->workersSize; i++) {
+        job = sw->workers[i].job;
+        if(job && job->channel == channel)
+            job->channel = NULL;
+    }
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+}
+
+UA_Boolean
+UA_ServiceWorkers_sessionBusy(UA_Server *server, const UA_Session *session) {
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw)
+        return false;
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    UA_Boolean busy = sessionBusy(sw, session);
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+    return busy;
+}
+
+UA_Boolean
+UA_ServiceWorkers_sessionPending(UA_Server *server, const UA_Session *session) {
+    UA_ServiceWorkers *sw = server->serviceWorkers;
+    if(!sw)
+        return false;
+    UA_LOCK_MUTEX_LOCK(&sw->queueLock);
+    UA_Boolean pending = (session->serviceJobs > 0 || session->deferredJobs > 0);
+    UA_LOCK_MUTEX_UNLOCK(&sw->queueLock);
+    return pending;
+}
+
+#endif /* UA_MULTITHREADING >= 100 */
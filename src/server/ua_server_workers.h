@@ -0,0 +1,90 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ *    Copyright 2024 (c) open62541 contributors
+ */
+
+#ifndef UA_SERVER_WORKERS_H_
+#define UA_SERVER_WORKERS_H_
+
+#include <open62541/server.h>
+
+#include "ua_session.h"
+#include "ua_services.h"
+
+_UA_BEGIN_DECLS
+
+#if UA_MULTITHREADING >= 100
+
+/* The service workers execute requests for the read-only services (with
+ * UA_ServiceDescription->parallel set) in a pool of threads. The workers hold a
+ * shared lock on the serviceMutex while processing. So they run concurrently
+ * with each other but never with a service that modifies the server state.
+ *
+ * Requests of the same session are executed one after the other. The encoding
+ * and sending of the responses is done from a delayed callback in the
+ * EventLoop thread. Until then, the following requests of the session are
+ * deferred and processed in order after the responses were sent. So the
+ * requests of a session are answered in the order they were received. */
+
+struct UA_ServiceWorkers;
+typedef struct UA_ServiceWorkers UA_ServiceWorkers;
+
+/* Starts the worker threads according to config.serviceWorkers. Nothing is
+ * started if no workers are configured. */
+UA_StatusCode
+UA_ServiceWorkers_start(UA_Server *server);
+
+/* Stops and joins the worker threads. The responses of finished jobs are sent.
+ * Jobs that were not started yet are discarded without a response. */
+void
+UA_ServiceWorkers_stop(UA_Server *server);
+
+void
+UA_ServiceWorkers_delete(UA_Server *server);
+
+/* Hands the request to the service workers. Returns false if the request has
+ * to be processed in the normal way. Otherwise the content of the request and
+ * response is moved into the job and the caller must not clear them. The
+ * request memory is allocated from the arena. The arena is moved into the job
+ * as well and left empty. The reception time (monotonic) is used for the
+ * latency statistics. */
+UA_Boolean
+UA_ServiceWorkers_enqueue(UA_Server *server, UA_SecureChannel *channel,
+                          UA_UInt32 requestId, const UA_ServiceDescription *sd,
+                          UA_Request *request, UA_Arena *requestArena,
+                          UA_Response *response, UA_DateTime received);
+
+/* Defers a request that cannot be handed to the service workers if the session
+ * has requests with the workers or deferred. Returns false if the request can
+ * be processed right away. Otherwise the request, arena and response are moved
+ * as for UA_ServiceWorkers_enqueue. Requires the exclusive lock. */
+UA_Boolean
+UA_ServiceWorkers_defer(UA_Server *server, UA_SecureChannel *channel,
+                        UA_UInt32 requestId, const UA_ServiceDescription *sd,
+                        UA_Request *request, UA_Arena *requestArena,
+                        UA_Response *response, UA_DateTime received);
+
+/* Detach jobs from a session or channel that is removed. The jobs are still
+ * processed, but the session-based services report BadSessionIdInvalid and no
+ * response is sent for a detached channel. */
+void
+UA_ServiceWorkers_removeSession(UA_Server *server, UA_Session *session);
+
+void
+UA_ServiceWorkers_removeChannel(UA_Server *server, UA_SecureChannel *channel);
+
+/* Is a job for the session currently being processed by a worker? */
+UA_Boolean
+UA_ServiceWorkers_sessionBusy(UA_Server *server, const UA_Session *session);
+
+/* Does the session have requests that are not answered yet? */
+UA_Boolean
+UA_ServiceWorkers_sessionPending(UA_Server *server, const UA_Session *session);
+
+#endif /* UA_MULTITHREADING >= 100 */
+
+_UA_END_DECLS
+
+#endif /* UA_SERVER_WORKERS_H_ */
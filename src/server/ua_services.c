@@ -39,136 +39,228 @@ UA_NodeId unsafe_fuzz_authenticationToken = {0, UA_NODEIDTYPE_NUMERIC, {0}};
 # define UA_SERVICECOUNTER_OFFSET(X, requiresSession) requiresSession
 #endif
 
-UA_ServiceDescription serviceDescriptions[] = {
+/* The table is indexed by the request type identifier modulo the table size.
+ * Every service has its own slot (the initializers would otherwise override
+ * each other, which is warned about with -Woverride-init). Empty slots have
+ * requestTypeId zero. */
+UA_ServiceDescription serviceDescriptions[UA_SERVICETABLE_SIZE] = {
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_GETENDPOINTSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_GETENDPOINTSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_GetEndpoints,
-     &UA_TYPES[UA_TYPES_GETENDPOINTSREQUEST], &UA_TYPES[UA_TYPES_GETENDPOINTSRESPONSE]},
+     &UA_TYPES[UA_TYPES_GETENDPOINTSREQUEST], &UA_TYPES[UA_TYPES_GETENDPOINTSRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_FINDSERVERSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_FINDSERVERSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_FindServers,
-     &UA_TYPES[UA_TYPES_FINDSERVERSREQUEST], &UA_TYPES[UA_TYPES_FINDSERVERSRESPONSE]},
+     &UA_TYPES[UA_TYPES_FINDSERVERSREQUEST], &UA_TYPES[UA_TYPES_FINDSERVERSRESPONSE], false},
 #ifdef UA_ENABLE_DISCOVERY
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_REGISTERSERVERREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_REGISTERSERVERREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_RegisterServer,
-     &UA_TYPES[UA_TYPES_REGISTERSERVERREQUEST], &UA_TYPES[UA_TYPES_REGISTERSERVERRESPONSE]},
+     &UA_TYPES[UA_TYPES_REGISTERSERVERREQUEST], &UA_TYPES[UA_TYPES_REGISTERSERVERRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_REGISTERSERVER2REQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_REGISTERSERVER2REQUEST_ENCODING_DEFAULTBINARY,
     UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_RegisterServer2,
-    &UA_TYPES[UA_TYPES_REGISTERSERVER2REQUEST], &UA_TYPES[UA_TYPES_REGISTERSERVER2RESPONSE]},
+    &UA_TYPES[UA_TYPES_REGISTERSERVER2REQUEST], &UA_TYPES[UA_TYPES_REGISTERSERVER2RESPONSE], false},
 # ifdef UA_ENABLE_DISCOVERY_MULTICAST
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_FINDSERVERSONNETWORKREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_FINDSERVERSONNETWORKREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_FindServersOnNetwork,
-     &UA_TYPES[UA_TYPES_FINDSERVERSONNETWORKREQUEST], &UA_TYPES[UA_TYPES_FINDSERVERSONNETWORKRESPONSE]},
+     &UA_TYPES[UA_TYPES_FINDSERVERSONNETWORKREQUEST], &UA_TYPES[UA_TYPES_FINDSERVERSONNETWORKRESPONSE], false},
 # endif
 #endif
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_CREATESESSIONREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_CREATESESSIONREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_CreateSession,
-     &UA_TYPES[UA_TYPES_CREATESESSIONREQUEST], &UA_TYPES[UA_TYPES_CREATESESSIONRESPONSE]},
+     &UA_TYPES[UA_TYPES_CREATESESSIONREQUEST], &UA_TYPES[UA_TYPES_CREATESESSIONRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_ACTIVATESESSIONREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_ACTIVATESESSIONREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(false), (UA_Service)Service_ActivateSession,
-     &UA_TYPES[UA_TYPES_ACTIVATESESSIONREQUEST],  &UA_TYPES[UA_TYPES_ACTIVATESESSIONRESPONSE]},
+     &UA_TYPES[UA_TYPES_ACTIVATESESSIONREQUEST],  &UA_TYPES[UA_TYPES_ACTIVATESESSIONRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_CLOSESESSIONREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_CLOSESESSIONREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(true), (UA_Service)Service_CloseSession,
-     &UA_TYPES[UA_TYPES_CLOSESESSIONREQUEST], &UA_TYPES[UA_TYPES_CLOSESESSIONRESPONSE]},
+     &UA_TYPES[UA_TYPES_CLOSESESSIONREQUEST], &UA_TYPES[UA_TYPES_CLOSESESSIONRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_CANCELREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_CANCELREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET_NONE(true), (UA_Service)Service_Cancel,
-     &UA_TYPES[UA_TYPES_CANCELREQUEST], &UA_TYPES[UA_TYPES_CANCELRESPONSE]},
+     &UA_TYPES[UA_TYPES_CANCELREQUEST], &UA_TYPES[UA_TYPES_CANCELRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_READREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_READREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(readCount, true), (UA_Service)Service_Read,
-     &UA_TYPES[UA_TYPES_READREQUEST], &UA_TYPES[UA_TYPES_READRESPONSE]},
+     &UA_TYPES[UA_TYPES_READREQUEST], &UA_TYPES[UA_TYPES_READRESPONSE], true},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_WRITEREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_WRITEREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(writeCount, true), (UA_Service)Service_Write,
-     &UA_TYPES[UA_TYPES_WRITEREQUEST], &UA_TYPES[UA_TYPES_WRITERESPONSE]},
+     &UA_TYPES[UA_TYPES_WRITEREQUEST], &UA_TYPES[UA_TYPES_WRITERESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_BROWSEREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_BROWSEREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(browseCount, true), (UA_Service)Service_Browse,
-     &UA_TYPES[UA_TYPES_BROWSEREQUEST], &UA_TYPES[UA_TYPES_BROWSERESPONSE]},
+     &UA_TYPES[UA_TYPES_BROWSEREQUEST], &UA_TYPES[UA_TYPES_BROWSERESPONSE], true},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_BROWSENEXTREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_BROWSENEXTREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(browseNextCount, true), (UA_Service)Service_BrowseNext,
-     &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST], &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE]},
+     &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST], &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE], true},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_REGISTERNODESREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_REGISTERNODESREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(registerNodesCount, true), (UA_Service)Service_RegisterNodes,
-     &UA_TYPES[UA_TYPES_REGISTERNODESREQUEST], &UA_TYPES[UA_TYPES_REGISTERNODESRESPONSE]},
+     &UA_TYPES[UA_TYPES_REGISTERNODESREQUEST], &UA_TYPES[UA_TYPES_REGISTERNODESRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_UNREGISTERNODESREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_UNREGISTERNODESREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(unregisterNodesCount, true), (UA_Service)Service_UnregisterNodes,
-     &UA_TYPES[UA_TYPES_UNREGISTERNODESREQUEST], &UA_TYPES[UA_TYPES_UNREGISTERNODESRESPONSE]},
+     &UA_TYPES[UA_TYPES_UNREGISTERNODESREQUEST], &UA_TYPES[UA_TYPES_UNREGISTERNODESRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_TRANSLATEBROWSEPATHSTONODEIDSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_TRANSLATEBROWSEPATHSTONODEIDSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(translateBrowsePathsToNodeIdsCount, true), (UA_Service)Service_TranslateBrowsePathsToNodeIds,
-     &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST], &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSRESPONSE]},
+     &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSREQUEST], &UA_TYPES[UA_TYPES_TRANSLATEBROWSEPATHSTONODEIDSRESPONSE], true},
 #ifdef UA_ENABLE_SUBSCRIPTIONS
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_CREATESUBSCRIPTIONREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_CREATESUBSCRIPTIONREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(createSubscriptionCount, true), (UA_Service)Service_CreateSubscription,
-     &UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONREQUEST], &UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONRESPONSE]},
+     &UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONREQUEST], &UA_TYPES[UA_TYPES_CREATESUBSCRIPTIONRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_PUBLISHREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_PUBLISHREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(publishCount, true), NULL,
-     &UA_TYPES[UA_TYPES_PUBLISHREQUEST], &UA_TYPES[UA_TYPES_PUBLISHRESPONSE]},
+     &UA_TYPES[UA_TYPES_PUBLISHREQUEST], &UA_TYPES[UA_TYPES_PUBLISHRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_REPUBLISHREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_REPUBLISHREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(republishCount, true), (UA_Service)Service_Republish,
-     &UA_TYPES[UA_TYPES_REPUBLISHREQUEST], &UA_TYPES[UA_TYPES_REPUBLISHRESPONSE]},
+     &UA_TYPES[UA_TYPES_REPUBLISHREQUEST], &UA_TYPES[UA_TYPES_REPUBLISHRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_MODIFYSUBSCRIPTIONREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_MODIFYSUBSCRIPTIONREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(modifySubscriptionCount, true), (UA_Service)Service_ModifySubscription,
-     &UA_TYPES[UA_TYPES_MODIFYSUBSCRIPTIONREQUEST], &UA_TYPES[UA_TYPES_MODIFYSUBSCRIPTIONRESPONSE]},
+     &UA_TYPES[UA_TYPES_MODIFYSUBSCRIPTIONREQUEST], &UA_TYPES[UA_TYPES_MODIFYSUBSCRIPTIONRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_SETPUBLISHINGMODEREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_SETPUBLISHINGMODEREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(setPublishingModeCount, true), (UA_Service)Service_SetPublishingMode,
-     &UA_TYPES[UA_TYPES_SETPUBLISHINGMODEREQUEST], &UA_TYPES[UA_TYPES_SETPUBLISHINGMODERESPONSE]},
+     &UA_TYPES[UA_TYPES_SETPUBLISHINGMODEREQUEST], &UA_TYPES[UA_TYPES_SETPUBLISHINGMODERESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_DELETESUBSCRIPTIONSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_DELETESUBSCRIPTIONSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(deleteSubscriptionsCount, true), (UA_Service)Service_DeleteSubscriptions,
-     &UA_TYPES[UA_TYPES_DELETESUBSCRIPTIONSREQUEST], &UA_TYPES[UA_TYPES_DELETESUBSCRIPTIONSRESPONSE]},
+     &UA_TYPES[UA_TYPES_DELETESUBSCRIPTIONSREQUEST], &UA_TYPES[UA_TYPES_DELETESUBSCRIPTIONSRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_TRANSFERSUBSCRIPTIONSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_TRANSFERSUBSCRIPTIONSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(transferSubscriptionsCount, true), (UA_Service)Service_TransferSubscriptions,
-     &UA_TYPES[UA_TYPES_TRANSFERSUBSCRIPTIONSREQUEST], &UA_TYPES[UA_TYPES_TRANSFERSUBSCRIPTIONSRESPONSE]},
+     &UA_TYPES[UA_TYPES_TRANSFERSUBSCRIPTIONSREQUEST], &UA_TYPES[UA_TYPES_TRANSFERSUBSCRIPTIONSRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_CREATEMONITOREDITEMSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_CREATEMONITOREDITEMSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(createMonitoredItemsCount, true), (UA_Service)Service_CreateMonitoredItems,
-     &UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSREQUEST], &UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSRESPONSE]},
+     &UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSREQUEST], &UA_TYPES[UA_TYPES_CREATEMONITOREDITEMSRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_DELETEMONITOREDITEMSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_DELETEMONITOREDITEMSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(deleteMonitoredItemsCount, true), (UA_Service)Service_DeleteMonitoredItems,
-     &UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSREQUEST], &UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSRESPONSE]},
+     &UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSREQUEST], &UA_TYPES[UA_TYPES_DELETEMONITOREDITEMSRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_MODIFYMONITOREDITEMSREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_MODIFYMONITOREDITEMSREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(modifyMonitoredItemsCount, true), (UA_Service)Service_ModifyMonitoredItems,
-     &UA_TYPES[UA_TYPES_MODIFYMONITOREDITEMSREQUEST], &UA_TYPES[UA_TYPES_MODIFYMONITOREDITEMSRESPONSE]},
+     &UA_TYPES[UA_TYPES_MODIFYMONITOREDITEMSREQUEST], &UA_TYPES[UA_TYPES_MODIFYMONITOREDITEMSRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_SETMONITORINGMODEREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_SETMONITORINGMODEREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(setMonitoringModeCount, true), (UA_Service)Service_SetMonitoringMode,
-     &UA_TYPES[UA_TYPES_SETMONITORINGMODEREQUEST], &UA_TYPES[UA_TYPES_SETMONITORINGMODERESPONSE]},
+     &UA_TYPES[UA_TYPES_SETMONITORINGMODEREQUEST], &UA_TYPES[UA_TYPES_SETMONITORINGMODERESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_SETTRIGGERINGREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_SETTRIGGERINGREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(setTriggeringCount, true), (UA_Service)Service_SetTriggering,
-     &UA_TYPES[UA_TYPES_SETTRIGGERINGREQUEST], &UA_TYPES[UA_TYPES_SETTRIGGERINGRESPONSE]},
+     &UA_TYPES[UA_TYPES_SETTRIGGERINGREQUEST], &UA_TYPES[UA_TYPES_SETTRIGGERINGRESPONSE], false},
 #endif
 #ifdef UA_ENABLE_HISTORIZING
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_HISTORYREADREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_HISTORYREADREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(historyReadCount, true), (UA_Service)Service_HistoryRead,
-     &UA_TYPES[UA_TYPES_HISTORYREADREQUEST], &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE]},
+     &UA_TYPES[UA_TYPES_HISTORYREADREQUEST], &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_HISTORYUPDATEREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_HISTORYUPDATEREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(historyUpdateCount, true), (UA_Service)Service_HistoryUpdate,
-     &UA_TYPES[UA_TYPES_HISTORYUPDATEREQUEST], &UA_TYPES[UA_TYPES_HISTORYUPDATERESPONSE]},
+     &UA_TYPES[UA_TYPES_HISTORYUPDATEREQUEST], &UA_TYPES[UA_TYPES_HISTORYUPDATERESPONSE], false},
 #endif
 #ifdef UA_ENABLE_METHODCALLS
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_CALLREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_CALLREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(callCount, true), (UA_Service)Service_Call,
-     &UA_TYPES[UA_TYPES_CALLREQUEST], &UA_TYPES[UA_TYPES_CALLRESPONSE]},
+     &UA_TYPES[UA_TYPES_CALLREQUEST], &UA_TYPES[UA_TYPES_CALLRESPONSE], false},
 #endif
 #ifdef UA_ENABLE_NODEMANAGEMENT
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_ADDNODESREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_ADDNODESREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(addNodesCount, true), (UA_Service)Service_AddNodes,
-     &UA_TYPES[UA_TYPES_ADDNODESREQUEST], &UA_TYPES[UA_TYPES_ADDNODESRESPONSE]},
+     &UA_TYPES[UA_TYPES_ADDNODESREQUEST], &UA_TYPES[UA_TYPES_ADDNODESRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_ADDREFERENCESREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_ADDREFERENCESREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(addReferencesCount, true), (UA_Service)Service_AddReferences,
-     &UA_TYPES[UA_TYPES_ADDREFERENCESREQUEST], &UA_TYPES[UA_TYPES_ADDREFERENCESRESPONSE]},
+     &UA_TYPES[UA_TYPES_ADDREFERENCESREQUEST], &UA_TYPES[UA_TYPES_ADDREFERENCESRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_DELETENODESREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_DELETENODESREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(deleteNodesCount, true), (UA_Service)Service_DeleteNodes,
-     &UA_TYPES[UA_TYPES_DELETENODESREQUEST], &UA_TYPES[UA_TYPES_DELETENODESRESPONSE]},
+     &UA_TYPES[UA_TYPES_DELETENODESREQUEST], &UA_TYPES[UA_TYPES_DELETENODESRESPONSE], false},
+    [UA_SERVICETABLE_INDEX(UA_NS0ID_DELETEREFERENCESREQUEST_ENCODING_DEFAULTBINARY)] =
     {UA_NS0ID_DELETEREFERENCESREQUEST_ENCODING_DEFAULTBINARY,
      UA_SERVICECOUNTER_OFFSET(deleteReferencesCount, true), (UA_Service)Service_DeleteReferences,
-     &UA_TYPES[UA_TYPES_DELETEREFERENCESREQUEST], &UA_TYPES[UA_TYPES_DELETEREFERENCESRESPONSE]},
+     &UA_TYPES[UA_TYPES_DELETEREFERENCESREQUEST], &UA_TYPES[UA_TYPES_DELETEREFERENCESRESPONSE], false},
 #endif
-    {0, UA_SERVICECOUNTER_OFFSET_NONE(false), NULL, NULL, NULL}
 };
 
 UA_ServiceDescription *
 getServiceDescription(UA_UInt32 requestTypeId) {
-    for(size_t i = 0; serviceDescriptions[i].requestTypeId > 0; i++) {
-        if(serviceDescriptions[i].requestTypeId == requestTypeId)
-            return &serviceDescriptions[i];
+    UA_ServiceDescription *sd =
+        &serviceDescriptions[UA_SERVICETABLE_INDEX(requestTypeId)];
+    if(requestTypeId == 0 || sd->requestTypeId != requestTypeId)
+        return NULL;
+    return sd;
+}
+
+static void
+updateServiceStatistics(UA_Session *session, const UA_ServiceDescription *sd,
+                        const UA_Response *response) {
+#ifdef UA_ENABLE_DIAGNOSTICS
+    session->diagnostics.totalRequestCount.totalCount++;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+        session->diagnostics.totalRequestCount.errorCount++;
+    if(sd->counterOffset != 0) {
+        UA_ServiceCounterDataType *serviceCounter = (UA_ServiceCounterDataType*)
+            (((uintptr_t)&session->diagnostics) + sd->counterOffset);
+        serviceCounter->totalCount++;
+        if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+            serviceCounter->errorCount++;
+    }
+#endif
+}
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+
+void
+UA_Server_updateServiceLatency(UA_Server *server, const UA_ServiceDescription *sd,
+                               UA_DateTime latency) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_ServiceLatency *sl = &server->serviceLatency[sd - serviceDescriptions];
+    sl->count++;
+    sl->totalTime += latency;
+    if(latency > sl->maxTime)
+        sl->maxTime = latency;
+    size_t bucket = 0;
+    UA_DateTime bound = 10 * UA_DATETIME_USEC;
+    while(bucket < UA_SERVICELATENCY_BUCKETS - 1 && latency >= bound) {
+        bound <<= 1;
+        bucket++;
     }
-    return NULL;
+    sl->histogram[bucket]++;
+}
+
+UA_StatusCode
+UA_Server_getServiceLatency(UA_Server *server, const UA_DataType *requestType,
+                            UA_ServiceLatency *latency) {
+    const UA_NodeId *id = &requestType->binaryEncodingId;
+    if(id->namespaceIndex != 0 || id->identifierType != UA_NODEIDTYPE_NUMERIC)
+        return UA_STATUSCODE_BADNOTFOUND;
+    UA_ServiceDescription *sd = getServiceDescription(id->identifier.numeric);
+    if(!sd)
+        return UA_STATUSCODE_BADNOTFOUND;
+    UA_LOCK(&server->serviceMutex);
+    *latency = server->serviceLatency[sd - serviceDescriptions];
+    UA_UNLOCK(&server->serviceMutex);
+    return UA_STATUSCODE_GOOD;
 }
 
+#endif
+
 static const UA_String securityPolicyNone =
     UA_STRING_STATIC("http://opcfoundation.org/UA/SecurityPolicy#None");
 
@@ -272,6 +364,26 @@ processServiceInternal(UA_Server *server, UA_SecureChannel *channel, UA_Session
     }
 #endif
 
+    /* Batched writes into DataSources might complete asynchronously */
+#if UA_MULTITHREADING >= 100
+    if(sd->requestType == &UA_TYPES[UA_TYPES_WRITEREQUEST]) {
+        UA_Boolean finished = true;
+        Service_WriteAsync(server, session, requestId, &request->writeRequest,
+                           &response->writeResponse, &finished);
+        return !finished;
+    }
+#endif
+
+    /* A raw HistoryRead is streamed into the SecureChannel if possible. Then
+     * the response has already been sent. */
+#ifdef UA_ENABLE_HISTORIZING
+    if(sd->requestType == &UA_TYPES[UA_TYPES_HISTORYREADREQUEST] &&
+       Service_HistoryReadStreaming(server, session, channel, requestId,
+                                    &request->historyReadRequest,
+                                    &response->historyReadResponse))
+        return true;
+#endif
+
     /* Execute the synchronous service call */
     sd->serviceCallback(server, session, request, response);
     return false;
@@ -284,14 +396,15 @@ UA_Server_processRequest(UA_Server *server, UA_SecureChannel *channel,
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
     /* Set the authenticationToken from the create session request to help
-     * fuzzing cover more lines */
+     * fuzzing cover more lines. The request is decoded into the arena of the
+     * SecureChannel. So the token is not freed but replaced by a shallow copy
+     * of the global (which outlives the request). */
 #ifdef FUZZING_BUILD_MODE_UNSAFE_FOR_PRODUCTION
-    UA_NodeId *authenticationToken = &request->requestHeader.authenticationToken;
+    UA_NodeId *authenticationToken = (UA_NodeId*)
+        (uintptr_t)&request->requestHeader.authenticationToken;
     if(!UA_NodeId_isNull(authenticationToken) &&
-       !UA_NodeId_isNull(&unsafe_fuzz_authenticationToken)) {
-        UA_NodeId_clear(authenticationToken);
-        UA_NodeId_copy(&unsafe_fuzz_authenticationToken, authenticationToken);
-    }
+       !UA_NodeId_isNull(&unsafe_fuzz_authenticationToken))
+        *authenticationToken = unsafe_fuzz_authenticationToken;
 #endif
 
     /* Get the session bound to the SecureChannel (not necessarily activated) */
@@ -309,20 +422,56 @@ UA_Server_processRequest(UA_Server *server, UA_SecureChannel *channel,
         processServiceInternal(server, channel, session, requestId, sd, request, response);
 
     /* Update the service statistics */
-#ifdef UA_ENABLE_DIAGNOSTICS
-    if(session) {
-        session->diagnostics.totalRequestCount.totalCount++;
-        if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
-            session->diagnostics.totalRequestCount.errorCount++;
-        if(sd->counterOffset != 0) {
-            UA_ServiceCounterDataType *serviceCounter = (UA_ServiceCounterDataType*)
-                (((uintptr_t)&session->diagnostics) + sd->counterOffset);
-            serviceCounter->totalCount++;
-            if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
-                serviceCounter->errorCount++;
-        }
-    }
-#endif
+    if(session)
+        updateServiceStatistics(session, sd, response);
 
     return async;
 }
+
+#if UA_MULTITHREADING >= 100
+
+UA_Session *
+UA_Server_prepareParallelRequest(UA_Server *server, UA_SecureChannel *channel,
+                                 const UA_ServiceDescription *sd,
+                                 const UA_Request *request) {
+    UA_assert(sd->parallel && sd->sessionRequired);
+
+    /* Leave the handling of missing timestamps to the normal processing */
+    if(request->requestHeader.timestamp == 0 &&
+       server->config.verifyRequestTimestamp <= UA_RULEHANDLING_WARN)
+        return NULL;
+
+    /* Only discovery services on an unencrypted channel */
+    if(server->config.securityPolicyNoneDiscoveryOnly &&
+       UA_String_equal(&channel->securityPolicy->policyUri, &securityPolicyNone))
+        return NULL;
+
+    /* Find the activated session bound to the SecureChannel. The statistics
+     * for rejected requests are updated in the normal processing. */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime nowMonotonic = el->dateTime_nowMonotonic(el);
+    const UA_NodeId *token = &request->requestHeader.authenticationToken;
+    UA_Session *session = channel->sessions;
+    for(; session; session = session->next) {
+        if(UA_NodeId_equal(token, &session->authenticationToken))
+            break;
+    }
+    if(!session || !session->activated || session->validTill < nowMonotonic)
+        return NULL;
+
+    /* The session lifetime is updated with the exclusive lock when the
+     * response is sent. The workers can read the session diagnostics. */
+    return session;
+}
+
+void
+UA_Server_processParallelRequest(UA_Server *server, UA_Session *session,
+                                 const UA_ServiceDescription *sd,
+                                 const UA_Request *request,
+                                 UA_Response *response) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    sd->serviceCallback(server, session, request, response);
+    updateServiceStatistics(session, sd, response);
+}
+
+#endif
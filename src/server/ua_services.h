@@ -35,8 +35,19 @@ typedef struct {
     UA_Service serviceCallback;
     const UA_DataType *requestType;
     const UA_DataType *responseType;
+    UA_Boolean parallel; /* Read-only service that can be executed by the
+                          * service workers with a shared lock */
 } UA_ServiceDescription;
 
+/* The services are stored in a table that is directly indexed by the binary
+ * encoding NodeId of the request. The size is the smallest modulus without
+ * collisions between the request type identifiers. Adding a service can
+ * require a new table size. */
+#define UA_SERVICETABLE_SIZE 116
+#define UA_SERVICETABLE_INDEX(requestTypeId) ((requestTypeId) % UA_SERVICETABLE_SIZE)
+
+extern UA_ServiceDescription serviceDescriptions[UA_SERVICETABLE_SIZE];
+
 /* Returns NULL if none found */
 UA_ServiceDescription * getServiceDescription(UA_UInt32 requestTypeId);
 
@@ -142,11 +153,27 @@ void Service_Write(UA_Server *server, UA_Session *session,
                    const UA_WriteRequest *request,
                    UA_WriteResponse *response);
 
+#if UA_MULTITHREADING >= 100
+void Service_WriteAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                        const UA_WriteRequest *request, UA_WriteResponse *response,
+                        UA_Boolean *finished);
+#endif
+
 #ifdef UA_ENABLE_HISTORIZING
 void Service_HistoryRead(UA_Server *server, UA_Session *session,
                          const UA_HistoryReadRequest *request,
                          UA_HistoryReadResponse *response);
 
+/* Streams the response of a raw HistoryRead into the SecureChannel if the
+ * HistoryDatabase provides cursors (see openRawCursor). Returns false if the
+ * request cannot be streamed. Then the response is created with
+ * Service_HistoryRead. */
+UA_Boolean
+Service_HistoryReadStreaming(UA_Server *server, UA_Session *session,
+                             UA_SecureChannel *channel, UA_UInt32 requestId,
+                             const UA_HistoryReadRequest *request,
+                             UA_HistoryReadResponse *response);
+
 void Service_HistoryUpdate(UA_Server *server, UA_Session *session,
                            const UA_HistoryUpdateRequest *request,
                            UA_HistoryUpdateResponse *response);
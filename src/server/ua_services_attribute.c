@@ -78,13 +78,13 @@ getUserWriteMask(UA_Server *server, const UA_Session *session,
         return 0xFFFFFFFF; /* the local admin user has all rights */
     UA_UInt32 mask = head->writeMask;
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    UA_UNLOCK(&server->serviceMutex);
+    UA_UNLOCK_CALLBACK(&server->serviceMutex);
     mask &= server->config.accessControl.
         getUserRightsMask(server, &server->config.accessControl,
                           session ? &session->sessionId : NULL,
                           session ? session->context : NULL,
                           &head->nodeId, head->context);
-    UA_LOCK(&server->serviceMutex);
+    UA_LOCK_CALLBACK(&server->serviceMutex);
     return mask;
 }
 
@@ -103,13 +103,13 @@ getUserAccessLevel(UA_Server *server, const UA_Session *session,
         return 0xFF; /* the local admin user has all rights */
     UA_Byte retval = node->accessLevel;
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    UA_UNLOCK(&server->serviceMutex);
+    UA_UNLOCK_CALLBACK(&server->serviceMutex);
     retval &= server->config.accessControl.
         getUserAccessLevel(server, &server->config.accessControl,
                            session ? &session->sessionId : NULL,
                            session ? session->context : NULL,
                            &node->head.nodeId, node->head.context);
-    UA_LOCK(&server->serviceMutex);
+    UA_LOCK_CALLBACK(&server->serviceMutex);
     return retval;
 }
 
@@ -119,7 +119,7 @@ getUserExecutable(UA_Server *server, const UA_Session *session,
     if(session == &server->adminSession)
         return true; /* the local admin user has all rights */
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    UA_UNLOCK(&server->serviceMutex);
+    UA_UNLOCK_CALLBACK(&server->serviceMutex);
     UA_Boolean userExecutable = node->executable;
     userExecutable &=
         server->config.accessControl.
@@ -127,7 +127,7 @@ getUserExecutable(UA_Server *server, const UA_Session *session,
                           session ? &session->sessionId : NULL,
                           session ? session->context : NULL,
                           &node->head.nodeId, node->head.context);
-    UA_LOCK(&server->serviceMutex);
+    UA_LOCK_CALLBACK(&server->serviceMutex);
     return userExecutable;
 }
 
@@ -165,13 +165,13 @@ readValueAttributeFromNode(UA_Server *server, UA_Session *session,
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
     /* Update the value by the user callback */
     if(vn->value.data.callback.onRead) {
-        UA_UNLOCK(&server->serviceMutex);
+        UA_UNLOCK_CALLBACK(&server->serviceMutex);
         vn->value.data.callback.onRead(server,
                                        session ? &session->sessionId : NULL,
                                        session ? session->context : NULL,
                                        &vn->head.nodeId, vn->head.context, rangeptr,
                                        &vn->value.data.value);
-        UA_LOCK(&server->serviceMutex);
+        UA_LOCK_CALLBACK(&server->serviceMutex);
         vn = (const UA_VariableNode*)
             UA_NODESTORE_GET_SELECTIVE(server, &vn->head.nodeId,
                                        UA_NODEATTRIBUTESMASK_VALUE,
@@ -197,6 +197,18 @@ readValueAttributeFromNode(UA_Server *server, UA_Session *session,
     return retval;
 }
 
+/* Take over the value returned from a DataSource. Borrowed data is copied. */
+static UA_StatusCode
+takeDataSourceValue(UA_StatusCode retval, UA_DataValue *src, UA_DataValue *dst) {
+    if(src->hasValue && src->value.storageType == UA_VARIANT_DATA_NODELETE) {
+        retval = UA_DataValue_copy(src, dst);
+        UA_DataValue_clear(src);
+    } else {
+        *dst = *src;
+    }
+    return retval;
+}
+
 static UA_StatusCode
 readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
                                  const UA_VariableNode *vn, UA_DataValue *v,
@@ -209,21 +221,38 @@ readValueAttributeFromDataSource(UA_Server *server, UA_Session *session,
                                   timestamps == UA_TIMESTAMPSTORETURN_BOTH);
     UA_DataValue v2;
     UA_DataValue_init(&v2);
-    UA_UNLOCK(&server->serviceMutex);
+    UA_UNLOCK_CALLBACK(&server->serviceMutex);
     UA_StatusCode retval = vn->value.dataSource.
         read(server,
              session ? &session->sessionId : NULL,
              session ? session->context : NULL,
              &vn->head.nodeId, vn->head.context,
              sourceTimeStamp, rangeptr, &v2);
-    UA_LOCK(&server->serviceMutex);
-    if(v2.hasValue && v2.value.storageType == UA_VARIANT_DATA_NODELETE) {
-        retval = UA_DataValue_copy(&v2, v);
-        UA_DataValue_clear(&v2);
-    } else {
-        *v = v2;
-    }
-    return retval;
+    UA_LOCK_CALLBACK(&server->serviceMutex);
+    return takeDataSourceValue(retval, &v2, v);
+}
+
+static UA_StatusCode
+readValueAttributeFromDataSourceBatch(UA_Server *server, UA_Session *session,
+                                      const UA_VariableNode *vn, UA_DataValue *v,
+                                      UA_TimestampsToReturn timestamps,
+                                      UA_NumericRange *rangeptr) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    const UA_DataSourceBatch *ds = &vn->valueBackend.backend.dataSourceBatch;
+    if(!ds->read)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_Boolean sourceTimeStamp = (timestamps == UA_TIMESTAMPSTORETURN_SOURCE ||
+                                  timestamps == UA_TIMESTAMPSTORETURN_BOTH);
+    const UA_NumericRange *range = rangeptr;
+    UA_DataValue v2;
+    UA_DataValue_init(&v2);
+    UA_UNLOCK_CALLBACK(&server->serviceMutex);
+    UA_StatusCode retval =
+        ds->read(server, session ? &session->sessionId : NULL,
+                 session ? session->context : NULL, 1, &vn->head.nodeId,
+                 &vn->head.context, sourceTimeStamp, &range, &v2);
+    UA_LOCK_CALLBACK(&server->serviceMutex);
+    return takeDataSourceValue(retval, &v2, v);
 }
 
 static UA_StatusCode
@@ -273,6 +302,10 @@ readValueAttributeComplete(UA_Server *server, UA_Session *session,
             else
                 retval = UA_DataValue_copy(*vn->valueBackend.backend.external.value, v);
             break;
+        case UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH:
+            retval = readValueAttributeFromDataSourceBatch(server, session, vn, v,
+                                                           timestamps, rangeptr);
+            break;
         case UA_VALUEBACKENDTYPE_NONE:
             /* Read the value */
             if(vn->valueSource == UA_VALUESOURCE_DATA)
@@ -380,6 +413,64 @@ getStructureDefinition(const UA_DataType *type, UA_StructureDefinition *def) {
 }
 #endif
 
+/* Only Binary Encoding is supported */
+static UA_StatusCode
+checkReadDataEncoding(const UA_ReadValueId *id) {
+    if(id->dataEncoding.name.length == 0 ||
+       UA_String_equal(&binEncoding, &id->dataEncoding.name))
+        return UA_STATUSCODE_GOOD;
+    if(UA_String_equal(&xmlEncoding, &id->dataEncoding.name) ||
+       UA_String_equal(&jsonEncoding, &id->dataEncoding.name))
+        return UA_STATUSCODE_BADDATAENCODINGUNSUPPORTED;
+    return UA_STATUSCODE_BADDATAENCODINGINVALID;
+}
+
+/* The access to a value variable is granted via the AccessLevel and
+ * UserAccessLevel attributes */
+static UA_StatusCode
+checkReadValueAccess(UA_Server *server, UA_Session *session,
+                     const UA_VariableNode *vn) {
+    UA_Byte accessLevel = getAccessLevel(server, session, vn);
+    if(!(accessLevel & (UA_ACCESSLEVELMASK_READ)))
+        return UA_STATUSCODE_BADNOTREADABLE;
+    accessLevel = getUserAccessLevel(server, session, vn);
+    if(!(accessLevel & (UA_ACCESSLEVELMASK_READ)))
+        return UA_STATUSCODE_BADUSERACCESSDENIED;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Set the status and the timestamps of a read result */
+static void
+finishReadResult(UA_Server *server, UA_TimestampsToReturn timestampsToReturn,
+                 UA_StatusCode retval, UA_DataValue *v) {
+    /* Reading has failed? */
+    if(retval == UA_STATUSCODE_GOOD) {
+        v->hasValue = true;
+    } else {
+        v->hasStatus = true;
+        v->status = retval;
+    }
+
+    /* Always use the current time as the server-timestamp */
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        UA_EventLoop *el = server->config.eventLoop;
+        v->serverTimestamp = el->dateTime_now(el);
+        v->hasServerTimestamp = true;
+        v->hasServerPicoseconds = false;
+    } else {
+        v->hasServerTimestamp = false;
+        v->hasServerPicoseconds = false;
+    }
+
+    /* Don't "invent" source timestamps. But remove them when not required. */
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER) {
+        v->hasSourceTimestamp = false;
+        v->hasSourcePicoseconds = false;
+    }
+}
+
 /* Returns a datavalue that may point into the node via the
  * UA_VARIANT_DATA_NODELETE tag. Don't access the returned DataValue once the
  * node has been released! */
@@ -394,14 +485,10 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
                                              nodeIdStr.data));
 
     /* Only Binary Encoding is supported */
-    if(id->dataEncoding.name.length > 0 &&
-       !UA_String_equal(&binEncoding, &id->dataEncoding.name)) {
-        if(UA_String_equal(&xmlEncoding, &id->dataEncoding.name) ||
-           UA_String_equal(&jsonEncoding, &id->dataEncoding.name))
-           v->status = UA_STATUSCODE_BADDATAENCODINGUNSUPPORTED;
-        else
-           v->status = UA_STATUSCODE_BADDATAENCODINGINVALID;
+    UA_StatusCode retval = checkReadDataEncoding(id);
+    if(retval != UA_STATUSCODE_GOOD) {
         v->hasStatus = true;
+        v->status = retval;
         return;
     }
 
@@ -413,7 +500,6 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
     }
 
     /* Read the attribute */
-    UA_StatusCode retval = UA_STATUSCODE_GOOD;
     switch(id->attributeId) {
     case UA_ATTRIBUTEID_NODEID:
         retval = UA_Variant_setScalarCopy(&v->value, &node->head.nodeId,
@@ -486,18 +572,9 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
         /* VariableTypes don't have the AccessLevel concept. Always allow
          * reading the value. */
         if(node->head.nodeClass == UA_NODECLASS_VARIABLE) {
-            /* The access to a value variable is granted via the AccessLevel
-             * and UserAccessLevel attributes */
-            UA_Byte accessLevel = getAccessLevel(server, session, &node->variableNode);
-            if(!(accessLevel & (UA_ACCESSLEVELMASK_READ))) {
-                retval = UA_STATUSCODE_BADNOTREADABLE;
-                break;
-            }
-            accessLevel = getUserAccessLevel(server, session, &node->variableNode);
-            if(!(accessLevel & (UA_ACCESSLEVELMASK_READ))) {
-                retval = UA_STATUSCODE_BADUSERACCESSDENIED;
+            retval = checkReadValueAccess(server, session, &node->variableNode);
+            if(retval != UA_STATUSCODE_GOOD)
                 break;
-            }
         }
         retval = readValueAttributeComplete(server, session, &node->variableNode,
                                             timestampsToReturn, &id->indexRange, v);
@@ -601,32 +678,7 @@ ReadWithNode(const UA_Node *node, UA_Server *server, UA_Session *session,
         retval = UA_STATUSCODE_BADATTRIBUTEIDINVALID;
     }
 
-    /* Reading has failed? */
-    if(retval == UA_STATUSCODE_GOOD) {
-        v->hasValue = true;
-    } else {
-        v->hasStatus = true;
-        v->status = retval;
-    }
-
-    /* Always use the current time as the server-timestamp */
-    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
-       timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
-        UA_EventLoop *el = server->config.eventLoop;
-        v->serverTimestamp = el->dateTime_now(el);
-        v->hasServerTimestamp = true;
-        v->hasServerPicoseconds = false;
-    } else {
-        v->hasServerTimestamp = false;
-        v->hasServerPicoseconds = false;
-    }
-
-    /* Don't "invent" source timestamps. But remove them when not required. */
-    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
-       timestampsToReturn == UA_TIMESTAMPSTORETURN_NEITHER) {
-        v->hasSourceTimestamp = false;
-        v->hasSourcePicoseconds = false;
-    }
+    finishReadResult(server, timestampsToReturn, retval, v);
 }
 
 void
@@ -649,6 +701,112 @@ Operation_Read(UA_Server *server, UA_Session *session, UA_TimestampsToReturn *tt
     UA_NODESTORE_RELEASE(server, node);
 }
 
+/* A value read that is deferred to a call of a batched DataSource */
+typedef struct {
+    const UA_Node *node;
+    UA_Boolean releaseNode; /* Set for the last read of the node */
+    UA_Boolean hasRange;
+    UA_Boolean done;
+    UA_NumericRange range;
+    UA_DataValue *result;
+} BatchedRead;
+
+static UA_Boolean
+isBatchedRead(const UA_Node *node, const UA_ReadValueId *rvi) {
+    return (rvi->attributeId == UA_ATTRIBUTEID_VALUE &&
+            node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+            node->variableNode.valueBackend.backendType ==
+            UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH &&
+            node->variableNode.valueBackend.backend.dataSourceBatch.read &&
+            checkReadDataEncoding(rvi) == UA_STATUSCODE_GOOD);
+}
+
+/* Reading these attributes can call into user code without the server lock */
+static UA_Boolean
+readCallsOut(UA_AttributeId attributeId) {
+    return (attributeId == UA_ATTRIBUTEID_VALUE ||
+            attributeId == UA_ATTRIBUTEID_USERWRITEMASK ||
+            attributeId == UA_ATTRIBUTEID_USERACCESSLEVEL ||
+            attributeId == UA_ATTRIBUTEID_USEREXECUTABLE);
+}
+
+/* Call every batched DataSource once with all of its reads */
+static void
+readBatched(UA_Server *server, UA_Session *session, UA_TimestampsToReturn ttr,
+            BatchedRead *batch, size_t batchSize) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_Boolean sourceTimeStamp = (ttr == UA_TIMESTAMPSTORETURN_SOURCE ||
+                                  ttr == UA_TIMESTAMPSTORETURN_BOTH);
+
+    /* Allocate the arguments for the callbacks */
+    UA_DataValue *values = (UA_DataValue*)
+        UA_malloc(batchSize * (sizeof(UA_DataValue) + sizeof(UA_NodeId) +
+                               sizeof(void*) + sizeof(UA_NumericRange*) +
+                               sizeof(size_t)));
+    if(!values) {
+        for(size_t i = 0; i < batchSize; i++)
+            finishReadResult(server, ttr, UA_STATUSCODE_BADOUTOFMEMORY,
+                             batch[i].result);
+        goto cleanup;
+    }
+    UA_NodeId *nodeIds = (UA_NodeId*)&values[batchSize];
+    void **contexts = (void**)&nodeIds[batchSize];
+    const UA_NumericRange **ranges = (const UA_NumericRange**)&contexts[batchSize];
+    size_t *index = (size_t*)&ranges[batchSize];
+
+    for(size_t i = 0; i < batchSize; i++) {
+        if(batch[i].done)
+            continue;
+
+        /* Collect the reads with the same callback */
+        const UA_DataSourceBatch *ds =
+            &batch[i].node->variableNode.valueBackend.backend.dataSourceBatch;
+        size_t n = 0;
+        for(size_t j = i; j < batchSize; j++) {
+            const UA_Node *node = batch[j].node;
+            if(batch[j].done ||
+               node->variableNode.valueBackend.backend.dataSourceBatch.read != ds->read)
+                continue;
+            nodeIds[n] = node->head.nodeId; /* Shallow copy */
+            contexts[n] = node->head.context;
+            ranges[n] = (batch[j].hasRange) ? &batch[j].range : NULL;
+            UA_DataValue_init(&values[n]);
+            index[n] = j;
+            batch[j].done = true;
+            n++;
+        }
+
+        /* Read all values in one call */
+        UA_UNLOCK_CALLBACK(&server->serviceMutex);
+        UA_StatusCode retval =
+            ds->read(server, session ? &session->sessionId : NULL,
+                     session ? session->context : NULL, n, nodeIds, contexts,
+                     sourceTimeStamp, ranges, values);
+        UA_LOCK_CALLBACK(&server->serviceMutex);
+
+        /* Set the results */
+        for(size_t k = 0; k < n; k++) {
+            UA_DataValue *dv = batch[index[k]].result;
+            UA_StatusCode res = takeDataSourceValue(retval, &values[k], dv);
+            if(!dv->hasSourceTimestamp) {
+                dv->sourceTimestamp = el->dateTime_now(el);
+                dv->hasSourceTimestamp = true;
+            }
+            finishReadResult(server, ttr, res, dv);
+        }
+    }
+    UA_free(values);
+
+ cleanup:
+    for(size_t i = 0; i < batchSize; i++) {
+        if(batch[i].hasRange)
+            UA_free(batch[i].range.dimensions);
+        if(batch[i].releaseNode)
+            UA_NODESTORE_RELEASE(server, batch[i].node);
+    }
+}
+
 void
 Service_Read(UA_Server *server, UA_Session *session,
              const UA_ReadRequest *request, UA_ReadResponse *response) {
@@ -674,16 +832,98 @@ Service_Read(UA_Server *server, UA_Session *session,
         return;
     }
 
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    /* Allocate the results */
+    size_t ops = request->nodesToReadSize;
+    if(ops == 0) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
+        return;
+    }
+    response->results = (UA_DataValue*)
+        UA_Array_new(ops, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(!response->results) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADOUTOFMEMORY;
+        return;
+    }
+    response->resultsSize = ops;
+
+    /* Process the operations in runs on the same node. The node is taken
+     * from the Nodestore once for the run. */
+    UA_TimestampsToReturn ttr = request->timestampsToReturn;
+    const UA_ReadValueId *rvi = request->nodesToRead;
+    BatchedRead *batch = NULL;
+    size_t batchSize = 0;
+    size_t end;
+    for(size_t i = 0; i < ops; i = end) {
+        UA_UInt32 mask = attributeId2AttributeMask((UA_AttributeId)rvi[i].attributeId);
+        for(end = i + 1; end < ops; end++) {
+            if(!UA_NodeId_equal(&rvi[end].nodeId, &rvi[i].nodeId))
+                break;
+            mask |= attributeId2AttributeMask((UA_AttributeId)rvi[end].attributeId);
+        }
+
+        const UA_Node *node = NULL;
+        UA_Boolean deferred = false;
+        for(size_t j = i; j < end; j++) {
+            /* Get the node with the attributes of the entire run. User code
+             * (DataSources, AccessControl) runs without the server lock and
+             * can modify the node. Then the node is taken again. */
+            if(!node) {
+                node = UA_NODESTORE_GET_SELECTIVE(server, &rvi[i].nodeId, mask,
+                                                  UA_REFERENCETYPESET_NONE,
+                                                  UA_BROWSEDIRECTION_INVALID);
+                deferred = false;
+                if(!node) {
+                    for(; j < end; j++) {
+                        response->results[j].hasStatus = true;
+                        response->results[j].status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+                    }
+                    break;
+                }
+            }
 
-    response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session,
-                                           (UA_ServiceOperation)Operation_Read,
-                                           &request->timestampsToReturn,
-                                           &request->nodesToReadSize,
-                                           &UA_TYPES[UA_TYPES_READVALUEID],
-                                           &response->resultsSize,
-                                           &UA_TYPES[UA_TYPES_DATAVALUE]);
+            UA_DataValue *dv = &response->results[j];
+            if(!isBatchedRead(node, &rvi[j])) {
+                ReadWithNode(node, server, session, ttr, &rvi[j], dv);
+            } else {
+                /* Check the access rights and the index range now. The values
+                 * are read in the batches at the end. */
+                UA_StatusCode res = checkReadValueAccess(server, session,
+                                                         &node->variableNode);
+                if(res == UA_STATUSCODE_GOOD && !batch) {
+                    batch = (BatchedRead*)UA_calloc(ops - j, sizeof(BatchedRead));
+                    if(!batch)
+                        res = UA_STATUSCODE_BADOUTOFMEMORY;
+                }
+                if(res == UA_STATUSCODE_GOOD && rvi[j].indexRange.length > 0) {
+                    res = UA_NumericRange_parse(&batch[batchSize].range,
+                                                rvi[j].indexRange);
+                    batch[batchSize].hasRange = (res == UA_STATUSCODE_GOOD);
+                }
+                if(res == UA_STATUSCODE_GOOD) {
+                    batch[batchSize].node = node;
+                    batch[batchSize].result = dv;
+                    batchSize++;
+                    deferred = true;
+                } else {
+                    finishReadResult(server, ttr, res, dv);
+                }
+            }
+
+            /* Release the node. Keep it until the batched read has finished
+             * if required. */
+            if(j + 1 == end || readCallsOut((UA_AttributeId)rvi[j].attributeId)) {
+                if(deferred)
+                    batch[batchSize - 1].releaseNode = true;
+                else
+                    UA_NODESTORE_RELEASE(server, node);
+                node = NULL;
+            }
+        }
+    }
+
+    if(batchSize > 0)
+        readBatched(server, session, ttr, batch, batchSize);
+    UA_free(batch);
 }
 
 UA_DataValue
@@ -698,6 +938,58 @@ readWithSession(UA_Server *server, UA_Session *session,
     return dv;
 }
 
+/* The read result is fully determined by the version of the internal value.
+ * The access rights are checked every time. They are not part of the value
+ * version and might depend on the session. */
+static UA_UInt64
+getValueVersion(UA_Server *server, UA_Session *session,
+                const UA_Node *node, const UA_ReadValueId *item) {
+    if(item->attributeId != UA_ATTRIBUTEID_VALUE ||
+       node->head.nodeClass != UA_NODECLASS_VARIABLE)
+        return 0;
+    const UA_VariableNode *vn = &node->variableNode;
+    if(vn->valueBackend.backendType != UA_VALUEBACKENDTYPE_NONE ||
+       vn->valueSource != UA_VALUESOURCE_DATA ||
+       vn->value.data.callback.onRead)
+        return 0;
+    if(!(getAccessLevel(server, session, vn) & UA_ACCESSLEVELMASK_READ) ||
+       !(getUserAccessLevel(server, session, vn) & UA_ACCESSLEVELMASK_READ))
+        return 0;
+    return vn->valueVersion;
+}
+
+UA_Boolean
+readWithSessionIfChanged(UA_Server *server, UA_Session *session,
+                         const UA_ReadValueId *item,
+                         UA_TimestampsToReturn timestampsToReturn,
+                         UA_UInt64 *version, UA_DataValue *dv) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    const UA_Node *node =
+        UA_NODESTORE_GET_SELECTIVE(server, &item->nodeId,
+                                   attributeId2AttributeMask((UA_AttributeId)item->attributeId),
+                                   UA_REFERENCETYPESET_NONE,
+                                   UA_BROWSEDIRECTION_INVALID);
+    if(!node) {
+        *version = 0;
+        dv->hasStatus = true;
+        dv->status = UA_STATUSCODE_BADNODEIDUNKNOWN;
+        return true;
+    }
+
+    /* Unchanged since the last read */
+    UA_UInt64 current = getValueVersion(server, session, node, item);
+    if(current != 0 && current == *version) {
+        UA_NODESTORE_RELEASE(server, node);
+        return false;
+    }
+
+    *version = current;
+    ReadWithNode(node, server, session, timestampsToReturn, item, dv);
+    UA_NODESTORE_RELEASE(server, node);
+    return true;
+}
+
 UA_StatusCode
 readWithReadValue(UA_Server *server, const UA_NodeId *nodeId,
                   const UA_AttributeId attributeId, void *v) {
@@ -1136,9 +1428,12 @@ unwrapEOArray(UA_Server *server, UA_Variant *value) {
         pos += innerType->memSize;
     }
 
-    /* Adjust the value */
+    /* Adjust the value. The unwrapped array is no longer part of a shared
+     * buffer. */
     value->type = innerType;
     value->data = unwrappedArray;
+    if(value->storageType == UA_VARIANT_DATA_SHARED)
+        value->storageType = UA_VARIANT_DATA_NODELETE;
 
     /* Add the delayed callback to free the memory of the unwrapped array */
     dc->callback = freeWrapperArray;
@@ -1178,6 +1473,8 @@ adjustValueType(UA_Server *server, UA_Variant *value,
         value->type = &UA_TYPES[UA_TYPES_BYTE];
         value->arrayLength = str->length;
         value->data = str->data;
+        if(value->storageType == UA_VARIANT_DATA_SHARED)
+            value->storageType = UA_VARIANT_DATA_NODELETE;
         return;
     }
 
@@ -1405,40 +1702,40 @@ writeValueAttributeWithRange(UA_VariableNode *node, const UA_DataValue *value,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Parse the range and check the type of the written value. The adjusted value
+ * is a shallow copy of the value with a possibly corrected type. The range
+ * dimensions are NULL if no range is given. */
 static UA_StatusCode
-writeNodeValueAttribute(UA_Server *server, UA_Session *session,
-                        UA_VariableNode *node, const UA_DataValue *value,
-                        const UA_String *indexRange) {
-    UA_assert(node != NULL);
-    UA_assert(session != NULL);
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
-
+prepareValueWrite(UA_Server *server, UA_Session *session,
+                  const UA_VariableNode *node, const UA_DataValue *value,
+                  const UA_String *indexRange, UA_NumericRange *range,
+                  UA_DataValue *adjustedValue) {
     /* Parse the range */
-    UA_NumericRange range;
-    range.dimensions = NULL;
+    range->dimensions = NULL;
+    range->dimensionsSize = 0;
     UA_NumericRange *rangeptr = NULL;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
     if(indexRange && indexRange->length > 0) {
-        retval = UA_NumericRange_parse(&range, *indexRange);
+        retval = UA_NumericRange_parse(range, *indexRange);
         if(retval != UA_STATUSCODE_GOOD)
             return retval;
-        rangeptr = &range;
+        rangeptr = range;
     }
 
     /* Created an editable version. The data is not touched. Only the variant
      * "container". */
-    UA_DataValue adjustedValue = *value;
+    *adjustedValue = *value;
 
     /* Type checking. May change the type of adjustedValue */
     const char *reason;
     if(value->hasValue && value->value.type) {
         /* Try to correct the type */
-        adjustValueType(server, &adjustedValue.value, &node->dataType);
+        adjustValueType(server, &adjustedValue->value, &node->dataType);
 
         /* Check the type */
         if(!compatibleValue(server, session, &node->dataType, node->valueRank,
                             node->arrayDimensionsSize, node->arrayDimensions,
-                            &adjustedValue.value, rangeptr, &reason)) {
+                            &adjustedValue->value, rangeptr, &reason)) {
             UA_LOG_NODEID_WARNING(&node->head.nodeId,
             if(session == &server->adminSession) {
                 /* If the value is written via the local API, log a warning */
@@ -1453,8 +1750,8 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
                                      "following reason: %s",
                                      (int)nodeIdStr.length, nodeIdStr.data, reason);
             });
-            if(rangeptr && rangeptr->dimensions != NULL)
-                UA_free(rangeptr->dimensions);
+            UA_free(range->dimensions);
+            range->dimensions = NULL;
             return UA_STATUSCODE_BADTYPEMISMATCH;
         }
     }
@@ -1462,9 +1759,74 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
     /* If no source timestamp is defined create one here.
      * It should be created as close to the source as possible. */
     if(node->head.nodeClass == UA_NODECLASS_VARIABLE && !node->isDynamic) {
-        adjustedValue.hasSourceTimestamp = false;
-        adjustedValue.hasSourcePicoseconds = false;
+        adjustedValue->hasSourceTimestamp = false;
+        adjustedValue->hasSourcePicoseconds = false;
     }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Call the batched write of a DataSource. Returns
+ * UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY if the results are submitted
+ * later. Otherwise the results are set. */
+static UA_StatusCode
+writeDataSourceBatch(UA_Server *server, UA_Session *session,
+                     const UA_DataSourceBatch *ds, size_t nodesSize,
+                     const UA_NodeId *nodeIds, void * const *nodeContexts,
+                     const UA_NumericRange * const *ranges,
+                     const UA_DataValue *values, void *asyncContext,
+                     UA_StatusCode *results) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    for(size_t i = 0; i < nodesSize; i++)
+        results[i] = UA_STATUSCODE_GOOD;
+    UA_UNLOCK(&server->serviceMutex);
+    UA_StatusCode res =
+        ds->write(server, &session->sessionId, session->context, nodesSize,
+                  nodeIds, nodeContexts, ranges, values, asyncContext, results);
+    UA_LOCK(&server->serviceMutex);
+    if(res == UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY) {
+        if(asyncContext)
+            return res;
+        res = UA_STATUSCODE_BADINTERNALERROR; /* Cannot complete async */
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < nodesSize; i++)
+            results[i] = res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+static void
+historizeWrittenValue(UA_Server *server, UA_Session *session,
+                      const UA_VariableNode *node, const UA_DataValue *value) {
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE ||
+       !server->config.historyDatabase.setValue)
+        return;
+    UA_UNLOCK(&server->serviceMutex);
+    server->config.historyDatabase.
+        setValue(server, server->config.historyDatabase.context,
+                 &session->sessionId, session->context,
+                 &node->head.nodeId, node->historizing, value);
+    UA_LOCK(&server->serviceMutex);
+}
+#endif
+
+static UA_StatusCode
+writeNodeValueAttribute(UA_Server *server, UA_Session *session,
+                        UA_VariableNode *node, const UA_DataValue *value,
+                        const UA_String *indexRange) {
+    UA_assert(node != NULL);
+    UA_assert(session != NULL);
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    /* Parse the range and check the type */
+    UA_NumericRange range;
+    UA_DataValue adjustedValue;
+    UA_StatusCode retval = prepareValueWrite(server, session, node, value,
+                                             indexRange, &range, &adjustedValue);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    UA_NumericRange *rangeptr = (range.dimensions) ? &range : NULL;
 
     /* Call into the different value storage backends.
      *
@@ -1480,6 +1842,10 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
             else
                 retval = writeValueAttributeWithRange(node, &adjustedValue, rangeptr);
 
+            /* Set a new version for the change detection */
+            if(retval == UA_STATUSCODE_GOOD)
+                node->valueVersion = ++server->lastValueVersion;
+
             /* Callback after writing */
             if(retval == UA_STATUSCODE_GOOD &&
                node->value.data.callback.onWrite) {
@@ -1510,6 +1876,16 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
         }
         break;
 
+    case UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH:
+        if(node->valueBackend.backend.dataSourceBatch.write) {
+            const UA_NumericRange *batchRange = rangeptr;
+            writeDataSourceBatch(server, session,
+                                 &node->valueBackend.backend.dataSourceBatch,
+                                 1, &node->head.nodeId, &node->head.context,
+                                 &batchRange, &adjustedValue, NULL, &retval);
+        }
+        break;
+
     case UA_VALUEBACKENDTYPE_INTERNAL:
     case UA_VALUEBACKENDTYPE_DATA_SOURCE_CALLBACK:
     default:
@@ -1519,16 +1895,8 @@ writeNodeValueAttribute(UA_Server *server, UA_Session *session,
     /* Write into the historical data backend. Not that the historical data
      * backend can be configured to "poll" data like a MonitoredItem also. */
 #ifdef UA_ENABLE_HISTORIZING
-    if(retval == UA_STATUSCODE_GOOD &&
-       node->head.nodeClass == UA_NODECLASS_VARIABLE &&
-       server->config.historyDatabase.setValue) {
-        UA_UNLOCK(&server->serviceMutex);
-        server->config.historyDatabase.
-            setValue(server, server->config.historyDatabase.context,
-                     &session->sessionId, session->context,
-                     &node->head.nodeId, node->historizing, &adjustedValue);
-        UA_LOCK(&server->serviceMutex);
-    }
+    if(retval == UA_STATUSCODE_GOOD)
+        historizeWrittenValue(server, session, node, &adjustedValue);
 #endif
 
     /* Clean up */
@@ -1630,6 +1998,20 @@ triggerImmediateDataChange(UA_Server *server, UA_Session *session,
 }
 #endif
 
+/* The access to a value variable is granted via the AccessLevel and
+ * UserAccessLevel attributes */
+static UA_StatusCode
+checkWriteValueAccess(UA_Server *server, UA_Session *session,
+                      const UA_VariableNode *node) {
+    UA_Byte accessLevel = getAccessLevel(server, session, node);
+    if(!(accessLevel & (UA_ACCESSLEVELMASK_WRITE)))
+        return UA_STATUSCODE_BADNOTWRITABLE;
+    accessLevel = getUserAccessLevel(server, session, node);
+    if(!(accessLevel & (UA_ACCESSLEVELMASK_WRITE)))
+        return UA_STATUSCODE_BADUSERACCESSDENIED;
+    return UA_STATUSCODE_GOOD;
+}
+
 /* This function implements the main part of the write service and operates on a
    copy of the node (not in single-threaded mode). */
 static UA_StatusCode
@@ -1712,18 +2094,9 @@ copyAttributeIntoNode(UA_Server *server, UA_Session *session,
     case UA_ATTRIBUTEID_VALUE:
         CHECK_NODECLASS_WRITE(UA_NODECLASS_VARIABLE | UA_NODECLASS_VARIABLETYPE);
         if(node->head.nodeClass == UA_NODECLASS_VARIABLE) {
-            /* The access to a value variable is granted via the AccessLevel
-             * and UserAccessLevel attributes */
-            UA_Byte accessLevel = getAccessLevel(server, session, &node->variableNode);
-            if(!(accessLevel & (UA_ACCESSLEVELMASK_WRITE))) {
-                retval = UA_STATUSCODE_BADNOTWRITABLE;
-                break;
-            }
-            accessLevel = getUserAccessLevel(server, session, &node->variableNode);
-            if(!(accessLevel & (UA_ACCESSLEVELMASK_WRITE))) {
-                retval = UA_STATUSCODE_BADUSERACCESSDENIED;
+            retval = checkWriteValueAccess(server, session, &node->variableNode);
+            if(retval != UA_STATUSCODE_GOOD)
                 break;
-            }
         } else { /* UA_NODECLASS_VARIABLETYPE */
             CHECK_USERWRITEMASK(UA_WRITEMASK_VALUEFORVARIABLETYPE);
         }
@@ -1818,6 +2191,218 @@ Operation_Write(UA_Server *server, UA_Session *session, void *context,
                                  (void*)(uintptr_t)wv);
 }
 
+/* A value write that is deferred to a call of a batched DataSource */
+typedef struct {
+    const UA_Node *node;
+    size_t index;          /* Index of the operation in the request */
+    UA_Boolean done;
+    UA_NumericRange range; /* The dimensions are NULL without a range */
+    UA_DataValue value;    /* Shallow copy with the adjusted type */
+} BatchedWrite;
+
+static UA_Boolean
+isBatchedWrite(const UA_Node *node) {
+    return (node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+            node->variableNode.valueBackend.backendType ==
+            UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH &&
+            node->variableNode.valueBackend.backend.dataSourceBatch.write);
+}
+
+/* Call every batched DataSource once with all of its writes. The DataSource
+ * can complete the writes asynchronously if ar is non-NULL. Then the
+ * AsyncResponse is created when it is first needed. The response (with the
+ * results array) is moved into the AsyncResponse right away. The results of
+ * earlier batches can be integrated while the lock is released for the later
+ * batches. */
+static void
+writeBatched(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+             UA_UInt32 requestHandle, const UA_WriteValue *wv,
+             BatchedWrite *batch, size_t batchSize, UA_WriteResponse *response,
+             UA_AsyncResponse **ar) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    UA_StatusCode *results = response->results; /* Not changed by the move */
+
+    /* Allocate the arguments for the callbacks */
+    UA_DataValue *values = (UA_DataValue*)
+        UA_malloc(batchSize * (sizeof(UA_DataValue) + sizeof(UA_NodeId) +
+                               sizeof(void*) + sizeof(UA_NumericRange*) +
+                               2 * sizeof(size_t) + sizeof(UA_StatusCode)));
+    if(!values) {
+        for(size_t i = 0; i < batchSize; i++)
+            results[batch[i].index] = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto cleanup;
+    }
+    UA_NodeId *nodeIds = (UA_NodeId*)&values[batchSize];
+    void **contexts = (void**)&nodeIds[batchSize];
+    const UA_NumericRange **ranges = (const UA_NumericRange**)&contexts[batchSize];
+    size_t *pos = (size_t*)&ranges[batchSize]; /* Position in the batch */
+    size_t *opIndex = &pos[batchSize];         /* Index in the request */
+    UA_StatusCode *opResults = (UA_StatusCode*)&opIndex[batchSize];
+
+    for(size_t i = 0; i < batchSize; i++) {
+        if(batch[i].done)
+            continue;
+
+        /* Collect the writes with the same callback */
+        const UA_DataSourceBatch *ds =
+            &batch[i].node->variableNode.valueBackend.backend.dataSourceBatch;
+        size_t n = 0;
+        for(size_t j = i; j < batchSize; j++) {
+            const UA_Node *node = batch[j].node;
+            if(batch[j].done ||
+               node->variableNode.valueBackend.backend.dataSourceBatch.write != ds->write)
+                continue;
+            nodeIds[n] = node->head.nodeId; /* Shallow copy */
+            contexts[n] = node->head.context;
+            ranges[n] = (batch[j].range.dimensions) ? &batch[j].range : NULL;
+            values[n] = batch[j].value; /* Shallow copy */
+            pos[n] = j;
+            opIndex[n] = batch[j].index;
+            batch[j].done = true;
+            n++;
+        }
+
+        /* Create the operation for the asynchronous completion. The writes
+         * complete synchronously if that fails. */
+        void *asyncContext = NULL;
+#if UA_MULTITHREADING >= 100
+        UA_AsyncOperation *ao = NULL;
+        if(ar) {
+            UA_StatusCode res = UA_STATUSCODE_GOOD;
+            if(!*ar) {
+                res = UA_AsyncManager_createAsyncResponse(&server->asyncManager, server,
+                                                          &session->sessionId, requestId,
+                                                          requestHandle,
+                                                          UA_ASYNCOPERATIONTYPE_WRITE, ar);
+                if(res == UA_STATUSCODE_GOOD) {
+                    (*ar)->inService = true;
+                    (*ar)->response.writeResponse = *response;
+                    UA_WriteResponse_init(response);
+                }
+            }
+            if(res == UA_STATUSCODE_GOOD)
+                UA_AsyncManager_createAsyncWriteOp(&server->asyncManager, server,
+                                                   *ar, n, opIndex, &ao);
+            asyncContext = ao;
+        }
+#endif
+
+        /* Write all values in one call */
+        UA_StatusCode retval =
+            writeDataSourceBatch(server, session, ds, n, nodeIds, contexts,
+                                 ranges, values, asyncContext, opResults);
+        if(retval == UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY)
+            continue; /* Integrated by the AsyncManager */
+#if UA_MULTITHREADING >= 100
+        /* The results were submitted despite the synchronous return. They are
+         * integrated by the AsyncManager as well. */
+        if(ao && !UA_AsyncManager_removeAsyncWriteOp(&server->asyncManager, ao))
+            continue;
+#endif
+
+        /* Set the results */
+        for(size_t k = 0; k < n; k++) {
+            results[opIndex[k]] = opResults[k];
+            if(opResults[k] != UA_STATUSCODE_GOOD)
+                continue;
+            BatchedWrite *bw = &batch[pos[k]];
+#ifdef UA_ENABLE_HISTORIZING
+            historizeWrittenValue(server, session, &bw->node->variableNode, &bw->value);
+#endif
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+            triggerImmediateDataChange(server, session, (UA_Node*)(uintptr_t)bw->node,
+                                       &wv[bw->index]);
+#endif
+        }
+    }
+    UA_free(values);
+
+ cleanup:
+    for(size_t i = 0; i < batchSize; i++) {
+        UA_free(batch[i].range.dimensions);
+        UA_NODESTORE_RELEASE(server, batch[i].node);
+    }
+}
+
+static void
+writeWithBatches(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                 const UA_WriteRequest *request, UA_WriteResponse *response,
+                 UA_AsyncResponse **ar) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    if(server->config.maxNodesPerWrite != 0 &&
+       request->nodesToWriteSize > server->config.maxNodesPerWrite) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
+        return;
+    }
+
+    /* Allocate the results */
+    size_t ops = request->nodesToWriteSize;
+    if(ops == 0) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADNOTHINGTODO;
+        return;
+    }
+    response->results = (UA_StatusCode*)
+        UA_Array_new(ops, &UA_TYPES[UA_TYPES_STATUSCODE]);
+    if(!response->results) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADOUTOFMEMORY;
+        return;
+    }
+    response->resultsSize = ops;
+
+    /* Value writes into a batched DataSource are checked right away and
+     * forwarded in batches at the end. All other writes are done in order. */
+    const UA_WriteValue *wv = request->nodesToWrite;
+    BatchedWrite *batch = NULL;
+    size_t batchSize = 0;
+    for(size_t i = 0; i < ops; i++) {
+        const UA_Node *node = NULL;
+        if(wv[i].attributeId == UA_ATTRIBUTEID_VALUE)
+            node = UA_NODESTORE_GET_SELECTIVE(server, &wv[i].nodeId,
+                                              UA_NODEATTRIBUTESMASK_NODECLASS |
+                                              UA_NODEATTRIBUTESMASK_VALUE |
+                                              UA_NODEATTRIBUTESMASK_DATATYPE |
+                                              UA_NODEATTRIBUTESMASK_VALUERANK |
+                                              UA_NODEATTRIBUTESMASK_ARRAYDIMENSIONS |
+                                              UA_NODEATTRIBUTESMASK_ACCESSLEVEL,
+                                              UA_REFERENCETYPESET_NONE,
+                                              UA_BROWSEDIRECTION_INVALID);
+        if(!node || !isBatchedWrite(node)) {
+            if(node)
+                UA_NODESTORE_RELEASE(server, node);
+            Operation_Write(server, session, NULL, &wv[i], &response->results[i]);
+            continue;
+        }
+
+        /* Check the access rights, the index range and the type now */
+        UA_StatusCode res = UA_STATUSCODE_GOOD;
+        if(!batch) {
+            batch = (BatchedWrite*)UA_calloc(ops - i, sizeof(BatchedWrite));
+            if(!batch)
+                res = UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        if(res == UA_STATUSCODE_GOOD)
+            res = checkWriteValueAccess(server, session, &node->variableNode);
+        if(res == UA_STATUSCODE_GOOD)
+            res = prepareValueWrite(server, session, &node->variableNode,
+                                    &wv[i].value, &wv[i].indexRange,
+                                    &batch[batchSize].range, &batch[batchSize].value);
+        if(res != UA_STATUSCODE_GOOD) {
+            response->results[i] = res;
+            UA_NODESTORE_RELEASE(server, node);
+            continue;
+        }
+        batch[batchSize].node = node;
+        batch[batchSize].index = i;
+        batchSize++;
+    }
+
+    if(batchSize > 0)
+        writeBatched(server, session, requestId, request->requestHeader.requestHandle,
+                     wv, batch, batchSize, response, ar);
+    UA_free(batch);
+}
+
 void
 Service_Write(UA_Server *server, UA_Session *session,
               const UA_WriteRequest *request,
@@ -1825,22 +2410,36 @@ Service_Write(UA_Server *server, UA_Session *session,
     UA_assert(session != NULL);
     UA_LOG_DEBUG_SESSION(server->config.logging, session,
                          "Processing WriteRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    writeWithBatches(server, session, 0, request, response, NULL);
+}
 
-    if(server->config.maxNodesPerWrite != 0 &&
-       request->nodesToWriteSize > server->config.maxNodesPerWrite) {
-        response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
+#if UA_MULTITHREADING >= 100
+void
+Service_WriteAsync(UA_Server *server, UA_Session *session, UA_UInt32 requestId,
+                   const UA_WriteRequest *request, UA_WriteResponse *response,
+                   UA_Boolean *finished) {
+    UA_assert(session != NULL);
+    UA_LOG_DEBUG_SESSION(server->config.logging, session,
+                         "Processing WriteRequestAsync");
+    UA_AsyncResponse *ar = NULL;
+    writeWithBatches(server, session, requestId, request, response, &ar);
+    if(!ar)
+        return;
+
+    /* The results are already in the AsyncResponse. The results of the
+     * batched writes are set when the DataSources complete them. */
+    ar->inService = false;
+    if(ar->opCountdown > 0) {
+        *finished = false;
         return;
     }
 
-    response->responseHeader.serviceResult =
-        UA_Server_processServiceOperations(server, session,
-                                           (UA_ServiceOperation)Operation_Write, NULL,
-                                           &request->nodesToWriteSize,
-                                           &UA_TYPES[UA_TYPES_WRITEVALUE],
-                                           &response->resultsSize,
-                                           &UA_TYPES[UA_TYPES_STATUSCODE]);
+    /* All batched writes have completed before the service returned */
+    *response = ar->response.writeResponse;
+    UA_WriteResponse_init(&ar->response.writeResponse);
+    UA_AsyncManager_removeAsyncResponse(&server->asyncManager, ar);
 }
+#endif
 
 UA_StatusCode
 UA_Server_write(UA_Server *server, const UA_WriteValue *value) {
@@ -2003,6 +2602,148 @@ Service_HistoryRead(UA_Server *server, UA_Session *session,
     UA_free(historyData);
 }
 
+typedef struct {
+    UA_StatusCode status;
+    UA_Int32 bodyLength; /* Of the HistoryData in the ExtensionObject */
+    UA_HistoryDataCursor cursor; /* Open if the status is good */
+} HistoryReadStream;
+
+static UA_StatusCode
+encodeHistoryReadResult(UA_MessageContext *mc, HistoryReadStream *hrs) {
+    /* StatusCode and (no) continuation point */
+    UA_StatusCode res =
+        UA_MessageContext_encode(mc, &hrs->status, &UA_TYPES[UA_TYPES_STATUSCODE]);
+    UA_CHECK_STATUS(res, return res);
+    UA_ByteString nullCP = UA_BYTESTRING_NULL;
+    res = UA_MessageContext_encode(mc, &nullCP, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    UA_CHECK_STATUS(res, return res);
+
+    /* ExtensionObject header for the HistoryData */
+    const UA_Byte encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+    res = UA_MessageContext_encode(mc, &UA_TYPES[UA_TYPES_HISTORYDATA].binaryEncodingId,
+                                   &UA_TYPES[UA_TYPES_NODEID]);
+    UA_CHECK_STATUS(res, return res);
+    res = UA_MessageContext_encode(mc, &encoding, &UA_TYPES[UA_TYPES_BYTE]);
+    UA_CHECK_STATUS(res, return res);
+    res = UA_MessageContext_encode(mc, &hrs->bodyLength, &UA_TYPES[UA_TYPES_INT32]);
+    UA_CHECK_STATUS(res, return res);
+
+    /* The DataValue array. The array is not allocated if the status is bad. */
+    UA_Int32 size = -1;
+    if(hrs->status == UA_STATUSCODE_GOOD)
+        size = (UA_Int32)hrs->cursor.size;
+    res = UA_MessageContext_encode(mc, &size, &UA_TYPES[UA_TYPES_INT32]);
+    for(UA_Int32 i = 0; i < size && res == UA_STATUSCODE_GOOD; i++) {
+        const UA_DataValue *dv = hrs->cursor.getValue(&hrs->cursor, (size_t)i);
+        res = UA_MessageContext_encode(mc, dv, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    }
+    return res;
+}
+
+UA_Boolean
+Service_HistoryReadStreaming(UA_Server *server, UA_Session *session,
+                             UA_SecureChannel *channel, UA_UInt32 requestId,
+                             const UA_HistoryReadRequest *request,
+                             UA_HistoryReadResponse *response) {
+    UA_assert(session != NULL);
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
+
+    /* Only raw reads without continuation points to release. Everything else
+     * (including the error cases) is left to the regular service. */
+    UA_HistoryDatabase *hdb = &server->config.historyDatabase;
+    if(!hdb->context || !hdb->openRawCursor || request->releaseContinuationPoints ||
+       request->nodesToReadSize == 0 ||
+       request->nodesToReadSize > UA_INT32_MAX ||
+       (server->config.maxNodesPerRead != 0 &&
+        request->nodesToReadSize > server->config.maxNodesPerRead))
+        return false;
+    if(request->historyReadDetails.encoding != UA_EXTENSIONOBJECT_DECODED ||
+       request->historyReadDetails.content.decoded.type !=
+       &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS])
+        return false;
+    const UA_ReadRawModifiedDetails *details = (const UA_ReadRawModifiedDetails*)
+        request->historyReadDetails.content.decoded.data;
+    if(details->isReadModified)
+        return false;
+
+    HistoryReadStream *streams = (HistoryReadStream*)
+        UA_calloc(request->nodesToReadSize, sizeof(HistoryReadStream));
+    if(!streams)
+        return false;
+
+    /* Open the cursors. The HistoryDatabase is called without the lock. */
+    UA_Boolean streamable = true;
+    size_t opened = 0;
+    UA_UNLOCK(&server->serviceMutex);
+    for(; opened < request->nodesToReadSize; opened++) {
+        HistoryReadStream *hrs = &streams[opened];
+        hrs->status = hdb->openRawCursor(server, hdb->context, &session->sessionId,
+                                         session->context, &request->requestHeader,
+                                         details, request->timestampsToReturn,
+                                         &request->nodesToRead[opened], &hrs->cursor);
+        if(hrs->status == UA_STATUSCODE_BADNOTSUPPORTED) {
+            streamable = false;
+            break;
+        }
+    }
+    UA_LOCK(&server->serviceMutex);
+
+    /* Compute the length of the encoded HistoryData. The length is encoded in
+     * the ExtensionObject before the content. */
+    for(size_t i = 0; i < opened && streamable; i++) {
+        HistoryReadStream *hrs = &streams[i];
+        size_t length = 4; /* Array length */
+        if(hrs->status == UA_STATUSCODE_GOOD) {
+            if(hrs->cursor.size > UA_INT32_MAX) {
+                streamable = false;
+                break;
+            }
+            for(size_t j = 0; j < hrs->cursor.size; j++)
+                length += UA_calcSizeBinary(hrs->cursor.getValue(&hrs->cursor, j),
+                                            &UA_TYPES[UA_TYPES_DATAVALUE]);
+        }
+        if(length > UA_INT32_MAX)
+            streamable = false;
+        hrs->bodyLength = (UA_Int32)length;
+    }
+
+    /* Encode and send the response. Chunks are sent out while the values are
+     * encoded. A failure after the first chunk cannot be recovered. The
+     * SecureChannel is closed. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(streamable) {
+        UA_MessageContext mc;
+        res = beginStreamedResponse(server, channel, requestId,
+                                    &response->responseHeader,
+                                    &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE], &mc);
+        UA_Int32 size = (UA_Int32)request->nodesToReadSize;
+        if(res == UA_STATUSCODE_GOOD)
+            res = UA_MessageContext_encode(&mc, &size, &UA_TYPES[UA_TYPES_INT32]);
+        for(size_t i = 0; i < request->nodesToReadSize && res == UA_STATUSCODE_GOOD; i++)
+            res = encodeHistoryReadResult(&mc, &streams[i]);
+        UA_Int32 noDiagnostics = -1;
+        if(res == UA_STATUSCODE_GOOD)
+            res = UA_MessageContext_encode(&mc, &noDiagnostics, &UA_TYPES[UA_TYPES_INT32]);
+        if(res == UA_STATUSCODE_GOOD)
+            res = UA_MessageContext_finish(&mc);
+    }
+
+    /* Close the cursors */
+    for(size_t i = 0; i < opened; i++) {
+        if(streams[i].status == UA_STATUSCODE_GOOD)
+            streams[i].cursor.close(&streams[i].cursor);
+    }
+    UA_free(streams);
+
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING_CHANNEL(server->config.logging, channel,
+                               "Could not stream the HistoryRead response "
+                               "with StatusCode %s", UA_StatusCode_name(res));
+        UA_SecureChannel_shutdown(channel, UA_SHUTDOWNREASON_ABORT);
+    }
+    return streamable;
+}
+
 void
 Service_HistoryUpdate(UA_Server *server, UA_Session *session,
                     const UA_HistoryUpdateRequest *request,
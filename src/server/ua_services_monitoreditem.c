@@ -732,6 +732,9 @@ Operation_ModifyMonitoredItem(UA_Server *server, UA_Session *session, UA_Subscri
     UA_MonitoringParameters_clear(&mon->parameters);
     mon->parameters = params;
 
+    /* The next sample is evaluated with the new filter */
+    mon->lastValueVersion = 0;
+
     /* Re-register the callback if necessary */
     if(oldSamplingInterval != mon->parameters.samplingInterval) {
         UA_MonitoredItem_unregisterSampling(server, mon);
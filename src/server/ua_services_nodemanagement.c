@@ -716,6 +716,10 @@ copyChild(UA_Server *server, UA_Session *session,
         reftypes_skipped = UA_ReferenceTypeSet_union(reftypes_skipped, UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASINTERFACE));
         UA_Node_deleteReferencesSubset(node, &reftypes_skipped);
 
+        /* The copied node gets its own value version */
+        if(node->head.nodeClass == UA_NODECLASS_VARIABLE)
+            node->variableNode.valueVersion = ++server->lastValueVersion;
+
         /* Add the node to the nodestore */
         UA_NodeId newNodeId = UA_NODEID_NULL;
         retval = UA_NODESTORE_INSERT(server, node, &newNodeId);
@@ -1093,6 +1097,10 @@ addNode_raw(UA_Server *server, UA_Session *session, void *nodeContext,
         node->variableNode.value.data.value.hasSourceTimestamp = true;
     }
 
+    /* Initial version of the value for the change detection */
+    if(node->head.nodeClass == UA_NODECLASS_VARIABLE)
+        node->variableNode.valueVersion = ++server->lastValueVersion;
+
     /* Add the node to the nodestore */
     if(!outNewNodeId)
         outNewNodeId = &tmpOutId;
@@ -2535,6 +2543,22 @@ setDataSourceCallback(UA_Server *server, UA_Session *session,
     return UA_STATUSCODE_GOOD;
 }
 
+/*****************************/
+/* Set Batched Data Source   */
+/*****************************/
+static UA_StatusCode
+setDataSourceBatch(UA_Server *server, UA_Session *session,
+                   UA_VariableNode *node, const UA_DataSourceBatch *dataSource) {
+    if(node->head.nodeClass != UA_NODECLASS_VARIABLE)
+        return UA_STATUSCODE_BADNODECLASSINVALID;
+    if(!dataSource->read)
+        return UA_STATUSCODE_BADCONFIGURATIONERROR;
+    node->valueBackend.backendType = UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH;
+    node->valueBackend.backend.dataSourceBatch.read = dataSource->read;
+    node->valueBackend.backend.dataSourceBatch.write = dataSource->write;
+    return UA_STATUSCODE_GOOD;
+}
+
 /**********************/
 /* Set Value Backend  */
 /**********************/
@@ -2561,6 +2585,13 @@ UA_Server_setVariableNode_valueBackend(UA_Server *server, const UA_NodeId nodeId
                 /* cast away const because callback uses const anyway */
                                         (UA_ValueCallback *)(uintptr_t) &valueBackend);
             break;
+        case UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH:
+            retval = UA_Server_editNode(server, &server->adminSession, &nodeId,
+                                        (UA_EditNodeCallback) setDataSourceBatch,
+                /* cast away const because callback uses const anyway */
+                                        (UA_DataSourceBatch *)(uintptr_t)
+                                        &valueBackend.backend.dataSourceBatch);
+            break;
     }
 
 
@@ -19,6 +19,14 @@
 /* Delayed callback to free the session memory */
 static void
 removeSessionCallback(UA_Server *server, session_list_entry *entry) {
+#if UA_MULTITHREADING >= 100
+    /* A service worker still uses the session. Try again later. */
+    if(UA_ServiceWorkers_sessionBusy(server, &entry->session)) {
+        UA_EventLoop *el = server->config.eventLoop;
+        el->addDelayedCallback(el, &entry->cleanupCallback);
+        return;
+    }
+#endif
     UA_LOCK(&server->serviceMutex);
     UA_Session_clear(&entry->session, server);
     UA_UNLOCK(&server->serviceMutex);
@@ -58,6 +66,11 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
     /* Detach the Session from the SecureChannel */
     UA_Session_detachFromSecureChannel(session);
 
+#if UA_MULTITHREADING >= 100
+    /* Detach the Session from the queued service worker jobs */
+    UA_ServiceWorkers_removeSession(server, session);
+#endif
+
     /* Deactivate the session */
     if(sentry->session.activated) {
         sentry->session.activated = false;
@@ -67,6 +80,8 @@ UA_Server_removeSession(UA_Server *server, session_list_entry *sentry,
     /* Detach the session from the session manager and make the capacity
      * available */
     LIST_REMOVE(sentry, pointers);
+    ZIP_REMOVE(UA_SessionIdTree, &server->sessionsById, sentry);
+    ZIP_REMOVE(UA_SessionTokenTree, &server->sessionsByToken, sentry);
     server->sessionCount--;
 
     switch(shutdownReason) {
@@ -103,14 +118,12 @@ UA_StatusCode
 UA_Server_removeSessionByToken(UA_Server *server, const UA_NodeId *token,
                                UA_ShutdownReason shutdownReason) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
-    session_list_entry *entry;
-    LIST_FOREACH(entry, &server->sessions, pointers) {
-        if(UA_NodeId_equal(&entry->session.authenticationToken, token)) {
-            UA_Server_removeSession(server, entry, shutdownReason);
-            return UA_STATUSCODE_GOOD;
-        }
-    }
-    return UA_STATUSCODE_BADSESSIONIDINVALID;
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionTokenTree, &server->sessionsByToken, token);
+    if(!entry)
+        return UA_STATUSCODE_BADSESSIONIDINVALID;
+    UA_Server_removeSession(server, entry, shutdownReason);
+    return UA_STATUSCODE_GOOD;
 }
 
 void
@@ -121,6 +134,11 @@ UA_Server_cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
         /* Session has timed out? */
         if(sentry->session.validTill >= nowMonotonic)
             continue;
+#if UA_MULTITHREADING >= 100
+        /* The lifetime is updated when the pending requests are answered */
+        if(UA_ServiceWorkers_sessionPending(server, &sentry->session))
+            continue;
+#endif
         UA_LOG_INFO_SESSION(server->config.logging, &sentry->session,
                             "Session has timed out");
         UA_Server_removeSession(server, sentry, UA_SHUTDOWNREASON_TIMEOUT);
@@ -131,52 +149,44 @@ UA_Server_cleanupSessions(UA_Server *server, UA_DateTime nowMonotonic) {
 /* Services */
 /************/
 
-UA_Session *
-getSessionByToken(UA_Server *server, const UA_NodeId *token) {
-    UA_LOCK_ASSERT(&server->serviceMutex, 1);
-
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.authenticationToken, token))
-            continue;
+enum ZIP_CMP
+cmpSessionNodeId(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
 
-        /* Session has timed out */
-        UA_EventLoop *el = server->config.eventLoop;
-        UA_DateTime now = el->dateTime_nowMonotonic(el);
-        if(now > current->session.validTill) {
-            UA_LOG_INFO_SESSION(server->config.logging, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+static UA_Session *
+checkSessionLifetime(UA_Server *server, session_list_entry *entry) {
+    if(!entry)
+        return NULL;
 
-        return &current->session;
+    /* Session has timed out */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime now = el->dateTime_nowMonotonic(el);
+    if(now > entry->session.validTill) {
+        UA_LOG_INFO_SESSION(server->config.logging, &entry->session,
+                            "Client tries to use a session that has timed out");
+        return NULL;
     }
 
-    return NULL;
+    return &entry->session;
 }
 
 UA_Session *
-getSessionById(UA_Server *server, const UA_NodeId *sessionId) {
+getSessionByToken(UA_Server *server, const UA_NodeId *token) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionTokenTree, &server->sessionsByToken, token);
+    return checkSessionLifetime(server, entry);
+}
 
-    session_list_entry *current = NULL;
-    LIST_FOREACH(current, &server->sessions, pointers) {
-        /* Token does not match */
-        if(!UA_NodeId_equal(&current->session.sessionId, sessionId))
-            continue;
-
-        /* Session has timed out */
-        UA_EventLoop *el = server->config.eventLoop;
-        UA_DateTime now = el->dateTime_nowMonotonic(el);
-        if(now > current->session.validTill) {
-            UA_LOG_INFO_SESSION(server->config.logging, &current->session,
-                                "Client tries to use a session that has timed out");
-            return NULL;
-        }
+UA_Session *
+getSessionById(UA_Server *server, const UA_NodeId *sessionId) {
+    UA_LOCK_ASSERT(&server->serviceMutex, 1);
 
-        return &current->session;
-    }
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionIdTree, &server->sessionsById, sessionId);
+    if(entry)
+        return checkSessionLifetime(server, entry);
 
     if(UA_NodeId_equal(sessionId, &server->adminSession.sessionId))
         return &server->adminSession;
@@ -263,6 +273,8 @@ UA_Server_createSession(UA_Server *server, UA_SecureChannel *channel,
 
     /* Add to the server */
     LIST_INSERT_HEAD(&server->sessions, newentry, pointers);
+    ZIP_INSERT(UA_SessionIdTree, &server->sessionsById, newentry);
+    ZIP_INSERT(UA_SessionTokenTree, &server->sessionsByToken, newentry);
     server->sessionCount++;
 
     *session = &newentry->session;
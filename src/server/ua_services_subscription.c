@@ -84,6 +84,7 @@ Service_CreateSubscription(UA_Server *server, UA_Session *session,
 
     /* Register the subscription in the server */
     LIST_INSERT_HEAD(&server->subscriptions, sub, serverListEntry);
+    ZIP_INSERT(UA_ServerSubscriptionTree, &server->subscriptionsById, sub);
     server->subscriptionsSize++;
 
     /* Update the server statistics */
@@ -533,12 +534,15 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
 
     /* Move over the MonitoredItems and adjust the backpointers */
     LIST_INIT(&newSub->monitoredItems);
+    ZIP_INIT(&newSub->monitoredItemsById);
     UA_MonitoredItem *mon, *mon_tmp;
     LIST_FOREACH_SAFE(mon, &sub->monitoredItems, listEntry, mon_tmp) {
         LIST_REMOVE(mon, listEntry);
         mon->subscription = newSub;
         LIST_INSERT_HEAD(&newSub->monitoredItems, mon, listEntry);
+        ZIP_INSERT(UA_MonitoredItemIdTree, &newSub->monitoredItemsById, mon);
     }
+    ZIP_INIT(&sub->monitoredItemsById);
     sub->monitoredItemsSize = 0;
 
     /* Move over the notification queue */
@@ -567,6 +571,8 @@ Operation_TransferSubscription(UA_Server *server, UA_Session *session,
     /* Add to the server */
     UA_assert(newSub->subscriptionId == sub->subscriptionId);
     LIST_INSERT_HEAD(&server->subscriptions, newSub, serverListEntry);
+    ZIP_REMOVE(UA_ServerSubscriptionTree, &server->subscriptionsById, sub);
+    ZIP_INSERT(UA_ServerSubscriptionTree, &server->subscriptionsById, newSub);
     server->subscriptionsSize++;
 
     /* Attach to the session */
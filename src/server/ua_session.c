@@ -22,6 +22,7 @@ void UA_Session_init(UA_Session *session) {
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     SIMPLEQ_INIT(&session->responseQueue);
     TAILQ_INIT(&session->subscriptions);
+    ZIP_INIT(&session->subscriptionsById);
 #endif
 }
 
@@ -148,6 +149,7 @@ void
 UA_Session_attachSubscription(UA_Session *session, UA_Subscription *sub) {
     /* Attach to the session */
     sub->session = session;
+    ZIP_INSERT(UA_SessionSubscriptionTree, &session->subscriptionsById, sub);
 
     /* Increase the count */
     session->subscriptionsSize++;
@@ -173,6 +175,7 @@ UA_Session_detachSubscription(UA_Server *server, UA_Session *session,
     /* Detach from the session */
     sub->session = NULL;
     TAILQ_REMOVE(&session->subscriptions, sub, sessionListEntry);
+    ZIP_REMOVE(UA_SessionSubscriptionTree, &session->subscriptionsById, sub);
 
     /* Reduce the count */
     UA_assert(session->subscriptionsSize > 0);
@@ -197,27 +200,23 @@ UA_Session_detachSubscription(UA_Server *server, UA_Session *session,
 
 UA_Subscription *
 UA_Session_getSubscriptionById(UA_Session *session, UA_UInt32 subscriptionId) {
-    UA_Subscription *sub;
-    TAILQ_FOREACH(sub, &session->subscriptions, sessionListEntry) {
-        /* Prevent lookup of subscriptions that are to be deleted with a statuschange */
-        if(sub->statusChange != UA_STATUSCODE_GOOD)
-            continue;
-        if(sub->subscriptionId == subscriptionId)
-            break;
-    }
+    UA_Subscription *sub =
+        ZIP_FIND(UA_SessionSubscriptionTree, &session->subscriptionsById,
+                 &subscriptionId);
+    /* Prevent lookup of subscriptions that are to be deleted with a statuschange */
+    if(sub && sub->statusChange != UA_STATUSCODE_GOOD)
+        return NULL;
     return sub;
 }
 
 UA_Subscription *
 getSubscriptionById(UA_Server *server, UA_UInt32 subscriptionId) {
-    UA_Subscription *sub;
-    LIST_FOREACH(sub, &server->subscriptions, serverListEntry) {
-        /* Prevent lookup of subscriptions that are to be deleted with a statuschange */
-        if(sub->statusChange != UA_STATUSCODE_GOOD)
-            continue;
-        if(sub->subscriptionId == subscriptionId)
-            break;
-    }
+    UA_Subscription *sub =
+        ZIP_FIND(UA_ServerSubscriptionTree, &server->subscriptionsById,
+                 &subscriptionId);
+    /* Prevent lookup of subscriptions that are to be deleted with a statuschange */
+    if(sub && sub->statusChange != UA_STATUSCODE_GOOD)
+        return NULL;
     return sub;
 }
 
@@ -248,14 +247,12 @@ UA_Session_queuePublishReq(UA_Session *session, UA_PublishResponseEntry* entry,
 UA_StatusCode
 UA_Server_closeSession(UA_Server *server, const UA_NodeId *sessionId) {
     UA_LOCK(&server->serviceMutex);
-    session_list_entry *entry;
     UA_StatusCode res = UA_STATUSCODE_BADSESSIONIDINVALID;
-    LIST_FOREACH(entry, &server->sessions, pointers) {
-        if(UA_NodeId_equal(&entry->session.sessionId, sessionId)) {
-            UA_Server_removeSession(server, entry, UA_SHUTDOWNREASON_CLOSE);
-            res = UA_STATUSCODE_GOOD;
-            break;
-        }
+    session_list_entry *entry =
+        ZIP_FIND(UA_SessionIdTree, &server->sessionsById, sessionId);
+    if(entry) {
+        UA_Server_removeSession(server, entry, UA_SHUTDOWNREASON_CLOSE);
+        res = UA_STATUSCODE_GOOD;
     }
     UA_UNLOCK(&server->serviceMutex);
     return res;
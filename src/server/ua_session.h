@@ -12,6 +12,7 @@
 #include <open62541/util.h>
 
 #include "ua_securechannel.h"
+#include "ziptree.h"
 
 _UA_BEGIN_DECLS
 
@@ -27,6 +28,9 @@ ContinuationPoint_clear(ContinuationPoint *cp);
 struct UA_Subscription;
 typedef struct UA_Subscription UA_Subscription;
 
+typedef ZIP_HEAD(UA_SessionSubscriptionTree, UA_Subscription)
+    UA_SessionSubscriptionTree;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
 typedef struct UA_PublishResponseEntry {
     SIMPLEQ_ENTRY(UA_PublishResponseEntry) listEntry;
@@ -75,6 +79,7 @@ struct UA_Session {
      * (round-robin scheduling). */
     size_t subscriptionsSize;
     TAILQ_HEAD(, UA_Subscription) subscriptions;
+    UA_SessionSubscriptionTree subscriptionsById; /* Index for the lookup */
 
     size_t responseQueueSize;
     SIMPLEQ_HEAD(, UA_PublishResponseEntry) responseQueue;
@@ -82,6 +87,14 @@ struct UA_Session {
     size_t totalRetransmissionQueueSize; /* Retransmissions of all subscriptions */
 #endif
 
+#if UA_MULTITHREADING >= 100
+    /* Requests handed to the service workers that are not answered yet. The
+     * later requests of the session are deferred until then to keep the
+     * order. Protected by the queue lock of the service workers. */
+    size_t serviceJobs;
+    size_t deferredJobs;
+#endif
+
 #ifdef UA_ENABLE_DIAGNOSTICS
     UA_SessionSecurityDiagnosticsDataType securityDiagnostics;
     UA_SessionDiagnosticsDataType diagnostics;
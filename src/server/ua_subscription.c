@@ -41,6 +41,7 @@ UA_Subscription_new(void) {
 
     TAILQ_INIT(&newSub->retransmissionQueue);
     TAILQ_INIT(&newSub->notificationQueue);
+    ZIP_INIT(&newSub->monitoredItemsById);
     return newSub;
 }
 
@@ -80,6 +81,7 @@ UA_Subscription_delete(UA_Server *server, UA_Subscription *sub) {
     /* Remove from the server if not previously registered */
     if(sub->serverListEntry.le_prev) {
         LIST_REMOVE(sub, serverListEntry);
+        ZIP_REMOVE(UA_ServerSubscriptionTree, &server->subscriptionsById, sub);
         UA_assert(server->subscriptionsSize > 0);
         server->subscriptionsSize--;
         server->serverDiagnosticsSummary.currentSubscriptionCount--;
@@ -119,14 +121,17 @@ Subscription_resetLifetime(UA_Subscription *sub) {
     sub->currentLifetimeCount = 0;
 }
 
+enum ZIP_CMP
+cmpUInt32Identifier(const UA_UInt32 *a, const UA_UInt32 *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
 UA_MonitoredItem *
 UA_Subscription_getMonitoredItem(UA_Subscription *sub, UA_UInt32 monitoredItemId) {
-    UA_MonitoredItem *mon;
-    LIST_FOREACH(mon, &sub->monitoredItems, listEntry) {
-        if(mon->monitoredItemId == monitoredItemId)
-            break;
-    }
-    return mon;
+    return ZIP_FIND(UA_MonitoredItemIdTree, &sub->monitoredItemsById,
+                    &monitoredItemId);
 }
 
 static void
@@ -101,7 +101,7 @@ typedef TAILQ_HEAD(NotificationMessageQueue, UA_NotificationMessageEntry)
 
 /* The type of sampling for MonitoredItems depends on the sampling interval.
  *
- * >0: Cyclic callback
+ * >0: Cyclic callback of the SamplingGroup for the interval
  * =0: Attached to the node. Sampling is triggered after every "write".
  * <0: Attached to the subscription. Triggered just before every "publish". */
 typedef enum {
@@ -113,9 +113,12 @@ typedef enum {
     UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH /* Attached to the subscription */
 } UA_MonitoredItemSamplingType;
 
+struct UA_SamplingGroup;
+
 struct UA_MonitoredItem {
     UA_DelayedCallback delayedFreePointers;
     LIST_ENTRY(UA_MonitoredItem) listEntry; /* Linked list in the Subscription */
+    ZIP_ENTRY(UA_MonitoredItem) idTreeEntry; /* Index in the Subscription */
     UA_Subscription *subscription;          /* Always non-NULL */
     UA_UInt32 monitoredItemId;
 
@@ -149,12 +152,17 @@ struct UA_MonitoredItem {
     /* Sampling */
     UA_MonitoredItemSamplingType samplingType;
     union {
-        UA_UInt64 callbackId;
+        struct {
+            LIST_ENTRY(UA_MonitoredItem) listEntry;
+            struct UA_SamplingGroup *group;
+        } cyclic; /* Cyclic: Sampled with the SamplingGroup of the interval */
         UA_MonitoredItem *nodeListNext; /* Event-Based: Attached to Node */
         LIST_ENTRY(UA_MonitoredItem) subscriptionSampling; /* Linked to publish
                                                             * interval */
     } sampling;
     UA_DataValue lastValue;
+    UA_UInt64 lastValueVersion; /* Version of the last sampled internal value.
+                                 * The sampling is skipped while unchanged. */
 
     /* Triggering Links */
     size_t triggeringLinksSize;
@@ -168,6 +176,14 @@ struct UA_MonitoredItem {
                             * the queue size */
 };
 
+/* Compare the numerical SubscriptionIds and MonitoredItemIds */
+enum ZIP_CMP
+cmpUInt32Identifier(const UA_UInt32 *a, const UA_UInt32 *b);
+
+typedef ZIP_HEAD(UA_MonitoredItemIdTree, UA_MonitoredItem) UA_MonitoredItemIdTree;
+ZIP_FUNCTIONS(UA_MonitoredItemIdTree, UA_MonitoredItem, idTreeEntry,
+              UA_UInt32, monitoredItemId, cmpUInt32Identifier)
+
 void UA_MonitoredItem_init(UA_MonitoredItem *mon);
 void UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *mon);
 void UA_MonitoredItem_removeOverflowInfoBits(UA_MonitoredItem *mon);
@@ -182,6 +198,32 @@ UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon);
 void
 UA_MonitoredItem_unregisterSampling(UA_Server *server, UA_MonitoredItem *mon);
 
+/* The MonitoredItems with a positive sampling interval are grouped by the
+ * interval. Every SamplingGroup has a single cyclic callback in the EventLoop
+ * that samples all of its MonitoredItems while taking the lock only once. The
+ * SamplingGroup is removed together with its last MonitoredItem.
+ *
+ * The lock is released for the user callbacks during the sampling. Then
+ * MonitoredItems can be removed from the SamplingGroup. The next item of the
+ * iteration is adjusted when it is removed. And the SamplingGroup is freed by
+ * the sampling callback if the last item is removed meanwhile. */
+typedef struct UA_SamplingGroup {
+    ZIP_ENTRY(UA_SamplingGroup) treeEntry;
+    UA_Double samplingInterval;
+    UA_UInt64 callbackId;
+    LIST_HEAD(, UA_MonitoredItem) monitoredItems;
+    size_t monitoredItemsSize;
+    UA_Boolean sampling;
+    struct UA_MonitoredItem *nextItem; /* Next item sampled in the callback */
+} UA_SamplingGroup;
+
+enum ZIP_CMP
+cmpSamplingInterval(const UA_Double *a, const UA_Double *b);
+
+typedef ZIP_HEAD(UA_SamplingGroupTree, UA_SamplingGroup) UA_SamplingGroupTree;
+ZIP_FUNCTIONS(UA_SamplingGroupTree, UA_SamplingGroup, treeEntry,
+              UA_Double, samplingInterval, cmpSamplingInterval)
+
 UA_StatusCode
 UA_MonitoredItem_setMonitoringMode(UA_Server *server, UA_MonitoredItem *mon,
                                    UA_MonitoringMode monitoringMode);
@@ -231,6 +273,8 @@ struct UA_Subscription {
     /* Ordered according to the priority byte and round-robin scheduling for
      * late subscriptions. See ua_session.h. Only set if session != NULL. */
     TAILQ_ENTRY(UA_Subscription) sessionListEntry;
+    ZIP_ENTRY(UA_Subscription) serverTreeEntry;  /* Index by the SubscriptionId */
+    ZIP_ENTRY(UA_Subscription) sessionTreeEntry;
     UA_Session *session; /* May be NULL if no session is attached. */
     UA_UInt32 subscriptionId;
 
@@ -261,6 +305,7 @@ struct UA_Subscription {
     /* MonitoredItems */
     UA_UInt32 lastMonitoredItemId; /* increase the identifiers */
     LIST_HEAD(, UA_MonitoredItem) monitoredItems;
+    UA_MonitoredItemIdTree monitoredItemsById; /* Index for the lookup */
     UA_UInt32 monitoredItemsSize;
 
     /* MonitoredItems that are sampled in every publish callback (with the
@@ -301,6 +346,16 @@ struct UA_Subscription {
 #endif
 };
 
+/* The Subscriptions are indexed by their SubscriptionId server-wide and in the
+ * attached Session. During the TransferSubscriptions Service only the new
+ * Subscription is kept in the server-wide index. */
+typedef ZIP_HEAD(UA_ServerSubscriptionTree, UA_Subscription) UA_ServerSubscriptionTree;
+ZIP_FUNCTIONS(UA_ServerSubscriptionTree, UA_Subscription, serverTreeEntry,
+              UA_UInt32, subscriptionId, cmpUInt32Identifier)
+
+ZIP_FUNCTIONS(UA_SessionSubscriptionTree, UA_Subscription, sessionTreeEntry,
+              UA_UInt32, subscriptionId, cmpUInt32Identifier)
+
 UA_Subscription * UA_Subscription_new(void);
 
 void
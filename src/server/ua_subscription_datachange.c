@@ -13,65 +13,117 @@
 #include "ua_subscription.h"
 #include "ua_types_encoding_binary.h"
 
+#include <math.h>
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS /* conditional compilation */
 
-/* Detect value changes outside the deadband */
-#define UA_DETECT_DEADBAND(TYPE) do {                           \
-    TYPE v1 = *(const TYPE*)data1;                              \
-    TYPE v2 = *(const TYPE*)data2;                              \
-    TYPE diff = (v1 > v2) ? (TYPE)(v1 - v2) : (TYPE)(v2 - v1);  \
-    return ((UA_Double)diff > deadband);                        \
-} while(false);
+/* Detect value changes outside the deadband. One kernel is generated per
+ * numeric type. The elements are compared in blocks. Inside a block there is
+ * no early exit and no data-dependent branch, so that the compiler can
+ * vectorize the loop for the target instruction set (SSE/AVX/NEON). The block
+ * size bounds the extra work if a change is found early.
+ *
+ * The integer kernels compare the unsigned distance with an integer threshold.
+ * This avoids the conversion of every element to floating point. */
+#define UA_DEADBAND_BLOCKSIZE 64
 
-static UA_Boolean
-detectScalarDeadBand(const void *data1, const void *data2,
-                     const UA_DataType *type, const UA_Double deadband) {
-    if(type->typeKind == UA_DATATYPEKIND_SBYTE) {
-        UA_DETECT_DEADBAND(UA_SByte);
-    } else if(type->typeKind == UA_DATATYPEKIND_BYTE) {
-        UA_DETECT_DEADBAND(UA_Byte);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT16) {
-        UA_DETECT_DEADBAND(UA_Int16);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT16) {
-        UA_DETECT_DEADBAND(UA_UInt16);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT32) {
-        UA_DETECT_DEADBAND(UA_Int32);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT32) {
-        UA_DETECT_DEADBAND(UA_UInt32);
-    } else if(type->typeKind == UA_DATATYPEKIND_INT64) {
-        UA_DETECT_DEADBAND(UA_Int64);
-    } else if(type->typeKind == UA_DATATYPEKIND_UINT64) {
-        UA_DETECT_DEADBAND(UA_UInt64);
-    } else if(type->typeKind == UA_DATATYPEKIND_FLOAT) {
-        UA_DETECT_DEADBAND(UA_Float);
-    } else if(type->typeKind == UA_DATATYPEKIND_DOUBLE) {
-        UA_DETECT_DEADBAND(UA_Double);
-    } else {
-        return false; /* Not a known numerical type */
-    }
+#define UA_DETECT_DEADBAND_INT(TYPE, UTYPE)                             \
+static UA_Boolean                                                       \
+detectDeadband_##TYPE(const TYPE *v1, const TYPE *v2,                   \
+                      size_t length, const UTYPE threshold) {           \
+    for(size_t i = 0; i < length; i += UA_DEADBAND_BLOCKSIZE) {         \
+        size_t end = i + UA_DEADBAND_BLOCKSIZE;                         \
+        if(end > length)                                                \
+            end = length;                                               \
+        unsigned outside = 0;                                           \
+        for(size_t j = i; j < end; j++) {                               \
+            UTYPE diff = (v1[j] > v2[j]) ?                              \
+                (UTYPE)((UTYPE)v1[j] - (UTYPE)v2[j]) :                  \
+                (UTYPE)((UTYPE)v2[j] - (UTYPE)v1[j]);                   \
+            outside |= (diff > threshold);                              \
+        }                                                               \
+        if(outside)                                                     \
+            return true;                                                \
+    }                                                                   \
+    return false;                                                       \
+}
+
+#define UA_DETECT_DEADBAND_FLOAT(TYPE)                                  \
+static UA_Boolean                                                       \
+detectDeadband_##TYPE(const TYPE *v1, const TYPE *v2,                   \
+                      size_t length, const UA_Double deadband) {        \
+    for(size_t i = 0; i < length; i += UA_DEADBAND_BLOCKSIZE) {         \
+        size_t end = i + UA_DEADBAND_BLOCKSIZE;                         \
+        if(end > length)                                                \
+            end = length;                                               \
+        unsigned outside = 0;                                           \
+        for(size_t j = i; j < end; j++) {                               \
+            TYPE diff = (TYPE)(v1[j] - v2[j]);                          \
+            outside |= (fabs((UA_Double)diff) > deadband);              \
+        }                                                               \
+        if(outside)                                                     \
+            return true;                                                \
+    }                                                                   \
+    return false;                                                       \
 }
 
+UA_DETECT_DEADBAND_INT(UA_SByte, UA_Byte)
+UA_DETECT_DEADBAND_INT(UA_Byte, UA_Byte)
+UA_DETECT_DEADBAND_INT(UA_Int16, UA_UInt16)
+UA_DETECT_DEADBAND_INT(UA_UInt16, UA_UInt16)
+UA_DETECT_DEADBAND_INT(UA_Int32, UA_UInt32)
+UA_DETECT_DEADBAND_INT(UA_UInt32, UA_UInt32)
+UA_DETECT_DEADBAND_INT(UA_Int64, UA_UInt64)
+UA_DETECT_DEADBAND_INT(UA_UInt64, UA_UInt64)
+UA_DETECT_DEADBAND_FLOAT(UA_Float)
+UA_DETECT_DEADBAND_FLOAT(UA_Double)
+
+/* The integer distance is above the deadband if it is above the integer part
+ * of the deadband. Every distance (also zero) is above a negative deadband. A
+ * deadband beyond the maximum distance is never exceeded. */
+#define UA_DEADBAND_INT_CASE(KIND, TYPE, UTYPE, UMAX)                   \
+    case KIND:                                                          \
+        if(deadband < 0.0)                                              \
+            return (length > 0);                                        \
+        if(deadband >= (UA_Double)UMAX)                                 \
+            return false;                                               \
+        return detectDeadband_##TYPE((const TYPE*)v1, (const TYPE*)v2,  \
+                                     length, (UTYPE)deadband);
+
 static UA_Boolean
 detectVariantDeadband(const UA_Variant *value, const UA_Variant *oldValue,
-                      const UA_Double deadbandValue) {
+                      const UA_Double deadband) {
     if(value->arrayLength != oldValue->arrayLength)
         return true;
     if(value->type != oldValue->type)
         return true;
+    if(deadband != deadband)
+        return false; /* NaN is never exceeded */
     size_t length = 1;
     if(!UA_Variant_isScalar(value))
         length = value->arrayLength;
-    uintptr_t data = (uintptr_t)value->data;
-    uintptr_t oldData = (uintptr_t)oldValue->data;
-    UA_UInt32 memSize = value->type->memSize;
-    for(size_t i = 0; i < length; ++i) {
-        if(detectScalarDeadBand((const void*)data, (const void*)oldData,
-                                value->type, deadbandValue))
-            return true;
-        data += memSize;
-        oldData += memSize;
+    const void *v1 = value->data;
+    const void *v2 = oldValue->data;
+
+    /* Select the kernel once for the entire array */
+    switch(value->type->typeKind) {
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_SBYTE, UA_SByte, UA_Byte, UA_BYTE_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_BYTE, UA_Byte, UA_Byte, UA_BYTE_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_INT16, UA_Int16, UA_UInt16, UA_UINT16_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_UINT16, UA_UInt16, UA_UInt16, UA_UINT16_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_INT32, UA_Int32, UA_UInt32, UA_UINT32_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_UINT32, UA_UInt32, UA_UInt32, UA_UINT32_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_INT64, UA_Int64, UA_UInt64, UA_UINT64_MAX)
+    UA_DEADBAND_INT_CASE(UA_DATATYPEKIND_UINT64, UA_UInt64, UA_UInt64, UA_UINT64_MAX)
+    case UA_DATATYPEKIND_FLOAT:
+        return detectDeadband_UA_Float((const UA_Float*)v1, (const UA_Float*)v2,
+                                       length, deadband);
+    case UA_DATATYPEKIND_DOUBLE:
+        return detectDeadband_UA_Double((const UA_Double*)v1, (const UA_Double*)v2,
+                                        length, deadband);
+    default:
+        return false; /* Not a known numerical type */
     }
-    return false;
 }
 
 static UA_Boolean
@@ -171,6 +223,7 @@ UA_MonitoredItem_processSampledValue(UA_Server *server, UA_MonitoredItem *mon,
                                     "Processing the sample returned the statuscode %s",
                                     mon->monitoredItemId, UA_StatusCode_name(res));
         UA_DataValue_clear(value);
+        mon->lastValueVersion = 0; /* Sample again */
         return;
     }
 
@@ -195,10 +248,34 @@ monitoredItem_sampleCallback(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOG_DEBUG_SUBSCRIPTION(server->config.logging, sub, "MonitoredItem %" PRIi32
                               " | Sample callback called", mon->monitoredItemId);
 
-    /* Sample the current value */
+    /* Sample the current value. Skip if the internal value of the node has
+     * not been written since the last sample. Static values get a fresh
+     * source timestamp for every read. So the version cannot be used if the
+     * trigger includes the timestamp. */
     UA_Session *session = (sub) ? sub->session : &server->adminSession;
-    UA_DataValue dv = readWithSession(server, session, &mon->itemToMonitor,
-                                      mon->timestampsToReturn);
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    const UA_ExtensionObject *filter = &mon->parameters.filter;
+    if(filter->content.decoded.type == &UA_TYPES[UA_TYPES_DATACHANGEFILTER] &&
+       ((UA_DataChangeFilter*)filter->content.decoded.data)->trigger ==
+       UA_DATACHANGETRIGGER_STATUSVALUETIMESTAMP) {
+        mon->lastValueVersion = 0;
+        dv = readWithSession(server, session, &mon->itemToMonitor,
+                             mon->timestampsToReturn);
+    } else {
+        UA_UInt64 version = mon->lastValueVersion;
+        if(!readWithSessionIfChanged(server, session, &mon->itemToMonitor,
+                                     mon->timestampsToReturn, &version, &dv))
+            return;
+        mon->lastValueVersion = version;
+    }
+
+    /* The MonitoredItem was removed or disabled while the lock was released
+     * for reading. The memory is only freed in a delayed callback. */
+    if(mon->samplingType == UA_MONITOREDITEMSAMPLINGTYPE_NONE) {
+        UA_DataValue_clear(&dv);
+        return;
+    }
 
     /* Process the sample. This always clears the value. */
     UA_MonitoredItem_processSampledValue(server, mon, &dv);
@@ -447,6 +447,7 @@ UA_Server_registerMonitoredItem(UA_Server *server, UA_MonitoredItem *mon) {
     mon->monitoredItemId = ++sub->lastMonitoredItemId;
     mon->subscription = sub;
     LIST_INSERT_HEAD(&sub->monitoredItems, mon, listEntry);
+    ZIP_INSERT(UA_MonitoredItemIdTree, &sub->monitoredItemsById, mon);
     sub->monitoredItemsSize++;
     server->monitoredItemsSize++;
 
@@ -497,6 +498,7 @@ UA_Server_unregisterMonitoredItem(UA_Server *server, UA_MonitoredItem *mon) {
     /* Deregister in Subscription and server */
     sub->monitoredItemsSize--;
     LIST_REMOVE(mon, listEntry);
+    ZIP_REMOVE(UA_MonitoredItemIdTree, &sub->monitoredItemsById, mon);
     server->monitoredItemsSize--;
 }
 
@@ -522,6 +524,7 @@ UA_MonitoredItem_setMonitoringMode(UA_Server *server, UA_MonitoredItem *mon,
             UA_Notification_delete(notification);
         }
         UA_DataValue_clear(&mon->lastValue);
+        mon->lastValueVersion = 0;
         return UA_STATUSCODE_GOOD;
     }
 
@@ -598,6 +601,7 @@ UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *mon) {
 
     /* Remove the last samples */
     UA_DataValue_clear(&mon->lastValue);
+    mon->lastValueVersion = 0;
 
     /* If this is a local MonitoredItem, clean up additional values */
     if(mon->subscription == server->adminSubscription) {
@@ -714,6 +718,123 @@ UA_MonitoredItem_ensureQueueSpace(UA_Server *server, UA_MonitoredItem *mon) {
     }
 }
 
+/*******************/
+/* Sampling Groups */
+/*******************/
+
+enum ZIP_CMP
+cmpSamplingInterval(const UA_Double *a, const UA_Double *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+static void
+samplingGroupCallback(UA_Server *server, UA_SamplingGroup *sg) {
+    UA_LOCK(&server->serviceMutex);
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_DateTime begin = el->dateTime_nowMonotonic(el);
+#endif
+
+    /* Sample all MonitoredItems of the interval. The next item is updated when
+     * it is removed while the lock is released in the sampling. */
+    sg->sampling = true;
+    UA_MonitoredItem *mon = LIST_FIRST(&sg->monitoredItems);
+    while(mon) {
+        sg->nextItem = LIST_NEXT(mon, sampling.cyclic.listEntry);
+        monitoredItem_sampleCallback(server, mon);
+        mon = sg->nextItem;
+    }
+    sg->sampling = false;
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+    UA_DateTime duration = el->dateTime_nowMonotonic(el) - begin;
+    UA_SamplingStatistics *stats = &server->samplingStatistics;
+    stats->batches++;
+    stats->lastBatchTime = duration;
+    stats->totalBatchTime += duration;
+    if(duration > stats->maxBatchTime)
+        stats->maxBatchTime = duration;
+#endif
+
+    /* The last MonitoredItem was removed during the sampling. The
+     * SamplingGroup is already detached from the server. */
+    if(sg->monitoredItemsSize == 0)
+        UA_free(sg);
+
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+static UA_StatusCode
+addToSamplingGroup(UA_Server *server, UA_MonitoredItem *mon) {
+    /* Get or create the SamplingGroup for the interval */
+    UA_Double interval = mon->parameters.samplingInterval;
+    UA_SamplingGroup *sg =
+        ZIP_FIND(UA_SamplingGroupTree, &server->samplingGroups, &interval);
+    if(!sg) {
+        sg = (UA_SamplingGroup*)UA_calloc(1, sizeof(UA_SamplingGroup));
+        if(!sg)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        sg->samplingInterval = interval;
+        LIST_INIT(&sg->monitoredItems);
+        UA_StatusCode res =
+            addRepeatedCallback(server, (UA_ServerCallback)samplingGroupCallback,
+                                sg, interval, &sg->callbackId);
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_free(sg);
+            return res;
+        }
+        ZIP_INSERT(UA_SamplingGroupTree, &server->samplingGroups, sg);
+#ifdef UA_ENABLE_DIAGNOSTICS
+        server->samplingStatistics.samplingTimers++;
+#endif
+    }
+
+    /* Add the MonitoredItem */
+    LIST_INSERT_HEAD(&sg->monitoredItems, mon, sampling.cyclic.listEntry);
+    sg->monitoredItemsSize++;
+    mon->sampling.cyclic.group = sg;
+#ifdef UA_ENABLE_DIAGNOSTICS
+    server->samplingStatistics.monitoredItems++;
+#endif
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+removeFromSamplingGroup(UA_Server *server, UA_MonitoredItem *mon) {
+    UA_SamplingGroup *sg = mon->sampling.cyclic.group;
+    if(sg->sampling && sg->nextItem == mon)
+        sg->nextItem = LIST_NEXT(mon, sampling.cyclic.listEntry);
+    LIST_REMOVE(mon, sampling.cyclic.listEntry);
+    sg->monitoredItemsSize--;
+#ifdef UA_ENABLE_DIAGNOSTICS
+    server->samplingStatistics.monitoredItems--;
+#endif
+
+    /* Remove the SamplingGroup with the last MonitoredItem. If it is currently
+     * sampled, the sampling callback frees the memory afterwards. */
+    if(sg->monitoredItemsSize > 0)
+        return;
+    removeCallback(server, sg->callbackId);
+    ZIP_REMOVE(UA_SamplingGroupTree, &server->samplingGroups, sg);
+#ifdef UA_ENABLE_DIAGNOSTICS
+    server->samplingStatistics.samplingTimers--;
+#endif
+    if(!sg->sampling)
+        UA_free(sg);
+}
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+void
+UA_Server_getSamplingStatistics(UA_Server *server, UA_SamplingStatistics *stats) {
+    UA_LOCK(&server->serviceMutex);
+    *stats = server->samplingStatistics;
+    UA_UNLOCK(&server->serviceMutex);
+}
+#endif
+
 UA_StatusCode
 UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
     UA_LOCK_ASSERT(&server->serviceMutex, 1);
@@ -741,13 +862,9 @@ UA_MonitoredItem_registerSampling(UA_Server *server, UA_MonitoredItem *mon) {
                          sampling.subscriptionSampling);
         mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_PUBLISH;
     } else {
-        /* DataChange MonitoredItems with a positive sampling interval have a
-         * repeated callback. Other MonitoredItems are attached to the Node in a
-         * linked list of backpointers. */
-        res = addRepeatedCallback(server,
-                                  (UA_ServerCallback)UA_MonitoredItem_sampleCallback,
-                                  mon, mon->parameters.samplingInterval,
-                                  &mon->sampling.callbackId);
+        /* DataChange MonitoredItems with a positive sampling interval are
+         * sampled with the SamplingGroup of the interval */
+        res = addToSamplingGroup(server, mon);
         if(res == UA_STATUSCODE_GOOD)
             mon->samplingType = UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC;
     }
@@ -761,8 +878,8 @@ UA_MonitoredItem_unregisterSampling(UA_Server *server, UA_MonitoredItem *mon) {
 
     switch(mon->samplingType) {
     case UA_MONITOREDITEMSAMPLINGTYPE_CYCLIC:
-        /* Remove repeated callback */
-        removeCallback(server, mon->sampling.callbackId);
+        /* Remove from the SamplingGroup */
+        removeFromSamplingGroup(server, mon);
         break;
 
     case UA_MONITOREDITEMSAMPLINGTYPE_EVENT: {
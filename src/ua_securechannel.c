@@ -190,6 +190,9 @@ UA_SecureChannel_clear(UA_SecureChannel *channel) {
     /* Delete remaining chunks */
     UA_SecureChannel_deleteBuffered(channel);
 
+    /* Release the request memory */
+    UA_Arena_clear(&channel->requestArena);
+
     /* Reset the SecureChannel for reuse (in the client) */
     channel->securityMode = UA_MESSAGESECURITYMODE_INVALID;
     channel->shutdownReason = UA_SHUTDOWNREASON_CLOSE;
@@ -672,10 +675,25 @@ unpackPayloadMSG(UA_SecureChannel *channel, UA_Chunk *chunk,
     res = checkSymHeader(channel, tokenId, nowMonotonic);
     UA_CHECK_STATUS(res, return res);
 
-    /* Decrypt the chunk payload */
+    /* Decrypt the chunk payload. This is the expensive part of the message
+     * processing. Release the processLock meanwhile. */
+#if UA_MULTITHREADING >= 100
+    UA_Lock *lock = (channel->securityMode != UA_MESSAGESECURITYMODE_NONE) ?
+        channel->processLock : NULL;
+    if(lock) {
+        channel->decrypting = true;
+        UA_UNLOCK(lock);
+    }
+#endif
     res = decryptAndVerifyChunk(channel,
                                 &channel->securityPolicy->symmetricModule.cryptoModule,
                                 chunk->messageType, &chunk->bytes, offset);
+#if UA_MULTITHREADING >= 100
+    if(lock) {
+        UA_LOCK(lock);
+        channel->decrypting = false;
+    }
+#endif
     UA_CHECK_STATUS(res, return res);
 
     /* Check the sequence number. Skip sequence number checking for fuzzer to
@@ -696,6 +714,27 @@ unpackPayloadMSG(UA_SecureChannel *channel, UA_Chunk *chunk,
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+callProcessMessage(UA_SecureChannel *channel, void *application,
+                   UA_ProcessMessageCallback callback, UA_MessageType messageType,
+                   UA_UInt32 requestId, UA_ByteString *slices, size_t slicesSize) {
+#if UA_MULTITHREADING >= 100
+    UA_Lock *lock = channel->processLock;
+    if(lock)
+        UA_UNLOCK(lock);
+#endif
+    UA_StatusCode res = callback(application, channel, messageType,
+                                 requestId, slices, slicesSize);
+#if UA_MULTITHREADING >= 100
+    if(lock)
+        UA_LOCK(lock);
+#endif
+    return res;
+}
+
+/* Number of slices for which no memory is allocated */
+#define UA_SECURECHANNEL_STACKSLICES 16
+
 static UA_StatusCode
 assembleProcessMessage(UA_SecureChannel *channel, void *application,
                        UA_ProcessMessageCallback callback) {
@@ -706,8 +745,9 @@ assembleProcessMessage(UA_SecureChannel *channel, void *application,
     if(chunk->chunkType == UA_CHUNKTYPE_FINAL) {
         SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
         UA_assert(chunk->chunkType == UA_CHUNKTYPE_FINAL);
-        res = callback(application, channel, chunk->messageType,
-                       chunk->requestId, &chunk->bytes);
+        res = callProcessMessage(channel, application, callback,
+                                 chunk->messageType, chunk->requestId,
+                                 &chunk->bytes, 1);
         UA_Chunk_delete(chunk);
         return res;
     }
@@ -717,7 +757,7 @@ assembleProcessMessage(UA_SecureChannel *channel, void *application,
     UA_ChunkType chunkType = chunk->chunkType;
     UA_assert(chunkType == UA_CHUNKTYPE_INTERMEDIATE);
 
-    size_t messageSize = 0;
+    size_t slicesSize = 0;
     SIMPLEQ_FOREACH(chunk, &channel->decryptedChunks, pointers) {
         /* Consistency check */
         if(requestId != chunk->requestId)
@@ -727,33 +767,38 @@ assembleProcessMessage(UA_SecureChannel *channel, void *application,
         if(chunk->messageType != messageType)
             return UA_STATUSCODE_BADTCPMESSAGETYPEINVALID;
 
-        /* Sum up the lengths */
-        messageSize += chunk->bytes.length;
+        /* Count the chunks */
+        slicesSize++;
         if(chunk->chunkType == UA_CHUNKTYPE_FINAL)
             break;
     }
 
-    /* Allocate memory for the full message */
-    UA_ByteString payload;
-    res = UA_ByteString_allocBuffer(&payload, messageSize);
-    UA_CHECK_STATUS(res, return res);
+    /* The chunk payloads are the slices of the message. They are decoded
+     * without concatenating them first. */
+    UA_ByteString stackSlices[UA_SECURECHANNEL_STACKSLICES];
+    UA_ByteString *slices = stackSlices;
+    if(slicesSize > UA_SECURECHANNEL_STACKSLICES) {
+        slices = (UA_ByteString*)UA_malloc(sizeof(UA_ByteString) * slicesSize);
+        UA_CHECK_MEM(slices, return UA_STATUSCODE_BADOUTOFMEMORY);
+    }
 
-    /* Assemble the full message */
-    size_t offset = 0;
-    while(true) {
+    /* Take the chunks of the message from the queue. The processLock is
+     * released in the callback. */
+    UA_ChunkQueue message;
+    SIMPLEQ_INIT(&message);
+    for(size_t i = 0; i < slicesSize; i++) {
         chunk = SIMPLEQ_FIRST(&channel->decryptedChunks);
-        memcpy(&payload.data[offset], chunk->bytes.data, chunk->bytes.length);
-        offset += chunk->bytes.length;
         SIMPLEQ_REMOVE_HEAD(&channel->decryptedChunks, pointers);
-        UA_ChunkType ct = chunk->chunkType;
-        UA_Chunk_delete(chunk);
-        if(ct == UA_CHUNKTYPE_FINAL)
-            break;
+        SIMPLEQ_INSERT_TAIL(&message, chunk, pointers);
+        slices[i] = chunk->bytes;
     }
 
-    /* Process the assembled message */
-    res = callback(application, channel, messageType, requestId, &payload);
-    UA_ByteString_clear(&payload);
+    /* Process the message */
+    res = callProcessMessage(channel, application, callback,
+                             messageType, requestId, slices, slicesSize);
+    deleteChunks(&message);
+    if(slices != stackSlices)
+        UA_free(slices);
     return res;
 }
 
@@ -784,6 +829,49 @@ persistIncompleteChunk(UA_SecureChannel *channel, const UA_ByteString *buffer,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Append the missing bytes of a half-received chunk from the buffer. Only the
+ * bytes up to the chunk length from the message header are taken. The offset
+ * is forwarded accordingly. */
+static UA_StatusCode
+appendIncompleteChunk(UA_SecureChannel *channel, UA_ByteString *chunk,
+                      const UA_ByteString *buffer, size_t *offset,
+                      UA_Boolean *complete) {
+    *complete = false;
+    while(*offset < buffer->length) {
+        /* Get the chunk length from the message header. Invalid lengths are
+         * rejected in extractCompleteChunk. */
+        size_t target = UA_SECURECHANNEL_MESSAGEHEADER_LENGTH;
+        if(chunk->length >= UA_SECURECHANNEL_MESSAGEHEADER_LENGTH) {
+            size_t headerOffset = 4; /* Skip the message type */
+            UA_UInt32 messageSize = 0;
+            UA_UInt32_decodeBinary(chunk, &headerOffset, &messageSize);
+            if(messageSize <= chunk->length ||
+               messageSize > channel->config.recvBufferSize) {
+                *complete = true;
+                return UA_STATUSCODE_GOOD;
+            }
+            target = messageSize;
+        }
+
+        size_t take = target - chunk->length;
+        if(take > buffer->length - *offset)
+            take = buffer->length - *offset;
+        UA_Byte *data = (UA_Byte*)UA_realloc(chunk->data, chunk->length + take);
+        UA_CHECK_MEM(data, return UA_STATUSCODE_BADOUTOFMEMORY);
+        memcpy(&data[chunk->length], &buffer->data[*offset], take);
+        chunk->data = data;
+        chunk->length += take;
+        *offset += take;
+
+        if(chunk->length == target &&
+           target > UA_SECURECHANNEL_MESSAGEHEADER_LENGTH) {
+            *complete = true;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 /* Processes chunks and puts them into the payloads queue. Once a final chunk is
  * put into the queue, the message is assembled and the callback is called. The
  * queue will be cleared for the next message. */
@@ -938,25 +1026,34 @@ UA_SecureChannel_processBuffer(UA_SecureChannel *channel, void *application,
                                UA_ProcessMessageCallback callback,
                                const UA_ByteString *buffer,
                                UA_DateTime nowMonotonic) {
-    /* Prepend the incomplete last chunk. This is usually done in the
-     * networklayer. But we test for a buffered incomplete chunk here again to
-     * work around "lazy" network layers. */
+    /* Complete the buffered half-received chunk with the first bytes of the
+     * buffer. This is usually done in the networklayer. But we test for a
+     * buffered incomplete chunk here again to work around "lazy" network
+     * layers. The remaining buffer is processed in place. */
+    size_t offset = 0;
+    UA_Boolean done = false;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
     UA_ByteString appended = channel->incompleteChunk;
     if(appended.length > 0) {
         channel->incompleteChunk = UA_BYTESTRING_NULL;
-        UA_Byte *t = (UA_Byte*)UA_realloc(appended.data, appended.length + buffer->length);
-        UA_CHECK_MEM(t, UA_ByteString_clear(&appended);
-                     return UA_STATUSCODE_BADOUTOFMEMORY);
-        memcpy(&t[appended.length], buffer->data, buffer->length);
-        appended.data = t;
-        appended.length += buffer->length;
-        buffer = &appended;
+        UA_Boolean complete;
+        res = appendIncompleteChunk(channel, &appended, buffer, &offset, &complete);
+        UA_CHECK_STATUS(res, goto cleanup);
+
+        /* Still incomplete. Wait for the next buffer. */
+        if(!complete) {
+            channel->incompleteChunk = appended;
+            return UA_STATUSCODE_GOOD;
+        }
+
+        /* Extract the completed chunk */
+        size_t appendedOffset = 0;
+        res = extractCompleteChunk(channel, &appended, &appendedOffset, &done);
+        UA_CHECK_STATUS(res, goto cleanup);
+        UA_assert(!done && appendedOffset == appended.length);
     }
 
     /* Loop over the received chunks */
-    size_t offset = 0;
-    UA_Boolean done = false;
-    UA_StatusCode res;
     while(!done) {
         res = extractCompleteChunk(channel, buffer, &offset, &done);
         UA_CHECK_STATUS(res, goto cleanup);
@@ -152,9 +152,23 @@ struct UA_SecureChannel {
     UA_ByteString incompleteChunk; /* A half-received chunk (TCP is a
                                     * streaming protocol) is stored here */
 
+    /* The decoded requests are allocated from the arena (only used in the
+     * server). It is reset once the response was sent. */
+    UA_Arena requestArena;
+
     UA_CertificateGroup *certificateVerification;
     UA_StatusCode (*processOPNHeader)(void *application, UA_SecureChannel *channel,
                                       const UA_AsymmetricAlgorithmSecurityHeader *asymHeader);
+
+#if UA_MULTITHREADING >= 100
+    /* If set, the lock is held when UA_SecureChannel_processBuffer is called.
+     * The lock is released while symmetric chunks are decrypted and verified
+     * and while the ProcessMessageCallback executes. So the receive side of
+     * several channels can be processed in parallel. The keys must not be
+     * revolved from another thread while decrypting is set. */
+    UA_Lock *processLock;
+    UA_Boolean decrypting;
+#endif
 };
 
 void UA_SecureChannel_init(UA_SecureChannel *channel);
@@ -269,17 +283,25 @@ UA_MessageContext_abort(UA_MessageContext *mc);
  * Receive Message
  * --------------- */
 
+/* The message body is passed as an array of slices, the payloads of its
+ * chunks. Only MSG messages can have more than one slice. Use
+ * UA_decodeBinarySlicesInternal to decode across the slices. */
 typedef UA_StatusCode
 (UA_ProcessMessageCallback)(void *application, UA_SecureChannel *channel,
                             UA_MessageType messageType, UA_UInt32 requestId,
-                            UA_ByteString *message);
+                            UA_ByteString *message, size_t slicesSize);
 
 /* Process a received buffer. The callback function is called with the message
  * body if the message is complete. The message is removed afterwards. Returns
- * if an irrecoverable error occured.
+ * if an irrecoverable error occured. Chunks are not copied out of the buffer
+ * unless they are still needed after the call. Multi-chunk messages are not
+ * concatenated.
  *
  * Note that only MSG and CLO messages are decrypted. HEL/ACK/OPN/... are
- * forwarded verbatim to the application. */
+ * forwarded verbatim to the application.
+ *
+ * With a processLock configured in the channel, the callback is executed
+ * without the lock. */
 UA_StatusCode
 UA_SecureChannel_processBuffer(UA_SecureChannel *channel, void *application,
                                UA_ProcessMessageCallback callback,
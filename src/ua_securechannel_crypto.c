@@ -573,6 +573,12 @@ UA_SecureChannel_checkTimeout(UA_SecureChannel *channel, UA_DateTime nowMonotoni
      * secure outgoing Messages until the SecurityToken expires or the
      * Server receives a Message secured with a new SecurityToken.*/
     if(timeout < nowMonotonic && channel->renewState == UA_SECURECHANNELRENEWSTATE_NEWTOKEN_SERVER) {
+#if UA_MULTITHREADING >= 100
+        /* The remote keys are in use. Try again with the next check. */
+        if(channel->decrypting)
+            return false;
+#endif
+
         /* Revolve the token manually. This is otherwise done in checkSymHeader. */
         channel->renewState = UA_SECURECHANNELRENEWSTATE_NORMAL;
         channel->securityToken = channel->altSecurityToken;
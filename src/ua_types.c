@@ -60,17 +60,136 @@ expandedNodeIdOrder(const UA_ExpandedNodeId *p1, const UA_ExpandedNodeId *p2,
 static UA_Order
 guidOrder(const UA_Guid *p1, const UA_Guid *p2, const UA_DataType *_);
 
+/******************/
+/* DataType Index */
+/******************/
+
+static const UA_NodeId *
+indexedId(const UA_DataType *type, UA_Boolean binary) {
+    return (binary) ? &type->binaryEncodingId : &type->typeId;
+}
+
+/* The first entry for a NodeId is kept */
+static void
+indexInsert(const UA_DataType **table, size_t mask,
+            const UA_DataType *type, UA_Boolean binary) {
+    const UA_NodeId *id = indexedId(type, binary);
+    size_t i = UA_NodeId_hash(id) & mask;
+    while(table[i]) {
+        if(UA_NodeId_equal(indexedId(table[i], binary), id))
+            return;
+        i = (i + 1) & mask;
+    }
+    table[i] = type;
+}
+
+static const UA_DataType *
+indexFind(const UA_DataType **table, size_t mask,
+          const UA_NodeId *id, UA_Boolean binary) {
+    size_t i = UA_NodeId_hash(id) & mask;
+    for(const UA_DataType *type = table[i]; type; type = table[i]) {
+        if(UA_NodeId_equal(indexedId(type, binary), id))
+            return type;
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+UA_StatusCode
+UA_DataTypeIndex_init(UA_DataTypeIndex *index, UA_Boolean withBuiltin,
+                      const UA_DataTypeArray *customTypes) {
+    memset(index, 0, sizeof(UA_DataTypeIndex));
+
+    /* Keep the fill ratio below 50% */
+    size_t count = (withBuiltin) ? UA_TYPES_COUNT : 0;
+    for(const UA_DataTypeArray *ct = customTypes; ct; ct = ct->next)
+        count += ct->typesSize;
+    size_t size = 16;
+    while(size < 2 * count)
+        size <<= 1;
+
+    const UA_DataType **tables = (const UA_DataType **)
+        UA_calloc(2 * size, sizeof(const UA_DataType *));
+    if(!tables)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    index->mask = size - 1;
+    index->byTypeId = tables;
+    index->byBinaryId = &tables[size];
+
+    /* Insert in the order of the linear search */
+    for(size_t i = 0; withBuiltin && i < UA_TYPES_COUNT; i++) {
+        indexInsert(index->byTypeId, index->mask, &UA_TYPES[i], false);
+        indexInsert(index->byBinaryId, index->mask, &UA_TYPES[i], true);
+    }
+    for(const UA_DataTypeArray *ct = customTypes; ct; ct = ct->next) {
+        for(size_t i = 0; i < ct->typesSize; i++) {
+            indexInsert(index->byTypeId, index->mask, &ct->types[i], false);
+            indexInsert(index->byBinaryId, index->mask, &ct->types[i], true);
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_DataTypeIndex_clear(UA_DataTypeIndex *index) {
+    UA_free((void*)index->byTypeId); /* Both tables in one allocation */
+    memset(index, 0, sizeof(UA_DataTypeIndex));
+}
+
+const UA_DataType *
+UA_DataTypeIndex_findTypeId(const UA_DataTypeIndex *index,
+                            const UA_NodeId *typeId) {
+    return indexFind(index->byTypeId, index->mask, typeId, false);
+}
+
+const UA_DataType *
+UA_DataTypeIndex_findBinary(const UA_DataTypeIndex *index,
+                            const UA_NodeId *binaryEncodingId) {
+    return indexFind(index->byBinaryId, index->mask, binaryEncodingId, true);
+}
+
+static UA_DataTypeIndex * volatile builtinIndex = NULL;
+
+const UA_DataTypeIndex *
+UA_DataTypeIndex_builtin(void) {
+    UA_DataTypeIndex *index = builtinIndex;
+    if(UA_LIKELY(index != NULL))
+        return index;
+
+    /* Create the index. If another thread was faster, use its index. */
+    index = (UA_DataTypeIndex*)UA_malloc(sizeof(UA_DataTypeIndex));
+    if(!index)
+        return NULL;
+    if(UA_DataTypeIndex_init(index, true, NULL) != UA_STATUSCODE_GOOD) {
+        UA_free(index);
+        return NULL;
+    }
+    UA_DataTypeIndex *other = (UA_DataTypeIndex*)
+        UA_atomic_cmpxchg((void * volatile *)&builtinIndex, NULL, index);
+    if(other) {
+        UA_DataTypeIndex_clear(index);
+        UA_free(index);
+        return other;
+    }
+    return index;
+}
+
 const UA_DataType *
 UA_findDataTypeWithCustom(const UA_NodeId *typeId,
                           const UA_DataTypeArray *customTypes) {
     /* Always look in built-in types first (may contain data types from all
-     * namespaces).
-     *
-     * TODO: The standard-defined types are ordered. See if binary search is
-     * more efficient. */
-    for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-        if(nodeIdOrder(&UA_TYPES[i].typeId, typeId, NULL) == UA_ORDER_EQ)
-            return &UA_TYPES[i];
+     * namespaces). Fall back to the linear search if the index could not be
+     * created. */
+    const UA_DataTypeIndex *index = UA_DataTypeIndex_builtin();
+    if(UA_LIKELY(index != NULL)) {
+        const UA_DataType *type = UA_DataTypeIndex_findTypeId(index, typeId);
+        if(type)
+            return type;
+    } else {
+        for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
+            if(nodeIdOrder(&UA_TYPES[i].typeId, typeId, NULL) == UA_ORDER_EQ)
+                return &UA_TYPES[i];
+        }
     }
 
     /* Search in the customTypes */
@@ -700,12 +819,55 @@ UA_ExtensionObject_setValueCopy(UA_ExtensionObject *eo,
 }
 
 /* Variant */
+
+/* Shared variant data is preceded by a header with the reference count. The
+ * header is padded to keep the alignment of malloc for the data. */
+typedef union {
+    volatile uint32_t refCount;
+    UA_Double alignDouble;
+    UA_UInt64 alignInt;
+    void *alignPtr;
+} VariantSharedHeader;
+
+#define VARIANT_SHARED_HEADER(data)                                     \
+    ((VariantSharedHeader*)((uintptr_t)(data) - sizeof(VariantSharedHeader)))
+
+static size_t
+Variant_dataLength(const UA_Variant *v) {
+    return (v->arrayLength == 0) ? 1 : v->arrayLength;
+}
+
+/* Release one reference. The last reference clears the members and frees the
+ * buffer. */
+static void
+Variant_releaseShared(UA_Variant *p) {
+    VariantSharedHeader *h = VARIANT_SHARED_HEADER(p->data);
+    if(UA_atomic_subUInt32(&h->refCount, 1) > 0)
+        return;
+    if(!p->type->pointerFree) {
+        size_t length = Variant_dataLength(p);
+        uintptr_t ptr = (uintptr_t)p->data;
+        for(size_t i = 0; i < length; ++i) {
+            UA_clear((void*)ptr, p->type);
+            ptr += p->type->memSize;
+        }
+    }
+    UA_free(h);
+}
+
 static void
 Variant_clear(UA_Variant *p, const UA_DataType *_) {
     /* The content is "borrowed" */
     if(p->storageType == UA_VARIANT_DATA_NODELETE)
         return;
 
+    /* Release the shared data. The array dimensions are owned by every copy
+     * of the variant. */
+    if(p->storageType == UA_VARIANT_DATA_SHARED) {
+        Variant_releaseShared(p);
+        p->data = NULL;
+    }
+
     /* Delete the value */
     if(p->type && p->data > UA_EMPTY_ARRAY_SENTINEL) {
         if(p->arrayLength == 0)
@@ -721,13 +883,20 @@ Variant_clear(UA_Variant *p, const UA_DataType *_) {
 
 static UA_StatusCode
 Variant_copy(UA_Variant const *src, UA_Variant *dst, const UA_DataType *_) {
-    size_t length = src->arrayLength;
-    if(UA_Variant_isScalar(src))
-        length = 1;
-    UA_StatusCode retval = UA_Array_copy(src->data, length,
-                                         &dst->data, src->type);
-    if(retval != UA_STATUSCODE_GOOD)
-        return retval;
+    UA_StatusCode retval;
+    if(src->storageType == UA_VARIANT_DATA_SHARED) {
+        /* Take a reference on the shared data */
+        UA_atomic_addUInt32(&VARIANT_SHARED_HEADER(src->data)->refCount, 1);
+        dst->data = src->data;
+        dst->storageType = UA_VARIANT_DATA_SHARED;
+    } else {
+        size_t length = src->arrayLength;
+        if(UA_Variant_isScalar(src))
+            length = 1;
+        retval = UA_Array_copy(src->data, length, &dst->data, src->type);
+        if(retval != UA_STATUSCODE_GOOD)
+            return retval;
+    }
     dst->arrayLength = src->arrayLength;
     dst->type = src->type;
     if(src->arrayDimensions) {
@@ -786,6 +955,92 @@ UA_Variant_setArrayCopy(UA_Variant *v, const void * UA_RESTRICT array,
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_Variant_makeShared(UA_Variant *v) {
+    /* Already shared or nothing to share */
+    if(v->storageType == UA_VARIANT_DATA_SHARED ||
+       !v->type || v->data <= UA_EMPTY_ARRAY_SENTINEL)
+        return UA_STATUSCODE_GOOD;
+
+    /* Allocate the buffer with the header in front */
+    size_t length = Variant_dataLength(v);
+    VariantSharedHeader *h = (VariantSharedHeader*)
+        UA_malloc(sizeof(VariantSharedHeader) + (length * v->type->memSize));
+    if(UA_UNLIKELY(!h))
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    h->refCount = 1;
+    void *data = (void*)((uintptr_t)h + sizeof(VariantSharedHeader));
+
+    if(v->storageType == UA_VARIANT_DATA) {
+        /* Move the members and free the old array */
+        memcpy(data, v->data, length * v->type->memSize);
+        UA_free(v->data);
+        v->data = data;
+        v->storageType = UA_VARIANT_DATA_SHARED;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Deep-copy the borrowed members and array dimensions */
+    UA_Variant tmp = *v;
+    tmp.data = data;
+    tmp.storageType = UA_VARIANT_DATA_SHARED;
+    tmp.arrayDimensions = NULL;
+    tmp.arrayDimensionsSize = 0;
+    memset(data, 0, length * v->type->memSize);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    uintptr_t src = (uintptr_t)v->data;
+    uintptr_t dst = (uintptr_t)data;
+    for(size_t i = 0; i < length && res == UA_STATUSCODE_GOOD; ++i) {
+        res = UA_copy((void*)src, (void*)dst, v->type);
+        src += v->type->memSize;
+        dst += v->type->memSize;
+    }
+    if(res == UA_STATUSCODE_GOOD && v->arrayDimensionsSize > 0) {
+        res = UA_Array_copy(v->arrayDimensions, v->arrayDimensionsSize,
+                            (void**)&tmp.arrayDimensions,
+                            &UA_TYPES[UA_TYPES_UINT32]);
+        tmp.arrayDimensionsSize = v->arrayDimensionsSize;
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        Variant_clear(&tmp, NULL);
+        return res;
+    }
+    *v = tmp;
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_Variant_makeWritable(UA_Variant *v) {
+    if(v->storageType != UA_VARIANT_DATA_SHARED)
+        return UA_STATUSCODE_GOOD;
+
+    size_t length = Variant_dataLength(v);
+    VariantSharedHeader *h = VARIANT_SHARED_HEADER(v->data);
+    void *data;
+    if(UA_atomic_cmpxchgUInt32(&h->refCount, 1, 0) == 1) {
+        /* The last reference is taken over atomically. No other variant can
+         * release the buffer or take a new reference anymore. Move the members
+         * out of the buffer. */
+        data = UA_malloc(length * v->type->memSize);
+        if(UA_UNLIKELY(!data)) {
+            UA_atomic_addUInt32(&h->refCount, 1);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+        memcpy(data, v->data, length * v->type->memSize);
+        UA_free(h);
+    } else {
+        /* Copy-on-write */
+        UA_StatusCode res = UA_Array_copy(v->data, length, &data, v->type);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        Variant_releaseShared(v);
+    }
+
+    v->data = data;
+    v->storageType = UA_VARIANT_DATA;
+    return UA_STATUSCODE_GOOD;
+}
+
 /* Test if a range is compatible with a variant. This may adjust the upper bound
  * (max) in order to fit the variant. */
 static UA_StatusCode
@@ -1077,6 +1332,11 @@ Variant_setRange(UA_Variant *v, void *array, size_t arraySize,
     if(retval != UA_STATUSCODE_GOOD)
         return retval;
 
+    /* Don't modify data that is shared with other variants */
+    retval = UA_Variant_makeWritable(v);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
     /* Compute the strides */
     size_t count, block, stride, first;
     computeStrides(v, range, &count, &block, &stride, &first);
@@ -1686,7 +1946,12 @@ variantOrder(const UA_Variant *p1, const UA_Variant *p2, const UA_DataType *_) {
         UA_Boolean s2 = UA_Variant_isScalar(p2);
         if(s1 != s2)
             return s1 ? UA_ORDER_LESS : UA_ORDER_MORE;
-        if(s1) {
+        if(p1->data == p2->data) {
+            /* Same (shared) data. Compare the array dimensions below. */
+            if(!s1 && p1->arrayLength != p2->arrayLength)
+                return (p1->arrayLength < p2->arrayLength) ? UA_ORDER_LESS : UA_ORDER_MORE;
+            o = UA_ORDER_EQ;
+        } else if(s1) {
             o = orderJumpTable[p1->type->typeKind](p1->data, p2->data, p1->type);
         } else {
             /* Mismatching array length? */
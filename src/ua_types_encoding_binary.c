@@ -33,7 +33,12 @@
  * Breaking a message up into chunks is integrated with the encoding. When the
  * end of a buffer is reached, a callback is executed that sends the current
  * buffer as a chunk and exchanges the encoding buffer "underneath" the ongoing
- * encoding. This reduces the RAM requirements and unnecessary copying. */
+ * encoding. This reduces the RAM requirements and unnecessary copying.
+ *
+ * Likewise, decoding can read from a message that is split into several
+ * slices (the payloads of the received chunks). The slices are not
+ * concatenated. Reads that cross the end of a slice are stitched together in a
+ * small buffer. Strings and arrays are copied directly from the slices. */
 
 /* Part 6 §5.1.5: Decoders shall support at least 100 nesting levels */
 #define UA_ENCODING_MAX_RECURSION 100
@@ -49,6 +54,22 @@ typedef struct {
     const UA_DataTypeArray *customTypes;
     UA_exchangeEncodeBuffer exchangeBufferCallback;
     void *exchangeBufferCallbackHandle;
+
+    /* Decoding allocates from the arena if it is set */
+    UA_Arena *arena;
+
+    /* Decoding from slices. The decoding continues at nextOffset in nextSlice
+     * when the end of the current slice is reached. restLength counts the
+     * bytes that remain after the current slice. */
+    const UA_ByteString *nextSlice;
+    size_t nextOffset;
+    size_t restLength;
+    u8 stitch[8];
+
+    /* Index for the custom types. Created during decoding when many
+     * ExtensionObjects have a non-builtin type. */
+    size_t customLookups;
+    UA_DataTypeIndex customIndex;
 } Ctx;
 
 typedef status
@@ -79,6 +100,149 @@ typedef status
 extern const encodeBinarySignature encodeBinaryJumpTable[UA_DATATYPEKINDS];
 extern const decodeBinarySignature decodeBinaryJumpTable[UA_DATATYPEKINDS];
 
+/* Allocate memory for decoding. The memory is taken from the arena if one is
+ * configured. */
+static void *
+decodeCalloc(Ctx *ctx, size_t nelem, size_t elsize) {
+    if(ctx->arena)
+        return UA_Arena_calloc(ctx->arena, nelem, elsize);
+    return UA_calloc(nelem, elsize);
+}
+
+/* Values decoded into the arena are released with the arena */
+static void
+decodeClear(Ctx *ctx, void *p, const UA_DataType *type) {
+    if(!ctx->arena)
+        UA_clear(p, type);
+}
+
+/* Remaining bytes for decoding */
+static UA_INLINE size_t
+decodeRemaining(const Ctx *ctx) {
+    return (size_t)(ctx->end - ctx->pos) + ctx->restLength;
+}
+
+/* Make n contiguous bytes available at ctx->pos. Called when the current slice
+ * has less than n bytes left. Bytes that are split across slices are copied
+ * into the stitch buffer. Exactly n bytes are stitched, so that the stitch
+ * buffer is used up by the read that follows. */
+static UA_Boolean
+decodeEnsure(Ctx *ctx, size_t n) {
+    UA_assert(n <= sizeof(ctx->stitch));
+    size_t have = (size_t)(ctx->end - ctx->pos);
+    if(have + ctx->restLength < n)
+        return false;
+
+    /* Continue in the next non-empty slice */
+    if(have == 0) {
+        while(have == 0) {
+            ctx->pos = &ctx->nextSlice->data[ctx->nextOffset];
+            ctx->end = &ctx->nextSlice->data[ctx->nextSlice->length];
+            have = (size_t)(ctx->end - ctx->pos);
+            ctx->nextSlice++;
+            ctx->nextOffset = 0;
+        }
+        ctx->restLength -= have;
+        if(have >= n)
+            return true;
+    }
+
+    /* Stitch the bytes together */
+    memmove(ctx->stitch, ctx->pos, have);
+    while(have < n) {
+        const UA_ByteString *slice = ctx->nextSlice;
+        size_t take = slice->length - ctx->nextOffset;
+        if(take > n - have)
+            take = n - have;
+        if(take > 0) /* Empty slices can have a NULL pointer */
+            memcpy(&ctx->stitch[have], &slice->data[ctx->nextOffset], take);
+        have += take;
+        ctx->nextOffset += take;
+        ctx->restLength -= take;
+        if(ctx->nextOffset == slice->length) {
+            ctx->nextSlice++;
+            ctx->nextOffset = 0;
+        }
+    }
+    ctx->pos = ctx->stitch;
+    ctx->end = &ctx->stitch[n];
+    return true;
+}
+
+/* Copy n bytes to dst (if not NULL) and advance across the slices */
+static UA_Boolean
+decodeCopy(Ctx *ctx, u8 *dst, size_t n) {
+    if(decodeRemaining(ctx) < n)
+        return false;
+    while(n > 0) {
+        size_t have = (size_t)(ctx->end - ctx->pos);
+        if(have == 0) {
+            decodeEnsure(ctx, 1);
+            continue;
+        }
+        if(have > n)
+            have = n;
+        if(dst) {
+            memcpy(dst, ctx->pos, have);
+            dst += have;
+        }
+        ctx->pos += have;
+        n -= have;
+    }
+    return true;
+}
+
+/* Compare the next n bytes with data and advance. The caller checks that
+ * enough bytes remain. */
+static UA_Boolean
+decodeEqual(Ctx *ctx, const u8 *data, size_t n) {
+    UA_assert(decodeRemaining(ctx) >= n);
+    while(n > 0) {
+        size_t have = (size_t)(ctx->end - ctx->pos);
+        if(have == 0) {
+            decodeEnsure(ctx, 1);
+            continue;
+        }
+        if(have > n)
+            have = n;
+        if(memcmp(ctx->pos, data, have) != 0)
+            return false;
+        ctx->pos += have;
+        data += have;
+        n -= have;
+    }
+    return true;
+}
+
+/* Position in the slices to return to */
+typedef struct {
+    u8 *pos;
+    const u8 *end;
+    const UA_ByteString *nextSlice;
+    size_t nextOffset;
+    size_t restLength;
+} DecodePos;
+
+static void
+decodeSavePos(const Ctx *ctx, DecodePos *dp) {
+    dp->pos = ctx->pos;
+    dp->end = ctx->end;
+    dp->nextSlice = ctx->nextSlice;
+    dp->nextOffset = ctx->nextOffset;
+    dp->restLength = ctx->restLength;
+}
+
+/* The stitch buffer is always used up. So a saved position inside the stitch
+ * buffer is at its end and the decoding continues in the next slice. */
+static void
+decodeRestorePos(Ctx *ctx, const DecodePos *dp) {
+    ctx->pos = dp->pos;
+    ctx->end = dp->end;
+    ctx->nextSlice = dp->nextSlice;
+    ctx->nextOffset = dp->nextOffset;
+    ctx->restLength = dp->restLength;
+}
+
 /* Send the current chunk and replace the buffer */
 static status exchangeBuffer(Ctx *ctx) {
     if(!ctx->exchangeBufferCallback)
@@ -182,7 +346,8 @@ ENCODE_BINARY(Boolean) {
 }
 
 DECODE_BINARY(Boolean) {
-    UA_CHECK(ctx->pos + 1 <= ctx->end, return UA_STATUSCODE_BADDECODINGERROR);
+    UA_CHECK(ctx->pos + 1 <= ctx->end || decodeEnsure(ctx, 1),
+             return UA_STATUSCODE_BADDECODINGERROR);
     *dst = (*ctx->pos > 0) ? true : false;
     ++ctx->pos;
     return UA_STATUSCODE_GOOD;
@@ -198,7 +363,7 @@ ENCODE_BINARY(Byte) {
 }
 
 DECODE_BINARY(Byte) {
-    UA_CHECK(ctx->pos + sizeof(u8) <= ctx->end,
+    UA_CHECK(ctx->pos + sizeof(u8) <= ctx->end || decodeEnsure(ctx, sizeof(u8)),
              return UA_STATUSCODE_BADDECODINGERROR);
     *dst = *ctx->pos;
     ++ctx->pos;
@@ -219,7 +384,7 @@ ENCODE_BINARY(UInt16) {
 }
 
 DECODE_BINARY(UInt16) {
-    UA_CHECK(ctx->pos + sizeof(u16) <= ctx->end,
+    UA_CHECK(ctx->pos + sizeof(u16) <= ctx->end || decodeEnsure(ctx, sizeof(u16)),
              return UA_STATUSCODE_BADDECODINGERROR);
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u16));
@@ -244,7 +409,7 @@ ENCODE_BINARY(UInt32) {
 }
 
 DECODE_BINARY(UInt32) {
-    UA_CHECK(ctx->pos + sizeof(u32) <= ctx->end,
+    UA_CHECK(ctx->pos + sizeof(u32) <= ctx->end || decodeEnsure(ctx, sizeof(u32)),
              return UA_STATUSCODE_BADDECODINGERROR);
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u32));
@@ -269,7 +434,7 @@ ENCODE_BINARY(UInt64) {
 }
 
 DECODE_BINARY(UInt64) {
-    UA_CHECK(ctx->pos + sizeof(u64) <= ctx->end,
+    UA_CHECK(ctx->pos + sizeof(u64) <= ctx->end || decodeEnsure(ctx, sizeof(u64)),
              return UA_STATUSCODE_BADDECODINGERROR);
 #if UA_BINARY_OVERLAYABLE_INTEGER
     memcpy(dst, ctx->pos, sizeof(u64));
@@ -425,6 +590,124 @@ Array_encodeBinaryOverlayable(uintptr_t ptr, size_t memSize, Ctx *ctx) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Numeric arrays that are not overlayable are converted in bulk. The elements
+ * are converted in a tight loop that the compiler can vectorize. Returns the
+ * width of the encoded elements. Or zero if every element is encoded on its
+ * own. Integer types are overlayable on little-endian platforms. Then only
+ * Boolean arrays (normalized to 0/1 during decoding) use the bulk conversion. */
+static u8
+Array_bulkWidth(const UA_DataType *type) {
+    switch(type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN:
+        return 1;
+#if !UA_BINARY_OVERLAYABLE_INTEGER
+    case UA_DATATYPEKIND_INT16:
+    case UA_DATATYPEKIND_UINT16:
+        return 2;
+    case UA_DATATYPEKIND_INT32:
+    case UA_DATATYPEKIND_UINT32:
+    case UA_DATATYPEKIND_STATUSCODE:
+        return 4;
+    case UA_DATATYPEKIND_ENUM:
+        return (type->memSize == sizeof(u32)) ? 4 : 0;
+    case UA_DATATYPEKIND_INT64:
+    case UA_DATATYPEKIND_UINT64:
+    case UA_DATATYPEKIND_DATETIME:
+        return 8;
+# if (UA_FLOAT_IEEE754 == 1) && (UA_LITTLE_ENDIAN == UA_FLOAT_LITTLE_ENDIAN)
+    case UA_DATATYPEKIND_FLOAT:
+        return 4;
+    case UA_DATATYPEKIND_DOUBLE:
+        return 8;
+# endif
+#endif
+    default:
+        return 0;
+    }
+}
+
+static void
+Array_encodeBulk(const u8 *UA_RESTRICT src, u8 *UA_RESTRICT dst, size_t length,
+                 const UA_DataType *type, u8 width) {
+    switch(width) {
+#if !UA_BINARY_OVERLAYABLE_INTEGER
+    case 2:
+        for(size_t i = 0; i < length; i++)
+            UA_encode16(((const u16*)src)[i], &dst[i * 2]);
+        break;
+    case 4:
+        for(size_t i = 0; i < length; i++)
+            UA_encode32(((const u32*)src)[i], &dst[i * 4]);
+        break;
+    case 8:
+        for(size_t i = 0; i < length; i++)
+            UA_encode64(((const u64*)src)[i], &dst[i * 8]);
+        break;
+#endif
+    default: /* Boolean */
+        for(size_t i = 0; i < length; i++)
+            dst[i] = src[i * type->memSize];
+        break;
+    }
+}
+
+static void
+Array_decodeBulk(const u8 *UA_RESTRICT src, u8 *UA_RESTRICT dst, size_t length,
+                 const UA_DataType *type, u8 width) {
+    (void)type;
+    switch(width) {
+#if !UA_BINARY_OVERLAYABLE_INTEGER
+    case 2:
+        for(size_t i = 0; i < length; i++)
+            UA_decode16(&src[i * 2], &((u16*)dst)[i]);
+        break;
+    case 4:
+        for(size_t i = 0; i < length; i++)
+            UA_decode32(&src[i * 4], &((u32*)dst)[i]);
+        break;
+    case 8:
+        for(size_t i = 0; i < length; i++)
+            UA_decode64(&src[i * 8], &((u64*)dst)[i]);
+        break;
+#endif
+    default: /* Boolean */
+        for(size_t i = 0; i < length; i++)
+            ((UA_Boolean*)dst)[i] = (src[i] > 0) ? true : false;
+        break;
+    }
+}
+
+static status
+Array_encodeBinaryBulk(uintptr_t ptr, size_t length, const UA_DataType *type,
+                       u8 width, Ctx *ctx) {
+    /* CalcSize only */
+    if(ctx->end == NULL) {
+        ctx->pos += length * width;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Convert as many elements as fit into the chunk. Then exchange the buffer
+     * and continue. */
+    while(length > 0) {
+        size_t fit = (size_t)(ctx->end - ctx->pos) / width;
+        if(fit == 0) {
+            status ret = exchangeBuffer(ctx);
+            UA_assert(ret != UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);
+            UA_CHECK_STATUS(ret, return ret);
+            fit = (size_t)(ctx->end - ctx->pos) / width;
+            if(fit == 0)
+                return UA_STATUSCODE_BADENCODINGERROR;
+        }
+        if(fit > length)
+            fit = length;
+        Array_encodeBulk((const u8*)ptr, ctx->pos, fit, type, width);
+        ptr += fit * type->memSize;
+        ctx->pos += fit * width;
+        length -= fit;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 static status
 Array_encodeBinaryComplex(uintptr_t ptr, size_t length,
                           const UA_DataType *type, Ctx *ctx) {
@@ -456,8 +739,11 @@ Array_encodeBinary(const void *src, size_t length, const UA_DataType *type, Ctx
 
     /* Encode the content */
     if(length > 0) {
+        u8 width;
         if(type->overlayable)
             ret = Array_encodeBinaryOverlayable((uintptr_t)src, length * type->memSize, ctx);
+        else if((width = Array_bulkWidth(type)) > 0)
+            ret = Array_encodeBinaryBulk((uintptr_t)src, length, type, width, ctx);
         else
             ret = Array_encodeBinaryComplex((uintptr_t)src, length, type, ctx);
     }
@@ -491,26 +777,62 @@ Array_decodeBinary(void *UA_RESTRICT *UA_RESTRICT dst, size_t *out_length,
      * sizeof(UA_DataValue) == 80 and an empty DataValue is encoded with just
      * one byte. We use 128 as the smallest power of 2 larger than 80. */
     size_t length = (size_t)signed_length;
-    UA_CHECK(ctx->pos + ((type->memSize * length) / 128) <= ctx->end,
+    UA_CHECK((type->memSize * length) / 128 <= decodeRemaining(ctx),
              return UA_STATUSCODE_BADDECODINGERROR);
 
     /* Allocate memory */
-    *dst = UA_calloc(length, type->memSize);
+    *dst = decodeCalloc(ctx, length, type->memSize);
     UA_CHECK_MEM(*dst, return UA_STATUSCODE_BADOUTOFMEMORY);
 
     if(type->overlayable) {
         /* memcpy overlayable array */
-        UA_CHECK(ctx->pos + (type->memSize * length) <= ctx->end,
-                 UA_free(*dst); *dst = NULL; return UA_STATUSCODE_BADDECODINGERROR);
-        memcpy(*dst, ctx->pos, type->memSize * length);
-        ctx->pos += type->memSize * length;
+        size_t size = type->memSize * length;
+        if(ctx->pos + size <= ctx->end) {
+            memcpy(*dst, ctx->pos, size);
+            ctx->pos += size;
+        } else if(!decodeCopy(ctx, (u8*)*dst, size)) {
+            if(!ctx->arena)
+                UA_free(*dst);
+            *dst = NULL;
+            return UA_STATUSCODE_BADDECODINGERROR;
+        }
+    } else if(Array_bulkWidth(type) > 0) {
+        /* Convert numeric array. Slice by slice if the message is split. An
+         * element that crosses the end of a slice is stitched together. */
+        u8 width = Array_bulkWidth(type);
+        if(width * length > decodeRemaining(ctx)) {
+            if(!ctx->arena)
+                UA_free(*dst);
+            *dst = NULL;
+            return UA_STATUSCODE_BADDECODINGERROR;
+        }
+        u8 *out = (u8*)*dst;
+        size_t todo = length;
+        while(todo > 0) {
+            size_t fit = (size_t)(ctx->end - ctx->pos) / width;
+            if(fit == 0) {
+                decodeEnsure(ctx, width);
+                fit = 1;
+            }
+            if(fit > todo)
+                fit = todo;
+            Array_decodeBulk(ctx->pos, out, fit, type, width);
+            ctx->pos += width * fit;
+            out += type->memSize * fit;
+            todo -= fit;
+        }
     } else {
         /* Decode array members */
         uintptr_t ptr = (uintptr_t)*dst;
         for(size_t i = 0; i < length; ++i) {
             ret = decodeBinaryJumpTable[type->typeKind]((void*)ptr, type, ctx);
-            UA_CHECK_STATUS(ret, /* +1 because last element is also already initialized */
-                            UA_Array_delete(*dst, i+1, type); *dst = NULL; return ret);
+            if(ret != UA_STATUSCODE_GOOD) {
+                /* +1 because last element is also already initialized */
+                if(!ctx->arena)
+                    UA_Array_delete(*dst, i+1, type);
+                *dst = NULL;
+                return ret;
+            }
             ptr += type->memSize;
         }
     }
@@ -548,7 +870,7 @@ DECODE_BINARY(Guid) {
     ret |= DECODE_DIRECT(&dst->data1, UInt32);
     ret |= DECODE_DIRECT(&dst->data2, UInt16);
     ret |= DECODE_DIRECT(&dst->data3, UInt16);
-    UA_CHECK(ctx->pos + (8*sizeof(u8)) <= ctx->end,
+    UA_CHECK(ctx->pos + (8*sizeof(u8)) <= ctx->end || decodeEnsure(ctx, 8*sizeof(u8)),
              return UA_STATUSCODE_BADDECODINGERROR);
     memcpy(dst->data4, ctx->pos, 8*sizeof(u8));
     ctx->pos += 8;
@@ -707,7 +1029,8 @@ ENCODE_BINARY(ExpandedNodeId) {
 
 DECODE_BINARY(ExpandedNodeId) {
     /* Decode the encoding mask */
-    UA_CHECK(ctx->pos + 1 <= ctx->end, return UA_STATUSCODE_BADDECODINGERROR);
+    UA_CHECK(ctx->pos + 1 <= ctx->end || decodeEnsure(ctx, 1),
+             return UA_STATUSCODE_BADDECODINGERROR);
     u8 encoding = *ctx->pos;
 
     /* Decode the NodeId */
@@ -779,22 +1102,47 @@ DECODE_BINARY(LocalizedText) {
     return ret;
 }
 
+/* Number of custom type lookups with a linear search during decoding before
+ * the index for the custom types is created */
+#define UA_CUSTOMTYPES_INDEX_THRESHOLD 16
+
 /* The binary encoding has a different nodeid from the data type. So it is not
  * possible to reuse UA_findDataType */
 static const UA_DataType *
 UA_findDataTypeByBinaryInternal(const UA_NodeId *typeId, Ctx *ctx) {
     /* Always look in the built-in types first. Assume that only numeric
      * identifiers are used for the builtin types. (They may contain data types
-     * from all namespaces though.) */
+     * from all namespaces though.) Fall back to the linear search if the index
+     * could not be created. */
     if(typeId->identifierType == UA_NODEIDTYPE_NUMERIC) {
-        for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
-            if(UA_TYPES[i].binaryEncodingId.identifier.numeric == typeId->identifier.numeric &&
-               UA_TYPES[i].binaryEncodingId.namespaceIndex == typeId->namespaceIndex)
-                return &UA_TYPES[i];
+        const UA_DataTypeIndex *index = UA_DataTypeIndex_builtin();
+        if(UA_LIKELY(index != NULL)) {
+            const UA_DataType *type = UA_DataTypeIndex_findBinary(index, typeId);
+            if(type)
+                return type;
+        } else {
+            for(size_t i = 0; i < UA_TYPES_COUNT; ++i) {
+                if(UA_TYPES[i].binaryEncodingId.identifier.numeric == typeId->identifier.numeric &&
+                   UA_TYPES[i].binaryEncodingId.namespaceIndex == typeId->namespaceIndex)
+                    return &UA_TYPES[i];
+            }
         }
     }
 
     const UA_DataTypeArray *customTypes = ctx->customTypes;
+    if(!customTypes)
+        return NULL;
+
+    /* Use the index for the custom types. Create it once the linear search was
+     * used often enough during the current decoding. */
+    if(ctx->customIndex.byBinaryId)
+        return UA_DataTypeIndex_findBinary(&ctx->customIndex, typeId);
+    if(ctx->customLookups >= UA_CUSTOMTYPES_INDEX_THRESHOLD &&
+       UA_DataTypeIndex_init(&ctx->customIndex, false,
+                             customTypes) == UA_STATUSCODE_GOOD)
+        return UA_DataTypeIndex_findBinary(&ctx->customIndex, typeId);
+    ctx->customLookups++;
+
     while(customTypes) {
         for(size_t i = 0; i < customTypes->typesSize; ++i) {
             if(UA_NodeId_equal(typeId, &customTypes->types[i].binaryEncodingId))
@@ -857,14 +1205,36 @@ ENCODE_BINARY(ExtensionObject) {
 
     const UA_DataType *contentType = src->content.decoded.type;
 
-    /* Compute the content length. But only if we are not already in the
-     * calcSizeBinary mode. This is avoids recursive cycles.*/
-    i32 signed_len = 0;
-    if(ctx->end != NULL) {
-        size_t len = UA_calcSizeBinary(src->content.decoded.data, contentType);
-        UA_CHECK(len <= UA_INT32_MAX, return UA_STATUSCODE_BADENCODINGERROR);
-        signed_len = (i32)len;
+    /* Encode the content into the current buffer first and write the length
+     * field afterwards. This avoids a separate pass to compute the length. If
+     * the content does not fit into the current buffer, reset and compute the
+     * length upfront. Then the buffer can be exchanged during the encoding. */
+    u8 *lenPos = ctx->pos;
+    if(lenPos + 4 <= ctx->end) {
+        UA_exchangeEncodeBuffer exchangeCallback = ctx->exchangeBufferCallback;
+        ctx->exchangeBufferCallback = NULL;
+        ctx->pos += 4;
+        ret = encodeBinaryJumpTable[contentType->typeKind](src->content.decoded.data,
+                                                           contentType, ctx);
+        ctx->exchangeBufferCallback = exchangeCallback;
+        size_t len = (uintptr_t)ctx->pos - (uintptr_t)lenPos - 4;
+        if(ret == UA_STATUSCODE_GOOD && len <= UA_INT32_MAX) {
+            u8 *contentEnd = ctx->pos;
+            i32 signed_len = (i32)len;
+            ctx->pos = lenPos;
+            ret = ENCODE_DIRECT(&signed_len, UInt32); /* Int32 */
+            ctx->pos = contentEnd;
+            return ret;
+        }
+        ctx->pos = lenPos;
     }
+
+    /* The content did not fit. Compute the length with the size-only visitor
+     * and encode it upfront. Then the content is encoded with buffer
+     * exchanges. */
+    size_t len = UA_calcSizeBinary(src->content.decoded.data, contentType);
+    UA_CHECK(len <= UA_INT32_MAX, return UA_STATUSCODE_BADENCODINGERROR);
+    i32 signed_len = (i32)len;
     ret = encodeWithExchangeBuffer(&signed_len, &UA_TYPES[UA_TYPES_INT32], ctx);
     UA_assert(ret != UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);
     UA_CHECK_STATUS(ret, return ret);
@@ -884,17 +1254,20 @@ ExtensionObject_decodeBinaryContent(UA_ExtensionObject *dst, const UA_NodeId *ty
     /* Unknown type, just take the binary content */
     if(!type) {
         dst->encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
-        UA_NodeId_copy(typeId, &dst->content.encoded.typeId);
+        if(ctx->arena)
+            dst->content.encoded.typeId = *typeId; /* Already in the arena */
+        else
+            UA_NodeId_copy(typeId, &dst->content.encoded.typeId);
         return DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
     }
 
+    /* Jump over the length field (TODO: check if the decoded length matches) */
+    UA_CHECK(decodeCopy(ctx, NULL, 4), return UA_STATUSCODE_BADDECODINGERROR);
+
     /* Allocate memory */
-    dst->content.decoded.data = UA_new(type);
+    dst->content.decoded.data = decodeCalloc(ctx, 1, type->memSize);
     UA_CHECK_MEM(dst->content.decoded.data, return UA_STATUSCODE_BADOUTOFMEMORY);
 
-    /* Jump over the length field (TODO: check if the decoded length matches) */
-    ctx->pos += 4;
-
     /* Decode */
     dst->encoding = UA_EXTENSIONOBJECT_DECODED;
     dst->content.decoded.type = type;
@@ -909,12 +1282,13 @@ DECODE_BINARY(ExtensionObject) {
     status ret = UA_STATUSCODE_GOOD;
     ret |= DECODE_DIRECT(&binTypeId, NodeId);
     ret |= DECODE_DIRECT(&encoding, Byte);
-    UA_CHECK_STATUS(ret, UA_NodeId_clear(&binTypeId); return ret);
+    UA_CHECK_STATUS(ret, decodeClear(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
+                    return ret);
 
     switch(encoding) {
     case UA_EXTENSIONOBJECT_ENCODED_BYTESTRING:
         ret = ExtensionObject_decodeBinaryContent(dst, &binTypeId, ctx);
-        UA_NodeId_clear(&binTypeId);
+        decodeClear(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
         break;
     case UA_EXTENSIONOBJECT_ENCODED_NOBODY:
         dst->encoding = (UA_ExtensionObjectEncoding)encoding;
@@ -925,10 +1299,11 @@ DECODE_BINARY(ExtensionObject) {
         dst->encoding = (UA_ExtensionObjectEncoding)encoding;
         dst->content.encoded.typeId = binTypeId; /* move to dst */
         ret = DECODE_DIRECT(&dst->content.encoded.body, String); /* ByteString */
-        UA_CHECK_STATUS(ret, UA_NodeId_clear(&dst->content.encoded.typeId));
+        UA_CHECK_STATUS(ret, decodeClear(ctx, &dst->content.encoded.typeId,
+                                         &UA_TYPES[UA_TYPES_NODEID]));
         break;
     default:
-        UA_NodeId_clear(&binTypeId);
+        decodeClear(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
         ret = UA_STATUSCODE_BADDECODINGERROR;
         break;
     }
@@ -1039,7 +1414,8 @@ static status
 Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     /* Save the position in the ByteString. If unwrapping is not possible, start
      * from here to decode a normal ExtensionObject. */
-    u8 *old_pos = ctx->pos;
+    DecodePos old_pos;
+    decodeSavePos(ctx, &old_pos);
 
     /* Decode the DataType */
     UA_NodeId typeId;
@@ -1050,22 +1426,25 @@ Variant_decodeBinaryUnwrapExtensionObject(UA_Variant *dst, Ctx *ctx) {
     /* Decode the EncodingByte */
     u8 encoding;
     ret = DECODE_DIRECT(&encoding, Byte);
-    UA_CHECK_STATUS(ret, UA_NodeId_clear(&typeId); return ret);
+    UA_CHECK_STATUS(ret, decodeClear(ctx, &typeId, &UA_TYPES[UA_TYPES_NODEID]);
+                    return ret);
 
     /* Search for the datatype. Default to ExtensionObject. */
     if(encoding == UA_EXTENSIONOBJECT_ENCODED_BYTESTRING &&
        (dst->type = UA_findDataTypeByBinaryInternal(&typeId, ctx)) != NULL) {
         /* Jump over the length field (TODO: check if length matches) */
-        ctx->pos += 4;
+        if(!decodeCopy(ctx, NULL, 4))
+            ret = UA_STATUSCODE_BADDECODINGERROR;
     } else {
         /* Reset and decode as ExtensionObject */
         dst->type = &UA_TYPES[UA_TYPES_EXTENSIONOBJECT];
-        ctx->pos = old_pos;
+        decodeRestorePos(ctx, &old_pos);
     }
-    UA_NodeId_clear(&typeId);
+    decodeClear(ctx, &typeId, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_CHECK_STATUS(ret, return ret);
 
     /* Allocate memory */
-    dst->data = UA_new(dst->type);
+    dst->data = decodeCalloc(ctx, 1, dst->type->memSize);
     UA_CHECK_MEM(dst->data, return UA_STATUSCODE_BADOUTOFMEMORY);
 
     /* Decode the content */
@@ -1078,7 +1457,8 @@ static status
 Variant_decodeBinaryUnwrapExtensionObjectArray(void *UA_RESTRICT *UA_RESTRICT dst,
                                                size_t *out_length, const UA_DataType **type,
                                                Ctx *ctx) {
-    u8 *orig_pos = ctx->pos;
+    DecodePos orig_pos;
+    decodeSavePos(ctx, &orig_pos);
 
     /* Decode the length */
     i32 signed_length;
@@ -1101,10 +1481,13 @@ Variant_decodeBinaryUnwrapExtensionObjectArray(void *UA_RESTRICT *UA_RESTRICT ds
      * ExtensionObject is at least 4 byte long (3 byte NodeId + 1 Byte encoding
      * field). */
     size_t length = (size_t)signed_length;
-    UA_CHECK(ctx->pos + ((4 * length) / 32) <= ctx->end,
+    UA_CHECK((4 * length) / 32 <= decodeRemaining(ctx),
              return UA_STATUSCODE_BADDECODINGERROR);
 
     /* Decode the type NodeId of the first member */
+    DecodePos members_pos;
+    decodeSavePos(ctx, &members_pos);
+    size_t remaining = decodeRemaining(ctx);
     UA_NodeId binTypeId;
     UA_NodeId_init(&binTypeId);
     ret |= DECODE_DIRECT(&binTypeId, NodeId);
@@ -1112,10 +1495,10 @@ Variant_decodeBinaryUnwrapExtensionObjectArray(void *UA_RESTRICT *UA_RESTRICT ds
 
     /* Lookup the data type */
     const UA_DataType *contentType = UA_findDataTypeByBinaryInternal(&binTypeId, ctx);
-    UA_NodeId_clear(&binTypeId);
+    decodeClear(ctx, &binTypeId, &UA_TYPES[UA_TYPES_NODEID]);
     if(!contentType) {
         /* DataType unknown, decode as ExtensionObject array */
-        ctx->pos = orig_pos;
+        decodeRestorePos(ctx, &orig_pos);
         return Array_decodeBinary(dst, out_length, *type, ctx);
     }
 
@@ -1126,48 +1509,76 @@ Variant_decodeBinaryUnwrapExtensionObjectArray(void *UA_RESTRICT *UA_RESTRICT ds
     if(encoding != UA_EXTENSIONOBJECT_ENCODED_BYTESTRING) {
         /* Encoding format is not automatically decoded, decode as
          * ExtensionObject array */
-        ctx->pos = orig_pos;
+        decodeRestorePos(ctx, &orig_pos);
         return Array_decodeBinary(dst, out_length, *type, ctx);
     }
 
-    /* Compare the header of all array members if the array can be unwrapped */
-    UA_ByteString header = {(uintptr_t)ctx->pos - (uintptr_t)orig_pos - 4, &orig_pos[4]};
-    UA_ByteString compare_header = header;
-    ctx->pos = &orig_pos[4];
+    /* Copy the header of the first member. It can be split across slices. */
+    u8 headerBuf[32];
+    UA_ByteString header = {remaining - decodeRemaining(ctx), headerBuf};
+    if(header.length > sizeof(headerBuf)) {
+        header.data = (u8*)UA_malloc(header.length);
+        UA_CHECK_MEM(header.data, return UA_STATUSCODE_BADOUTOFMEMORY);
+    }
+    decodeRestorePos(ctx, &members_pos);
+    decodeCopy(ctx, header.data, header.length);
 
+    /* Compare the header of all array members if the array can be unwrapped */
+    decodeRestorePos(ctx, &members_pos);
+    UA_Boolean unwrap = true;
     for(size_t i = 0; i < length; i++) {
-        compare_header.data = ctx->pos;
-        UA_CHECK(compare_header.data + compare_header.length <= ctx->end,
-                 return UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);
-        if(!UA_ByteString_equal(&header, &compare_header)) {
-            /* Different member types, decode as ExtensionObject array */
-            ctx->pos = orig_pos;
-            return Array_decodeBinary(dst, out_length, *type, ctx);
+        if(header.length > decodeRemaining(ctx)) {
+            ret = UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED;
+            goto cleanup;
+        }
+        if(!decodeEqual(ctx, header.data, header.length)) {
+            unwrap = false; /* Different member types */
+            break;
         }
 
         /* Decode the length field and jump to the next element */
-        ctx->pos += header.length;
         u32 member_length = 0;
         ret = DECODE_DIRECT(&member_length, UInt32);
-        UA_CHECK_STATUS(ret, return ret);
-        ctx->pos += member_length;
+        UA_CHECK_STATUS(ret, goto cleanup);
+        if(!decodeCopy(ctx, NULL, member_length)) {
+            ret = UA_STATUSCODE_BADDECODINGERROR;
+            goto cleanup;
+        }
+    }
+
+    /* Decode as ExtensionObject array */
+    if(!unwrap) {
+        decodeRestorePos(ctx, &orig_pos);
+        ret = Array_decodeBinary(dst, out_length, *type, ctx);
+        goto cleanup;
     }
 
     /* Allocate memory for the unwrapped members */
-    *dst = UA_calloc(length, contentType->memSize);
-    UA_CHECK_MEM(*dst, return UA_STATUSCODE_BADOUTOFMEMORY);
+    *dst = decodeCalloc(ctx, length, contentType->memSize);
+    if(!*dst) {
+        ret = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto cleanup;
+    }
     *out_length = length;
     *type = contentType;
 
     /* Decode unwrapped members */
     uintptr_t array_pos = (uintptr_t)*dst;
-    ctx->pos = &orig_pos[4];
+    decodeRestorePos(ctx, &members_pos);
     for(size_t i = 0; i < length && ret == UA_STATUSCODE_GOOD; i++) {
-        ctx->pos += header.length + 4; /* Jump over the header and length field */
+        /* Jump over the header and length field */
+        if(!decodeCopy(ctx, NULL, header.length + 4)) {
+            ret = UA_STATUSCODE_BADDECODINGERROR;
+            break;
+        }
         ret = decodeBinaryJumpTable[contentType->typeKind]
             ((void*)array_pos, contentType, ctx);
         array_pos += contentType->memSize;
     }
+
+ cleanup:
+    if(header.data != headerBuf)
+        UA_free(header.data);
     return ret;
 }
 
@@ -1206,7 +1617,7 @@ DECODE_BINARY(Variant) {
     if(!isArray) {
         /* Decode scalar */
         if(typeKind != UA_DATATYPEKIND_EXTENSIONOBJECT) {
-            dst->data = UA_new(dst->type);
+            dst->data = decodeCalloc(ctx, 1, dst->type->memSize);
             UA_CHECK_MEM(dst->data, ctx->depth--; return UA_STATUSCODE_BADOUTOFMEMORY);
             ret = decodeBinaryJumpTable[typeKind](dst->data, dst->type, ctx);
         } else {
@@ -1394,7 +1805,7 @@ DECODE_BINARY(DiagnosticInfo) {
     if(encodingMask & 0x40u) {
         /* innerDiagnosticInfo is allocated on the heap */
         dst->innerDiagnosticInfo = (UA_DiagnosticInfo*)
-            UA_calloc(1, sizeof(UA_DiagnosticInfo));
+            decodeCalloc(ctx, 1, sizeof(UA_DiagnosticInfo));
         UA_CHECK_MEM(dst->innerDiagnosticInfo, return UA_STATUSCODE_BADOUTOFMEMORY);
         dst->hasInnerDiagnosticInfo = true;
 
@@ -1413,8 +1824,66 @@ DECODE_BINARY(DiagnosticInfo) {
 /* Structured Types */
 /********************/
 
+#ifdef UA_ENABLE_PRECOMPILED_BINARY_ENCODING
+
+/* The structures in UA_TYPES have generated en-/decoding functions that call
+ * the functions for the members directly instead of interpreting the member
+ * description. They are defined in types_generated_encoding_binary.h that is
+ * included at the end of this file. Returns NULL for types that are not
+ * precompiled. */
+static encodeBinarySignature getPrecompiledEncoder(const UA_DataType *type);
+static decodeBinarySignature getPrecompiledDecoder(const UA_DataType *type);
+
+/* Helper macros for the generated functions */
+#define PRECOMPILED_BEGIN                                           \
+    (void)type;                                                     \
+    UA_CHECK(ctx->depth <= UA_ENCODING_MAX_RECURSION,               \
+             return UA_STATUSCODE_BADENCODINGERROR);                \
+    ctx->depth++;                                                   \
+    status ret = UA_STATUSCODE_GOOD
+
+#define PRECOMPILED_END                                             \
+    ctx->depth--;                                                   \
+    return ret
+
+/* Same as encodeWithExchangeBuffer with a direct call */
+#define ENCODE_MEMBER(FUNC, SRC, TYPE)                              \
+    if(UA_LIKELY(ret == UA_STATUSCODE_GOOD)) {                      \
+        u8 *oldpos = ctx->pos;                                      \
+        ret = FUNC(SRC, TYPE, ctx);                                 \
+        if(ret == UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED) {        \
+            ctx->pos = oldpos;                                      \
+            ret = exchangeBuffer(ctx);                              \
+            if(ret == UA_STATUSCODE_GOOD)                           \
+                ret = FUNC(SRC, TYPE, ctx);                         \
+        }                                                           \
+        UA_assert(ret != UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);  \
+    }
+
+#define ENCODE_MEMBER_ARRAY(SRC, LENGTH, TYPE)                      \
+    if(UA_LIKELY(ret == UA_STATUSCODE_GOOD)) {                      \
+        ret = Array_encodeBinary(SRC, LENGTH, TYPE, ctx);           \
+        UA_assert(ret != UA_STATUSCODE_BADENCODINGLIMITSEXCEEDED);  \
+    }
+
+#define DECODE_MEMBER(FUNC, DST, TYPE)                              \
+    if(UA_LIKELY(ret == UA_STATUSCODE_GOOD))                        \
+        ret = FUNC(DST, TYPE, ctx)
+
+#define DECODE_MEMBER_ARRAY(DST, LENGTH, TYPE)                      \
+    if(UA_LIKELY(ret == UA_STATUSCODE_GOOD))                        \
+        ret = Array_decodeBinary((void *UA_RESTRICT *UA_RESTRICT)DST, LENGTH, TYPE, ctx)
+
+#endif /* UA_ENABLE_PRECOMPILED_BINARY_ENCODING */
+
 static status
 encodeBinaryStruct(const void *src, const UA_DataType *type, Ctx *ctx) {
+#ifdef UA_ENABLE_PRECOMPILED_BINARY_ENCODING
+    encodeBinarySignature precompiled = getPrecompiledEncoder(type);
+    if(precompiled)
+        return precompiled(src, type, ctx);
+#endif
+
     /* Check the recursion limit */
     UA_CHECK(ctx->depth <= UA_ENCODING_MAX_RECURSION,
              return UA_STATUSCODE_BADENCODINGERROR);
@@ -1664,6 +2133,12 @@ decodeBinaryNotImplemented(void *dst, const UA_DataType *type, Ctx *ctx) {
 
 static status
 decodeBinaryStructure(void *dst, const UA_DataType *type, Ctx *ctx) {
+#ifdef UA_ENABLE_PRECOMPILED_BINARY_ENCODING
+    decodeBinarySignature precompiled = getPrecompiledDecoder(type);
+    if(precompiled)
+        return precompiled(dst, type, ctx);
+#endif
+
     /* Check the recursion limit */
     UA_CHECK(ctx->depth <= UA_ENCODING_MAX_RECURSION,
              return UA_STATUSCODE_BADENCODINGERROR);
@@ -1725,7 +2200,7 @@ decodeBinaryStructureWithOptFields(void *dst, const UA_DataType *type, Ctx *ctx)
                 ret = Array_decodeBinary((void *UA_RESTRICT *UA_RESTRICT)ptr, length, mt , ctx);
             } else {
                 /* Optional Scalar */
-                *(void *UA_RESTRICT *UA_RESTRICT) ptr = UA_calloc(1, mt->memSize);
+                *(void *UA_RESTRICT *UA_RESTRICT) ptr = decodeCalloc(ctx, 1, mt->memSize);
                 UA_CHECK_MEM(*(void *UA_RESTRICT *UA_RESTRICT) ptr, return UA_STATUSCODE_BADOUTOFMEMORY);
                 ret = decodeBinaryJumpTable[mt->typeKind](*(void *UA_RESTRICT *UA_RESTRICT) ptr, mt, ctx);
             }
@@ -1821,32 +2296,86 @@ const decodeBinarySignature decodeBinaryJumpTable[UA_DATATYPEKINDS] = {
     (decodeBinarySignature)decodeBinaryNotImplemented /* BitfieldCluster */
 };
 
-status
-UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
-                        void *dst, const UA_DataType *type,
-                        const UA_DataTypeArray *customTypes) {
-    /* Set up the context */
-    Ctx ctx;
-    ctx.pos = &src->data[*offset];
-    ctx.end = &src->data[src->length];
-    ctx.depth = 0;
-    ctx.customTypes = customTypes;
+static status
+decodeBinaryWithCtx(const UA_ByteString *slices, size_t slicesSize, size_t *offset,
+                    void *dst, const UA_DataType *type, Ctx *ctx) {
+    UA_assert(slicesSize > 0);
+    ctx->pos = &slices[0].data[*offset];
+    ctx->end = &slices[0].data[slices[0].length];
+    ctx->nextSlice = &slices[1];
+    ctx->nextOffset = 0;
+    ctx->restLength = 0;
+    ctx->depth = 0;
+    ctx->customLookups = 0;
+    memset(&ctx->customIndex, 0, sizeof(UA_DataTypeIndex));
+
+    /* Start in a later slice if the offset is beyond the first slice */
+    size_t remaining = 0;
+    if(slicesSize > 1) {
+        for(size_t i = 1; i < slicesSize; i++)
+            ctx->restLength += slices[i].length;
+        if(*offset > slices[0].length) {
+            ctx->pos = &slices[0].data[slices[0].length];
+            if(!decodeCopy(ctx, NULL, *offset - slices[0].length))
+                return UA_STATUSCODE_BADDECODINGERROR;
+        }
+        remaining = decodeRemaining(ctx);
+    }
 
     /* Decode */
     memset(dst, 0, type->memSize); /* Initialize the value */
-    status ret = decodeBinaryJumpTable[type->typeKind](dst, type, &ctx);
+    status ret = decodeBinaryJumpTable[type->typeKind](dst, type, ctx);
 
     if(UA_LIKELY(ret == UA_STATUSCODE_GOOD)) {
         /* Set the new offset */
-        *offset = (size_t)(ctx.pos - src->data) / sizeof(u8);
+        if(slicesSize > 1)
+            *offset += remaining - decodeRemaining(ctx);
+        else
+            *offset = (size_t)(ctx->pos - slices[0].data) / sizeof(u8);
     } else {
         /* Clean up */
-        UA_clear(dst, type);
+        decodeClear(ctx, dst, type);
         memset(dst, 0, type->memSize);
     }
+
+    /* The decoded value points into the custom types, not into the index */
+    if(ctx->customIndex.byBinaryId)
+        UA_DataTypeIndex_clear(&ctx->customIndex);
     return ret;
 }
 
+status
+UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
+                        void *dst, const UA_DataType *type,
+                        const UA_DataTypeArray *customTypes) {
+    Ctx ctx;
+    ctx.customTypes = customTypes;
+    ctx.arena = NULL;
+    return decodeBinaryWithCtx(src, 1, offset, dst, type, &ctx);
+}
+
+status
+UA_decodeBinaryInternalArena(const UA_ByteString *src, size_t *offset,
+                             void *dst, const UA_DataType *type,
+                             const UA_DataTypeArray *customTypes,
+                             UA_Arena *arena) {
+    Ctx ctx;
+    ctx.customTypes = customTypes;
+    ctx.arena = arena;
+    return decodeBinaryWithCtx(src, 1, offset, dst, type, &ctx);
+}
+
+status
+UA_decodeBinarySlicesInternal(const UA_ByteString *slices, size_t slicesSize,
+                              size_t *offset, void *dst, const UA_DataType *type,
+                              const UA_DataTypeArray *customTypes,
+                              UA_Arena *arena) {
+    Ctx ctx;
+    ctx.customTypes = customTypes;
+    ctx.arena = arena;
+    return decodeBinaryWithCtx(slices, slicesSize, offset, dst, type, &ctx);
+}
+
 UA_StatusCode
 UA_decodeBinary(const UA_ByteString *inBuf,
                 void *p, const UA_DataType *type,
@@ -1859,16 +2388,396 @@ UA_decodeBinary(const UA_ByteString *inBuf,
 /**
  * Compute the Message Size
  * ------------------------
- * The following methods are used to compute the length of a datum in binary
- * encoding. If the end-ptr is NULL, then the normal encoding functions do not
- * throw an error when the buffer limits are exceeded. */
+ * The following methods compute the length of a datum in binary encoding
+ * without encoding it. They follow the structure of the encoding methods. The
+ * length of types with a fixed encoding length and of arrays thereof is
+ * computed in O(1). If the encoding would fail, the error is set in the context
+ * and the returned size is invalid. */
+
+typedef struct {
+    u16 depth;
+    status ret;
+} SizeCtx;
+
+typedef size_t
+(*calcSizeBinarySignature)(const void *UA_RESTRICT src, const UA_DataType *type,
+                           SizeCtx *UA_RESTRICT ctx);
+#define CALCSIZE_BINARY(TYPE) static size_t                             \
+    TYPE##_calcSizeBinary(const UA_##TYPE *UA_RESTRICT src,             \
+                          const UA_DataType *type, SizeCtx *UA_RESTRICT ctx)
+#define CALCSIZE_DIRECT(SRC, TYPE) TYPE##_calcSizeBinary((const UA_##TYPE*)SRC, NULL, ctx)
+
+extern const calcSizeBinarySignature calcSizeBinaryJumpTable[UA_DATATYPEKINDS];
+
+/* Encoding length of the type kinds with a fixed length. Zero otherwise. */
+static const u8 fixedSizeBinary[UA_DATATYPEKINDS] = {
+    1, 1, 1, 2, 2, 4, 4, 8, 8, 4, 8, /* Boolean to Double */
+    0, 8, 16, 0, 0, 0, 0, 4,         /* String to StatusCode */
+    0, 0, 0, 0, 0, 0, 0,             /* QualifiedName to Decimal */
+    4,                               /* Enumeration */
+    0, 0, 0, 0                       /* Structure to BitfieldCluster */
+};
+
+static size_t
+calcSizeBinaryFixed(const void *src, const UA_DataType *type, SizeCtx *ctx) {
+    (void)src, (void)ctx;
+    return fixedSizeBinary[type->typeKind];
+}
+
+/* Without the array length */
+static size_t
+Array_calcSizeBinaryMembers(const void *src, size_t length,
+                            const UA_DataType *type, SizeCtx *ctx) {
+    if(type->overlayable)
+        return length * type->memSize;
+    u8 fixedSize = fixedSizeBinary[type->typeKind];
+    if(fixedSize > 0)
+        return length * fixedSize;
+    size_t size = 0;
+    uintptr_t ptr = (uintptr_t)src;
+    calcSizeBinarySignature calcSize = calcSizeBinaryJumpTable[type->typeKind];
+    for(size_t i = 0; i < length; ++i) {
+        size += calcSize((const void*)ptr, type, ctx);
+        ptr += type->memSize;
+    }
+    return size;
+}
+
+static size_t
+Array_calcSizeBinary(const void *src, size_t length,
+                     const UA_DataType *type, SizeCtx *ctx) {
+    if(length > UA_INT32_MAX) {
+        ctx->ret = UA_STATUSCODE_BADINTERNALERROR;
+        return 0;
+    }
+    return 4 + Array_calcSizeBinaryMembers(src, length, type, ctx);
+}
+
+CALCSIZE_BINARY(String) {
+    return Array_calcSizeBinary(src->data, src->length, &UA_TYPES[UA_TYPES_BYTE], ctx);
+}
+
+CALCSIZE_BINARY(NodeId) {
+    switch(src->identifierType) {
+    case UA_NODEIDTYPE_NUMERIC:
+        if(src->identifier.numeric > UA_UINT16_MAX || src->namespaceIndex > UA_BYTE_MAX)
+            return 7;
+        if(src->identifier.numeric > UA_BYTE_MAX || src->namespaceIndex > 0)
+            return 4;
+        return 2;
+    case UA_NODEIDTYPE_STRING:
+        return 3 + CALCSIZE_DIRECT(&src->identifier.string, String);
+    case UA_NODEIDTYPE_GUID:
+        return 19;
+    case UA_NODEIDTYPE_BYTESTRING:
+        return 3 + CALCSIZE_DIRECT(&src->identifier.byteString, String);
+    default:
+        ctx->ret = UA_STATUSCODE_BADINTERNALERROR;
+        return 0;
+    }
+}
+
+CALCSIZE_BINARY(ExpandedNodeId) {
+    size_t size = CALCSIZE_DIRECT(&src->nodeId, NodeId);
+    if((void*)src->namespaceUri.data > UA_EMPTY_ARRAY_SENTINEL)
+        size += CALCSIZE_DIRECT(&src->namespaceUri, String);
+    if(src->serverIndex > 0)
+        size += 4;
+    return size;
+}
+
+CALCSIZE_BINARY(QualifiedName) {
+    return 2 + CALCSIZE_DIRECT(&src->name, String);
+}
+
+CALCSIZE_BINARY(LocalizedText) {
+    size_t size = 1; /* Encoding byte */
+    if(src->locale.data)
+        size += CALCSIZE_DIRECT(&src->locale, String);
+    if(src->text.data)
+        size += CALCSIZE_DIRECT(&src->text, String);
+    return size;
+}
+
+CALCSIZE_BINARY(ExtensionObject) {
+    /* No content or already encoded content */
+    if(src->encoding <= UA_EXTENSIONOBJECT_ENCODED_XML) {
+        size_t size = CALCSIZE_DIRECT(&src->content.encoded.typeId, NodeId) + 1;
+        if(src->encoding != UA_EXTENSIONOBJECT_ENCODED_NOBODY)
+            size += CALCSIZE_DIRECT(&src->content.encoded.body, String);
+        return size;
+    }
+
+    /* Cannot encode with no data or no type description */
+    const UA_DataType *contentType = src->content.decoded.type;
+    if(!contentType || !src->content.decoded.data) {
+        ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+        return 0;
+    }
+
+    /* NodeId, encoding byte, length field and content */
+    return CALCSIZE_DIRECT(&contentType->binaryEncodingId, NodeId) + 1 + 4 +
+        calcSizeBinaryJumpTable[contentType->typeKind](src->content.decoded.data,
+                                                       contentType, ctx);
+}
+
+CALCSIZE_BINARY(Variant) {
+    /* Encoding byte */
+    size_t size = 1;
+    if(!src->type)
+        return size;
+
+    /* Array dimensions */
+    const UA_Boolean isArray = src->arrayLength > 0 || src->data <= UA_EMPTY_ARRAY_SENTINEL;
+    if(isArray && src->arrayDimensionsSize > 0) {
+        size_t totalRequiredSize = 1;
+        for(size_t i = 0; i < src->arrayDimensionsSize; ++i)
+            totalRequiredSize *= src->arrayDimensions[i];
+        if(totalRequiredSize != src->arrayLength) {
+            ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+            return 0;
+        }
+        size += 4 + (src->arrayDimensionsSize * 4);
+    }
+
+    /* Builtin types and enums are encoded directly */
+    if(src->type->typeKind <= UA_DATATYPEKIND_DIAGNOSTICINFO ||
+       src->type->typeKind == UA_DATATYPEKIND_ENUM) {
+        if(isArray)
+            return size + Array_calcSizeBinary(src->data, src->arrayLength, src->type, ctx);
+        return size + calcSizeBinaryJumpTable[src->type->typeKind](src->data, src->type, ctx);
+    }
+
+    /* Other types are wrapped in an ExtensionObject */
+    size_t length = 1;
+    if(isArray) {
+        if(src->arrayLength > UA_INT32_MAX) {
+            ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+            return 0;
+        }
+        length = src->arrayLength;
+        size += 4;
+    }
+    if(length == 0)
+        return size;
+    if(!src->data) {
+        ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+        return 0;
+    }
+    size_t eoHeader = CALCSIZE_DIRECT(&src->type->binaryEncodingId, NodeId) + 1 + 4;
+    return size + (length * eoHeader) +
+        Array_calcSizeBinaryMembers(src->data, length, src->type, ctx);
+}
+
+CALCSIZE_BINARY(DataValue) {
+    size_t size = 1; /* Encoding byte */
+    if(src->hasValue)
+        size += CALCSIZE_DIRECT(&src->value, Variant);
+    if(src->hasStatus)
+        size += 4;
+    if(src->hasSourceTimestamp)
+        size += 8;
+    if(src->hasSourcePicoseconds)
+        size += 2;
+    if(src->hasServerTimestamp)
+        size += 8;
+    if(src->hasServerPicoseconds)
+        size += 2;
+    return size;
+}
+
+CALCSIZE_BINARY(DiagnosticInfo) {
+    size_t size = 1; /* Encoding byte */
+    if(src->hasSymbolicId)
+        size += 4;
+    if(src->hasNamespaceUri)
+        size += 4;
+    if(src->hasLocalizedText)
+        size += 4;
+    if(src->hasLocale)
+        size += 4;
+    if(src->hasAdditionalInfo)
+        size += CALCSIZE_DIRECT(&src->additionalInfo, String);
+    if(src->hasInnerStatusCode)
+        size += 4;
+    if(src->hasInnerDiagnosticInfo)
+        size += CALCSIZE_DIRECT(src->innerDiagnosticInfo, DiagnosticInfo);
+    return size;
+}
+
+static size_t
+calcSizeBinaryStruct(const void *src, const UA_DataType *type, SizeCtx *ctx) {
+    /* The memory layout is identical to the encoding */
+    if(type->overlayable)
+        return type->memSize;
+
+    /* Check the recursion limit */
+    if(ctx->depth > UA_ENCODING_MAX_RECURSION) {
+        ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+        return 0;
+    }
+    ctx->depth++;
+
+    /* Loop over members */
+    size_t size = 0;
+    uintptr_t ptr = (uintptr_t)src;
+    for(size_t i = 0; i < type->membersSize; ++i) {
+        const UA_DataTypeMember *m = &type->members[i];
+        const UA_DataType *mt = m->memberType;
+        ptr += m->padding;
+        if(m->isArray) {
+            const size_t length = *((const size_t*)ptr);
+            ptr += sizeof(size_t);
+            size += Array_calcSizeBinary(*(void *UA_RESTRICT const *)ptr, length, mt, ctx);
+            ptr += sizeof(void*);
+            continue;
+        }
+        size += calcSizeBinaryJumpTable[mt->typeKind]((const void*)ptr, mt, ctx);
+        ptr += mt->memSize;
+    }
+
+    ctx->depth--;
+    return size;
+}
+
+static size_t
+calcSizeBinaryStructWithOptFields(const void *src, const UA_DataType *type,
+                                  SizeCtx *ctx) {
+    /* Check the recursion limit */
+    if(ctx->depth > UA_ENCODING_MAX_RECURSION) {
+        ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+        return 0;
+    }
+    ctx->depth++;
+
+    /* Encoding mask and members */
+    size_t size = 4;
+    uintptr_t ptr = (uintptr_t)src;
+    for(size_t i = 0; i < type->membersSize; ++i) {
+        const UA_DataTypeMember *m = &type->members[i];
+        const UA_DataType *mt = m->memberType;
+        ptr += m->padding;
+
+        if(m->isOptional) {
+            if(m->isArray) {
+                /* Optional Array */
+                const size_t length = *((const size_t *)ptr);
+                ptr += sizeof(size_t);
+                const void *data = *(void *UA_RESTRICT const *)ptr;
+                if(data)
+                    size += Array_calcSizeBinary(data, length, mt, ctx);
+            } else {
+                /* Optional Scalar */
+                const void *data = *(void* const*)ptr;
+                if(data)
+                    size += calcSizeBinaryJumpTable[mt->typeKind](data, mt, ctx);
+            }
+            ptr += sizeof(void *);
+            continue;
+        }
+
+        /* Mandatory Array */
+        if(m->isArray) {
+            const size_t length = *((const size_t *)ptr);
+            ptr += sizeof(size_t);
+            size += Array_calcSizeBinary(*(void *UA_RESTRICT const *)ptr, length, mt, ctx);
+            ptr += sizeof(void *);
+            continue;
+        }
+
+        /* Mandatory Scalar */
+        size += calcSizeBinaryJumpTable[mt->typeKind]((const void*)ptr, mt, ctx);
+        ptr += mt->memSize;
+    }
+
+    ctx->depth--;
+    return size;
+}
+
+static size_t
+calcSizeBinaryUnion(const void *src, const UA_DataType *type, SizeCtx *ctx) {
+    /* Check the recursion limit */
+    if(ctx->depth > UA_ENCODING_MAX_RECURSION) {
+        ctx->ret = UA_STATUSCODE_BADENCODINGERROR;
+        return 0;
+    }
+
+    /* Selection */
+    const UA_UInt32 selection = *(const UA_UInt32*)src;
+    if(selection == 0)
+        return 4;
+
+    /* Selected member */
+    ctx->depth++;
+    const UA_DataTypeMember *m = &type->members[selection-1];
+    const UA_DataType *mt = m->memberType;
+    uintptr_t ptr = ((uintptr_t)src) + m->padding; /* includes the switchfield length */
+    size_t size = 4;
+    if(!m->isArray) {
+        size += calcSizeBinaryJumpTable[mt->typeKind]((const void*)ptr, mt, ctx);
+    } else {
+        const size_t length = *((const size_t*)ptr);
+        ptr += sizeof(size_t);
+        size += Array_calcSizeBinary(*(void *UA_RESTRICT const *)ptr, length, mt, ctx);
+    }
+    ctx->depth--;
+    return size;
+}
+
+static size_t
+calcSizeBinaryNotImplemented(const void *src, const UA_DataType *type, SizeCtx *ctx) {
+    (void)src, (void)type;
+    ctx->ret = UA_STATUSCODE_BADNOTIMPLEMENTED;
+    return 0;
+}
+
+const calcSizeBinarySignature calcSizeBinaryJumpTable[UA_DATATYPEKINDS] = {
+    calcSizeBinaryFixed, /* Boolean */
+    calcSizeBinaryFixed, /* SByte */
+    calcSizeBinaryFixed, /* Byte */
+    calcSizeBinaryFixed, /* Int16 */
+    calcSizeBinaryFixed, /* UInt16 */
+    calcSizeBinaryFixed, /* Int32 */
+    calcSizeBinaryFixed, /* UInt32 */
+    calcSizeBinaryFixed, /* Int64 */
+    calcSizeBinaryFixed, /* UInt64 */
+    calcSizeBinaryFixed, /* Float */
+    calcSizeBinaryFixed, /* Double */
+    (calcSizeBinarySignature)String_calcSizeBinary,
+    calcSizeBinaryFixed, /* DateTime */
+    calcSizeBinaryFixed, /* Guid */
+    (calcSizeBinarySignature)String_calcSizeBinary, /* ByteString */
+    (calcSizeBinarySignature)String_calcSizeBinary, /* XmlElement */
+    (calcSizeBinarySignature)NodeId_calcSizeBinary,
+    (calcSizeBinarySignature)ExpandedNodeId_calcSizeBinary,
+    calcSizeBinaryFixed, /* StatusCode */
+    (calcSizeBinarySignature)QualifiedName_calcSizeBinary,
+    (calcSizeBinarySignature)LocalizedText_calcSizeBinary,
+    (calcSizeBinarySignature)ExtensionObject_calcSizeBinary,
+    (calcSizeBinarySignature)DataValue_calcSizeBinary,
+    (calcSizeBinarySignature)Variant_calcSizeBinary,
+    (calcSizeBinarySignature)DiagnosticInfo_calcSizeBinary,
+    calcSizeBinaryNotImplemented, /* Decimal */
+    calcSizeBinaryFixed, /* Enumeration */
+    calcSizeBinaryStruct,
+    calcSizeBinaryStructWithOptFields, /* Structure with Optional Fields */
+    calcSizeBinaryUnion, /* Union */
+    calcSizeBinaryStruct /* BitfieldCluster */
+};
 
 size_t
 UA_calcSizeBinary(const void *p, const UA_DataType *type) {
-    u8 *pos = NULL;
-    const u8 *posEnd = NULL;
-    UA_StatusCode res = UA_encodeBinaryInternal(p, type, &pos, &posEnd, NULL, NULL);
-    if(res != UA_STATUSCODE_GOOD)
+    if(!type || !p)
         return 0;
-    return (size_t)(uintptr_t)pos;
+    SizeCtx ctx;
+    ctx.depth = 0;
+    ctx.ret = UA_STATUSCODE_GOOD;
+    size_t size = calcSizeBinaryJumpTable[type->typeKind](p, type, &ctx);
+    return (ctx.ret == UA_STATUSCODE_GOOD) ? size : 0;
 }
+
+#ifdef UA_ENABLE_PRECOMPILED_BINARY_ENCODING
+/* Must be at the end of the file. In the single-file release, the generated
+ * definitions follow after this file. */
+#include <open62541/types_generated_encoding_binary.h>
+#endif
@@ -67,6 +67,27 @@ UA_decodeBinaryInternal(const UA_ByteString *src, size_t *offset,
                         const UA_DataTypeArray *customTypes)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+/* Same as UA_decodeBinaryInternal. But all memory of the decoded value is
+ * taken from the arena (see ua_util_internal.h). The value must not be cleared
+ * with _clear. It is released together with the arena. */
+struct UA_Arena;
+UA_StatusCode
+UA_decodeBinaryInternalArena(const UA_ByteString *src, size_t *offset,
+                             void *dst, const UA_DataType *type,
+                             const UA_DataTypeArray *customTypes,
+                             struct UA_Arena *arena)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
+/* Decode from a message that is split into several slices, e.g. the payloads
+ * of the chunks of a SecureChannel message. The slices are not concatenated.
+ * The offset counts the bytes across all slices. The arena can be NULL. */
+UA_StatusCode
+UA_decodeBinarySlicesInternal(const UA_ByteString *slices, size_t slicesSize,
+                              size_t *offset, void *dst, const UA_DataType *type,
+                              const UA_DataTypeArray *customTypes,
+                              struct UA_Arena *arena)
+    UA_FUNC_ATTR_WARN_UNUSED_RESULT;
+
 const UA_DataType *
 UA_findDataTypeByBinary(const UA_NodeId *typeId);
 
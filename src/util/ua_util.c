@@ -530,6 +530,122 @@ UA_EXPORT UA_THREAD_LOCAL void * (*UA_callocSingleton)(size_t nelem, size_t elsi
 UA_EXPORT UA_THREAD_LOCAL void * (*UA_reallocSingleton)(void *ptr, size_t size) = realloc;
 #endif
 
+/*******************/
+/* Arena Allocator */
+/*******************/
+
+#define UA_ARENA_ALIGN 8
+#define UA_ARENA_FIRSTBLOCKSIZE 4096
+#define UA_ARENA_MAXRETAIN 65536 /* Larger blocks are not kept by _reset */
+
+struct UA_ArenaBlock {
+    UA_ArenaBlock *next;
+    size_t size; /* Usable size after the header */
+    size_t pos;
+};
+
+/* The usable memory begins after the header with the alignment */
+#define UA_ARENA_HEADERSIZE \
+    ((sizeof(UA_ArenaBlock) + UA_ARENA_ALIGN - 1) & ~(size_t)(UA_ARENA_ALIGN - 1))
+
+void *
+UA_Arena_calloc(UA_Arena *arena, size_t nelem, size_t elsize) {
+    if(elsize > 0 && nelem > SIZE_MAX / elsize)
+        return NULL;
+    size_t size = nelem * elsize;
+    if(size > SIZE_MAX - UA_ARENA_HEADERSIZE - UA_ARENA_ALIGN)
+        return NULL;
+    size = (size + UA_ARENA_ALIGN - 1) & ~(size_t)(UA_ARENA_ALIGN - 1);
+
+    /* Add a new block if the current block is full */
+    UA_ArenaBlock *b = arena->blocks;
+    if(!b || b->pos + size > b->size) {
+        size_t blockSize = (b) ? b->size * 2 : UA_ARENA_FIRSTBLOCKSIZE;
+        if(blockSize < size)
+            blockSize = size;
+        UA_ArenaBlock *nb = (UA_ArenaBlock*)
+            UA_malloc(UA_ARENA_HEADERSIZE + blockSize);
+        if(!nb)
+            return NULL;
+        nb->next = b;
+        nb->size = blockSize;
+        nb->pos = 0;
+        arena->blocks = nb;
+        arena->blockCount++;
+        b = nb;
+    }
+
+    void *p = (u8*)b + UA_ARENA_HEADERSIZE + b->pos;
+    b->pos += size;
+    arena->used += size;
+    if(arena->used > arena->highWaterMark)
+        arena->highWaterMark = arena->used;
+    arena->allocCount++;
+    memset(p, 0, size);
+    return p;
+}
+
+void
+UA_Arena_reset(UA_Arena *arena) {
+    arena->used = 0;
+    UA_ArenaBlock *b = arena->blocks;
+    if(!b)
+        return;
+
+    /* Free all but the current block */
+    UA_Boolean overflowed = (b->next != NULL);
+    UA_ArenaBlock *next = b->next;
+    while(next) {
+        UA_ArenaBlock *tmp = next->next;
+        UA_free(next);
+        next = tmp;
+    }
+    b->next = NULL;
+    b->pos = 0;
+
+    /* Don't hold on to the memory of exceptionally large values */
+    if(b->size > UA_ARENA_MAXRETAIN) {
+        UA_free(b);
+        arena->blocks = NULL;
+        return;
+    }
+
+    /* The last cycle did not fit into a single block. Replace the current
+     * block with one that fits the high-water mark. If that fails, the arena
+     * starts over with an empty chain. */
+    if(overflowed && arena->highWaterMark > b->size &&
+       arena->highWaterMark <= UA_ARENA_MAXRETAIN) {
+        UA_free(b);
+        arena->blocks = (UA_ArenaBlock*)
+            UA_malloc(UA_ARENA_HEADERSIZE + arena->highWaterMark);
+        if(!arena->blocks)
+            return;
+        arena->blocks->next = NULL;
+        arena->blocks->size = arena->highWaterMark;
+        arena->blocks->pos = 0;
+        arena->blockCount++;
+    }
+}
+
+void
+UA_Arena_clear(UA_Arena *arena) {
+    UA_ArenaBlock *b = arena->blocks;
+    while(b) {
+        UA_ArenaBlock *next = b->next;
+        UA_free(b);
+        b = next;
+    }
+    memset(arena, 0, sizeof(UA_Arena));
+}
+
+/****************/
+/* Lock Section */
+/****************/
+
+#if UA_MULTITHREADING >= 100 && defined(UA_LOCK_MUTEX_LOCK)
+UA_EXPORT UA_THREAD_LOCAL UA_LockSection UA_lockSection = {NULL, UA_LOCKMODE_NONE, 0, 0};
+#endif
+
 /************************/
 /* ReferenceType Lookup */
 /************************/
@@ -214,6 +214,42 @@ isTrue(uint8_t expr) {
 void
 UA_cleanupDataTypeWithCustom(const UA_DataTypeArray *customTypes);
 
+/**
+ * DataType Index
+ * --------------
+ * Hash index to look up DataTypes by their type NodeId or by their
+ * binaryEncodingId. If several DataTypes have the same NodeId, the first one
+ * is found. This gives the same result as the linear search that looks at the
+ * builtin types first and then follows the list of custom type arrays. The
+ * index is initialized by zeroing out. */
+
+typedef struct {
+    size_t mask; /* The table size is a power of two */
+    const UA_DataType **byTypeId;
+    const UA_DataType **byBinaryId;
+} UA_DataTypeIndex;
+
+/* Index the builtin types (if withBuiltin is set) and the custom types */
+UA_StatusCode
+UA_DataTypeIndex_init(UA_DataTypeIndex *index, UA_Boolean withBuiltin,
+                      const UA_DataTypeArray *customTypes);
+
+void
+UA_DataTypeIndex_clear(UA_DataTypeIndex *index);
+
+const UA_DataType *
+UA_DataTypeIndex_findTypeId(const UA_DataTypeIndex *index,
+                            const UA_NodeId *typeId);
+
+const UA_DataType *
+UA_DataTypeIndex_findBinary(const UA_DataTypeIndex *index,
+                            const UA_NodeId *binaryEncodingId);
+
+/* The index for the builtin types is created on first use and kept until the
+ * process ends. Returns NULL if out of memory. */
+const UA_DataTypeIndex *
+UA_DataTypeIndex_builtin(void);
+
 /* Get the number of optional fields contained in an structure type */
 size_t UA_EXPORT
 getCountOfOptionalFields(const UA_DataType *type);
@@ -228,6 +264,46 @@ UA_dump_hex_pkg(UA_Byte* buffer, size_t bufferLen);
  * certificates */
 UA_ByteString getLeafCertificate(UA_ByteString chain);
 
+/**
+ * Arena Allocator
+ * ---------------
+ * Bump allocator for values that are released together. The memory is taken
+ * from blocks that are allocated on the heap. A new block is added (with twice
+ * the size of the last block) when the current block is full. Values allocated
+ * from the arena must not be freed individually (e.g. with _clear). Instead,
+ * all allocations are released at once with UA_Arena_reset. The arena is
+ * initialized by zeroing out.
+ *
+ * The arena is not synchronized. Every thread (or every object that is only
+ * used under a lock) needs its own arena. The high-water mark is used by
+ * _reset to size the retained block. So a cyclic workload with a bounded
+ * memory demand allocates no new blocks after the first cycles. */
+
+struct UA_ArenaBlock;
+typedef struct UA_ArenaBlock UA_ArenaBlock;
+
+typedef struct UA_Arena {
+    UA_ArenaBlock *blocks; /* The current (largest) block is the first */
+    size_t used;           /* Bytes allocated since the last reset */
+    size_t allocCount;     /* Statistics: Number of allocations served */
+    size_t blockCount;     /* Statistics: Number of blocks allocated */
+    size_t highWaterMark;  /* Statistics: Max bytes used between resets */
+} UA_Arena;
+
+/* Returns zeroed memory or NULL if out of memory */
+void *
+UA_Arena_calloc(UA_Arena *arena, size_t nelem, size_t elsize);
+
+/* Releases all allocations. The current block is kept for reuse if it is not
+ * too large. If the allocations since the last reset overflowed into several
+ * blocks, they are replaced by a single block that fits the high-water mark. */
+void
+UA_Arena_reset(UA_Arena *arena);
+
+/* Releases all memory */
+void
+UA_Arena_clear(UA_Arena *arena);
+
 /* Unions that represent any of the supported request or response message */
 typedef union {
     UA_RequestHeader requestHeader;
@@ -151,12 +151,76 @@ START_TEST(encodeTwoStringsIntoTenChunksShallWork) {
     UA_String_clear(&string);
 } END_TEST
 
+/* ExtensionObjects that do not fit into the current chunk are encoded with the
+ * length computed upfront */
+UA_Byte collected[4096];
+size_t collectedSize;
+
+static UA_StatusCode
+sendChunkCollect(void *_, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    size_t offset = (uintptr_t)(*bufPos - buffers[bufIndex].data);
+    memcpy(&collected[collectedSize], buffers[bufIndex].data, offset);
+    collectedSize += offset;
+    bufIndex++;
+    *bufPos = buffers[bufIndex].data;
+    *bufEnd = &(*bufPos)[buffers[bufIndex].length];
+    counter++;
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(encodeExtensionObjectsIntoChunksShallWork) {
+    size_t arraySize = 20;
+    size_t chunkCount = 40;
+    size_t chunkSize = 30;
+    bufIndex = 0;
+    counter = 0;
+    collectedSize = 0;
+    buffers = (UA_ByteString*)UA_Array_new(chunkCount, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    for(size_t i = 0; i < chunkCount; i++)
+        UA_ByteString_allocBuffer(&buffers[i], chunkSize);
+
+    /* The ReadValueIds are wrapped in ExtensionObjects. Some are larger than
+     * a chunk. */
+    UA_ReadValueId *rvi = (UA_ReadValueId*)
+        UA_Array_new(arraySize, &UA_TYPES[UA_TYPES_READVALUEID]);
+    for(size_t i = 0; i < arraySize; i++) {
+        rvi[i].attributeId = (UA_UInt32)i;
+        if(i % 3 == 0)
+            rvi[i].indexRange = UA_STRING_ALLOC("a long index range");
+    }
+    UA_Variant v;
+    UA_Variant_setArray(&v, rvi, arraySize, &UA_TYPES[UA_TYPES_READVALUEID]);
+
+    UA_Byte *pos = buffers[0].data;
+    const UA_Byte *end = &buffers[0].data[buffers[0].length];
+    UA_StatusCode retval = UA_encodeBinaryInternal(&v, &UA_TYPES[UA_TYPES_VARIANT],
+                                                   &pos, &end, sendChunkCollect, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(counter, 0);
+    size_t offset = (uintptr_t)(pos - buffers[bufIndex].data);
+    memcpy(&collected[collectedSize], buffers[bufIndex].data, offset);
+    collectedSize += offset;
+
+    /* Identical to the encoding in a single buffer */
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    retval = UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &encoded);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(encoded.length, collectedSize);
+    ck_assert_uint_eq(UA_calcSizeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT]), collectedSize);
+    ck_assert(memcmp(encoded.data, collected, collectedSize) == 0);
+
+    UA_ByteString_clear(&encoded);
+    UA_Variant_clear(&v);
+    UA_Array_delete(buffers, chunkCount, &UA_TYPES[UA_TYPES_BYTESTRING]);
+} END_TEST
+
 int main(void) {
     Suite *s = suite_create("Chunked encoding");
     TCase *tc_message = tcase_create("encode chunking");
     tcase_add_test(tc_message,encodeArrayIntoFiveChunksShallWork);
     tcase_add_test(tc_message,encodeStringIntoFiveChunksShallWork);
     tcase_add_test(tc_message,encodeTwoStringsIntoTenChunksShallWork);
+    tcase_add_test(tc_message,encodeExtensionObjectsIntoChunksShallWork);
     suite_add_tcase(s, tc_message);
 
     SRunner *sr = srunner_create(s);
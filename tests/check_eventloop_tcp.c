@@ -10,6 +10,7 @@
 #include "testing_clock.h"
 #include <time.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <check.h>
 
 static UA_EventLoop *el;
@@ -180,11 +181,141 @@ START_TEST(connectTCP) {
     el = NULL;
 } END_TEST
 
+/* Measure the connections/sec and messages/sec for many client connections to
+ * a listen socket of the same EventLoop */
+#define BENCH_CONNECTIONS 256
+#define BENCH_MESSAGES 20000
+#define BENCH_BATCH 100
+
+static size_t benchConnections;
+static size_t benchBytes;
+static uintptr_t benchClients[BENCH_CONNECTIONS];
+static size_t benchClientsSize;
+
+static void
+benchCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
+              void *application, void **connectionContext,
+              UA_ConnectionState status,
+              const UA_KeyValueMap *params,
+              UA_ByteString msg) {
+    if(status == UA_CONNECTIONSTATE_CLOSING) {
+        benchConnections--;
+        return;
+    }
+    if(msg.length > 0) {
+        benchBytes += msg.length;
+        return;
+    }
+    if(status != UA_CONNECTIONSTATE_ESTABLISHED)
+        return;
+    benchConnections++;
+    if(*connectionContext != NULL && benchClientsSize < BENCH_CONNECTIONS)
+        benchClients[benchClientsSize++] = connectionId;
+}
+
+START_TEST(benchmarkTCP) {
+    UA_ConnectionManager *cm = UA_ConnectionManager_new_POSIX_TCP(UA_STRING("tcpCM"));
+    el = UA_EventLoop_new_POSIX(UA_Log_Stdout);
+    el->registerEventSource(el, &cm->eventSource);
+    el->start(el);
+
+    /* Use a separate port. The closed connections linger in TIME_WAIT. */
+    UA_UInt16 port = 4843;
+    UA_Boolean listen = true;
+    UA_Boolean reuse = true;
+    UA_String host = UA_STRING("localhost");
+
+    UA_KeyValuePair params[4];
+    params[0].key = UA_QUALIFIEDNAME(0, "port");
+    UA_Variant_setScalar(&params[0].value, &port, &UA_TYPES[UA_TYPES_UINT16]);
+    params[1].key = UA_QUALIFIEDNAME(0, "listen");
+    UA_Variant_setScalar(&params[1].value, &listen, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    params[2].key = UA_QUALIFIEDNAME(0, "address");
+    UA_Variant_setScalar(&params[2].value, &host, &UA_TYPES[UA_TYPES_STRING]);
+    params[3].key = UA_QUALIFIEDNAME(0, "reuse");
+    UA_Variant_setScalar(&params[3].value, &reuse, &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    UA_KeyValueMap paramsMap;
+    paramsMap.map = params;
+    paramsMap.mapSize = 4;
+
+    benchConnections = 0;
+    benchClientsSize = 0;
+    benchBytes = 0;
+
+    UA_StatusCode retval =
+        cm->openConnection(cm, &paramsMap, NULL, NULL, benchCallback);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    size_t listenSockets = benchConnections;
+
+    /* Open the client connections all at once */
+    listen = false;
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < BENCH_CONNECTIONS; i++) {
+        retval = cm->openConnection(cm, &paramsMap, NULL, (void*)0x01,
+                                    benchCallback);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    size_t iterations = 0;
+    while(benchConnections < listenSockets + (2 * BENCH_CONNECTIONS) &&
+          UA_DateTime_nowMonotonic() - begin < 10 * UA_DATETIME_SEC) {
+        el->run(el, 1);
+        iterations++;
+    }
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+    ck_assert_uint_eq(benchConnections, listenSockets + (2 * BENCH_CONNECTIONS));
+    ck_assert_uint_eq(benchClientsSize, BENCH_CONNECTIONS);
+    printf("%.0f connections/sec (%lu EventLoop iterations for %u connections)\n",
+           (double)BENCH_CONNECTIONS * UA_DATETIME_SEC / (double)(end - begin),
+           (unsigned long)iterations, (unsigned)BENCH_CONNECTIONS);
+
+    /* Send messages round-robin over the client connections */
+    size_t msgLen = strlen(testMsg);
+    begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < BENCH_MESSAGES; i++) {
+        UA_ByteString snd;
+        uintptr_t id = benchClients[i % BENCH_CONNECTIONS];
+        retval = cm->allocNetworkBuffer(cm, id, &snd, msgLen);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        memcpy(snd.data, testMsg, msgLen);
+        retval = cm->sendWithConnection(cm, id, NULL, &snd);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        if(i % BENCH_BATCH == BENCH_BATCH - 1)
+            el->run(el, 0);
+    }
+    iterations = 0;
+    while(benchBytes < BENCH_MESSAGES * msgLen &&
+          UA_DateTime_nowMonotonic() - begin < 10 * UA_DATETIME_SEC) {
+        el->run(el, 1);
+        iterations++;
+    }
+    end = UA_DateTime_nowMonotonic();
+    ck_assert_uint_eq(benchBytes, BENCH_MESSAGES * msgLen);
+    printf("%.0f messages/sec over %u connections\n",
+           (double)BENCH_MESSAGES * UA_DATETIME_SEC / (double)(end - begin),
+           (unsigned)BENCH_CONNECTIONS);
+
+    /* Stop the EventLoop */
+    int max_stop_iteration_count = 1000;
+    int iteration = 0;
+    el->stop(el);
+    while(el->state != UA_EVENTLOOPSTATE_STOPPED &&
+          iteration < max_stop_iteration_count) {
+        el->run(el, 1);
+        iteration++;
+    }
+    ck_assert(el->state == UA_EVENTLOOPSTATE_STOPPED);
+    ck_assert_uint_eq(benchConnections, 0);
+    el->free(el);
+    el = NULL;
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test TCP EventLoop");
     TCase *tc = tcase_create("test cases");
     tcase_add_test(tc, listenTCP);
     tcase_add_test(tc, connectTCP);
+    tcase_add_test(tc, benchmarkTCP);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -456,7 +456,7 @@ START_TEST(SecureChannel_sendSymmetricMessage_invalidParameters) {
 static UA_StatusCode
 process_callback(void *application, UA_SecureChannel *channel,
                  UA_MessageType messageType, UA_UInt32 requestId,
-                 UA_ByteString *message) {
+                 UA_ByteString *message, size_t slicesSize) {
     ck_assert_ptr_ne(message, NULL);
     ck_assert_ptr_ne(application, NULL);
     if(message == NULL || application == NULL)
@@ -524,6 +524,109 @@ START_TEST(SecureChannel_assemblePartialChunks) {
     ck_assert_int_eq(chunks_processed, 5);
 } END_TEST
 
+/* Collect all sent chunks in one buffer */
+static UA_ByteString sentChunks;
+
+static UA_StatusCode
+collectSentChunk(UA_ConnectionManager *cm, uintptr_t connectionId,
+                 const UA_KeyValueMap *params, UA_ByteString *buf) {
+    UA_Byte *data = (UA_Byte*)UA_realloc(sentChunks.data, sentChunks.length + buf->length);
+    ck_assert_ptr_ne(data, NULL);
+    memcpy(&data[sentChunks.length], buf->data, buf->length);
+    sentChunks.data = data;
+    sentChunks.length += buf->length;
+    UA_ByteString_clear(buf);
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_WriteRequest chunkedRequest;
+static size_t chunkedSlices;
+
+static UA_StatusCode
+chunked_callback(void *application, UA_SecureChannel *channel,
+                 UA_MessageType messageType, UA_UInt32 requestId,
+                 UA_ByteString *message, size_t slicesSize) {
+    ck_assert_uint_eq(messageType, UA_MESSAGETYPE_MSG);
+    ck_assert_uint_eq(requestId, 42);
+    chunkedSlices = slicesSize;
+
+    /* Decode across the slices */
+    size_t offset = 0;
+    UA_NodeId typeId;
+    UA_WriteRequest decoded;
+    UA_StatusCode res =
+        UA_decodeBinarySlicesInternal(message, slicesSize, &offset, &typeId,
+                                      &UA_TYPES[UA_TYPES_NODEID], NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_NodeId_equal(&typeId, &UA_TYPES[UA_TYPES_WRITEREQUEST].binaryEncodingId));
+    res = UA_decodeBinarySlicesInternal(message, slicesSize, &offset, &decoded,
+                                        &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_order(&decoded, &chunkedRequest,
+                       &UA_TYPES[UA_TYPES_WRITEREQUEST]) == UA_ORDER_EQ);
+    UA_WriteRequest_clear(&decoded);
+    (*(int*)application)++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* A message of many chunks is received in pieces that do not align with the
+ * chunks. The callback gets the chunk payloads as slices. */
+START_TEST(SecureChannel_processChunkedMessage) {
+    UA_ConnectionManager collectCM = testConnectionManagerTCP;
+    collectCM.sendWithConnection = collectSentChunk;
+    testChannel.connectionManager = &collectCM;
+    testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    testChannel.config.sendBufferSize = 8192;
+    testChannel.securityToken.createdAt = UA_DateTime_nowMonotonic();
+    testChannel.securityToken.revisedLifetime = 600000;
+
+    UA_WriteValue wv[2];
+    UA_WriteValue_init(&wv[0]);
+    UA_WriteValue_init(&wv[1]);
+    wv[0].nodeId = UA_NODEID_STRING(1, "Large");
+    wv[0].attributeId = UA_ATTRIBUTEID_VALUE;
+    wv[0].value.hasValue = true;
+    UA_ByteString value;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&value, 100000);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < value.length; i++)
+        value.data[i] = (UA_Byte)(i * 7);
+    UA_Variant_setScalar(&wv[0].value.value, &value, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    wv[1].nodeId = UA_NODEID_NUMERIC(1, 4242);
+    wv[1].attributeId = UA_ATTRIBUTEID_VALUE;
+    wv[1].value.hasValue = true;
+    UA_Double doubles[3000];
+    for(size_t i = 0; i < 3000; i++)
+        doubles[i] = (UA_Double)i / 3.0;
+    UA_Variant_setArray(&wv[1].value.value, doubles, 3000, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_WriteRequest_init(&chunkedRequest);
+    chunkedRequest.nodesToWrite = wv;
+    chunkedRequest.nodesToWriteSize = 2;
+
+    res = UA_SecureChannel_sendSymmetricMessage(&testChannel, 42, UA_MESSAGETYPE_MSG,
+                                                &chunkedRequest,
+                                                &UA_TYPES[UA_TYPES_WRITEREQUEST]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Receive in pieces of 1000 bytes */
+    int processed = 0;
+    chunkedSlices = 0;
+    for(size_t offset = 0; offset < sentChunks.length; offset += 1000) {
+        UA_ByteString piece = {sentChunks.length - offset, &sentChunks.data[offset]};
+        if(piece.length > 1000)
+            piece.length = 1000;
+        res = UA_SecureChannel_processBuffer(&testChannel, &processed, chunked_callback,
+                                             &piece, UA_DateTime_nowMonotonic());
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_int_eq(processed, 1);
+    ck_assert_uint_gt(chunkedSlices, 10);
+    ck_assert_uint_eq(testChannel.incompleteChunk.length, 0);
+
+    UA_ByteString_clear(&value);
+    UA_ByteString_clear(&sentChunks);
+} END_TEST
+
 
 static Suite *
 testSuite_SecureChannel(void) {
@@ -565,6 +668,7 @@ testSuite_SecureChannel(void) {
     tcase_add_checked_fixture(tc_processBuffer, setup_key_sizes, teardown_key_sizes);
     tcase_add_checked_fixture(tc_processBuffer, setup_secureChannel, teardown_secureChannel);
     tcase_add_test(tc_processBuffer, SecureChannel_assemblePartialChunks);
+    tcase_add_test(tc_processBuffer, SecureChannel_processChunkedMessage);
     suite_add_tcase(s, tc_processBuffer);
 
     return s;
@@ -1037,6 +1037,83 @@ START_TEST(UA_DataValue_encodeShallWorkOnExampleWithVariant) {
 }
 END_TEST
 
+static void
+checkCalcSize(const void *src, const UA_DataType *type) {
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = UA_encodeBinary(src, type, &encoded);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(UA_calcSizeBinary(src, type), encoded.length);
+    UA_ByteString_clear(&encoded);
+}
+
+START_TEST(UA_calcSizeBinary_shallMatchTheEncodingLength) {
+    /* NodeId encodings */
+    UA_NodeId nodeIds[6] = {
+        UA_NODEID_NUMERIC(0, 12), UA_NODEID_NUMERIC(1, 1200),
+        UA_NODEID_NUMERIC(300, 120000), UA_NODEID_STRING(1, "node"),
+        UA_NODEID_GUID(1, UA_GUID("09087e75-8e5e-499b-954f-f2a9603db28a")),
+        UA_NODEID_BYTESTRING(2, "bytes")};
+    for(size_t i = 0; i < 6; i++)
+        checkCalcSize(&nodeIds[i], &UA_TYPES[UA_TYPES_NODEID]);
+
+    UA_ExpandedNodeId en = UA_EXPANDEDNODEID_STRING(1, "node");
+    en.namespaceUri = UA_STRING("urn:namespace");
+    en.serverIndex = 2;
+    checkCalcSize(&en, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+
+    /* Array with dimensions */
+    UA_Double matrix[6] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    UA_UInt32 dims[2] = {2, 3};
+    UA_Variant v;
+    UA_Variant_setArray(&v, matrix, 6, &UA_TYPES[UA_TYPES_DOUBLE]);
+    v.arrayDimensions = dims;
+    v.arrayDimensionsSize = 2;
+    checkCalcSize(&v, &UA_TYPES[UA_TYPES_VARIANT]);
+
+    /* The dimensions do not match the array length */
+    dims[1] = 4;
+    ck_assert_uint_eq(UA_calcSizeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT]), 0);
+
+    /* Array of structures wrapped in ExtensionObjects */
+    UA_ReadValueId rvi[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = nodeIds[i * 2 + 1];
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_Variant_setArray(&v, rvi, 3, &UA_TYPES[UA_TYPES_READVALUEID]);
+    checkCalcSize(&v, &UA_TYPES[UA_TYPES_VARIANT]);
+
+    /* Scalar structure with a nested ExtensionObject */
+    UA_ExtensionObject eos[2];
+    UA_ExtensionObject_setValue(&eos[0], &rvi[0], &UA_TYPES[UA_TYPES_READVALUEID]);
+    UA_ExtensionObject_init(&eos[1]);
+    eos[1].encoding = UA_EXTENSIONOBJECT_ENCODED_BYTESTRING;
+    eos[1].content.encoded.typeId = UA_NODEID_NUMERIC(1, 5000);
+    eos[1].content.encoded.body = UA_BYTESTRING("body");
+    UA_Variant_setArray(&v, eos, 2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    checkCalcSize(&v, &UA_TYPES[UA_TYPES_VARIANT]);
+
+    /* An ExtensionObject without content cannot be encoded */
+    eos[0].content.decoded.data = NULL;
+    ck_assert_uint_eq(UA_calcSizeBinary(&eos[0], &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]), 0);
+
+    /* Nested DiagnosticInfo */
+    UA_DiagnosticInfo inner;
+    UA_DiagnosticInfo_init(&inner);
+    inner.hasAdditionalInfo = true;
+    inner.additionalInfo = UA_STRING("info");
+    UA_DiagnosticInfo di;
+    UA_DiagnosticInfo_init(&di);
+    di.hasSymbolicId = true;
+    di.symbolicId = 1;
+    di.hasInnerStatusCode = true;
+    di.hasInnerDiagnosticInfo = true;
+    di.innerDiagnosticInfo = &inner;
+    checkCalcSize(&di, &UA_TYPES[UA_TYPES_DIAGNOSTICINFO]);
+}
+END_TEST
+
 START_TEST(UA_DateTime_toStructShallWorkOnExample) {
     // given
     UA_DateTime src = 13974671891234567 + (11644473600 * 10000000); // ua counts since 1601, unix since 1970
@@ -1760,6 +1837,7 @@ static Suite *testSuite_builtin(void) {
     tcase_add_test(tc_encode, UA_ExpandedNodeId_encodeShallWorkOnExample);
     tcase_add_test(tc_encode, UA_DataValue_encodeShallWorkOnExampleWithoutVariant);
     tcase_add_test(tc_encode, UA_DataValue_encodeShallWorkOnExampleWithVariant);
+    tcase_add_test(tc_encode, UA_calcSizeBinary_shallMatchTheEncodingLength);
     tcase_add_test(tc_encode, UA_ExtensionObject_encodeDecodeShallWorkOnExtensionObject);
     tcase_add_test(tc_encode, UA_Variant_encodeDecodeShallWorkOnVariantWithStruct);
     tcase_add_test(tc_encode, UA_Variant_encodeDecodeShallWorkOnVariantWithArrayOfStruct);
@@ -8,6 +8,7 @@
 #include "ua_types_encoding_binary.h"
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <check.h>
 #include <math.h>
 
@@ -697,6 +698,80 @@ START_TEST(parseSelfContainingUnionSelfMember) {
         UA_ByteString_clear(&buf);
     } END_TEST
 
+/* The lookup gives the first type with the NodeId. Same as the linear
+ * search. */
+START_TEST(findDataTypeIndexed) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        ck_assert(UA_findDataType(&UA_TYPES[i].typeId) == &UA_TYPES[i]);
+        const UA_DataType *first = NULL;
+        for(size_t j = 0; j <= i; j++) {
+            if(UA_NodeId_equal(&UA_TYPES[j].binaryEncodingId,
+                               &UA_TYPES[i].binaryEncodingId)) {
+                first = &UA_TYPES[j];
+                break;
+            }
+        }
+        ck_assert(UA_findDataTypeByBinary(&UA_TYPES[i].binaryEncodingId) == first);
+    }
+
+    ck_assert(UA_findDataTypeWithCustom(&PointType.typeId,
+                                        &customDataTypesUnion) == &PointType);
+    ck_assert(UA_findDataTypeWithCustom(&UniType.typeId,
+                                        &customDataTypesUnion) == &UniType);
+    ck_assert(UA_findDataTypeWithCustom(&PointType.typeId, NULL) == NULL);
+} END_TEST
+
+#define DECODE_EO_COUNT 100000
+
+/* Decode an array of many ExtensionObjects with the custom type at the end of
+ * the custom types list */
+START_TEST(decodeCustomExtensionObjectArraySpeed) {
+    Point p = {1.0, 2.0, 3.0};
+    UA_ExtensionObject *eos = (UA_ExtensionObject*)
+        UA_Array_new(DECODE_EO_COUNT, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    ck_assert(eos != NULL);
+    for(size_t i = 0; i < DECODE_EO_COUNT; i++)
+        UA_ExtensionObject_setValueNoDelete(&eos[i], &p, &PointType);
+
+    /* The first member has a different type. So the array is not unwrapped
+     * and the type of every member is looked up. */
+    UA_Argument arg;
+    UA_Argument_init(&arg);
+    UA_ExtensionObject_setValueNoDelete(&eos[0], &arg, &UA_TYPES[UA_TYPES_ARGUMENT]);
+
+    UA_Variant var;
+    UA_Variant_setArray(&var, eos, DECODE_EO_COUNT,
+                        &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode retval = UA_encodeBinary(&var, &UA_TYPES[UA_TYPES_VARIANT], &buf);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DateTime start = UA_DateTime_nowMonotonic();
+    UA_Variant var2;
+    size_t offset = 0;
+    retval = UA_decodeBinaryInternal(&buf, &offset, &var2, &UA_TYPES[UA_TYPES_VARIANT],
+                                     &customDataTypesUnion);
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    printf("Decoded %u custom ExtensionObjects in %.2f ms\n",
+           (unsigned)DECODE_EO_COUNT, (double)(end - start) / UA_DATETIME_MSEC);
+
+    ck_assert(var2.type == &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    ck_assert_uint_eq(var2.arrayLength, DECODE_EO_COUNT);
+    UA_ExtensionObject *eos2 = (UA_ExtensionObject*)var2.data;
+    ck_assert(eos2[0].content.decoded.type == &UA_TYPES[UA_TYPES_ARGUMENT]);
+    for(size_t i = 1; i < DECODE_EO_COUNT; i++) {
+        ck_assert_int_eq(eos2[i].encoding, UA_EXTENSIONOBJECT_DECODED);
+        ck_assert(eos2[i].content.decoded.type == &PointType);
+    }
+    Point *p2 = (Point*)eos2[DECODE_EO_COUNT - 1].content.decoded.data;
+    ck_assert((int)p2->z == 3);
+
+    UA_Variant_clear(&var2);
+    UA_Array_delete(eos, DECODE_EO_COUNT, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    UA_ByteString_clear(&buf);
+} END_TEST
+
 int main(void) {
     Suite *s  = suite_create("Test Custom DataType Encoding");
     TCase *tc = tcase_create("test cases");
@@ -709,6 +784,8 @@ int main(void) {
     tcase_add_test(tc, parseSelfContainingUnionSelfMember);
     tcase_add_test(tc, parseCustomStructureWithOptionalFieldsWithArrayNotContained);
     tcase_add_test(tc, parseCustomStructureWithOptionalFieldsWithArrayContained);
+    tcase_add_test(tc, findDataTypeIndexed);
+    tcase_add_test(tc, decodeCustomExtensionObjectArraySpeed);
     suite_add_tcase(s, tc);
 
     SRunner *sr = srunner_create(s);
@@ -0,0 +1,282 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Decoding from a message that is split into slices. The result must not
+ * depend on where the message is split. Measures the decoding of a large
+ * WriteRequest from 64 KB slices against concatenating the slices first. */
+
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+
+#include "ua_types_encoding_binary.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <check.h>
+
+static UA_ByteString encoded;
+static UA_WriteRequest request;
+static UA_WriteRequest reference; /* Decoded from the contiguous message */
+
+/* A request that covers the types with special handling in the decoding:
+ * numeric arrays, Guids, ExpandedNodeIds and ExtensionObject arrays that are
+ * unwrapped (or not) in Variants. */
+static void setup(void) {
+    UA_WriteRequest_init(&request);
+    request.requestHeader.timestamp = 1234567890;
+    request.requestHeader.authenticationToken =
+        UA_NODEID_GUID(1, UA_GUID("09087e75-8e5e-499b-954f-f2a9603db28a"));
+    request.nodesToWrite = (UA_WriteValue*)
+        UA_Array_new(6, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+    request.nodesToWriteSize = 6;
+    for(size_t i = 0; i < 6; i++) {
+        request.nodesToWrite[i].nodeId = UA_NODEID_STRING_ALLOC(1, "Variable");
+        request.nodesToWrite[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        request.nodesToWrite[i].value.hasValue = true;
+        request.nodesToWrite[i].value.hasSourceTimestamp = true;
+        request.nodesToWrite[i].value.sourceTimestamp = (UA_DateTime)i;
+    }
+
+    UA_Double doubles[17];
+    for(size_t i = 0; i < 17; i++)
+        doubles[i] = (UA_Double)i / 3.0;
+    UA_Variant_setArrayCopy(&request.nodesToWrite[0].value.value, doubles, 17,
+                            &UA_TYPES[UA_TYPES_DOUBLE]);
+
+    UA_Boolean bools[5] = {true, false, true, true, false};
+    UA_Variant_setArrayCopy(&request.nodesToWrite[1].value.value, bools, 5,
+                            &UA_TYPES[UA_TYPES_BOOLEAN]);
+
+    UA_ExpandedNodeId en = UA_EXPANDEDNODEID_STRING(2, "Expanded");
+    en.namespaceUri = UA_STRING("urn:test");
+    en.serverIndex = 3;
+    UA_Variant_setScalarCopy(&request.nodesToWrite[2].value.value, &en,
+                             &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+
+    /* ExtensionObject array with the same type. Unwrapped during decoding. */
+    UA_Range ranges[3] = {{0.0, 1.0}, {2.0, 3.0}, {4.0, 5.0}};
+    UA_ExtensionObject eos[3];
+    for(size_t i = 0; i < 3; i++)
+        UA_ExtensionObject_setValue(&eos[i], &ranges[i], &UA_TYPES[UA_TYPES_RANGE]);
+    UA_Variant_setArrayCopy(&request.nodesToWrite[3].value.value, eos, 3,
+                            &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+
+    /* Different types. Not unwrapped. */
+    UA_Argument arg;
+    UA_Argument_init(&arg);
+    arg.name = UA_STRING("Argument");
+    arg.valueRank = -1;
+    UA_ExtensionObject_setValue(&eos[1], &arg, &UA_TYPES[UA_TYPES_ARGUMENT]);
+    UA_Variant_setArrayCopy(&request.nodesToWrite[4].value.value, eos, 3,
+                            &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+
+    UA_Guid guid = UA_GUID("7d7a6bb1-4a53-4dc0-9b2c-b51a0ae9f6a1");
+    UA_Variant_setScalarCopy(&request.nodesToWrite[5].value.value, &guid,
+                             &UA_TYPES[UA_TYPES_GUID]);
+
+    UA_ByteString_init(&encoded);
+    UA_StatusCode res =
+        UA_encodeBinary(&request, &UA_TYPES[UA_TYPES_WRITEREQUEST], &encoded);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_decodeBinary(&encoded, &reference, &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasArrayType(&reference.nodesToWrite[3].value.value,
+                                      &UA_TYPES[UA_TYPES_RANGE]));
+    ck_assert(UA_Variant_hasArrayType(&reference.nodesToWrite[4].value.value,
+                                      &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]));
+}
+
+static void teardown(void) {
+    UA_WriteRequest_clear(&request);
+    UA_WriteRequest_clear(&reference);
+    UA_ByteString_clear(&encoded);
+}
+
+/* Decode from the slices and compare with the contiguous decoding */
+static void
+decodeSlices(const UA_ByteString *slices, size_t slicesSize) {
+    UA_WriteRequest decoded;
+    size_t offset = 0;
+    UA_StatusCode res =
+        UA_decodeBinarySlicesInternal(slices, slicesSize, &offset, &decoded,
+                                      &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(offset, encoded.length);
+    ck_assert(UA_order(&decoded, &reference,
+                       &UA_TYPES[UA_TYPES_WRITEREQUEST]) == UA_ORDER_EQ);
+    UA_WriteRequest_clear(&decoded);
+}
+
+/* Split into two slices at every position */
+START_TEST(splitTwice) {
+    for(size_t i = 0; i <= encoded.length; i++) {
+        UA_ByteString slices[2] = {{i, encoded.data},
+                                   {encoded.length - i, &encoded.data[i]}};
+        decodeSlices(slices, 2);
+    }
+} END_TEST
+
+/* Split into slices of the same length. With empty slices in between. */
+START_TEST(splitEvenly) {
+    UA_ByteString *slices = (UA_ByteString*)
+        UA_malloc(sizeof(UA_ByteString) * encoded.length * 2);
+    ck_assert_ptr_ne(slices, NULL);
+    for(size_t length = 1; length <= 17; length++) {
+        size_t slicesSize = 0;
+        for(size_t i = 0; i < encoded.length; i += length) {
+            slices[slicesSize].data = &encoded.data[i];
+            slices[slicesSize].length = (i + length > encoded.length) ?
+                encoded.length - i : length;
+            slicesSize++;
+            if(length % 2 == 0) {
+                slices[slicesSize].data = NULL;
+                slices[slicesSize].length = 0;
+                slicesSize++;
+            }
+        }
+        decodeSlices(slices, slicesSize);
+    }
+    UA_free(slices);
+} END_TEST
+
+/* Decoding continues at the offset. Truncated messages fail. */
+START_TEST(offsetAndTruncated) {
+    UA_ByteString slices[3] = {{10, encoded.data}, {10, &encoded.data[10]},
+                               {encoded.length - 20, &encoded.data[20]}};
+
+    /* Decode the RequestHeader, then the rest */
+    size_t offset = 0;
+    UA_RequestHeader header;
+    UA_StatusCode res =
+        UA_decodeBinarySlicesInternal(slices, 3, &offset, &header,
+                                      &UA_TYPES[UA_TYPES_REQUESTHEADER], NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_order(&header, &request.requestHeader,
+                       &UA_TYPES[UA_TYPES_REQUESTHEADER]) == UA_ORDER_EQ);
+    ck_assert_uint_gt(offset, 20);
+    UA_RequestHeader_clear(&header);
+    UA_Int32 nodesToWriteSize = 0;
+    res = UA_decodeBinarySlicesInternal(slices, 3, &offset, &nodesToWriteSize,
+                                        &UA_TYPES[UA_TYPES_INT32], NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(nodesToWriteSize, 6);
+
+    offset = 0;
+    UA_WriteRequest decoded;
+    res = UA_decodeBinarySlicesInternal(slices, 3, &offset, &decoded,
+                                        &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_WriteRequest_clear(&decoded);
+
+    for(size_t len = 0; len < encoded.length; len += 7) {
+        UA_ByteString truncated[2] = {{len / 2, encoded.data},
+                                      {len - len / 2, &encoded.data[len / 2]}};
+        offset = 0;
+        res = UA_decodeBinarySlicesInternal(truncated, 2, &offset, &decoded,
+                                            &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                            NULL, NULL);
+        ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    }
+} END_TEST
+
+#define LARGE_SIZE (16 * 1024 * 1024)
+#define SLICE_SIZE (64 * 1024)
+#define ITERATIONS 10
+
+/* 16 MB WriteRequest from 64 KB chunk payloads */
+START_TEST(largeWriteRequest) {
+    UA_ByteString value;
+    UA_StatusCode res = UA_ByteString_allocBuffer(&value, LARGE_SIZE);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    memset(value.data, 0x2a, value.length);
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = UA_NODEID_NUMERIC(1, 1);
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value.hasValue = true;
+    UA_Variant_setScalar(&wv.value.value, &value, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    UA_WriteRequest large;
+    UA_WriteRequest_init(&large);
+    large.nodesToWrite = &wv;
+    large.nodesToWriteSize = 1;
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    res = UA_encodeBinary(&large, &UA_TYPES[UA_TYPES_WRITEREQUEST], &buf);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    size_t slicesSize = (buf.length + SLICE_SIZE - 1) / SLICE_SIZE;
+    UA_ByteString *slices = (UA_ByteString*)UA_malloc(sizeof(UA_ByteString) * slicesSize);
+    ck_assert_ptr_ne(slices, NULL);
+    for(size_t i = 0; i < slicesSize; i++) {
+        slices[i].data = &buf.data[i * SLICE_SIZE];
+        slices[i].length = (i + 1 < slicesSize) ? SLICE_SIZE : buf.length - i * SLICE_SIZE;
+    }
+
+    /* Concatenate, then decode */
+    UA_WriteRequest decoded;
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < ITERATIONS; i++) {
+        UA_ByteString message;
+        res = UA_ByteString_allocBuffer(&message, buf.length);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        size_t pos = 0;
+        for(size_t j = 0; j < slicesSize; j++) {
+            memcpy(&message.data[pos], slices[j].data, slices[j].length);
+            pos += slices[j].length;
+        }
+        size_t offset = 0;
+        res = UA_decodeBinaryInternal(&message, &offset, &decoded,
+                                      &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_WriteRequest_clear(&decoded);
+        UA_ByteString_clear(&message);
+    }
+    UA_DateTime finish = UA_DateTime_nowMonotonic();
+    double concatMs = (double)(finish - begin) / UA_DATETIME_MSEC / ITERATIONS;
+
+    /* Decode from the slices */
+    begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < ITERATIONS; i++) {
+        size_t offset = 0;
+        res = UA_decodeBinarySlicesInternal(slices, slicesSize, &offset, &decoded,
+                                            &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                            NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(UA_order(&decoded, &large,
+                           &UA_TYPES[UA_TYPES_WRITEREQUEST]) == UA_ORDER_EQ);
+        UA_WriteRequest_clear(&decoded);
+    }
+    finish = UA_DateTime_nowMonotonic();
+    double slicesMs = (double)(finish - begin) / UA_DATETIME_MSEC / ITERATIONS;
+
+    printf("WriteRequest of %u bytes in %u slices: concatenate and decode %.2f ms, "
+           "decode slices %.2f ms\n", (unsigned)buf.length, (unsigned)slicesSize,
+           concatMs, slicesMs);
+
+    UA_free(slices);
+    UA_ByteString_clear(&buf);
+    UA_ByteString_clear(&value);
+} END_TEST
+
+static Suite *testSuite_decodeSlices(void) {
+    Suite *s = suite_create("Decode Slices");
+    TCase *tc = tcase_create("Decode Slices");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, splitTwice);
+    tcase_add_test(tc, splitEvenly);
+    tcase_add_test(tc, offsetAndTruncated);
+    tcase_add_test(tc, largeWriteRequest);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_decodeSlices();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
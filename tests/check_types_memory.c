@@ -226,6 +226,89 @@ START_TEST(calcSizeBinaryShallBeCorrect) {
 }
 END_TEST
 
+START_TEST(sharedVariantCopyShallShareTheData) {
+    UA_String a[3] = {UA_STRING_STATIC("a"), UA_STRING_STATIC("bb"),
+                      UA_STRING_STATIC("ccc")};
+    UA_Variant v;
+    UA_StatusCode retval =
+        UA_Variant_setArrayCopy(&v, a, 3, &UA_TYPES[UA_TYPES_STRING]);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Variant_makeShared(&v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(v.storageType, UA_VARIANT_DATA_SHARED);
+
+    UA_Variant c1, c2;
+    retval = UA_Variant_copy(&v, &c1);
+    retval |= UA_Variant_copy(&c1, &c2);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(c1.data, v.data);
+    ck_assert_ptr_eq(c2.data, v.data);
+    ck_assert(UA_Variant_equal(&c1, &v));
+
+    /* The copy-on-write leaves the other copies untouched */
+    retval = UA_Variant_makeWritable(&c1);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(c1.storageType, UA_VARIANT_DATA);
+    ck_assert_ptr_ne(c1.data, v.data);
+    ck_assert(UA_Variant_equal(&c1, &v));
+    UA_String_clear(&((UA_String*)c1.data)[0]);
+    ck_assert(!UA_Variant_equal(&c1, &v));
+    ck_assert_uint_eq(((UA_String*)c2.data)[0].length, 1);
+
+    /* Clear in any order */
+    UA_Variant_clear(&v);
+    UA_Variant_clear(&c1);
+    ck_assert(UA_String_equal(&((UA_String*)c2.data)[2], &a[2]));
+
+    /* Moved out of the buffer with the last reference */
+    void *shared = c2.data;
+    retval = UA_Variant_makeWritable(&c2);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(c2.storageType, UA_VARIANT_DATA);
+    ck_assert_ptr_ne(c2.data, shared);
+    ck_assert(UA_String_equal(&((UA_String*)c2.data)[1], &a[1]));
+    UA_Variant_clear(&c2);
+}
+END_TEST
+
+START_TEST(sharedVariantFromBorrowedData) {
+    UA_Double d[4] = {1.0, 2.0, 3.0, 4.0};
+    UA_UInt32 dims[2] = {2, 2};
+    UA_Variant v;
+    UA_Variant_setArray(&v, d, 4, &UA_TYPES[UA_TYPES_DOUBLE]);
+    v.arrayDimensions = dims;
+    v.arrayDimensionsSize = 2;
+    v.storageType = UA_VARIANT_DATA_NODELETE;
+
+    UA_StatusCode retval = UA_Variant_makeShared(&v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(v.storageType, UA_VARIANT_DATA_SHARED);
+    ck_assert_ptr_ne(v.data, d);
+    ck_assert_ptr_ne(v.arrayDimensions, dims);
+    ck_assert_uint_eq(v.arrayDimensions[1], 2);
+
+    /* Setting a range copies the shared data first */
+    UA_Variant c;
+    retval = UA_Variant_copy(&v, &c);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Double n = 5.0;
+    UA_NumericRangeDimension rd[2] = {{1, 1}, {1, 1}};
+    UA_NumericRange range = {2, rd};
+    retval = UA_Variant_setRangeCopy(&c, &n, 1, range);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(((UA_Double*)v.data)[3] == 4.0);
+    ck_assert(((UA_Double*)c.data)[3] == 5.0);
+    UA_Variant_clear(&c);
+    UA_Variant_clear(&v);
+
+    /* Empty variants are not shared */
+    UA_Variant_init(&v);
+    retval = UA_Variant_makeShared(&v);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(v.storageType, UA_VARIANT_DATA);
+}
+END_TEST
+
 int main(void) {
     int number_failed = 0;
     SRunner *sr;
@@ -252,6 +335,11 @@ int main(void) {
     tcase_add_loop_test(tc, calcSizeBinaryShallBeCorrect, UA_TYPES_BOOLEAN, UA_TYPES_COUNT - 1);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("Shared Variants");
+    tcase_add_test(tc, sharedVariantCopyShallShareTheData);
+    tcase_add_test(tc, sharedVariantFromBorrowedData);
+    suite_add_tcase(s, tc);
+
     sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
     srunner_run_all (sr, CK_NORMAL);
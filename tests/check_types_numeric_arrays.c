@@ -0,0 +1,201 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* En-/decoding of large numeric arrays. Measures the throughput in GB/s for
+ * every numeric type and tests the conversion across chunk boundaries. */
+
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+
+#include "ua_types_encoding_binary.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <check.h>
+
+#define ELEMENTS (1024 * 1024)
+#define ITERATIONS 20
+
+static const UA_UInt16 numericTypes[] = {
+    UA_TYPES_BOOLEAN, UA_TYPES_SBYTE, UA_TYPES_BYTE, UA_TYPES_INT16,
+    UA_TYPES_UINT16, UA_TYPES_INT32, UA_TYPES_UINT32, UA_TYPES_INT64,
+    UA_TYPES_UINT64, UA_TYPES_FLOAT, UA_TYPES_DOUBLE, UA_TYPES_DATETIME,
+    UA_TYPES_STATUSCODE
+};
+
+/* Fill the array with values that survive the roundtrip */
+static void
+fillArray(void *array, size_t length, const UA_DataType *type) {
+    UA_Byte *bytes = (UA_Byte*)array;
+    UA_UInt32 seed = 42;
+    for(size_t i = 0; i < length; i++) {
+        void *p = &bytes[i * type->memSize];
+        seed = seed * 1103515245 + 12345;
+        switch(type->typeKind) {
+        case UA_DATATYPEKIND_BOOLEAN:
+            *(UA_Boolean*)p = (seed >> 16) & 0x01;
+            break;
+        case UA_DATATYPEKIND_FLOAT:
+            *(UA_Float*)p = (UA_Float)seed / 7.0f;
+            break;
+        case UA_DATATYPEKIND_DOUBLE:
+            *(UA_Double*)p = (UA_Double)seed / 7.0;
+            break;
+        default:
+            for(size_t j = 0; j < type->memSize; j++)
+                ((UA_Byte*)p)[j] = (UA_Byte)(seed >> (j % 4 * 8));
+            break;
+        }
+    }
+}
+
+START_TEST(numericArrayThroughput) {
+    const UA_DataType *type = &UA_TYPES[numericTypes[_i]];
+    void *array = UA_Array_new(ELEMENTS, type);
+    ck_assert(array != NULL);
+    fillArray(array, ELEMENTS, type);
+
+    UA_Variant v;
+    UA_Variant_setArray(&v, array, ELEMENTS, type);
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &buf);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(UA_calcSizeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT]), buf.length);
+
+    UA_Variant decoded;
+    res = UA_decodeBinary(&buf, &decoded, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_order(&decoded, &v, &UA_TYPES[UA_TYPES_VARIANT]) == UA_ORDER_EQ);
+    UA_Variant_clear(&decoded);
+
+    /* Measure */
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < ITERATIONS; i++) {
+        UA_Byte *pos = buf.data;
+        const UA_Byte *end = &buf.data[buf.length];
+        res = UA_encodeBinaryInternal(&v, &UA_TYPES[UA_TYPES_VARIANT],
+                                      &pos, &end, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    UA_DateTime finish = UA_DateTime_nowMonotonic();
+    double encodeNs = (double)(finish - begin) * 100.0;
+
+    begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < ITERATIONS; i++) {
+        res = UA_decodeBinary(&buf, &decoded, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&decoded);
+    }
+    finish = UA_DateTime_nowMonotonic();
+    double decodeNs = (double)(finish - begin) * 100.0;
+
+    /* Bytes per ns equals GB/s */
+    double bytes = (double)buf.length * ITERATIONS;
+    printf("%-12s %8u bytes: encode %6.2f GB/s, decode %6.2f GB/s\n",
+           type->typeName, (unsigned)buf.length, bytes / encodeNs, bytes / decodeNs);
+
+    UA_ByteString_clear(&buf);
+    UA_Array_delete(array, ELEMENTS, type);
+} END_TEST
+
+/* Collects the chunks into one buffer. The chunks have an odd length so that
+ * elements are split across the chunk boundary. */
+#define CHUNKSIZE 13
+
+typedef struct {
+    UA_Byte chunk[CHUNKSIZE];
+    UA_ByteString collected;
+} ChunkCollector;
+
+static UA_StatusCode
+exchangeChunk(void *handle, UA_Byte **bufPos, const UA_Byte **bufEnd) {
+    ChunkCollector *cc = (ChunkCollector*)handle;
+    size_t length = (size_t)(*bufPos - cc->chunk);
+    UA_Byte *data = (UA_Byte*)UA_realloc(cc->collected.data,
+                                         cc->collected.length + length);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memcpy(&data[cc->collected.length], cc->chunk, length);
+    cc->collected.data = data;
+    cc->collected.length += length;
+    *bufPos = cc->chunk;
+    *bufEnd = &cc->chunk[CHUNKSIZE];
+    return UA_STATUSCODE_GOOD;
+}
+
+START_TEST(numericArrayChunks) {
+    const UA_DataType *type = &UA_TYPES[numericTypes[_i]];
+    size_t length = 1000;
+    void *array = UA_Array_new(length, type);
+    ck_assert(array != NULL);
+    fillArray(array, length, type);
+
+    UA_Variant v;
+    UA_Variant_setArray(&v, array, length, type);
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &buf);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    ChunkCollector cc;
+    memset(&cc, 0, sizeof(ChunkCollector));
+    UA_Byte *pos = cc.chunk;
+    const UA_Byte *end = &cc.chunk[CHUNKSIZE];
+    res = UA_encodeBinaryInternal(&v, &UA_TYPES[UA_TYPES_VARIANT],
+                                  &pos, &end, exchangeChunk, &cc);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = exchangeChunk(&cc, &pos, &end); /* Collect the last chunk */
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_ByteString_equal(&buf, &cc.collected));
+
+    /* Decoding a truncated array fails */
+    UA_Variant decoded;
+    UA_ByteString truncated = {buf.length - 1, buf.data};
+    res = UA_decodeBinary(&truncated, &decoded, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+    ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+
+    UA_ByteString_clear(&cc.collected);
+    UA_ByteString_clear(&buf);
+    UA_Array_delete(array, length, type);
+} END_TEST
+
+/* Booleans are normalized to 0/1 during decoding */
+START_TEST(booleanArrayNormalized) {
+    UA_Byte encoded[] = {0x81, 0x05, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0xff, 0x00};
+    UA_ByteString buf = {sizeof(encoded), encoded};
+    UA_Variant decoded;
+    UA_StatusCode res =
+        UA_decodeBinary(&buf, &decoded, &UA_TYPES[UA_TYPES_VARIANT], NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasArrayType(&decoded, &UA_TYPES[UA_TYPES_BOOLEAN]));
+    ck_assert_uint_eq(decoded.arrayLength, 5);
+    UA_Boolean *dst = (UA_Boolean*)decoded.data;
+    ck_assert(dst[0] == false);
+    ck_assert(dst[1] == true);
+    ck_assert(dst[2] == true);
+    ck_assert(dst[3] == true);
+    ck_assert(dst[4] == false);
+    UA_Variant_clear(&decoded);
+} END_TEST
+
+static Suite *testSuite_numericArrays(void) {
+    Suite *s = suite_create("Numeric Arrays");
+    TCase *tc = tcase_create("Numeric Arrays");
+    tcase_set_timeout(tc, 60);
+    int typesSize = (int)(sizeof(numericTypes) / sizeof(numericTypes[0]));
+    tcase_add_loop_test(tc, numericArrayThroughput, 0, typesSize);
+    tcase_add_loop_test(tc, numericArrayChunks, 0, typesSize);
+    tcase_add_test(tc, booleanArrayNormalized);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_numericArrays();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,267 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Compares the precompiled binary en-/decoding of the structures in UA_TYPES
+ * with the generic en-/decoding that interprets the type description. For the
+ * generic version, a copy of UA_TYPES is used. The precompiled functions are
+ * only used for types from the original array. */
+
+#include <open62541/types.h>
+#include <open62541/types_generated_handling.h>
+
+#include "ua_types_encoding_binary.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <check.h>
+
+#define ITERATIONS 2000
+
+static UA_DataType *interpreted;
+
+static void setup(void) {
+    interpreted = (UA_DataType*)UA_malloc(sizeof(UA_DataType) * UA_TYPES_COUNT);
+    ck_assert(interpreted != NULL);
+    memcpy(interpreted, UA_TYPES, sizeof(UA_DataType) * UA_TYPES_COUNT);
+
+    /* The members point to the copied types */
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        UA_DataType *type = &interpreted[i];
+        if(type->membersSize == 0)
+            continue;
+        UA_DataTypeMember *members = (UA_DataTypeMember*)
+            UA_malloc(sizeof(UA_DataTypeMember) * type->membersSize);
+        ck_assert(members != NULL);
+        memcpy(members, type->members, sizeof(UA_DataTypeMember) * type->membersSize);
+        for(size_t j = 0; j < type->membersSize; j++)
+            members[j].memberType = &interpreted[members[j].memberType - UA_TYPES];
+        type->members = members;
+    }
+}
+
+static void teardown(void) {
+    for(size_t i = 0; i < UA_TYPES_COUNT; i++) {
+        if(interpreted[i].membersSize > 0)
+            UA_free(interpreted[i].members);
+    }
+    UA_free(interpreted);
+}
+
+/* Encodes, sizes and decodes the value with both versions and compares the
+ * results */
+static void
+compare(const char *name, const void *p, UA_UInt16 typeIndex) {
+    const UA_DataType *type = &UA_TYPES[typeIndex];
+    const UA_DataType *itype = &interpreted[typeIndex];
+
+    UA_ByteString buf1 = UA_BYTESTRING_NULL;
+    UA_ByteString buf2 = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(p, type, &buf1);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_encodeBinary(p, itype, &buf2);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_ByteString_equal(&buf1, &buf2));
+    ck_assert_uint_eq(UA_calcSizeBinary(p, type), buf1.length);
+    ck_assert_uint_eq(UA_calcSizeBinary(p, itype), buf1.length);
+
+    void *dst1 = UA_new(type);
+    void *dst2 = UA_new(type);
+    res = UA_decodeBinary(&buf1, dst1, type, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_decodeBinary(&buf1, dst2, itype, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_order(dst1, p, type) == UA_ORDER_EQ);
+    ck_assert(UA_order(dst2, p, type) == UA_ORDER_EQ);
+    UA_delete(dst1, type);
+    UA_delete(dst2, type);
+
+    if(!name) {
+        UA_ByteString_clear(&buf1);
+        UA_ByteString_clear(&buf2);
+        return;
+    }
+
+    /* Measure */
+    double ns[2][3];
+    const UA_DataType *types[2] = {type, itype};
+    UA_Byte *pos;
+    const UA_Byte *end;
+    for(size_t t = 0; t < 2; t++) {
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        for(size_t i = 0; i < ITERATIONS; i++) {
+            pos = buf2.data;
+            end = &buf2.data[buf2.length];
+            res = UA_encodeBinaryInternal(p, types[t], &pos, &end, NULL, NULL);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+        UA_DateTime finish = UA_DateTime_nowMonotonic();
+        ns[t][0] = (double)(finish - begin) * 100.0 / ITERATIONS;
+
+        begin = UA_DateTime_nowMonotonic();
+        for(size_t i = 0; i < ITERATIONS; i++)
+            ck_assert_uint_eq(UA_calcSizeBinary(p, types[t]), buf1.length);
+        finish = UA_DateTime_nowMonotonic();
+        ns[t][1] = (double)(finish - begin) * 100.0 / ITERATIONS;
+
+        void *dst = UA_new(type);
+        begin = UA_DateTime_nowMonotonic();
+        for(size_t i = 0; i < ITERATIONS; i++) {
+            res = UA_decodeBinary(&buf1, dst, types[t], NULL);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+            UA_clear(dst, type);
+        }
+        finish = UA_DateTime_nowMonotonic();
+        ns[t][2] = (double)(finish - begin) * 100.0 / ITERATIONS;
+        UA_delete(dst, type);
+    }
+
+    printf("%-24s %6u bytes: encode %8.1f / %8.1f ns, calcSize %8.1f / %8.1f ns, "
+           "decode %8.1f / %8.1f ns (precompiled / interpreted)\n",
+           name, (unsigned)buf1.length, ns[0][0], ns[1][0], ns[0][1], ns[1][1],
+           ns[0][2], ns[1][2]);
+
+    UA_ByteString_clear(&buf1);
+    UA_ByteString_clear(&buf2);
+}
+
+/* All structures in their initial state */
+START_TEST(compareInitialized) {
+    for(UA_UInt16 i = 0; i < UA_TYPES_COUNT; i++) {
+        void *p = UA_new(&UA_TYPES[i]);
+        compare(NULL, p, i);
+        UA_delete(p, &UA_TYPES[i]);
+    }
+} END_TEST
+
+START_TEST(compareReadRequest) {
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.requestHeader.timestamp = UA_DateTime_now();
+    request.requestHeader.requestHandle = 42;
+    request.maxAge = 1000.0;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request.nodesToRead = (UA_ReadValueId*)
+        UA_Array_new(100, &UA_TYPES[UA_TYPES_READVALUEID]);
+    request.nodesToReadSize = 100;
+    for(size_t i = 0; i < 100; i++) {
+        request.nodesToRead[i].nodeId = UA_NODEID_NUMERIC(1, (UA_UInt32)i + 50000);
+        request.nodesToRead[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    request.nodesToRead[0].nodeId = UA_NODEID_STRING_ALLOC(1, "Variable");
+    request.nodesToRead[1].dataEncoding = UA_QUALIFIEDNAME_ALLOC(0, "Default Binary");
+    compare("ReadRequest", &request, UA_TYPES_READREQUEST);
+    UA_ReadRequest_clear(&request);
+} END_TEST
+
+START_TEST(compareReadResponse) {
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    response.responseHeader.timestamp = UA_DateTime_now();
+    response.results = (UA_DataValue*)
+        UA_Array_new(100, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    response.resultsSize = 100;
+    for(size_t i = 0; i < 100; i++) {
+        UA_Double value = (UA_Double)i;
+        UA_Variant_setScalarCopy(&response.results[i].value, &value,
+                                 &UA_TYPES[UA_TYPES_DOUBLE]);
+        response.results[i].hasValue = true;
+        response.results[i].sourceTimestamp = UA_DateTime_now();
+        response.results[i].hasSourceTimestamp = true;
+    }
+    compare("ReadResponse", &response, UA_TYPES_READRESPONSE);
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
+START_TEST(comparePublishResponse) {
+    UA_DataChangeNotification *dcn = UA_DataChangeNotification_new();
+    dcn->monitoredItems = (UA_MonitoredItemNotification*)
+        UA_Array_new(100, &UA_TYPES[UA_TYPES_MONITOREDITEMNOTIFICATION]);
+    dcn->monitoredItemsSize = 100;
+    for(size_t i = 0; i < 100; i++) {
+        UA_Int32 value = (UA_Int32)i;
+        dcn->monitoredItems[i].clientHandle = (UA_UInt32)i;
+        UA_Variant_setScalarCopy(&dcn->monitoredItems[i].value.value, &value,
+                                 &UA_TYPES[UA_TYPES_INT32]);
+        dcn->monitoredItems[i].value.hasValue = true;
+    }
+
+    UA_PublishResponse response;
+    UA_PublishResponse_init(&response);
+    response.subscriptionId = 1;
+    response.notificationMessage.sequenceNumber = 2;
+    response.notificationMessage.publishTime = UA_DateTime_now();
+    response.notificationMessage.notificationData = UA_ExtensionObject_new();
+    response.notificationMessage.notificationDataSize = 1;
+    UA_ExtensionObject_setValue(response.notificationMessage.notificationData, dcn,
+                                &UA_TYPES[UA_TYPES_DATACHANGENOTIFICATION]);
+    compare("PublishResponse", &response, UA_TYPES_PUBLISHRESPONSE);
+    UA_PublishResponse_clear(&response);
+} END_TEST
+
+START_TEST(compareCreateSessionRequest) {
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    request.clientDescription.applicationUri =
+        UA_STRING_ALLOC("urn:open62541.unconfigured.application");
+    request.clientDescription.applicationType = UA_APPLICATIONTYPE_CLIENT;
+    request.endpointUrl = UA_STRING_ALLOC("opc.tcp://localhost:4840");
+    request.sessionName = UA_STRING_ALLOC("Session");
+    request.requestedSessionTimeout = 1200000.0;
+    request.maxResponseMessageSize = 1 << 24;
+    compare("CreateSessionRequest", &request, UA_TYPES_CREATESESSIONREQUEST);
+    UA_CreateSessionRequest_clear(&request);
+} END_TEST
+
+/* Decoding of truncated messages fails and leaves no allocated memory */
+START_TEST(decodeTruncated) {
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    UA_Int32 value = 42;
+    wv.nodeId = UA_NODEID_STRING(1, "Variable");
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value.hasValue = true;
+    UA_Variant_setScalar(&wv.value.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = &wv;
+    request.nodesToWriteSize = 1;
+
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode res =
+        UA_encodeBinary(&request, &UA_TYPES[UA_TYPES_WRITEREQUEST], &encoded);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_WriteRequest decoded;
+    for(size_t len = 0; len < encoded.length; len++) {
+        UA_ByteString truncated = {len, encoded.data};
+        res = UA_decodeBinary(&truncated, &decoded,
+                              &UA_TYPES[UA_TYPES_WRITEREQUEST], NULL);
+        ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+    }
+    UA_ByteString_clear(&encoded);
+} END_TEST
+
+static Suite *testSuite_precompiled(void) {
+    Suite *s = suite_create("Precompiled Binary Encoding");
+    TCase *tc = tcase_create("Compare with the interpreted encoding");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, compareInitialized);
+    tcase_add_test(tc, compareReadRequest);
+    tcase_add_test(tc, compareReadResponse);
+    tcase_add_test(tc, comparePublishResponse);
+    tcase_add_test(tc, compareCreateSessionRequest);
+    tcase_add_test(tc, decodeTruncated);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_precompiled();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -567,6 +567,69 @@ START_TEST(idOrderString) {
     ck_assert(UA_NodeId_order(&id_str_d, &id_str_c) == UA_ORDER_MORE);
 } END_TEST
 
+START_TEST(arenaAlloc) {
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+
+    /* Allocations are zeroed and aligned. The blocks grow with the demand. */
+    for(size_t i = 1; i < 2000; i++) {
+        UA_Byte *p = (UA_Byte*)UA_Arena_calloc(&arena, i, 3);
+        ck_assert(p != NULL);
+        ck_assert_uint_eq((uintptr_t)p % 8, 0);
+        for(size_t j = 0; j < i * 3; j++)
+            ck_assert_uint_eq(p[j], 0);
+        memset(p, 0xff, i * 3);
+    }
+    ck_assert_uint_eq(arena.allocCount, 1999);
+    ck_assert_uint_lt(arena.blockCount, 20);
+
+    /* Overflowing sizes are rejected */
+    ck_assert(UA_Arena_calloc(&arena, SIZE_MAX, 2) == NULL);
+
+    /* Large blocks are released by the reset */
+    UA_Arena_reset(&arena);
+    ck_assert(arena.blocks == NULL);
+
+    /* A small block is reused after the reset */
+    for(size_t i = 0; i < 30; i++)
+        ck_assert(UA_Arena_calloc(&arena, 1, 100) != NULL);
+    UA_Arena_reset(&arena);
+    size_t blocks = arena.blockCount;
+    for(size_t i = 0; i < 30; i++)
+        ck_assert(UA_Arena_calloc(&arena, 1, 100) != NULL);
+    ck_assert_uint_eq(arena.blockCount, blocks);
+
+    UA_Arena_clear(&arena);
+    ck_assert(arena.blocks == NULL);
+} END_TEST
+
+START_TEST(arenaHighWaterMark) {
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+
+    /* The first cycle overflows into several blocks */
+    for(size_t i = 0; i < 100; i++)
+        ck_assert(UA_Arena_calloc(&arena, 1, 200) != NULL);
+    ck_assert_uint_eq(arena.used, 100 * 200);
+    ck_assert_uint_eq(arena.highWaterMark, 100 * 200);
+    ck_assert_uint_gt(arena.blockCount, 1);
+
+    /* The reset replaces the chain with a single block that fits the
+     * high-water mark. The following cycles need no new blocks. */
+    UA_Arena_reset(&arena);
+    ck_assert_uint_eq(arena.used, 0);
+    size_t blocks = arena.blockCount;
+    for(size_t c = 0; c < 10; c++) {
+        for(size_t i = 0; i < 100; i++)
+            ck_assert(UA_Arena_calloc(&arena, 1, 200) != NULL);
+        UA_Arena_reset(&arena);
+    }
+    ck_assert_uint_eq(arena.blockCount, blocks);
+    ck_assert_uint_eq(arena.highWaterMark, 100 * 200);
+
+    UA_Arena_clear(&arena);
+} END_TEST
+
 static Suite* testSuite_Utils(void) {
     Suite *s = suite_create("Utils");
     TCase *tc_endpointUrl_split = tcase_create("EndpointUrl_split");
@@ -580,6 +643,8 @@ static Suite* testSuite_Utils(void) {
     tcase_add_test(tc_utils, readNumberWithBase);
     tcase_add_test(tc_utils, StatusCode_msg);
     tcase_add_test(tc_utils, stringCompare);
+    tcase_add_test(tc_utils, arenaAlloc);
+    tcase_add_test(tc_utils, arenaHighWaterMark);
     suite_add_tcase(s,tc_utils);
 
 
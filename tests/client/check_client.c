@@ -195,6 +195,47 @@ START_TEST(Client_read) {
 }
 END_TEST
 
+#ifdef UA_ENABLE_DIAGNOSTICS
+START_TEST(Client_read_latency) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ServiceLatency before;
+    retval = UA_Server_getServiceLatency(server, &UA_TYPES[UA_TYPES_READREQUEST],
+                                         &before);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Variant val;
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "my.variable");
+    for(size_t i = 0; i < 10; i++) {
+        retval = UA_Client_readValueAttribute(client, nodeId, &val);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        UA_Variant_clear(&val);
+    }
+
+    UA_ServiceLatency after;
+    retval = UA_Server_getServiceLatency(server, &UA_TYPES[UA_TYPES_READREQUEST],
+                                         &after);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(after.count, before.count + 10);
+    UA_UInt64 histogramCount = 0;
+    for(size_t i = 0; i < UA_SERVICELATENCY_BUCKETS; i++)
+        histogramCount += after.histogram[i];
+    ck_assert_uint_eq(histogramCount, after.count);
+    ck_assert(after.maxTime <= after.totalTime);
+
+    /* Not a service request */
+    retval = UA_Server_getServiceLatency(server, &UA_TYPES[UA_TYPES_READRESPONSE],
+                                         &after);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNOTFOUND);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+#endif
+
 START_TEST(Client_renewSecureChannel) {
     UA_Client *client = UA_Client_newForUnitTest();
     UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
@@ -440,6 +481,9 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_endpoints);
     tcase_add_test(tc_client, Client_endpoints_empty);
     tcase_add_test(tc_client, Client_read);
+#ifdef UA_ENABLE_DIAGNOSTICS
+    tcase_add_test(tc_client, Client_read_latency);
+#endif
     suite_add_tcase(s,tc_client);
     TCase *tc_client_reconnect = tcase_create("Client Reconnect");
     tcase_add_checked_fixture(tc_client_reconnect, setup, teardown);
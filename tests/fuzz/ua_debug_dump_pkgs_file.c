@@ -113,7 +113,7 @@ UA_debug_dumpSetServiceName(const UA_ByteString *msg, char serviceNameTarget[100
 static UA_StatusCode
 UA_debug_dump_setName(void *application, UA_SecureChannel *channel,
                       UA_MessageType messagetype, UA_UInt32 requestId,
-                      UA_ByteString *message) {
+                      UA_ByteString *message, size_t slicesSize) {
     struct UA_dump_filename *dump_filename = (struct UA_dump_filename *)application;
     dump_filename->messageType = UA_debug_dumpGetMessageTypePrefix(messagetype);
     if(messagetype == UA_MESSAGETYPE_MSG)
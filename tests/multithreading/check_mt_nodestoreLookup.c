@@ -0,0 +1,130 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Measures the lookups/sec of getNode/releaseNode from several threads for the
+ * Nodestore implementations. The ConcurrentHashMap additionally has a writer
+ * thread that replaces nodes during the lookups. */
+
+#include <open62541/plugin/nodestore_default.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "thread_wrapper.h"
+
+#define NODES 10000
+#define LOOKUP_THREADS 4
+#define LOOKUPS_PER_THREAD 1000000
+
+typedef struct {
+    const char *name;
+    UA_StatusCode (*init)(UA_Nodestore *ns);
+    UA_Boolean concurrentWrites;
+} NodestoreVariant;
+
+static const NodestoreVariant variants[] = {
+    {"HashMap", UA_Nodestore_HashMap, false},
+    {"ZipTree", UA_Nodestore_ZipTree, false},
+    {"ConcurrentHashMap", UA_Nodestore_ConcurrentHashMap, false},
+    {"ConcurrentHashMap (with writer)", UA_Nodestore_ConcurrentHashMap, true}
+};
+
+UA_Nodestore ns;
+volatile UA_Boolean writing;
+size_t threadIndex[LOOKUP_THREADS];
+
+static void
+addNodes(void) {
+    for(UA_UInt32 i = 0; i < NODES; i++) {
+        UA_Node *node = ns.newNode(ns.context, UA_NODECLASS_VARIABLE);
+        ck_assert(node != NULL);
+        node->head.nodeId = UA_NODEID_NUMERIC(1, i + 1);
+        UA_StatusCode res = ns.insertNode(ns.context, node, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+THREAD_CALLBACK_PARAM(lookupLoop, val) {
+    size_t index = *(size_t*)val;
+    UA_NodeId id = UA_NODEID_NUMERIC(1, 0);
+    UA_UInt32 next = (UA_UInt32)(index * (NODES / LOOKUP_THREADS));
+    for(size_t i = 0; i < LOOKUPS_PER_THREAD; i++) {
+        id.identifier.numeric = (next % NODES) + 1;
+        next += 7919; /* Prime stride to spread over the shards */
+        const UA_Node *node =
+            ns.getNode(ns.context, &id, UA_NODEATTRIBUTESMASK_NONE,
+                       UA_REFERENCETYPESET_NONE, UA_BROWSEDIRECTION_INVALID);
+        ck_assert(node != NULL);
+        ns.releaseNode(ns.context, node);
+    }
+    return 0;
+}
+
+THREAD_CALLBACK(writeLoop) {
+    UA_NodeId id = UA_NODEID_NUMERIC(1, 0);
+    UA_UInt32 next = 0;
+    while(writing) {
+        id.identifier.numeric = (next++ % NODES) + 1;
+        UA_Node *copy = NULL;
+        UA_StatusCode res = ns.getNodeCopy(ns.context, &id, &copy);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        res = ns.replaceNode(ns.context, copy);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    return 0;
+}
+
+START_TEST(lookupSpeed) {
+    const NodestoreVariant *v = &variants[_i];
+    UA_StatusCode res = v->init(&ns);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    addNodes();
+
+    THREAD_HANDLE writer;
+    writing = v->concurrentWrites;
+    if(writing)
+        THREAD_CREATE(writer, writeLoop);
+
+    THREAD_HANDLE threads[LOOKUP_THREADS];
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < LOOKUP_THREADS; i++) {
+        threadIndex[i] = i;
+        THREAD_CREATE_PARAM(threads[i], lookupLoop, threadIndex[i]);
+    }
+    for(size_t i = 0; i < LOOKUP_THREADS; i++)
+        THREAD_JOIN(threads[i]);
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+
+    if(writing) {
+        writing = false;
+        THREAD_JOIN(writer);
+    }
+
+    double duration = (double)(end - begin) / UA_DATETIME_SEC;
+    printf("%s: %.0f lookups/sec with %u threads\n", v->name,
+           (double)(LOOKUP_THREADS * LOOKUPS_PER_THREAD) / duration,
+           (unsigned)LOOKUP_THREADS);
+
+    ns.clear(ns.context);
+} END_TEST
+
+static Suite * testSuite_nodestoreLookup(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_lookup = tcase_create("Nodestore Lookup");
+    tcase_set_timeout(tc_lookup, 60);
+    tcase_add_loop_test(tc_lookup, lookupSpeed, 0,
+                        sizeof(variants) / sizeof(variants[0]));
+    suite_add_tcase(s, tc_lookup);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_nodestoreLookup();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,232 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Measures the throughput of Read requests from several clients with a varying
+ * number of service workers. The DataSource simulates a slow device access.
+ * Also checks that the requests of a session are answered in order. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_highlevel_async.h>
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+#include "mt_testing.h"
+
+#define NUMBER_OF_CLIENTS 8
+#define ITERATIONS_PER_CLIENT 50
+#define DATASOURCE_DELAY_MS 1
+#define ORDER_DELAY_MS 20
+#define ORDER_ITERATIONS 10
+
+static const UA_UInt16 serviceWorkers[] = {0, 1, 2, 4};
+
+UA_NodeId sensorId = {1, UA_NODEIDTYPE_NUMERIC, {1001}};
+
+static UA_StatusCode
+readSensor(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+           const UA_NodeId *nodeId, void *nodeContext, UA_Boolean sourceTimeStamp,
+           const UA_NumericRange *range, UA_DataValue *value) {
+    UA_realSleep(DATASOURCE_DELAY_MS);
+    UA_Int32 sensorValue = 42;
+    value->hasValue = true;
+    return UA_Variant_setScalarCopy(&value->value, &sensorValue,
+                                    &UA_TYPES[UA_TYPES_INT32]);
+}
+
+static void
+addSensorNode(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "Sensor");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    UA_DataSource dataSource;
+    dataSource.read = readSensor;
+    dataSource.write = NULL;
+    UA_StatusCode res =
+        UA_Server_addDataSourceVariableNode(tc.server, sensorId,
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "Sensor"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, dataSource, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+client_readSensor(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    UA_Variant val;
+    UA_StatusCode retval =
+        UA_Client_readValueAttribute(tc.clients[tmp.index], sensorId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(42, *(UA_Int32 *)val.data);
+    UA_Variant_clear(&val);
+}
+
+UA_NodeId orderId = {1, UA_NODEIDTYPE_NUMERIC, {1002}};
+UA_Int32 orderValue;
+
+static UA_StatusCode
+readOrder(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+          const UA_NodeId *nodeId, void *nodeContext, UA_Boolean sourceTimeStamp,
+          const UA_NumericRange *range, UA_DataValue *value) {
+    UA_realSleep(ORDER_DELAY_MS);
+    value->hasValue = true;
+    return UA_Variant_setScalarCopy(&value->value, &orderValue,
+                                    &UA_TYPES[UA_TYPES_INT32]);
+}
+
+static UA_StatusCode
+writeOrder(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+           const UA_NodeId *nodeId, void *nodeContext,
+           const UA_NumericRange *range, const UA_DataValue *value) {
+    if(!UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_INT32]))
+        return UA_STATUSCODE_BADTYPEMISMATCH;
+    orderValue = *(UA_Int32*)value->value.data;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addOrderNode(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "Order");
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_DataSource dataSource;
+    dataSource.read = readOrder;
+    dataSource.write = writeOrder;
+    UA_StatusCode res =
+        UA_Server_addDataSourceVariableNode(tc.server, orderId,
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "Order"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, dataSource, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+size_t responseCount;
+size_t readPosition;
+size_t writePosition;
+UA_Int32 readValue;
+
+static void
+orderReadCallback(UA_Client *client, void *userdata, UA_UInt32 requestId,
+                  UA_StatusCode status, UA_DataValue *value) {
+    readPosition = ++responseCount;
+    ck_assert_uint_eq(status, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_INT32]));
+    readValue = *(UA_Int32*)value->value.data;
+}
+
+static void
+orderWriteCallback(UA_Client *client, void *userdata,
+                   UA_UInt32 requestId, UA_WriteResponse *wr) {
+    writePosition = ++responseCount;
+    ck_assert_uint_eq(wr->responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+}
+
+/* The Read is processed by a worker. The Write that follows in the same session
+ * must neither be executed nor answered before it. */
+START_TEST(sessionOrder) {
+    tc.running = true;
+    tc.numberOfWorkers = 0;
+    tc.numberofClients = 0;
+    tc.checkServerNodes = NULL;
+    tc.server = UA_Server_newForUnitTest();
+    ck_assert(tc.server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(tc.server);
+    config->serviceWorkers = 2;
+    addOrderNode();
+    orderValue = 0;
+    UA_StatusCode res = UA_Server_run_startup(tc.server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client *client = UA_Client_newForUnitTest();
+    res = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    for(UA_Int32 i = 1; i <= ORDER_ITERATIONS; i++) {
+        responseCount = 0;
+        readPosition = 0;
+        writePosition = 0;
+        readValue = -1;
+
+        res = UA_Client_readValueAttribute_async(client, orderId,
+                                                 orderReadCallback, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        UA_Variant v;
+        UA_Variant_setScalar(&v, &i, &UA_TYPES[UA_TYPES_INT32]);
+        res = UA_Client_writeValueAttribute_async(client, orderId, &v,
+                                                  orderWriteCallback, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        UA_DateTime timeout = UA_DateTime_nowMonotonic() + 5 * UA_DATETIME_SEC;
+        while(responseCount < 2 && UA_DateTime_nowMonotonic() < timeout)
+            UA_Client_run_iterate(client, 10);
+        ck_assert_uint_eq(responseCount, 2);
+        ck_assert_uint_eq(readPosition, 1);
+        ck_assert_uint_eq(writePosition, 2);
+        ck_assert_int_eq(readValue, i - 1);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+    teardown();
+} END_TEST
+
+START_TEST(parallelRead) {
+    tc.running = true;
+    tc.server = UA_Server_newForUnitTest();
+    ck_assert(tc.server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(tc.server);
+    config->serviceWorkers = serviceWorkers[_i];
+    addSensorNode();
+    UA_StatusCode res = UA_Server_run_startup(tc.server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    THREAD_CREATE(server_thread, serverloop);
+
+    createThreadContext(0, NUMBER_OF_CLIENTS, NULL);
+    for(size_t i = 0; i < tc.numberofClients; i++)
+        setThreadContext(&tc.clientContext[i], i, ITERATIONS_PER_CLIENT,
+                         client_readSensor);
+
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    startMultithreading();
+    teardown(); /* Waits for the clients and stops the server */
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+    deleteThreadContext();
+
+    double duration = (double)(end - begin) / UA_DATETIME_SEC;
+    double requests = NUMBER_OF_CLIENTS * ITERATIONS_PER_CLIENT;
+    printf("%u service workers: %.0f requests/sec\n",
+           (unsigned)serviceWorkers[_i], requests / duration);
+} END_TEST
+
+static Suite * testSuite_parallelRead(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_parallel = tcase_create("Parallel Read");
+    tcase_set_timeout(tc_parallel, 60);
+    tcase_add_loop_test(tc_parallel, parallelRead, 0,
+                        sizeof(serviceWorkers) / sizeof(serviceWorkers[0]));
+    suite_add_tcase(s, tc_parallel);
+    TCase *tc_order = tcase_create("Session Order");
+    tcase_add_test(tc_order, sessionOrder);
+    suite_add_tcase(s, tc_order);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_parallelRead();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
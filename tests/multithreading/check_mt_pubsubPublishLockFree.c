@@ -0,0 +1,323 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* The publish cycle of a frozen WriterGroup with direct value access runs in a
+ * dedicated thread without the server lock. Measures the publish jitter while
+ * the server is busy with Browse requests. */
+
+#include <open62541/server_pubsub.h>
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+#include "ua_server_internal.h"
+#include "ua_pubsub.h"
+
+#define PUBLISH_INTERVAL_US 250
+#define BROWSE_ITERATIONS 5000
+
+UA_Server *server;
+UA_NodeId connectionId, publishedDataSetId, writerGroupId;
+UA_DataValue *staticSource;
+
+/* The publish callback registered by the WriterGroup */
+MUTEX_HANDLE callbackMutex;
+UA_ServerCallback publishCallback;
+void *publishData;
+volatile UA_Boolean publishDispatched; /* callback read, not yet returned */
+
+/* Publish thread */
+THREAD_HANDLE publishThread;
+volatile UA_Boolean publishRunning;
+volatile UA_UInt32 publishCycles;
+
+/* Statistics, reset by the main thread */
+volatile UA_DateTime maxLateness;
+volatile UA_DateTime maxDuration;
+volatile UA_DateTime sumDuration;
+volatile UA_UInt32 measuredCycles;
+
+static void
+lockCallback(void) {
+    if(!MUTEX_LOCK(callbackMutex))
+        abort();
+}
+
+static void
+unlockCallback(void) {
+    if(!MUTEX_UNLOCK(callbackMutex))
+        abort();
+}
+
+static UA_StatusCode
+addCustomCallback(UA_Server *s, UA_NodeId identifier, UA_ServerCallback callback,
+                  void *data, UA_Double interval_ms, UA_DateTime *baseTime,
+                  UA_TimerPolicy timerPolicy, UA_UInt64 *callbackId) {
+    lockCallback();
+    publishCallback = callback;
+    publishData = data;
+    unlockCallback();
+    *callbackId = 1;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The data of the lock-free callback is freed after the removal. Wait for a
+ * cycle that was dispatched before. The locked callback takes the server lock
+ * held by the caller and is not waited for. */
+static void
+removeCustomCallback(UA_Server *s, UA_NodeId identifier, UA_UInt64 callbackId) {
+    lockCallback();
+    UA_Boolean lockFree =
+        (publishCallback != (UA_ServerCallback)UA_WriterGroup_publishCallback);
+    publishCallback = NULL;
+    publishData = NULL;
+    unlockCallback();
+    while(lockFree && publishDispatched) {}
+}
+
+THREAD_CALLBACK(publishLoop) {
+    UA_DateTime next = UA_DateTime_nowMonotonic();
+    while(publishRunning) {
+        next += PUBLISH_INTERVAL_US * UA_DATETIME_USEC;
+        while(UA_DateTime_nowMonotonic() < next) {}
+
+        lockCallback();
+        UA_ServerCallback cb = publishCallback;
+        void *data = publishData;
+        publishDispatched = (cb != NULL);
+        unlockCallback();
+        if(!cb)
+            continue;
+
+        UA_DateTime start = UA_DateTime_nowMonotonic();
+        cb(server, data);
+        UA_DateTime end = UA_DateTime_nowMonotonic();
+        publishDispatched = false;
+
+        if(start - next > maxLateness)
+            maxLateness = start - next;
+        if(end - start > maxDuration)
+            maxDuration = end - start;
+        sumDuration += end - start;
+        measuredCycles++;
+        UA_atomic_addUInt32(&publishCycles, 1);
+
+        /* Don't catch up with missed cycles */
+        if(next < end)
+            next = end;
+    }
+    return 0;
+}
+
+static void
+resetStatistics(void) {
+    maxLateness = 0;
+    maxDuration = 0;
+    sumDuration = 0;
+    measuredCycles = 0;
+}
+
+static void
+printStatistics(const char *phase) {
+    UA_UInt32 cycles = measuredCycles;
+    printf("%s: %u cycles, duration avg %" PRIi64 " ns, max %" PRIi64
+           " ns, start max late %" PRIi64 " ns\n", phase, cycles,
+           (cycles > 0) ? (sumDuration * 100) / cycles : 0,
+           maxDuration * 100, maxLateness * 100);
+}
+
+/* Wait until the publish thread has done some cycles */
+static UA_Boolean
+waitForCycles(UA_UInt32 cycles) {
+    UA_UInt32 target = UA_atomic_addUInt32(&publishCycles, 0) + cycles;
+    UA_DateTime timeout = UA_DateTime_nowMonotonic() + 2 * UA_DATETIME_SEC;
+    while(UA_atomic_addUInt32(&publishCycles, 0) < target) {
+        if(UA_DateTime_nowMonotonic() > timeout)
+            return false;
+    }
+    return true;
+}
+
+static void setup(void) {
+    ck_assert(MUTEX_INIT(callbackMutex));
+    publishCallback = NULL;
+    publishData = NULL;
+    publishDispatched = false;
+    publishCycles = 0;
+    resetStatistics();
+
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(connectionConfig));
+    connectionConfig.name = UA_STRING("UDP-UADP Connection 1");
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.enabled = true;
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL , UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.uint16 = 2234;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("Demo PDS");
+    res = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_UInt32 *intValue = UA_UInt32_new();
+    staticSource = UA_DataValue_new();
+    UA_Variant_setScalar(&staticSource->value, intValue, &UA_TYPES[UA_TYPES_UINT32]);
+    staticSource->hasValue = true;
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = true;
+    dsfConfig.field.variable.rtValueSource.staticValueSource = &staticSource;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    res = UA_Server_addDataSetField(server, publishedDataSetId, &dsfConfig, NULL).result;
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = PUBLISH_INTERVAL_US / 1000.0;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel =
+        (UA_PubSubRTLevel)(UA_PUBSUB_RT_FIXED_SIZE | UA_PUBSUB_RT_DIRECT_VALUE_ACCESS);
+    writerGroupConfig.pubsubManagerCallback.addCustomCallback = addCustomCallback;
+    writerGroupConfig.pubsubManagerCallback.removeCustomCallback = removeCustomCallback;
+    UA_UadpWriterGroupMessageDataType wgm;
+    UA_UadpWriterGroupMessageDataType_init(&wgm);
+    wgm.networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    UA_ExtensionObject_setValue(&writerGroupConfig.messageSettings, &wgm,
+                                &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]);
+    res = UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig, &writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dswConfig;
+    memset(&dswConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dswConfig.name = UA_STRING("Demo DataSetWriter");
+    dswConfig.dataSetWriterId = 62541;
+    dswConfig.dataSetFieldContentMask = UA_DATASETFIELDCONTENTMASK_RAWDATA;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, publishedDataSetId,
+                                     &dswConfig, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_freezeWriterGroupConfiguration(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_enableWriterGroup(server, writerGroupId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+
+    publishRunning = true;
+    THREAD_CREATE(publishThread, publishLoop);
+}
+
+static void teardown(void) {
+    publishRunning = false;
+    THREAD_JOIN(publishThread);
+
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_DataValue_delete(staticSource);
+    ck_assert(MUTEX_DESTROY(callbackMutex));
+}
+
+START_TEST(PublishWhileServerLocked) {
+    /* The lock-free callback is registered */
+    lockCallback();
+    UA_Boolean lockFree =
+        (publishCallback != (UA_ServerCallback)UA_WriterGroup_publishCallback);
+    unlockCallback();
+    ck_assert(lockFree);
+
+    /* Publishing continues while the server is locked */
+    UA_LOCK(&server->serviceMutex);
+    UA_Boolean published = waitForCycles(20);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert(published);
+
+    UA_PubSubState state = UA_PUBSUBSTATE_DISABLED;
+    UA_Server_WriterGroup_getState(server, writerGroupId, &state);
+    ck_assert_int_eq(state, UA_PUBSUBSTATE_OPERATIONAL);
+} END_TEST
+
+START_TEST(PublishJitterUnderBrowseLoad) {
+    ck_assert(waitForCycles(100));
+    resetStatistics();
+    ck_assert(waitForCycles(1000));
+    printStatistics("Idle server");
+
+    /* Browse the Server object with all its references */
+    resetStatistics();
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+    bd.browseDirection = UA_BROWSEDIRECTION_BOTH;
+    bd.includeSubtypes = true;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    UA_UInt32 cyclesBefore = UA_atomic_addUInt32(&publishCycles, 0);
+    for(size_t i = 0; i < BROWSE_ITERATIONS; i++) {
+        UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+        ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+        UA_BrowseResult_clear(&br);
+    }
+    UA_UInt32 cyclesAfter = UA_atomic_addUInt32(&publishCycles, 0);
+    printStatistics("Browse load");
+    ck_assert_uint_gt(cyclesAfter, cyclesBefore);
+} END_TEST
+
+START_TEST(UnfreezeWhilePublishing) {
+    for(size_t i = 0; i < 100; i++) {
+        ck_assert(waitForCycles(2));
+        UA_StatusCode res =
+            UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupId);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        /* The buffer is released. The callback takes the server lock. */
+        lockCallback();
+        UA_Boolean locked =
+            (publishCallback == (UA_ServerCallback)UA_WriterGroup_publishCallback);
+        unlockCallback();
+        ck_assert(locked);
+
+        ck_assert(waitForCycles(2));
+        res = UA_Server_freezeWriterGroupConfiguration(server, writerGroupId);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_PubSubState state = UA_PUBSUBSTATE_DISABLED;
+    UA_Server_WriterGroup_getState(server, writerGroupId, &state);
+    ck_assert_int_eq(state, UA_PUBSUBSTATE_OPERATIONAL);
+} END_TEST
+
+int main(void) {
+    TCase *tc = tcase_create("PubSub lock-free publish");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, PublishWhileServerLocked);
+    tcase_add_test(tc, PublishJitterUnderBrowseLoad);
+    tcase_add_test(tc, UnfreezeWhilePublishing);
+
+    Suite *s = suite_create("PubSub Multithreading");
+    suite_add_tcase(s, tc);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
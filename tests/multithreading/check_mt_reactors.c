@@ -0,0 +1,98 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Measures the throughput of Read requests from several clients with a varying
+ * number of reactor threads handling the TCP connections. */
+
+#include <open62541/plugin/log_stdout.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+#include "mt_testing.h"
+
+#define NUMBER_OF_CLIENTS 8
+#define ITERATIONS_PER_CLIENT 200
+
+static const UA_UInt16 tcpReactors[] = {0, 1, 2, 4};
+
+UA_NodeId valueId = {1, UA_NODEIDTYPE_NUMERIC, {1001}};
+
+static void
+addValueNode(void) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "Value");
+    UA_StatusCode res =
+        UA_Server_addVariableNode(tc.server, valueId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Value"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+client_readValue(void *value) {
+    ThreadContext tmp = (*(ThreadContext *) value);
+    UA_Variant val;
+    UA_StatusCode retval =
+        UA_Client_readValueAttribute(tc.clients[tmp.index], valueId, &val);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(42, *(UA_Int32 *)val.data);
+    UA_Variant_clear(&val);
+}
+
+START_TEST(reactorRead) {
+    tc.running = true;
+    tc.server = UA_Server_newForUnitTest();
+    ck_assert(tc.server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(tc.server);
+    config->tcpReactors = tcpReactors[_i];
+    addValueNode();
+    UA_StatusCode res = UA_Server_run_startup(tc.server);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    THREAD_CREATE(server_thread, serverloop);
+
+    createThreadContext(0, NUMBER_OF_CLIENTS, NULL);
+    for(size_t i = 0; i < tc.numberofClients; i++)
+        setThreadContext(&tc.clientContext[i], i, ITERATIONS_PER_CLIENT,
+                         client_readValue);
+
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    startMultithreading();
+    teardown(); /* Waits for the clients and stops the server */
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+    deleteThreadContext();
+
+    double duration = (double)(end - begin) / UA_DATETIME_SEC;
+    double requests = NUMBER_OF_CLIENTS * ITERATIONS_PER_CLIENT;
+    printf("%u reactors: %.0f requests/sec\n",
+           (unsigned)tcpReactors[_i], requests / duration);
+} END_TEST
+
+static Suite * testSuite_reactors(void) {
+    Suite *s = suite_create("Multithreading");
+    TCase *tc_reactors = tcase_create("Reactors");
+    tcase_set_timeout(tc_reactors, 60);
+    tcase_add_loop_test(tc_reactors, reactorRead, 0,
+                        sizeof(tcpReactors) / sizeof(tcpReactors[0]));
+    suite_add_tcase(s, tc_reactors);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_reactors();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -9,6 +9,7 @@
 #include <open62541/types.h>
 
 #include "ua_pubsub_networkmessage.h"
+#include "util/ua_util_internal.h"
 
 #include "check.h"
 
@@ -1330,6 +1331,22 @@ START_TEST(UA_PubSub_EnDecode_ShallWorkOn2DSVariant) {
     ck_assert_int_eq(*(UA_Int64 *)m2.payload.dataSetPayload.dataSetMessages[1].data.deltaFrameData.deltaFrameFields[1].fieldValue.value.data, iv64);
     ck_assert(m.payload.dataSetPayload.dataSetMessages[1].data.deltaFrameData.deltaFrameFields[1].fieldValue.hasSourceTimestamp == m2.payload.dataSetPayload.dataSetMessages[1].data.deltaFrameData.deltaFrameFields[1].fieldValue.hasSourceTimestamp);
 
+    /* The decoded sizes are not reused once the DataSetMessage changes */
+    UA_Variant *v2 = &m2.payload.dataSetPayload.dataSetMessages[0].data.keyFrameData.dataSetFields[0].value;
+    UA_Variant_clear(v2);
+    UA_Variant_setScalarCopy(v2, &iv64, &UA_TYPES[UA_TYPES_INT64]);
+    UA_ByteString buffer2;
+    size_t msgSize2 = UA_NetworkMessage_calcSizeBinary(&m2, NULL);
+    ck_assert_uint_eq(msgSize2, msgSize + 4);
+    rv = UA_ByteString_allocBuffer(&buffer2, msgSize2);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    bufPos = buffer2.data;
+    bufEnd = &buffer2.data[buffer2.length];
+    rv = UA_NetworkMessage_encodeBinary(&m2, &bufPos, bufEnd, NULL);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert(bufPos == bufEnd);
+    UA_ByteString_clear(&buffer2);
+
     UA_Array_delete(m.payloadHeader.dataSetPayloadHeader.dataSetWriterIds, m.payloadHeader.dataSetPayloadHeader.count, &UA_TYPES[UA_TYPES_UINT16]);
     UA_Array_delete(m.payload.dataSetPayload.dataSetMessages[0].data.keyFrameData.dataSetFields, m.payload.dataSetPayload.dataSetMessages[0].data.keyFrameData.fieldCount, &UA_TYPES[UA_TYPES_DATAVALUE]);
     UA_free(m.payload.dataSetPayload.dataSetMessages[1].data.deltaFrameData.deltaFrameFields);
@@ -1340,12 +1357,106 @@ START_TEST(UA_PubSub_EnDecode_ShallWorkOn2DSVariant) {
 }
 END_TEST
 
+START_TEST(UA_PubSub_Decode_IntoArena) {
+    UA_NetworkMessage m;
+    memset(&m, 0, sizeof(UA_NetworkMessage));
+    m.version = 1;
+    m.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    m.publisherIdEnabled = true;
+    m.publisherIdType = UA_PUBLISHERIDTYPE_STRING;
+    m.publisherId.string = UA_STRING("Publisher");
+    m.payloadHeaderEnabled = true;
+    m.payloadHeader.dataSetPayloadHeader.count = 1;
+    UA_UInt16 dsWriter = 12;
+    m.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &dsWriter;
+
+    UA_Variant promoted[1];
+    UA_Float fv = 3.5f;
+    UA_Variant_setScalar(&promoted[0], &fv, &UA_TYPES[UA_TYPES_FLOAT]);
+    m.promotedFieldsEnabled = true;
+    m.promotedFieldsSize = 1;
+    m.promotedFields = promoted;
+
+    UA_DataValue fields[2];
+    UA_DataValue_init(&fields[0]);
+    UA_DataValue_init(&fields[1]);
+    UA_UInt32 iv = 4711;
+    UA_String sv = UA_STRING("a string value");
+    UA_Variant_setScalar(&fields[0].value, &iv, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_Variant_setScalar(&fields[1].value, &sv, &UA_TYPES[UA_TYPES_STRING]);
+    fields[0].hasValue = true;
+    fields[1].hasValue = true;
+
+    UA_DataSetMessage dmkf;
+    memset(&dmkf, 0, sizeof(UA_DataSetMessage));
+    dmkf.header.dataSetMessageValid = true;
+    dmkf.header.fieldEncoding = UA_FIELDENCODING_VARIANT;
+    dmkf.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    dmkf.data.keyFrameData.fieldCount = 2;
+    dmkf.data.keyFrameData.dataSetFields = fields;
+    m.payload.dataSetPayload.dataSetMessages = &dmkf;
+
+    UA_ByteString buffer;
+    size_t msgSize = UA_NetworkMessage_calcSizeBinary(&m, NULL);
+    UA_StatusCode rv = UA_ByteString_allocBuffer(&buffer, msgSize);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = buffer.data;
+    const UA_Byte *bufEnd = &buffer.data[buffer.length];
+    rv = UA_NetworkMessage_encodeBinary(&m, &bufPos, bufEnd, NULL);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+
+    /* Decode into the arena. Repeated decoding and resetting does not
+     * allocate new blocks once the arena has grown to fit the message. */
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+    size_t blocks = 0;
+    for(size_t i = 0; i < 10; i++) {
+        UA_NetworkMessage m2;
+        memset(&m2, 0, sizeof(UA_NetworkMessage));
+        size_t offset = 0;
+        rv = UA_NetworkMessage_decodeBinaryArena(&buffer, &offset, &m2, NULL, &arena);
+        ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(offset, msgSize);
+        ck_assert(UA_String_equal(&m2.publisherId.string, &m.publisherId.string));
+        ck_assert_uint_eq(m2.payloadHeader.dataSetPayloadHeader.dataSetWriterIds[0], dsWriter);
+        ck_assert_uint_eq(m2.promotedFieldsSize, 1);
+        ck_assert(*(UA_Float*)m2.promotedFields[0].data == fv);
+        UA_DataSetMessage *dsm = m2.payload.dataSetPayload.dataSetMessages;
+        ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, 2);
+        ck_assert_uint_eq(*(UA_UInt32*)dsm->data.keyFrameData.dataSetFields[0].value.data, iv);
+        ck_assert(UA_String_equal((UA_String*)dsm->data.keyFrameData.dataSetFields[1].value.data, &sv));
+        ck_assert_uint_gt(arena.used, 0);
+
+        /* The decoded message is released with the arena. No _clear. */
+        UA_Arena_reset(&arena);
+        if(i == 1)
+            blocks = arena.blockCount;
+        if(i > 1)
+            ck_assert_uint_eq(arena.blockCount, blocks);
+    }
+    ck_assert_uint_gt(arena.highWaterMark, 0);
+
+    /* Decoding only the headers into the arena */
+    UA_NetworkMessage m3;
+    memset(&m3, 0, sizeof(UA_NetworkMessage));
+    size_t offset = 0;
+    rv = UA_NetworkMessage_decodeHeadersArena(&buffer, &offset, &m3, &arena);
+    ck_assert_int_eq(rv, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(m3.payloadHeader.dataSetPayloadHeader.dataSetWriterIds[0], dsWriter);
+    ck_assert_uint_eq(arena.blockCount, blocks);
+
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&buffer);
+}
+END_TEST
+
 int main(void) {
     TCase *tc_encode = tcase_create("encode");
     tcase_add_test(tc_encode, UA_PubSub_Encode_WithBufferTooSmallShallReturnError);
 
     TCase *tc_decode = tcase_create("decode");
     tcase_add_test(tc_decode, UA_PubSub_Decode_WithBufferTooSmallShallReturnError);
+    tcase_add_test(tc_decode, UA_PubSub_Decode_IntoArena);
 
     TCase *tc_ende1 = tcase_create("encode_decode1DS");
     tcase_add_test(tc_ende1, UA_PubSub_EnDecode_ShallWorkOn1DS1ValueVariantKeyFrame);
@@ -607,7 +607,7 @@ START_TEST(SetupInvalidPubSubConfig) {
     UA_free(readerConfig.dataSetMetaData.fields);
     UA_Variant_clear(&variant);
 
-    ck_assert(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_BADNOTIMPLEMENTED); // Multiple DSR not supported
+    ck_assert(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_BADNOTSUPPORTED); // DateTime not supported
 
     ck_assert(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_GOOD);
     retVal = UA_Server_removeDataSetReader(server, readerIdentifier2);
@@ -11,6 +11,7 @@
 #include "test_helpers.h"
 #include "ua_pubsub.h"
 #include "ua_pubsub_networkmessage.h"
+#include "ua_types_encoding_binary.h"
 #include <server/ua_server_internal.h>
 
 #include "testing_clock.h"
@@ -23,6 +24,7 @@ UA_Server *server = NULL;
 UA_NodeId connectionIdentifier, publishedDataSetIdent, writerGroupIdent, dataSetWriterIdent, dataSetFieldIdent;
 
 UA_DataValue *staticSource1, *staticSource2;
+UA_DataValue *activeSource; /* Double-buffered value source */
 
 #define PUBLISH_INTERVAL         10       /* Publish interval*/
 
@@ -376,6 +378,260 @@ START_TEST(PublishSingleFieldInCustomCallback) {
         UA_Server_run_iterate(server, false);
 } END_TEST
 
+static void
+addRTWriterGroup(UA_PubSubRTLevel rtLevel) {
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(UA_WriterGroupConfig));
+    writerGroupConfig.name = UA_STRING("Demo WriterGroup");
+    writerGroupConfig.publishingInterval = PUBLISH_INTERVAL;
+    writerGroupConfig.enabled = UA_FALSE;
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = rtLevel;
+    UA_UadpWriterGroupMessageDataType *wgm = UA_UadpWriterGroupMessageDataType_new();
+    wgm->networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    writerGroupConfig.messageSettings.content.decoded.data = wgm;
+    writerGroupConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE];
+    writerGroupConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    ck_assert(UA_Server_addWriterGroup(server, connectionIdentifier, &writerGroupConfig,
+                                       &writerGroupIdent) == UA_STATUSCODE_GOOD);
+    ck_assert(UA_Server_enableWriterGroup(server, writerGroupIdent) == UA_STATUSCODE_GOOD);
+    UA_UadpWriterGroupMessageDataType_delete(wgm);
+}
+
+static void
+addRTDataSetWriter(UA_UInt16 writerId, UA_DataSetFieldContentMask contentMask) {
+    UA_DataSetWriterConfig dataSetWriterConfig;
+    memset(&dataSetWriterConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dataSetWriterConfig.name = UA_STRING("Test DataSetWriter");
+    dataSetWriterConfig.dataSetWriterId = writerId;
+    dataSetWriterConfig.dataSetFieldContentMask = contentMask;
+    ck_assert(UA_Server_addDataSetWriter(server, writerGroupIdent, publishedDataSetIdent,
+                                         &dataSetWriterConfig, NULL) == UA_STATUSCODE_GOOD);
+}
+
+static void
+addStaticSourceField(UA_DataValue **source) {
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = UA_TRUE;
+    dsfConfig.field.variable.rtValueSource.staticValueSource = source;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    ck_assert(UA_Server_addDataSetField(server, publishedDataSetIdent,
+                                        &dsfConfig, NULL).result == UA_STATUSCODE_GOOD);
+}
+
+static UA_DataValue *
+newUInt32Source(UA_UInt32 value) {
+    UA_UInt32 *intValue = UA_UInt32_new();
+    *intValue = value;
+    UA_DataValue *dv = UA_DataValue_new();
+    UA_Variant_setScalar(&dv->value, intValue, &UA_TYPES[UA_TYPES_UINT32]);
+    dv->hasValue = true;
+    return dv;
+}
+
+/* Returns the n-th payload offset of the buffered message */
+static UA_NetworkMessageOffset *
+payloadOffset(UA_WriterGroup *wg, size_t n) {
+    for(size_t i = 0; i < wg->bufferedMessage.offsetsSize; i++) {
+        UA_NetworkMessageOffset *nmo = &wg->bufferedMessage.offsets[i];
+        if(nmo->contentType != UA_PUBSUB_OFFSETTYPE_PAYLOAD_DATAVALUE &&
+           nmo->contentType != UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT &&
+           nmo->contentType != UA_PUBSUB_OFFSETTYPE_PAYLOAD_RAW &&
+           nmo->contentType != UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT)
+            continue;
+        if(n == 0)
+            return nmo;
+        n--;
+    }
+    return NULL;
+}
+
+/* The EventLoop uses the system clock */
+static void
+publishCycle(void) {
+    UA_realSleep(PUBLISH_INTERVAL + 1);
+    rtEventLoop->run(rtEventLoop, 0);
+}
+
+/* The last sent message. Taken from the registered send buffers if used. */
+static const UA_ByteString *
+lastSent(UA_WriterGroup *wg) {
+    if(wg->sendRingSize == 0)
+        return &wg->bufferedMessage.buffer;
+    size_t last = (wg->sendRingNext + wg->sendRingSize - 1) % wg->sendRingSize;
+    return &wg->sendRing[last];
+}
+
+static UA_UInt32
+decodeUInt32(const UA_ByteString *buf, size_t offset) {
+    UA_UInt32 value = 0;
+    UA_StatusCode res =
+        UA_decodeBinaryInternal(buf, &offset, &value, &UA_TYPES[UA_TYPES_UINT32], NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    return value;
+}
+
+START_TEST(PublishDoubleBufferedDirectValueAccess) {
+        ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+        addRTWriterGroup((UA_PubSubRTLevel)
+                         (UA_PUBSUB_RT_FIXED_SIZE | UA_PUBSUB_RT_DIRECT_VALUE_ACCESS));
+
+        /* Two buffers. The published one is selected by the pointer. */
+        staticSource1 = newUInt32Source(1000);
+        staticSource2 = newUInt32Source(2000);
+        activeSource = staticSource1;
+        addStaticSourceField(&activeSource);
+        addRTDataSetWriter(62541, UA_DATASETFIELDCONTENTMASK_NONE);
+        ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) ==
+                  UA_STATUSCODE_GOOD);
+
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+        UA_NetworkMessageOffset *nmo = payloadOffset(wg, 0);
+        ck_assert(nmo != NULL);
+        ck_assert(nmo->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_VARIANT);
+        ck_assert(nmo->valueSource == &activeSource);
+        size_t valuePos = nmo->offset + 1; /* Skip the variant encoding byte */
+
+        /* Publish from the first buffer */
+        publishCycle();
+        ck_assert_uint_eq(decodeUInt32(lastSent(wg), valuePos), 1000);
+
+        /* Update the second buffer and swap */
+        *(UA_UInt32*)staticSource2->value.data = 2001;
+        UA_atomic_xchg((void * volatile *)&activeSource, staticSource2);
+        publishCycle();
+        ck_assert_uint_eq(decodeUInt32(lastSent(wg), valuePos), 2001);
+
+        /* Values with a different type are not published */
+        UA_Double wrongType = 1.0;
+        UA_DataValue *other = UA_DataValue_new();
+        UA_Variant_setScalar(&other->value, &wrongType, &UA_TYPES[UA_TYPES_DOUBLE]);
+        other->value.storageType = UA_VARIANT_DATA_NODELETE;
+        activeSource = other;
+        ck_assert_uint_eq(UA_NetworkMessage_updateBufferedMessage(&wg->bufferedMessage),
+                          UA_STATUSCODE_BADTYPEMISMATCH);
+        activeSource = staticSource1;
+        UA_DataValue_delete(other);
+
+        /* Unfreeze while operational */
+        ck_assert(UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent) ==
+                  UA_STATUSCODE_GOOD);
+        UA_fakeSleep(PUBLISH_INTERVAL + 1);
+        rtEventLoop->run(rtEventLoop, 100);
+        UA_Server_run_iterate(server, false);
+} END_TEST
+
+START_TEST(PublishDeterministicPrecomputedSchedule) {
+        ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+        addRTWriterGroup(UA_PUBSUB_RT_DETERMINISTIC);
+        staticSource1 = newUInt32Source(1000);
+        staticSource2 = newUInt32Source(2000);
+        activeSource = staticSource1;
+        addStaticSourceField(&activeSource);
+        addStaticSourceField(&staticSource2);
+
+        /* The same fields in raw and variant encoding */
+        addRTDataSetWriter(1, UA_DATASETFIELDCONTENTMASK_RAWDATA);
+        addRTDataSetWriter(2, UA_DATASETFIELDCONTENTMASK_NONE);
+        ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) ==
+                  UA_STATUSCODE_GOOD);
+
+        /* All values are written directly at the precomputed positions */
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+        for(size_t i = 0; i < 4; i++) {
+            UA_NetworkMessageOffset *nmo = payloadOffset(wg, i);
+            ck_assert(nmo != NULL);
+            ck_assert(nmo->contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT);
+        }
+        ck_assert(payloadOffset(wg, 4) == NULL);
+
+        *(UA_UInt32*)staticSource2->value.data = 2001;
+        ck_assert_uint_eq(UA_NetworkMessage_updateBufferedMessage(&wg->bufferedMessage),
+                          UA_STATUSCODE_GOOD);
+        const UA_ByteString *msg = &wg->bufferedMessage.buffer;
+        ck_assert_uint_eq(decodeUInt32(msg, payloadOffset(wg, 0)->offset), 1000);
+        ck_assert_uint_eq(decodeUInt32(msg, payloadOffset(wg, 1)->offset), 2001);
+        ck_assert_uint_eq(decodeUInt32(msg, payloadOffset(wg, 2)->offset), 1000);
+        ck_assert_uint_eq(decodeUInt32(msg, payloadOffset(wg, 3)->offset), 2001);
+
+        /* The encoded variant header is unchanged */
+        size_t variantField =
+            (LIST_FIRST(&wg->writers)->config.dataSetWriterId == 2) ? 0 : 2;
+        UA_Variant v;
+        size_t pos = payloadOffset(wg, variantField)->offset - 1;
+        ck_assert_uint_eq(UA_decodeBinaryInternal(msg, &pos, &v,
+                                                  &UA_TYPES[UA_TYPES_VARIANT], NULL),
+                          UA_STATUSCODE_GOOD);
+        ck_assert(v.type == &UA_TYPES[UA_TYPES_UINT32]);
+        ck_assert_uint_eq(*(UA_UInt32*)v.data, 1000);
+        UA_Variant_clear(&v);
+
+        /* Publish through the EventLoop */
+        *(UA_UInt32*)staticSource1->value.data = 1001;
+        publishCycle();
+        publishCycle();
+        ck_assert_uint_eq(decodeUInt32(lastSent(wg), payloadOffset(wg, 0)->offset), 1001);
+        UA_Server_run_iterate(server, false);
+} END_TEST
+
+START_TEST(DeterministicRequiresFixedSizeEncoding) {
+        ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+        addRTWriterGroup(UA_PUBSUB_RT_DETERMINISTIC);
+        staticSource1 = newUInt32Source(1000);
+        addStaticSourceField(&staticSource1);
+
+        /* The DataValue encoding is not supported */
+        addRTDataSetWriter(62541, UA_DATASETFIELDCONTENTMASK_STATUSCODE);
+        ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) ==
+                  UA_STATUSCODE_BADNOTSUPPORTED);
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+        ck_assert(!wg->configurationFrozen);
+        ck_assert_uint_eq(wg->bufferedMessage.offsetsSize, 0);
+} END_TEST
+
+START_TEST(PublishFromRegisteredSendBuffers) {
+        ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+        addRTWriterGroup((UA_PubSubRTLevel)
+                         (UA_PUBSUB_RT_FIXED_SIZE | UA_PUBSUB_RT_DIRECT_VALUE_ACCESS));
+        staticSource1 = newUInt32Source(1000);
+        addStaticSourceField(&staticSource1);
+        addRTDataSetWriter(62541, UA_DATASETFIELDCONTENTMASK_RAWDATA);
+        ck_assert(UA_Server_freezeWriterGroupConfiguration(server, writerGroupIdent) ==
+                  UA_STATUSCODE_GOOD);
+
+        UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroupIdent);
+        size_t valuePos = payloadOffset(wg, 0)->offset;
+        ck_assert_uint_eq(wg->sendRingSize, 0);
+
+        /* Every message is written in place into the next registered buffer */
+        UA_Byte *sent[UA_WRITERGROUP_SENDRINGSIZE + 1];
+        for(UA_UInt32 i = 0; i < UA_WRITERGROUP_SENDRINGSIZE + 1; i++) {
+            *(UA_UInt32*)staticSource1->value.data = 2000 + i;
+            publishCycle();
+            ck_assert_uint_eq(wg->sendRingSize, UA_WRITERGROUP_SENDRINGSIZE);
+            ck_assert_uint_eq(decodeUInt32(lastSent(wg), valuePos), 2000 + i);
+            ck_assert_uint_eq(lastSent(wg)->length, wg->bufferedMessage.buffer.length);
+            sent[i] = lastSent(wg)->data;
+        }
+        ck_assert(sent[0] != sent[1]);
+        ck_assert(sent[0] == sent[UA_WRITERGROUP_SENDRINGSIZE]);
+
+        /* The precomputed message is not touched */
+        ck_assert_uint_eq(decodeUInt32(&wg->bufferedMessage.buffer, valuePos), 1000);
+
+        /* The constant parts of the message are equal */
+        ck_assert(memcmp(lastSent(wg)->data, wg->bufferedMessage.buffer.data,
+                         valuePos) == 0);
+
+        /* The buffers are returned to the ConnectionManager */
+        ck_assert(UA_Server_unfreezeWriterGroupConfiguration(server, writerGroupIdent) ==
+                  UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(wg->sendRingSize, 0);
+} END_TEST
+
 static UA_StatusCode
 simpleNotificationRead(UA_Server *srv, const UA_NodeId *sessionId,
                        void *sessionContext, const UA_NodeId *nodeid,
@@ -558,10 +814,18 @@ int main(void) {
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishSingleFieldWithFixedOffsets);
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishPDSWithMultipleFieldsAndFixedOffset);
     tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishSingleFieldInCustomCallback);
+    tcase_add_test(tc_pubsub_rt_fixed_offsets, PublishFromRegisteredSendBuffers);
+
+    TCase *tc_pubsub_rt_direct = tcase_create("PubSub RT publish with direct value access");
+    tcase_add_checked_fixture(tc_pubsub_rt_direct, setup, teardown);
+    tcase_add_test(tc_pubsub_rt_direct, PublishDoubleBufferedDirectValueAccess);
+    tcase_add_test(tc_pubsub_rt_direct, PublishDeterministicPrecomputedSchedule);
+    tcase_add_test(tc_pubsub_rt_direct, DeterministicRequiresFixedSizeEncoding);
 
     Suite *s = suite_create("PubSub RT configuration levels");
     suite_add_tcase(s, tc_pubsub_rt_static_value_source);
     suite_add_tcase(s, tc_pubsub_rt_fixed_offsets);
+    suite_add_tcase(s, tc_pubsub_rt_direct);
 
     SRunner *sr = srunner_create(s);
     srunner_set_fork_status(sr, CK_NOFORK);
@@ -10,6 +10,8 @@
 
 #include "test_helpers.h"
 #include "ua_server_internal.h"
+#include "ua_pubsub_networkmessage.h"
+#include "ua_types_encoding_binary.h"
 
 #include <check.h>
 #include <stdio.h>
@@ -83,10 +85,95 @@ START_TEST(PublishSpeedTest) {
 
 } END_TEST
 
+/* Jitter of the per-cycle message update with precomputed write positions */
+START_TEST(DeterministicJitterTest) {
+    UA_UInt32 *intValue = UA_UInt32_new();
+    UA_DataValue *dv = UA_DataValue_new();
+    UA_Variant_setScalar(&dv->value, intValue, &UA_TYPES[UA_TYPES_UINT32]);
+    dv->hasValue = true;
+
+    UA_DataSetFieldConfig dsfConfig;
+    memset(&dsfConfig, 0, sizeof(UA_DataSetFieldConfig));
+    dsfConfig.field.variable.rtValueSource.rtFieldSourceEnabled = true;
+    dsfConfig.field.variable.rtValueSource.staticValueSource = &dv;
+    dsfConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_StatusCode retval =
+        UA_Server_addDataSetField(server, publishedDataSet1, &dsfConfig, NULL).result;
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 2");
+    writerGroupConfig.publishingInterval = 10;
+    writerGroupConfig.writerGroupId = 2;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.rtLevel = UA_PUBSUB_RT_DETERMINISTIC;
+    UA_UadpWriterGroupMessageDataType wgm;
+    UA_UadpWriterGroupMessageDataType_init(&wgm);
+    wgm.networkMessageContentMask = UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+    UA_ExtensionObject_setValue(&writerGroupConfig.messageSettings, &wgm,
+                                &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]);
+    UA_NodeId writerGroup2;
+    retval = UA_Server_addWriterGroup(server, connection1, &writerGroupConfig, &writerGroup2);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig dswConfig;
+    memset(&dswConfig, 0, sizeof(UA_DataSetWriterConfig));
+    dswConfig.name = UA_STRING("DataSetWriter 1");
+    dswConfig.dataSetWriterId = 1;
+    dswConfig.dataSetFieldContentMask = UA_DATASETFIELDCONTENTMASK_RAWDATA;
+    retval = UA_Server_addDataSetWriter(server, writerGroup2, publishedDataSet1,
+                                        &dswConfig, &dataSetWriter1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_freezeWriterGroupConfiguration(server, writerGroup2);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_WriterGroup *wg = UA_WriterGroup_findWGbyId(server, writerGroup2);
+    UA_NetworkMessageOffsetBuffer *buf = &wg->bufferedMessage;
+    size_t pos = 0;
+    for(size_t i = 0; i < buf->offsetsSize; i++) {
+        if(buf->offsets[i].contentType == UA_PUBSUB_OFFSETTYPE_PAYLOAD_DIRECT)
+            pos = buf->offsets[i].offset;
+    }
+    ck_assert_uint_ne(pos, 0);
+
+    printf("start updating 1000000 deterministic network messages\n");
+
+    UA_DateTime min = UA_INT64_MAX, max = 0, sum = 0;
+    for(UA_UInt32 i = 0; i < 1000000; i++) {
+        *intValue = i;
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        retval = UA_NetworkMessage_updateBufferedMessage(buf);
+        UA_DateTime duration = UA_DateTime_nowMonotonic() - begin;
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        if(duration < min)
+            min = duration;
+        if(duration > max)
+            max = duration;
+        sum += duration;
+    }
+
+    printf("cycle duration min %" PRIi64 " ns, avg %" PRIi64 " ns, max %" PRIi64 " ns\n",
+           min * 100, sum / 10000, max * 100);
+
+    UA_UInt32 encoded = 0;
+    retval = UA_decodeBinaryInternal(&buf->buffer, &pos, &encoded,
+                                     &UA_TYPES[UA_TYPES_UINT32], NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(encoded, 999999);
+
+    retval = UA_Server_unfreezeWriterGroupConfiguration(server, writerGroup2);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_removeWriterGroup(server, writerGroup2);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_DataValue_delete(dv);
+} END_TEST
+
 int main(void) {
     TCase *tc_publishspeed = tcase_create("Speed of the publisher");
     tcase_add_checked_fixture(tc_publishspeed, setup, teardown);
     tcase_add_test(tc_publishspeed, PublishSpeedTest);
+    tcase_add_test(tc_publishspeed, DeterministicJitterTest);
 
     Suite *s = suite_create("PubSub Speed Test");
     suite_add_tcase(s, tc_publishspeed);
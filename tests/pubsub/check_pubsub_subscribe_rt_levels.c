@@ -12,6 +12,7 @@
 
 #include "ua_pubsub.h"
 #include "ua_pubsub_networkmessage.h"
+#include <server/ua_server_internal.h>
 #include "testing_clock.h"
 #include "test_helpers.h"
 
@@ -410,7 +411,7 @@ START_TEST(SetupInvalidPubSubConfigReader) {
         UA_free(readerConfig.dataSetMetaData.fields);
         // UA_Variant_clear(&variant);
 
-        ck_assert(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_BADNOTIMPLEMENTED); // Multiple DSR not supported
+        ck_assert(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_BADNOTSUPPORTED); // DateTime not supported
 
         ck_assert(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdentifier) == UA_STATUSCODE_GOOD);
         retVal = UA_Server_removeDataSetReader(server, readerIdentifier2);
@@ -806,6 +807,231 @@ START_TEST(PublishSubscribeWithWriteCallback) {
     UA_LOG_INFO(UA_Log_Stdout, UA_LOGCATEGORY_USERLAND, "PublishSubscribeWithWriteCallback() test end");
 } END_TEST
 
+#define MANYREADERS 128
+
+static UA_UInt32 manyCounter[MANYREADERS];
+static UA_Boolean manyFlag[MANYREADERS];
+static UA_DataValue *manyCounterValue[MANYREADERS];
+static UA_DataValue *manyFlagValue[MANYREADERS];
+
+/* Encode a NetworkMessage with a single DataSetMessage (UInt32 + Boolean) for
+ * the DataSetWriter. Odd writers use the raw field encoding. */
+static UA_ByteString
+encodeReaderMessage(UA_UInt16 writerId, const UA_DataType *counterType,
+                    void *counter, UA_Boolean flag) {
+    UA_FieldMetaData fields[2];
+    memset(fields, 0, sizeof(fields));
+    fields[0].valueRank = -1;
+    fields[1].valueRank = -1;
+    UA_DataSetMetaDataType metaData;
+    UA_DataSetMetaDataType_init(&metaData);
+    metaData.fieldsSize = 2;
+    metaData.fields = fields;
+
+    UA_DataValue dv[2];
+    UA_DataValue_init(&dv[0]);
+    UA_DataValue_init(&dv[1]);
+    UA_Variant_setScalar(&dv[0].value, counter, counterType);
+    UA_Variant_setScalar(&dv[1].value, &flag, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    dv[0].hasValue = true;
+    dv[1].hasValue = true;
+
+    UA_DataSetMessage dsm;
+    memset(&dsm, 0, sizeof(UA_DataSetMessage));
+    dsm.header.dataSetMessageValid = true;
+    dsm.header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    dsm.header.fieldEncoding = (writerId % 2) ?
+        UA_FIELDENCODING_RAWDATA : UA_FIELDENCODING_VARIANT;
+    dsm.data.keyFrameData.fieldCount = 2;
+    dsm.data.keyFrameData.dataSetFields = dv;
+    dsm.data.keyFrameData.dataSetMetaDataType = &metaData;
+
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.version = 1;
+    nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm.publisherIdEnabled = true;
+    nm.publisherIdType = UA_PUBLISHERIDTYPE_UINT16;
+    nm.publisherId.uint16 = 2234;
+    nm.groupHeaderEnabled = true;
+    nm.groupHeader.writerGroupIdEnabled = true;
+    nm.groupHeader.writerGroupId = 100;
+    nm.groupHeader.sequenceNumberEnabled = true;
+    nm.payloadHeaderEnabled = true;
+    nm.payloadHeader.dataSetPayloadHeader.count = 1;
+    nm.payloadHeader.dataSetPayloadHeader.dataSetWriterIds = &writerId;
+    nm.payload.dataSetPayload.dataSetMessages = &dsm;
+
+    UA_ByteString buf;
+    size_t size = UA_NetworkMessage_calcSizeBinary(&nm, NULL);
+    ck_assert_uint_gt(size, 0);
+    ck_assert_int_eq(UA_ByteString_allocBuffer(&buf, size), UA_STATUSCODE_GOOD);
+    UA_Byte *bufPos = buf.data;
+    ck_assert_int_eq(UA_NetworkMessage_encodeBinary(&nm, &bufPos, buf.data + buf.length,
+                                                    NULL), UA_STATUSCODE_GOOD);
+    return buf;
+}
+
+static UA_Boolean
+receiveReaderMessage(UA_UInt16 writerId, const UA_DataType *counterType,
+                     void *counter, UA_Boolean flag) {
+    UA_ByteString buf = encodeReaderMessage(writerId, counterType, counter, flag);
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupIdentifier);
+    ck_assert(rg != NULL);
+    UA_Boolean processed = UA_ReaderGroup_decodeAndProcessRT(server, rg, &buf);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_ByteString_clear(&buf);
+    return processed;
+}
+
+START_TEST(SubscribeManyReadersWithLookupTable) {
+    ck_assert(addMinimalPubSubConfiguration() == UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup Test");
+    readerGroupConfig.rtLevel = UA_PUBSUB_RT_FIXED_SIZE;
+    ck_assert_int_eq(UA_Server_addReaderGroup(server, connectionIdentifier, &readerGroupConfig,
+                                              &readerGroupIdentifier), UA_STATUSCODE_GOOD);
+
+    UA_FieldMetaData fields[2];
+    UA_FieldMetaData_init(&fields[0]);
+    UA_FieldMetaData_init(&fields[1]);
+    fields[0].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    fields[0].builtInType = UA_NS0ID_UINT32;
+    fields[0].valueRank = -1;
+    fields[1].dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+    fields[1].builtInType = UA_NS0ID_BOOLEAN;
+    fields[1].valueRank = -1;
+
+    UA_UadpDataSetReaderMessageDataType readerMessage;
+    UA_UadpDataSetReaderMessageDataType_init(&readerMessage);
+
+    UA_UInt16 publisherIdentifier = 2234;
+    UA_FieldTargetVariable targetVars[2];
+    memset(targetVars, 0, sizeof(targetVars));
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader Test");
+    readerConfig.publisherId.type = &UA_TYPES[UA_TYPES_UINT16];
+    readerConfig.publisherId.data = &publisherIdentifier;
+    readerConfig.writerGroupId = 100;
+    readerConfig.messageSettings.encoding = UA_EXTENSIONOBJECT_DECODED;
+    readerConfig.messageSettings.content.decoded.type =
+        &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE];
+    readerConfig.messageSettings.content.decoded.data = &readerMessage;
+    readerConfig.dataSetMetaData.fieldsSize = 2;
+    readerConfig.dataSetMetaData.fields = fields;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariablesSize = 2;
+    readerConfig.subscribedDataSet.subscribedDataSetTarget.targetVariables = targetVars;
+
+    UA_VariableAttributes counterAttr = UA_VariableAttributes_default;
+    counterAttr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+    UA_VariableAttributes flagAttr = UA_VariableAttributes_default;
+    flagAttr.dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+    UA_ValueBackend valueBackend;
+    memset(&valueBackend, 0, sizeof(UA_ValueBackend));
+    valueBackend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+
+    for(UA_UInt16 i = 0; i < MANYREADERS; i++) {
+        manyCounter[i] = 0;
+        manyFlag[i] = false;
+        manyCounterValue[i] = UA_DataValue_new();
+        manyFlagValue[i] = UA_DataValue_new();
+        UA_Variant_setScalar(&manyCounterValue[i]->value, &manyCounter[i],
+                             &UA_TYPES[UA_TYPES_UINT32]);
+        manyCounterValue[i]->value.storageType = UA_VARIANT_DATA_NODELETE;
+        UA_Variant_setScalar(&manyFlagValue[i]->value, &manyFlag[i],
+                             &UA_TYPES[UA_TYPES_BOOLEAN]);
+        manyFlagValue[i]->value.storageType = UA_VARIANT_DATA_NODELETE;
+
+        UA_NodeId counterId = UA_NODEID_NUMERIC(1, 60000 + 2 * (UA_UInt32)i);
+        UA_NodeId flagId = UA_NODEID_NUMERIC(1, 60001 + 2 * (UA_UInt32)i);
+        ck_assert_int_eq(UA_Server_addVariableNode(server, counterId,
+                             UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                             UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                             UA_QUALIFIEDNAME(1, "Counter"),
+                             UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                             counterAttr, NULL, NULL), UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(UA_Server_addVariableNode(server, flagId,
+                             UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                             UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                             UA_QUALIFIEDNAME(1, "Flag"),
+                             UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                             flagAttr, NULL, NULL), UA_STATUSCODE_GOOD);
+        valueBackend.backend.external.value = &manyCounterValue[i];
+        UA_Server_setVariableNode_valueBackend(server, counterId, valueBackend);
+        valueBackend.backend.external.value = &manyFlagValue[i];
+        UA_Server_setVariableNode_valueBackend(server, flagId, valueBackend);
+
+        targetVars[0].targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+        targetVars[0].targetVariable.targetNodeId = counterId;
+        targetVars[1].targetVariable.attributeId = UA_ATTRIBUTEID_VALUE;
+        targetVars[1].targetVariable.targetNodeId = flagId;
+        readerConfig.dataSetWriterId = (UA_UInt16)(1000 + i);
+        ck_assert_int_eq(UA_Server_addDataSetReader(server, readerGroupIdentifier,
+                                                    &readerConfig, NULL),
+                         UA_STATUSCODE_GOOD);
+    }
+
+    /* The lookup table is built with the frozen configuration */
+    ck_assert_int_eq(UA_Server_freezeReaderGroupConfiguration(server, readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(UA_Server_enableReaderGroup(server, readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    UA_ReaderGroup *rg = UA_ReaderGroup_findRGbyId(server, readerGroupIdentifier);
+    ck_assert(rg->matcher != NULL);
+    ck_assert_uint_ge(rg->matcherSize, 2 * MANYREADERS);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Every message is processed by its reader only. The first message of a
+     * reader prepares the offsets. The following ones are written directly. */
+    for(UA_UInt32 round = 1; round <= 3; round++) {
+        for(UA_UInt32 i = 0; i < MANYREADERS; i++) {
+            UA_UInt32 reader = (i * 37) % MANYREADERS; /* Not in creation order */
+            UA_UInt32 counter = round * 1000 + reader;
+            ck_assert(receiveReaderMessage((UA_UInt16)(1000 + reader),
+                                           &UA_TYPES[UA_TYPES_UINT32], &counter,
+                                           (round + reader) % 2 == 0));
+        }
+        for(UA_UInt32 i = 0; i < MANYREADERS; i++) {
+            ck_assert_uint_eq(manyCounter[i], round * 1000 + i);
+            ck_assert(manyFlag[i] == ((round + i) % 2 == 0));
+        }
+    }
+
+    UA_LOCK(&server->serviceMutex);
+    UA_DataSetReader *dsr;
+    LIST_FOREACH(dsr, &rg->readers, listEntry) {
+        ck_assert(dsr->directValueAccess);
+    }
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* No reader for the DataSetWriter */
+    UA_UInt32 counter = 4242;
+    ck_assert(!receiveReaderMessage(999, &UA_TYPES[UA_TYPES_UINT32], &counter, true));
+
+    /* The reader is matched. But the layout does not match and no value is
+     * written. */
+    UA_Int32 wrongType = 4242;
+    ck_assert(receiveReaderMessage(1000, &UA_TYPES[UA_TYPES_INT32], &wrongType, true));
+    ck_assert_uint_eq(manyCounter[0], 3000);
+
+    ck_assert_int_eq(UA_Server_unfreezeReaderGroupConfiguration(server, readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(rg->matcher == NULL);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_int_eq(UA_Server_removeReaderGroup(server, readerGroupIdentifier),
+                     UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < MANYREADERS; i++) {
+        UA_DataValue_delete(manyCounterValue[i]);
+        UA_DataValue_delete(manyFlagValue[i]);
+    }
+} END_TEST
 
 int main(void) {
     TCase *tc_pubsub_subscribe_rt = tcase_create("PubSub RT subscribe with fixed offsets");
@@ -814,6 +1040,7 @@ int main(void) {
     tcase_add_test(tc_pubsub_subscribe_rt, SetupInvalidPubSubConfigReader);
     tcase_add_test(tc_pubsub_subscribe_rt, SubscribeSingleFieldWithFixedOffsets);
     tcase_add_test(tc_pubsub_subscribe_rt, PublishSubscribeWithWriteCallback);
+    tcase_add_test(tc_pubsub_subscribe_rt, SubscribeManyReadersWithLookupTable);
 
     Suite *s = suite_create("PubSub RT configuration levels");
     suite_add_tcase(s, tc_pubsub_subscribe_rt);
@@ -27,6 +27,10 @@ static void setupHashMap(void) {
     UA_Nodestore_HashMap(&ns);
 }
 
+static void setupConcurrentHashMap(void) {
+    UA_Nodestore_ConcurrentHashMap(&ns);
+}
+
 static void teardown(void) {
     ns.clear(ns.context);
 }
@@ -312,6 +316,32 @@ static Suite * namespace_suite (void) {
     tcase_add_test (tc_profile_hm, profileGetDelete);
     suite_add_tcase (s, tc_profile_hm);
 
+    TCase* tc_find_chm = tcase_create ("Find-ConcurrentHashMap");
+    tcase_add_checked_fixture(tc_find_chm, setupConcurrentHashMap, teardown);
+    tcase_add_test (tc_find_chm, findNodeInUA_NodeStoreWithSingleEntry);
+    tcase_add_test (tc_find_chm, findNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_chm, findNodeInExpandedNamespace);
+    tcase_add_test (tc_find_chm, failToFindNonExistentNodeInUA_NodeStoreWithSeveralEntries);
+    tcase_add_test (tc_find_chm, failToFindNodeInOtherUA_NodeStore);
+    suite_add_tcase (s, tc_find_chm);
+
+    TCase *tc_replace_chm = tcase_create("Replace-ConcurrentHashMap");
+    tcase_add_checked_fixture(tc_replace_chm, setupConcurrentHashMap, teardown);
+    tcase_add_test (tc_replace_chm, replaceExistingNode);
+    tcase_add_test (tc_replace_chm, replaceOldNode);
+    suite_add_tcase (s, tc_replace_chm);
+
+    TCase* tc_iterate_chm = tcase_create ("Iterate-ConcurrentHashMap");
+    tcase_add_checked_fixture(tc_iterate_chm, setupConcurrentHashMap, teardown);
+    tcase_add_test (tc_iterate_chm, iterateOverUA_NodeStoreShallNotVisitEmptyNodes);
+    tcase_add_test (tc_iterate_chm, iterateOverExpandedNamespaceShallNotVisitEmptyNodes);
+    suite_add_tcase (s, tc_iterate_chm);
+
+    TCase* tc_profile_chm = tcase_create ("Profile-ConcurrentHashMap");
+    tcase_add_checked_fixture(tc_profile_chm, setupConcurrentHashMap, teardown);
+    tcase_add_test (tc_profile_chm, profileGetDelete);
+    suite_add_tcase (s, tc_profile_chm);
+
     return s;
 }
 
@@ -11,6 +11,7 @@
 #include <open62541/client_highlevel_async.h>
 #include <open62541/plugin/log_stdout.h>
 
+#include "server/ua_server_internal.h"
 #include "testing_clock.h"
 #include "test_helpers.h"
 #include "thread_wrapper.h"
@@ -40,6 +41,87 @@ clientReceiveCallback(UA_Client *client, void *userdata,
     clientCounter++;
 }
 
+/* Batched writes into a DataSource that complete asynchronously */
+static size_t writeBatchCalls;
+static size_t writeBatchNodes;
+static void *writeBatchContext;
+static UA_WriteResponse writeResponse;
+
+static UA_StatusCode
+readBatch(UA_Server *serverArg, const UA_NodeId *sessionId, void *sessionContext,
+          size_t nodesSize, const UA_NodeId *nodeIds, void * const *nodeContexts,
+          UA_Boolean includeSourceTimeStamp, const UA_NumericRange * const *ranges,
+          UA_DataValue *values) {
+    return UA_STATUSCODE_BADNOTREADABLE;
+}
+
+static UA_StatusCode
+writeBatchAsync(UA_Server *serverArg, const UA_NodeId *sessionId,
+                void *sessionContext, size_t nodesSize,
+                const UA_NodeId *nodeIds, void * const *nodeContexts,
+                const UA_NumericRange * const *ranges,
+                const UA_DataValue *values, void *asyncContext,
+                UA_StatusCode *results) {
+    writeBatchCalls++;
+    writeBatchNodes += nodesSize;
+    writeBatchContext = asyncContext;
+    return UA_STATUSCODE_GOODCOMPLETESASYNCHRONOUSLY;
+}
+
+/* The second batch completes the first batch and integrates the results while
+ * the server lock is released. Then it completes synchronously. */
+static size_t completeOtherCalls;
+
+static UA_StatusCode
+writeBatchCompleteOther(UA_Server *serverArg, const UA_NodeId *sessionId,
+                        void *sessionContext, size_t nodesSize,
+                        const UA_NodeId *nodeIds, void * const *nodeContexts,
+                        const UA_NumericRange * const *ranges,
+                        const UA_DataValue *values, void *asyncContext,
+                        UA_StatusCode *results) {
+    completeOtherCalls++;
+    ck_assert_ptr_ne(writeBatchContext, NULL);
+    UA_StatusCode otherResults[2] = {UA_STATUSCODE_BADOUTOFRANGE, UA_STATUSCODE_GOOD};
+    UA_Server_setAsyncWriteResults(serverArg, writeBatchContext, otherResults);
+    UA_AsyncManager_checkTimeouts(serverArg, NULL);
+    for(size_t i = 0; i < nodesSize; i++)
+        results[i] = UA_STATUSCODE_BADTYPEMISMATCH;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+clientWriteCallback(UA_Client *client, void *userdata,
+                    UA_UInt32 requestId, void *response) {
+    UA_WriteResponse_copy((UA_WriteResponse*)response, &writeResponse);
+    clientCounter++;
+}
+
+#define WRITEBATCHNODES 3
+
+static void
+sendWriteRequest(UA_Client *client) {
+    /* The batched nodes and a normal variable in between */
+    UA_UInt32 value = 42;
+    UA_WriteValue wv[WRITEBATCHNODES + 1];
+    for(size_t i = 0; i < WRITEBATCHNODES + 1; i++) {
+        UA_WriteValue_init(&wv[i]);
+        wv[i].nodeId = UA_NODEID_NUMERIC(1, 6000 + (UA_UInt32)i);
+        wv[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[i].value.hasValue = true;
+        UA_Variant_setScalar(&wv[i].value.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    wv[1].nodeId = UA_NODEID_STRING(1, "variable");
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = wv;
+    request.nodesToWriteSize = WRITEBATCHNODES + 1;
+    UA_StatusCode retval =
+        __UA_Client_AsyncService(client, &request, &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                 clientWriteCallback, &UA_TYPES[UA_TYPES_WRITERESPONSE],
+                                 NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+}
+
 THREAD_CALLBACK(serverloop) {
     while(running)
         UA_Server_run_iterate(server, true);
@@ -79,6 +161,48 @@ static void setup(void) {
     res = UA_Server_setMethodNodeAsync(server, UA_NODEID_STRING(1, "asyncMethod"), true);
     ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
 
+    /* Variables with a batched DataSource */
+    UA_ValueBackend backend;
+    memset(&backend, 0, sizeof(UA_ValueBackend));
+    backend.backendType = UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH;
+    backend.backend.dataSourceBatch.read = readBatch;
+    backend.backend.dataSourceBatch.write = writeBatchAsync;
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    vattr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    for(UA_UInt32 i = 0; i < WRITEBATCHNODES + 1; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(1, 6000 + i);
+        if(i == 1)
+            id = UA_NODEID_STRING(1, "variable"); /* Without the DataSource */
+        res = UA_Server_addVariableNode(server, id,
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                        UA_QUALIFIEDNAME(1, "variable"),
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                        vattr, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        if(i == 1)
+            continue;
+        res = UA_Server_setVariableNode_valueBackend(server, id, backend);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    backend.backend.dataSourceBatch.write = writeBatchCompleteOther;
+    res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 6100),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                    UA_QUALIFIEDNAME(1, "completeOther"),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                    vattr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_setVariableNode_valueBackend(server, UA_NODEID_NUMERIC(1, 6100),
+                                                 backend);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    writeBatchCalls = 0;
+    writeBatchNodes = 0;
+    completeOtherCalls = 0;
+    writeBatchContext = NULL;
+    UA_WriteResponse_init(&writeResponse);
+
     UA_Server_run_startup(server);
     THREAD_CREATE(server_thread, serverloop);
 }
@@ -88,6 +212,7 @@ static void teardown(void) {
     THREAD_JOIN(server_thread);
     UA_Server_run_shutdown(server);
     UA_Server_delete(server);
+    UA_WriteResponse_clear(&writeResponse);
 }
 
 START_TEST(Async_call) {
@@ -301,6 +426,138 @@ START_TEST(Async_timeout_worker) {
     UA_Client_delete(client);
 } END_TEST
 
+/* The batched writes are completed asynchronously. The normal write in
+ * between is done right away. */
+START_TEST(Async_writeBatch) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    sendWriteRequest(client);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(writeBatchCalls, 1);
+    ck_assert_uint_eq(writeBatchNodes, WRITEBATCHNODES);
+    ck_assert_ptr_ne(writeBatchContext, NULL);
+    ck_assert_uint_eq(clientCounter, 0);
+
+    /* Complete the writes */
+    UA_StatusCode results[WRITEBATCHNODES] =
+        {UA_STATUSCODE_GOOD, UA_STATUSCODE_BADOUTOFRANGE, UA_STATUSCODE_GOOD};
+    UA_Server_setAsyncWriteResults(server, writeBatchContext, results);
+
+    /* Iterate and pick up the async response to be sent out */
+    UA_fakeSleep(200);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 1);
+    ck_assert_uint_eq(writeResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(writeResponse.resultsSize, WRITEBATCHNODES + 1);
+    ck_assert_uint_eq(writeResponse.results[0], UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(writeResponse.results[1], UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(writeResponse.results[2], UA_STATUSCODE_BADOUTOFRANGE);
+    ck_assert_uint_eq(writeResponse.results[3], UA_STATUSCODE_GOOD);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+/* The first batch is completed and integrated while the second batch is
+ * written. The response is sent only after the service has returned. */
+START_TEST(Async_writeBatch_completeBetweenBatches) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    UA_UInt32 value = 42;
+    UA_WriteValue wv[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_WriteValue_init(&wv[i]);
+        wv[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[i].value.hasValue = true;
+        UA_Variant_setScalar(&wv[i].value.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    }
+    wv[0].nodeId = UA_NODEID_NUMERIC(1, 6000);
+    wv[1].nodeId = UA_NODEID_NUMERIC(1, 6100);
+    wv[2].nodeId = UA_NODEID_NUMERIC(1, 6002);
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = wv;
+    request.nodesToWriteSize = 3;
+    retval = __UA_Client_AsyncService(client, &request, &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                      clientWriteCallback, &UA_TYPES[UA_TYPES_WRITERESPONSE],
+                                      NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Both batches are done when the service returns */
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(writeBatchCalls, 1);
+    ck_assert_uint_eq(writeBatchNodes, 2);
+    ck_assert_uint_eq(completeOtherCalls, 1);
+    ck_assert_uint_eq(clientCounter, 1);
+    ck_assert_uint_eq(writeResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(writeResponse.resultsSize, 3);
+    ck_assert_uint_eq(writeResponse.results[0], UA_STATUSCODE_BADOUTOFRANGE);
+    ck_assert_uint_eq(writeResponse.results[1], UA_STATUSCODE_BADTYPEMISMATCH);
+    ck_assert_uint_eq(writeResponse.results[2], UA_STATUSCODE_GOOD);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+/* The batched writes time out if the DataSource does not complete them */
+START_TEST(Async_writeBatch_timeout) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Stop the server thread. Iterate manually from now on */
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    sendWriteRequest(client);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(writeBatchCalls, 1);
+    ck_assert_uint_eq(clientCounter, 0);
+
+    /* Force a timeout */
+    UA_fakeSleep(2500);
+    UA_Server_run_iterate(server, true);
+    UA_Client_run_iterate(client, 0);
+    ck_assert_uint_eq(clientCounter, 1);
+    ck_assert_uint_eq(writeResponse.resultsSize, WRITEBATCHNODES + 1);
+    ck_assert_uint_eq(writeResponse.results[0], UA_STATUSCODE_BADTIMEOUT);
+    ck_assert_uint_eq(writeResponse.results[1], UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(writeResponse.results[2], UA_STATUSCODE_BADTIMEOUT);
+    ck_assert_uint_eq(writeResponse.results[3], UA_STATUSCODE_BADTIMEOUT);
+
+    /* Return the late results */
+    UA_StatusCode results[WRITEBATCHNODES] = {0};
+    UA_Server_setAsyncWriteResults(server, writeBatchContext, results);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
 static Suite* method_async_suite(void) {
     /* set up unit test for internal data structures */
     Suite *s = suite_create("Async Method");
@@ -314,6 +571,13 @@ static Suite* method_async_suite(void) {
     tcase_add_test(tc_manager, Async_timeout_worker);
     suite_add_tcase(s, tc_manager);
 
+    TCase* tc_write = tcase_create("AsyncWrite");
+    tcase_add_checked_fixture(tc_write, setup, teardown);
+    tcase_add_test(tc_write, Async_writeBatch);
+    tcase_add_test(tc_write, Async_writeBatch_completeBetweenBatches);
+    tcase_add_test(tc_write, Async_writeBatch_timeout);
+    suite_add_tcase(s, tc_write);
+
     return s;
 }
 
@@ -0,0 +1,338 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+/* Streams raw HistoryRead responses into a SecureChannel whose chunks are
+ * collected by a test ConnectionManager. The streamed response is compared
+ * with the regular response. For a large history, the peak memory of the
+ * process must not grow by more than a fixed budget. */
+
+#include <open62541/plugin/historydata/history_data_backend_memory.h>
+#include <open62541/plugin/historydata/history_data_gathering_default.h>
+#include <open62541/plugin/historydata/history_database_default.h>
+#include <open62541/plugin/securitypolicy_default.h>
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+#include "test_helpers.h"
+#include "testing_networklayers.h"
+
+#define HISTORY_POINTS 1000000 /* Set to 10000000 for the full-size run */
+#define RSS_BUDGET_KB (16 * 1024)
+
+/* The peak memory is only measured without the address sanitizer. It keeps
+ * freed memory in quarantine. */
+#if defined(__linux__) && !defined(__SANITIZE_ADDRESS__)
+# define MEASURE_PEAK_MEMORY
+#endif
+#if defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  undef MEASURE_PEAK_MEMORY
+# endif
+#endif
+#define START_TIME (UA_DATETIME_UNIX_EPOCH + 1000 * UA_DATETIME_SEC)
+
+static UA_Server *server;
+static UA_HistoryDataGathering gathering;
+static UA_HistorizingNodeIdSettings setting;
+static UA_NodeId historyNodeId;
+static UA_SecurityPolicy policy;
+static UA_SecureChannel channel;
+
+/* Collect the sent chunks */
+static UA_ConnectionManager collectCM;
+static UA_Boolean collectBody;
+static UA_ByteString body;
+static size_t chunks;
+static size_t maxChunkLength;
+static size_t totalLength;
+
+static UA_StatusCode
+collectChunk(UA_ConnectionManager *cm, uintptr_t connectionId,
+             const UA_KeyValueMap *params, UA_ByteString *buf) {
+    chunks++;
+    totalLength += buf->length;
+    if(buf->length > maxChunkLength)
+        maxChunkLength = buf->length;
+
+    /* Without security, the body follows the 24 bytes of headers */
+    if(collectBody) {
+        size_t length = buf->length - UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH;
+        UA_Byte *data = (UA_Byte*)UA_realloc(body.data, body.length + length);
+        ck_assert(data != NULL);
+        memcpy(&data[body.length],
+               &buf->data[UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH], length);
+        body.data = data;
+        body.length += length;
+    }
+    UA_ByteString_clear(buf);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addHistory(size_t points) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Double value = 0.0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_HISTORYREAD;
+    attr.historizing = true;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_STRING(1, "History"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "History"), UA_NODEID_NULL,
+                                  attr, NULL, &historyNodeId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The store is preallocated, so that it is not reallocated while the
+     * values are inserted */
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = UA_HistoryDataBackend_Memory(1, points);
+    setting.maxHistoryDataResponseSize = points;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    res = gathering.registerNodeId(server, gathering.context, &historyNodeId, setting);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    dv.hasValue = true;
+    dv.hasSourceTimestamp = true;
+    for(size_t i = 0; i < points; i++) {
+        value = (UA_Double)i;
+        UA_Variant_setScalar(&dv.value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+        dv.sourceTimestamp = START_TIME + (UA_DateTime)i * UA_DATETIME_SEC;
+        res = setting.historizingBackend.
+            serverSetHistoryData(server, setting.historizingBackend.context, NULL,
+                                 NULL, &historyNodeId, true, &dv);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    gathering = UA_HistoryDataGathering_Default(1);
+    config->historyDatabase = UA_HistoryDatabase_default(gathering);
+
+    /* SecureChannel without security and without message limits */
+    UA_StatusCode res = UA_SecurityPolicy_None(&policy, UA_BYTESTRING_NULL,
+                                               config->logging);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_SecureChannel_init(&channel);
+    channel.config = UA_ConnectionConfig_default;
+    channel.config.localMaxMessageSize = 0;
+    channel.config.localMaxChunkCount = 0;
+    res = UA_SecureChannel_setSecurityPolicy(&channel, &policy, &UA_BYTESTRING_NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    collectCM = testConnectionManagerTCP;
+    collectCM.sendWithConnection = collectChunk;
+    channel.connectionManager = &collectCM;
+    channel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+    channel.state = UA_SECURECHANNELSTATE_OPEN;
+
+    collectBody = false;
+    UA_ByteString_init(&body);
+    chunks = 0;
+    maxChunkLength = 0;
+    totalLength = 0;
+}
+
+static void teardown(void) {
+    UA_ByteString_clear(&body);
+    UA_SecureChannel_clear(&channel);
+    policy.clear(&policy);
+    UA_NodeId_clear(&historyNodeId);
+    UA_Server_delete(server);
+}
+
+static void
+initRequest(UA_HistoryReadRequest *request, UA_ReadRawModifiedDetails *details,
+            UA_HistoryReadValueId *nodesToRead, size_t nodesToReadSize) {
+    UA_ReadRawModifiedDetails_init(details);
+    details->startTime = START_TIME;
+    details->endTime = START_TIME + (UA_DateTime)HISTORY_POINTS * 2 * UA_DATETIME_SEC;
+    UA_HistoryReadRequest_init(request);
+    UA_ExtensionObject_setValue(&request->historyReadDetails, details,
+                                &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS]);
+    request->timestampsToReturn = UA_TIMESTAMPSTORETURN_BOTH;
+    request->nodesToRead = nodesToRead;
+    request->nodesToReadSize = nodesToReadSize;
+}
+
+static UA_Boolean
+streamRequest(const UA_HistoryReadRequest *request) {
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    UA_Boolean streamed =
+        Service_HistoryReadStreaming(server, &server->adminSession, &channel,
+                                     1, request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    UA_HistoryReadResponse_clear(&response);
+    return streamed;
+}
+
+/* The streamed response is identical to the regular response. Including the
+ * results for nodes that cannot be read. */
+START_TEST(streamedResponseMatches) {
+    addHistory(1000);
+
+    UA_HistoryReadValueId nodesToRead[2];
+    UA_HistoryReadValueId_init(&nodesToRead[0]);
+    UA_HistoryReadValueId_init(&nodesToRead[1]);
+    nodesToRead[0].nodeId = historyNodeId;
+    nodesToRead[1].nodeId = UA_NODEID_STRING(1, "DoesNotExist");
+    UA_ReadRawModifiedDetails details;
+    UA_HistoryReadRequest request;
+    initRequest(&request, &details, nodesToRead, 2);
+
+    /* Small chunks, so that the response spans several of them */
+    channel.config.sendBufferSize = 8192;
+    collectBody = true;
+    ck_assert(streamRequest(&request));
+    ck_assert_uint_gt(chunks, 1);
+
+    /* Decode the streamed response */
+    size_t offset = 0;
+    UA_NodeId typeId;
+    UA_StatusCode res = UA_NodeId_decodeBinary(&body, &offset, &typeId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_NodeId_equal(&typeId,
+                              &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE].binaryEncodingId));
+    UA_HistoryReadResponse streamed;
+    res = UA_decodeBinaryInternal(&body, &offset, &streamed,
+                                  &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE], NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(offset, body.length);
+
+    /* Get the regular response */
+    UA_HistoryReadResponse regular;
+    UA_HistoryReadResponse_init(&regular);
+    UA_LOCK(&server->serviceMutex);
+    Service_HistoryRead(server, &server->adminSession, &request, &regular);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(regular.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+
+    /* Compare the encoded results */
+    ck_assert_uint_eq(streamed.resultsSize, 2);
+    ck_assert_uint_eq(streamed.results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_ne(streamed.results[1].statusCode, UA_STATUSCODE_GOOD);
+    UA_HistoryData *hd = (UA_HistoryData*)
+        streamed.results[0].historyData.content.decoded.data;
+    ck_assert_uint_eq(hd->dataValuesSize, 1000);
+    regular.responseHeader = streamed.responseHeader;
+    UA_ByteString encodedStreamed = UA_BYTESTRING_NULL;
+    UA_ByteString encodedRegular = UA_BYTESTRING_NULL;
+    res = UA_encodeBinary(&streamed, &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE],
+                          &encodedStreamed);
+    res |= UA_encodeBinary(&regular, &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE],
+                           &encodedRegular);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_ByteString_equal(&encodedStreamed, &encodedRegular));
+
+    UA_ResponseHeader_init(&regular.responseHeader);
+    UA_HistoryReadResponse_clear(&regular);
+    UA_HistoryReadResponse_clear(&streamed);
+    UA_ByteString_clear(&encodedStreamed);
+    UA_ByteString_clear(&encodedRegular);
+    UA_NodeId_clear(&typeId);
+} END_TEST
+
+/* Reads that need a continuation point use the regular service */
+START_TEST(continuationPointNotStreamed) {
+    addHistory(1000);
+
+    UA_HistoryReadValueId nodeToRead;
+    UA_HistoryReadValueId_init(&nodeToRead);
+    nodeToRead.nodeId = historyNodeId;
+    UA_ReadRawModifiedDetails details;
+    UA_HistoryReadRequest request;
+    initRequest(&request, &details, &nodeToRead, 1);
+    details.numValuesPerNode = 100;
+    ck_assert(!streamRequest(&request));
+    ck_assert_uint_eq(chunks, 0);
+
+    details.numValuesPerNode = 1000;
+    details.returnBounds = true;
+    ck_assert(!streamRequest(&request));
+    ck_assert_uint_eq(chunks, 0);
+
+    details.returnBounds = false;
+    ck_assert(streamRequest(&request));
+    ck_assert_uint_gt(chunks, 0);
+} END_TEST
+
+#ifdef MEASURE_PEAK_MEMORY
+static long
+peakRssKB(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+#endif
+
+/* The response is never held in memory */
+START_TEST(largeHistoryBoundedMemory) {
+    addHistory(HISTORY_POINTS);
+
+    UA_HistoryReadValueId nodeToRead;
+    UA_HistoryReadValueId_init(&nodeToRead);
+    nodeToRead.nodeId = historyNodeId;
+    UA_ReadRawModifiedDetails details;
+    UA_HistoryReadRequest request;
+    initRequest(&request, &details, &nodeToRead, 1);
+
+#ifdef MEASURE_PEAK_MEMORY
+    long before = peakRssKB();
+#endif
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    ck_assert(streamRequest(&request));
+    UA_DateTime finish = UA_DateTime_nowMonotonic();
+
+    printf("Streamed %u points in %u chunks (%u bytes, largest chunk %u bytes) "
+           "in %.1f ms\n", (unsigned)HISTORY_POINTS, (unsigned)chunks,
+           (unsigned)totalLength, (unsigned)maxChunkLength,
+           (double)(finish - begin) / UA_DATETIME_MSEC);
+    ck_assert_uint_le(maxChunkLength, channel.config.sendBufferSize);
+    ck_assert_uint_gt(totalLength, (size_t)HISTORY_POINTS * 16);
+
+#ifdef MEASURE_PEAK_MEMORY
+    long growth = peakRssKB() - before;
+    printf("Peak memory growth: %ld KB (budget %d KB)\n", growth, RSS_BUDGET_KB);
+    ck_assert_int_le(growth, RSS_BUDGET_KB);
+#endif
+} END_TEST
+
+static Suite *testSuite_historyReadStreaming(void) {
+    Suite *s = suite_create("HistoryRead Streaming");
+    TCase *tc = tcase_create("HistoryRead Streaming");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_set_timeout(tc, 120);
+    /* First, so that the peak memory of the process is not raised by the
+     * other tests */
+    tcase_add_test(tc, largeHistoryBoundedMemory);
+    tcase_add_test(tc, streamedResponseMatches);
+    tcase_add_test(tc, continuationPointNotStreamed);
+    suite_add_tcase(s, tc);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_historyReadStreaming();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
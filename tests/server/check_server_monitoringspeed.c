@@ -6,6 +6,7 @@
 
 #include <open62541/server_config_default.h>
 
+#include "server/ua_services.h"
 #include "server/ua_subscription.h"
 #include "ua_server_internal.h"
 #include "test_helpers.h"
@@ -81,14 +82,203 @@ START_TEST(monitorIntegerNoChanges) {
 }
 END_TEST
 
+/* Evaluate the absolute deadband for Double arrays of different lengths. The
+ * samples stay inside the deadband and are not reported. */
+static const size_t deadbandArraySizes[3] = {1000, 10000, 100000};
+#define DEADBAND_ELEMENTS 20000000 /* Elements compared per array size */
+
+START_TEST(deadbandArraySpeed) {
+    size_t length = deadbandArraySizes[_i];
+    UA_Double *array = (UA_Double*)UA_Array_new(length, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_Double *sample = (UA_Double*)UA_Array_new(length, &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert(array != NULL && sample != NULL);
+    for(size_t i = 0; i < length; i++) {
+        array[i] = (UA_Double)i;
+        sample[i] = (UA_Double)i + 0.1;
+    }
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Variant_setArray(&attr.value, array, length, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_NodeId arrayNodeId = UA_NODEID_STRING(1, "deadband.array");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, arrayNodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "deadband array"),
+                                  UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataChangeFilter filter;
+    UA_DataChangeFilter_init(&filter);
+    filter.trigger = UA_DATACHANGETRIGGER_STATUSVALUE;
+    filter.deadbandType = UA_DEADBANDTYPE_ABSOLUTE;
+    filter.deadbandValue = 0.5;
+
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = arrayNodeId;
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    UA_ExtensionObject_setValue(&item.requestedParameters.filter, &filter,
+                                &UA_TYPES[UA_TYPES_DATACHANGEFILTER]);
+    UA_MonitoredItemCreateResult result =
+        UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_NEITHER,
+                                                item, NULL,
+                                                dataChangeNotificationCallback);
+    ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+    UA_MonitoredItem *mon = LIST_FIRST(&server->adminSubscription->monitoredItems);
+
+    callbackCount = 0;
+    size_t rounds = DEADBAND_ELEMENTS / length;
+    clock_t begin = clock();
+    UA_LOCK(&server->serviceMutex);
+    for(size_t i = 0; i < rounds; i++) {
+        /* The sample is not copied. Clearing it leaves the array in place. */
+        UA_DataValue dv;
+        UA_DataValue_init(&dv);
+        UA_Variant_setArray(&dv.value, sample, length, &UA_TYPES[UA_TYPES_DOUBLE]);
+        dv.value.storageType = UA_VARIANT_DATA_NODELETE;
+        dv.hasValue = true;
+        UA_MonitoredItem_processSampledValue(server, mon, &dv);
+    }
+    UA_UNLOCK(&server->serviceMutex);
+    clock_t finish = clock();
+    ck_assert_uint_eq(callbackCount, 0);
+
+    /* A change of the last element outside the deadband is detected */
+    sample[length - 1] += 1.0;
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    retval = UA_Variant_setArrayCopy(&dv.value, sample, length,
+                                     &UA_TYPES[UA_TYPES_DOUBLE]);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    dv.hasValue = true;
+    UA_LOCK(&server->serviceMutex);
+    UA_MonitoredItem_processSampledValue(server, mon, &dv);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert(((UA_Double*)mon->lastValue.value.data)[length - 1] ==
+              sample[length - 1]);
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("duration was %f s for %lu deadband evaluations of %lu Doubles "
+           "(%.2f ns/element)\n", time_spent, (unsigned long)rounds,
+           (unsigned long)length, time_spent * 1e9 / (double)(rounds * length));
+
+    UA_Array_delete(array, length, &UA_TYPES[UA_TYPES_DOUBLE]);
+    UA_Array_delete(sample, length, &UA_TYPES[UA_TYPES_DOUBLE]);
+}
+END_TEST
+
+#define MONITOREDITEMS 50000 /* Number of MonitoredItems in the Subscription */
+#define BATCHSIZE 1000 /* Number of MonitoredItems per request */
+
+START_TEST(deleteMonitoredItemsSpeed) {
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->maxMonitoredItemsPerCall = BATCHSIZE;
+
+    /* Create a session and a subscription */
+    UA_CreateSessionRequest sessionRequest;
+    UA_CreateSessionRequest_init(&sessionRequest);
+    UA_Session *session = NULL;
+    UA_LOCK(&server->serviceMutex);
+    UA_StatusCode retval =
+        UA_Server_createSession(server, NULL, &sessionRequest, &session);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_CreateSubscriptionRequest subRequest;
+    UA_CreateSubscriptionRequest_init(&subRequest);
+    UA_CreateSubscriptionResponse subResponse;
+    UA_CreateSubscriptionResponse_init(&subResponse);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateSubscription(server, session, &subRequest, &subResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(subResponse.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    UA_UInt32 subscriptionId = subResponse.subscriptionId;
+    UA_CreateSubscriptionResponse_clear(&subResponse);
+
+    /* Create the MonitoredItems. Sampled with the publishing interval. */
+    UA_MonitoredItemCreateRequest items[BATCHSIZE];
+    for(size_t i = 0; i < BATCHSIZE; i++) {
+        UA_MonitoredItemCreateRequest_init(&items[i]);
+        items[i].itemToMonitor.nodeId =
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_REPORTING;
+        items[i].requestedParameters.samplingInterval = -1.0;
+        items[i].requestedParameters.queueSize = 1;
+    }
+    UA_CreateMonitoredItemsRequest createRequest;
+    UA_CreateMonitoredItemsRequest_init(&createRequest);
+    createRequest.subscriptionId = subscriptionId;
+    createRequest.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    createRequest.itemsToCreate = items;
+    createRequest.itemsToCreateSize = BATCHSIZE;
+
+    UA_UInt32 *ids = (UA_UInt32*)UA_malloc(MONITOREDITEMS * sizeof(UA_UInt32));
+    ck_assert(ids != NULL);
+    for(size_t i = 0; i < MONITOREDITEMS; i += BATCHSIZE) {
+        UA_CreateMonitoredItemsResponse createResponse;
+        UA_CreateMonitoredItemsResponse_init(&createResponse);
+        UA_LOCK(&server->serviceMutex);
+        Service_CreateMonitoredItems(server, session, &createRequest, &createResponse);
+        UA_UNLOCK(&server->serviceMutex);
+        ck_assert_uint_eq(createResponse.resultsSize, BATCHSIZE);
+        for(size_t j = 0; j < BATCHSIZE; j++) {
+            ck_assert_uint_eq(createResponse.results[j].statusCode,
+                              UA_STATUSCODE_GOOD);
+            ids[i + j] = createResponse.results[j].monitoredItemId;
+        }
+        UA_CreateMonitoredItemsResponse_clear(&createResponse);
+    }
+
+    /* Delete the MonitoredItems in batches, in the order of creation */
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subscriptionId;
+    deleteRequest.monitoredItemIdsSize = BATCHSIZE;
+
+    clock_t begin, finish;
+    begin = clock();
+
+    for(size_t i = 0; i < MONITOREDITEMS; i += BATCHSIZE) {
+        deleteRequest.monitoredItemIds = &ids[i];
+        UA_DeleteMonitoredItemsResponse deleteResponse;
+        UA_DeleteMonitoredItemsResponse_init(&deleteResponse);
+        UA_LOCK(&server->serviceMutex);
+        Service_DeleteMonitoredItems(server, session, &deleteRequest, &deleteResponse);
+        UA_UNLOCK(&server->serviceMutex);
+        ck_assert_uint_eq(deleteResponse.resultsSize, BATCHSIZE);
+        for(size_t j = 0; j < BATCHSIZE; j++)
+            ck_assert_uint_eq(deleteResponse.results[j], UA_STATUSCODE_GOOD);
+        UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
+    }
+
+    finish = clock();
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("duration was %f s for deleting %u MonitoredItems in batches of %u\n",
+           time_spent, (unsigned)MONITOREDITEMS, (unsigned)BATCHSIZE);
+
+    UA_free(ids);
+}
+END_TEST
+
 static Suite * monitoring_speed_suite (void) {
     Suite *s = suite_create ("Monitoring Speed");
 
     TCase* tc_datachange = tcase_create ("DataChange");
     tcase_add_checked_fixture(tc_datachange, setup, teardown);
     tcase_add_test (tc_datachange, monitorIntegerNoChanges);
+    tcase_add_loop_test(tc_datachange, deadbandArraySpeed, 0,
+                        sizeof(deadbandArraySizes) / sizeof(deadbandArraySizes[0]));
     suite_add_tcase (s, tc_datachange);
 
+    TCase* tc_delete = tcase_create ("DeleteMonitoredItems");
+    tcase_add_checked_fixture(tc_delete, setup, teardown);
+    tcase_add_test (tc_delete, deleteMonitoredItemsSpeed);
+    suite_add_tcase (s, tc_delete);
+
     return s;
 }
 
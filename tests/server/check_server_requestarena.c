@@ -0,0 +1,256 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measures decode/process/encode of Read, Write and Browse requests with the
+ * request memory taken from the heap or from an arena. The server does not
+ * open a TCP port. */
+
+#include <open62541/server_config_default.h>
+
+#include "server/ua_services.h"
+#include "ua_server_internal.h"
+#include "ua_types_encoding_binary.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define NODES 100 /* Number of variables that are accessed */
+#define OPERATIONS_PER_TEST 100000 /* Operations per measurement */
+
+static UA_Server *server;
+static UA_NodeId nodeIds[NODES];
+static UA_ByteString responseBuf;
+
+static const size_t operations[] = {1, 100, 10000};
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    for(size_t i = 0; i < NODES; i++) {
+        char name[20];
+        snprintf(name, 20, "Variable %u", (unsigned)i);
+        UA_StatusCode res =
+            UA_Server_addVariableNode(server, UA_NODEID_STRING(1, name),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, name), UA_NODEID_NULL,
+                                      attr, NULL, &nodeIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_StatusCode res = UA_ByteString_allocBuffer(&responseBuf, 16 * 1024 * 1024);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    for(size_t i = 0; i < NODES; i++)
+        UA_NodeId_clear(&nodeIds[i]);
+    UA_ByteString_clear(&responseBuf);
+    UA_Server_delete(server);
+}
+
+/* Decode, process and encode the request. Returns the duration in ns per
+ * request. */
+static double
+measure(const UA_ByteString *encoded, const UA_DataType *requestType,
+        UA_Service service, const UA_DataType *responseType,
+        size_t iterations, UA_Arena *arena) {
+    UA_Request request;
+    UA_Response response;
+    UA_DateTime begin = UA_DateTime_nowMonotonic();
+    for(size_t i = 0; i < iterations; i++) {
+        size_t offset = 0;
+        UA_StatusCode res = (arena) ?
+            UA_decodeBinaryInternalArena(encoded, &offset, &request,
+                                         requestType, NULL, arena) :
+            UA_decodeBinaryInternal(encoded, &offset, &request,
+                                    requestType, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        UA_init(&response, responseType);
+        UA_LOCK(&server->serviceMutex);
+        service(server, &server->adminSession, &request, &response);
+        UA_UNLOCK(&server->serviceMutex);
+        ck_assert_uint_eq(response.responseHeader.serviceResult,
+                          UA_STATUSCODE_GOOD);
+
+        UA_Byte *pos = responseBuf.data;
+        const UA_Byte *end = &responseBuf.data[responseBuf.length];
+        res = UA_encodeBinaryInternal(&response, responseType,
+                                      &pos, &end, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        if(arena)
+            UA_Arena_reset(arena);
+        else
+            UA_clear(&request, requestType);
+        UA_clear(&response, responseType);
+    }
+    UA_DateTime end = UA_DateTime_nowMonotonic();
+    return (double)(end - begin) * 100.0 / (double)iterations;
+}
+
+static void
+benchmark(const char *name, const void *request, const UA_DataType *requestType,
+          UA_Service service, const UA_DataType *responseType, size_t ops) {
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode res = UA_encodeBinary(request, requestType, &encoded);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The decoded request is identical with and without the arena */
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+    UA_Request decoded;
+    size_t offset = 0;
+    res = UA_decodeBinaryInternalArena(&encoded, &offset, &decoded,
+                                       requestType, NULL, &arena);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_order(&decoded, request, requestType) == UA_ORDER_EQ);
+
+    /* Every allocation from the arena is a malloc without the arena */
+    size_t allocs = arena.allocCount;
+    size_t blocks = arena.blockCount;
+    UA_Arena_reset(&arena);
+
+    size_t iterations = OPERATIONS_PER_TEST / ops;
+    if(iterations < 10)
+        iterations = 10;
+    if(iterations > 1000)
+        iterations = 1000;
+    double heapNs = measure(&encoded, requestType, service,
+                            responseType, iterations, NULL);
+    double arenaNs = measure(&encoded, requestType, service,
+                             responseType, iterations, &arena);
+
+    printf("%-6s %5u ops: decode allocations %6u (heap) / %2u (arena), "
+           "latency %9.1f us (heap) / %9.1f us (arena)\n", name, (unsigned)ops,
+           (unsigned)allocs, (unsigned)blocks, heapNs / 1000.0, arenaNs / 1000.0);
+
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&encoded);
+}
+
+START_TEST(readArena) {
+    size_t ops = operations[_i];
+    UA_ReadValueId *rvi = (UA_ReadValueId*)
+        UA_Array_new(ops, &UA_TYPES[UA_TYPES_READVALUEID]);
+    for(size_t i = 0; i < ops; i++) {
+        UA_NodeId_copy(&nodeIds[i % NODES], &rvi[i].nodeId);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = ops;
+    benchmark("Read", &request, &UA_TYPES[UA_TYPES_READREQUEST],
+              (UA_Service)Service_Read, &UA_TYPES[UA_TYPES_READRESPONSE], ops);
+    UA_ReadRequest_clear(&request);
+} END_TEST
+
+START_TEST(writeArena) {
+    size_t ops = operations[_i];
+    UA_WriteValue *wv = (UA_WriteValue*)
+        UA_Array_new(ops, &UA_TYPES[UA_TYPES_WRITEVALUE]);
+    for(size_t i = 0; i < ops; i++) {
+        UA_Int32 value = (UA_Int32)i;
+        UA_NodeId_copy(&nodeIds[i % NODES], &wv[i].nodeId);
+        wv[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[i].value.hasValue = true;
+        UA_Variant_setScalarCopy(&wv[i].value.value, &value,
+                                 &UA_TYPES[UA_TYPES_INT32]);
+    }
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = wv;
+    request.nodesToWriteSize = ops;
+    benchmark("Write", &request, &UA_TYPES[UA_TYPES_WRITEREQUEST],
+              (UA_Service)Service_Write, &UA_TYPES[UA_TYPES_WRITERESPONSE], ops);
+    UA_WriteRequest_clear(&request);
+} END_TEST
+
+START_TEST(browseArena) {
+    size_t ops = operations[_i];
+    UA_BrowseDescription *bd = (UA_BrowseDescription*)
+        UA_Array_new(ops, &UA_TYPES[UA_TYPES_BROWSEDESCRIPTION]);
+    for(size_t i = 0; i < ops; i++) {
+        UA_NodeId_copy(&nodeIds[i % NODES], &bd[i].nodeId);
+        bd[i].browseDirection = UA_BROWSEDIRECTION_BOTH;
+        bd[i].includeSubtypes = true;
+        bd[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowse = bd;
+    request.nodesToBrowseSize = ops;
+    benchmark("Browse", &request, &UA_TYPES[UA_TYPES_BROWSEREQUEST],
+              (UA_Service)Service_Browse, &UA_TYPES[UA_TYPES_BROWSERESPONSE], ops);
+    UA_BrowseRequest_clear(&request);
+} END_TEST
+
+/* Decoding errors release the partially decoded request with the arena */
+START_TEST(decodeErrorArena) {
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    UA_Int32 value = 42;
+    wv.nodeId = nodeIds[0];
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value.hasValue = true;
+    UA_Variant_setScalar(&wv.value.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = &wv;
+    request.nodesToWriteSize = 1;
+
+    UA_ByteString encoded = UA_BYTESTRING_NULL;
+    UA_StatusCode res =
+        UA_encodeBinary(&request, &UA_TYPES[UA_TYPES_WRITEREQUEST], &encoded);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_Arena arena;
+    memset(&arena, 0, sizeof(UA_Arena));
+    UA_WriteRequest decoded;
+    for(size_t len = 0; len < encoded.length; len++) {
+        UA_ByteString truncated = {len, encoded.data};
+        size_t offset = 0;
+        res = UA_decodeBinaryInternalArena(&truncated, &offset, &decoded,
+                                           &UA_TYPES[UA_TYPES_WRITEREQUEST],
+                                           NULL, &arena);
+        ck_assert_uint_ne(res, UA_STATUSCODE_GOOD);
+        UA_Arena_reset(&arena);
+    }
+    UA_Arena_clear(&arena);
+    UA_ByteString_clear(&encoded);
+} END_TEST
+
+static Suite * testSuite_requestArena(void) {
+    Suite *s = suite_create("Request Arena");
+    TCase *tc_arena = tcase_create("Request Arena");
+    tcase_add_checked_fixture(tc_arena, setup, teardown);
+    tcase_set_timeout(tc_arena, 60);
+    size_t opsSize = sizeof(operations) / sizeof(operations[0]);
+    tcase_add_loop_test(tc_arena, readArena, 0, (int)opsSize);
+    tcase_add_loop_test(tc_arena, writeArena, 0, (int)opsSize);
+    tcase_add_loop_test(tc_arena, browseArena, 0, (int)opsSize);
+    tcase_add_test(tc_arena, decodeErrorArena);
+    suite_add_tcase(s, tc_arena);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_requestArena();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
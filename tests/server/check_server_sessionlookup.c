@@ -0,0 +1,120 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* Measures the cost of looking up the session for a request with many open
+ * sessions. The server does not open a TCP port. */
+
+#include <open62541/server_config_default.h>
+
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <time.h>
+#include <stdio.h>
+
+#include "test_helpers.h"
+
+#define SESSIONS 10000 /* Number of sessions to be created */
+#define LOOKUPS 1000000 /* Number of lookups to perform */
+
+static UA_Server *server;
+static UA_NodeId tokens[SESSIONS];
+static UA_NodeId sessionIds[SESSIONS];
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->maxSessions = SESSIONS;
+
+    UA_CreateSessionRequest request;
+    UA_CreateSessionRequest_init(&request);
+    UA_LOCK(&server->serviceMutex);
+    for(size_t i = 0; i < SESSIONS; i++) {
+        UA_Session *session = NULL;
+        UA_StatusCode retval =
+            UA_Server_createSession(server, NULL, &request, &session);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        tokens[i] = session->authenticationToken;
+        sessionIds[i] = session->sessionId;
+    }
+    UA_UNLOCK(&server->serviceMutex);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+START_TEST(lookupSpeed) {
+    UA_LOCK(&server->serviceMutex);
+    clock_t begin = clock();
+    for(size_t i = 0; i < LOOKUPS; i++) {
+        UA_Session *session = getSessionByToken(server, &tokens[i % SESSIONS]);
+        ck_assert(session != NULL);
+    }
+    clock_t finish = clock();
+    UA_UNLOCK(&server->serviceMutex);
+
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("duration was %f s for %u lookups with %u sessions (%.0f ns/lookup)\n",
+           time_spent, (unsigned)LOOKUPS, (unsigned)SESSIONS,
+           time_spent * 1e9 / LOOKUPS);
+}
+END_TEST
+
+START_TEST(lookupConsistency) {
+    UA_LOCK(&server->serviceMutex);
+
+    /* Both indices resolve to the same session */
+    for(size_t i = 0; i < SESSIONS; i++) {
+        UA_Session *byToken = getSessionByToken(server, &tokens[i]);
+        UA_Session *byId = getSessionById(server, &sessionIds[i]);
+        ck_assert(byToken != NULL);
+        ck_assert_ptr_eq(byToken, byId);
+    }
+
+    /* Remove every second session */
+    for(size_t i = 0; i < SESSIONS; i += 2) {
+        UA_StatusCode retval =
+            UA_Server_removeSessionByToken(server, &tokens[i],
+                                           UA_SHUTDOWNREASON_CLOSE);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_eq(server->sessionCount, SESSIONS / 2);
+
+    for(size_t i = 0; i < SESSIONS; i++) {
+        UA_Session *byToken = getSessionByToken(server, &tokens[i]);
+        UA_Session *byId = getSessionById(server, &sessionIds[i]);
+        ck_assert_ptr_eq(byToken, byId);
+        ck_assert_uint_eq(byToken == NULL, i % 2 == 0);
+    }
+
+    /* Removing twice fails */
+    UA_StatusCode retval =
+        UA_Server_removeSessionByToken(server, &tokens[0], UA_SHUTDOWNREASON_CLOSE);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADSESSIONIDINVALID);
+
+    UA_UNLOCK(&server->serviceMutex);
+}
+END_TEST
+
+static Suite * testSuite_sessionLookup(void) {
+    Suite *s = suite_create("Session Lookup");
+    TCase *tc_lookup = tcase_create("Session Lookup");
+    tcase_add_checked_fixture(tc_lookup, setup, teardown);
+    tcase_add_test(tc_lookup, lookupSpeed);
+    tcase_add_test(tc_lookup, lookupConsistency);
+    suite_add_tcase(s, tc_lookup);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_sessionLookup();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1120,6 +1120,409 @@ START_TEST(CheckDescriptionLocalization) {
     UA_LocalizedText_clear(&lt);
 } END_TEST
 
+#define SHARED_READERS 10000
+#define SHARED_IMAGE_SIZE (1024 * 1024)
+
+/* Many readers of a large shared value hold references to the same buffer */
+START_TEST(ReadSharedValue) {
+    UA_ByteString *image = UA_ByteString_new();
+    UA_StatusCode retval = UA_ByteString_allocBuffer(image, SHARED_IMAGE_SIZE);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    memset(image->data, 0xab, image->length);
+
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Variant_setScalar(&vattr.value, image, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    retval = UA_Variant_makeShared(&vattr.value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(vattr.value.storageType, UA_VARIANT_DATA_SHARED);
+    vattr.displayName = UA_LOCALIZEDTEXT("locale","image");
+    UA_NodeId imageId = UA_NODEID_STRING(1, "image");
+    retval = UA_Server_addVariableNode(server, imageId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "image"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       vattr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = imageId;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+
+    UA_DataValue *results = (UA_DataValue*)
+        UA_Array_new(SHARED_READERS, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    ck_assert(results != NULL);
+    for(size_t i = 0; i < SHARED_READERS; i++) {
+        results[i] = UA_Server_read(server, &rvi, UA_TIMESTAMPSTORETURN_NEITHER);
+        ck_assert(results[i].hasValue);
+        ck_assert_int_eq(results[i].value.storageType, UA_VARIANT_DATA_SHARED);
+        ck_assert_ptr_eq(results[i].value.data, vattr.value.data);
+    }
+
+    /* The original reference can go away before the readers */
+    UA_ByteString *read = (UA_ByteString*)results[0].value.data;
+    UA_Variant_clear(&vattr.value);
+    ck_assert_uint_eq(read->length, SHARED_IMAGE_SIZE);
+    ck_assert_uint_eq(read->data[SHARED_IMAGE_SIZE - 1], 0xab);
+
+    /* A shared value written into the node stays shared */
+    UA_Variant next;
+    retval = UA_Variant_setScalarCopy(&next, read, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Variant_makeShared(&next);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_writeValue(server, imageId, next);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_DataValue written = UA_Server_read(server, &rvi, UA_TIMESTAMPSTORETURN_NEITHER);
+    ck_assert_int_eq(written.value.storageType, UA_VARIANT_DATA_SHARED);
+    ck_assert_ptr_eq(written.value.data, next.data);
+    UA_DataValue_clear(&written);
+    UA_Variant_clear(&next);
+
+    UA_Array_delete(results, SHARED_READERS, &UA_TYPES[UA_TYPES_DATAVALUE]);
+} END_TEST
+
+/* Writing an index range into a shared value copies it first. The earlier
+ * readers keep the old value. */
+START_TEST(WriteRangeSharedValue) {
+    UA_Int32 arr[3] = {1, 2, 3};
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_StatusCode retval =
+        UA_Variant_setArrayCopy(&vattr.value, arr, 3, &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Variant_makeShared(&vattr.value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    vattr.displayName = UA_LOCALIZEDTEXT("locale","sharedarray");
+    UA_NodeId arrayId = UA_NODEID_STRING(1, "sharedarray");
+    retval = UA_Server_addVariableNode(server, arrayId,
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                       UA_QUALIFIEDNAME(1, "sharedarray"),
+                                       UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                       vattr, NULL, NULL);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&vattr.value);
+
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = arrayId;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_DataValue before = UA_Server_read(server, &rvi, UA_TIMESTAMPSTORETURN_NEITHER);
+    ck_assert_int_eq(before.value.storageType, UA_VARIANT_DATA_SHARED);
+
+    UA_WriteValue wValue;
+    UA_WriteValue_init(&wValue);
+    UA_Int32 newValue = 20;
+    UA_Variant_setArray(&wValue.value.value, &newValue, 1, &UA_TYPES[UA_TYPES_INT32]);
+    wValue.value.hasValue = true;
+    wValue.nodeId = arrayId;
+    wValue.indexRange = UA_STRING("1");
+    wValue.attributeId = UA_ATTRIBUTEID_VALUE;
+    retval = UA_Server_write(server, &wValue);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_DataValue after = UA_Server_read(server, &rvi, UA_TIMESTAMPSTORETURN_NEITHER);
+    ck_assert_int_eq(((UA_Int32*)before.value.data)[1], 2);
+    ck_assert_int_eq(((UA_Int32*)after.value.data)[1], 20);
+    ck_assert_ptr_ne(before.value.data, after.value.data);
+    UA_DataValue_clear(&before);
+    UA_DataValue_clear(&after);
+} END_TEST
+
+static size_t batchCalls;
+static size_t batchNodes;
+
+static UA_StatusCode
+readBatch(UA_Server *server_, const UA_NodeId *sessionId, void *sessionContext,
+          size_t nodesSize, const UA_NodeId *nodeIds, void * const *nodeContexts,
+          UA_Boolean includeSourceTimeStamp, const UA_NumericRange * const *ranges,
+          UA_DataValue *values) {
+    batchCalls++;
+    batchNodes += nodesSize;
+    for(size_t i = 0; i < nodesSize; i++) {
+        UA_UInt32 v = 10 * (UA_UInt32)(uintptr_t)nodeContexts[i];
+        UA_Variant_setScalarCopy(&values[i].value, &v, &UA_TYPES[UA_TYPES_UINT32]);
+        values[i].hasValue = true;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+#define BATCHNODES 8
+
+static UA_UInt32 batchWritten[BATCHNODES];
+static void *batchAsyncContext;
+
+static UA_StatusCode
+writeBatch(UA_Server *server_, const UA_NodeId *sessionId, void *sessionContext,
+           size_t nodesSize, const UA_NodeId *nodeIds, void * const *nodeContexts,
+           const UA_NumericRange * const *ranges, const UA_DataValue *values,
+           void *asyncContext, UA_StatusCode *results) {
+    batchCalls++;
+    batchNodes += nodesSize;
+    batchAsyncContext = asyncContext;
+    for(size_t i = 0; i < nodesSize; i++) {
+        size_t index = (uintptr_t)nodeContexts[i];
+        if(index == 5) {
+            results[i] = UA_STATUSCODE_BADOUTOFRANGE;
+            continue;
+        }
+        batchWritten[index] = *(UA_UInt32*)values[i].value.data;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+addBatchedNodes(UA_Byte accessLevel) {
+    UA_ValueBackend backend;
+    memset(&backend, 0, sizeof(UA_ValueBackend));
+    backend.backendType = UA_VALUEBACKENDTYPE_DATA_SOURCE_BATCH;
+    backend.backend.dataSourceBatch.read = readBatch;
+    backend.backend.dataSourceBatch.write = writeBatch;
+    for(UA_UInt32 i = 0; i < BATCHNODES; i++) {
+        UA_VariableAttributes vattr = UA_VariableAttributes_default;
+        vattr.displayName = UA_LOCALIZEDTEXT("locale","batched");
+        vattr.accessLevel = accessLevel;
+        UA_NodeId id = UA_NODEID_NUMERIC(1, 5000 + i);
+        UA_StatusCode retval =
+            UA_Server_addVariableNode(server, id,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "batched"),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                      vattr, (void*)(uintptr_t)i, NULL);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+        retval = UA_Server_setVariableNode_valueBackend(server, id, backend);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+    batchCalls = 0;
+    batchNodes = 0;
+    memset(batchWritten, 0, sizeof(batchWritten));
+}
+
+/* The values of all nodes with the same batched DataSource are read with one
+ * call. Other operations in between are not affected. */
+START_TEST(ReadBatchedDataSource) {
+    addBatchedNodes(UA_ACCESSLEVELMASK_READ);
+
+    UA_ReadValueId rvi[2 * BATCHNODES];
+    for(size_t i = 0; i < BATCHNODES; i++) {
+        UA_ReadValueId_init(&rvi[2*i]);
+        rvi[2*i].nodeId = UA_NODEID_NUMERIC(1, 5000 + (UA_UInt32)i);
+        rvi[2*i].attributeId = UA_ATTRIBUTEID_VALUE;
+        UA_ReadValueId_init(&rvi[2*i+1]);
+        rvi[2*i+1].nodeId = UA_NODEID_STRING(1, "the.answer");
+        rvi[2*i+1].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    rvi[3].nodeId = rvi[2].nodeId; /* Same node, different attribute */
+    rvi[3].attributeId = UA_ATTRIBUTEID_NODECLASS;
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 2 * BATCHNODES;
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Read(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(batchCalls, 1);
+    ck_assert_uint_eq(batchNodes, BATCHNODES);
+    ck_assert_uint_eq(response.resultsSize, 2 * BATCHNODES);
+    for(size_t i = 0; i < BATCHNODES; i++) {
+        UA_DataValue *dv = &response.results[2*i];
+        ck_assert(dv->hasValue);
+        ck_assert(dv->hasSourceTimestamp);
+        ck_assert(!dv->hasServerTimestamp);
+        ck_assert(UA_Variant_hasScalarType(&dv->value, &UA_TYPES[UA_TYPES_UINT32]));
+        ck_assert_uint_eq(*(UA_UInt32*)dv->value.data, 10 * i);
+        dv = &response.results[2*i+1];
+        ck_assert(dv->hasValue);
+        if(i == 1) {
+            ck_assert(UA_Variant_hasScalarType(&dv->value, &UA_TYPES[UA_TYPES_NODECLASS]));
+            ck_assert_int_eq(*(UA_NodeClass*)dv->value.data, UA_NODECLASS_VARIABLE);
+        } else {
+            ck_assert_int_eq(*(UA_Int32*)dv->value.data, 42);
+        }
+    }
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
+/* Several attributes of the same node are read from the node taken once */
+START_TEST(ReadAttributesOfSameNode) {
+    UA_AttributeId attrs[5] = {UA_ATTRIBUTEID_NODEID, UA_ATTRIBUTEID_BROWSENAME,
+                               UA_ATTRIBUTEID_VALUE, UA_ATTRIBUTEID_VALUERANK,
+                               UA_ATTRIBUTEID_EXECUTABLE};
+    UA_ReadValueId rvi[5];
+    for(size_t i = 0; i < 5; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_STRING(1, "the.answer");
+        rvi[i].attributeId = attrs[i];
+    }
+
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 5;
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Read(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(response.resultsSize, 5);
+    ck_assert(UA_NodeId_equal((UA_NodeId*)response.results[0].value.data,
+                              &rvi[0].nodeId));
+    UA_QualifiedName bn = UA_QUALIFIEDNAME(1, "the answer");
+    ck_assert(UA_QualifiedName_equal((UA_QualifiedName*)response.results[1].value.data,
+                                     &bn));
+    ck_assert_int_eq(*(UA_Int32*)response.results[2].value.data, 42);
+    ck_assert_int_eq(*(UA_Int32*)response.results[3].value.data, UA_VALUERANK_ANY);
+    ck_assert_uint_eq(response.results[4].status, UA_STATUSCODE_BADATTRIBUTEIDINVALID);
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
+/* Single reads call the batched DataSource with one node. The access rights are
+ * checked before the callback. */
+START_TEST(ReadBatchedDataSourceSingle) {
+    addBatchedNodes(UA_ACCESSLEVELMASK_READ);
+    UA_Variant value;
+    UA_StatusCode retval =
+        UA_Server_readValue(server, UA_NODEID_NUMERIC(1, 5003), &value);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(*(UA_UInt32*)value.data, 30);
+    ck_assert_uint_eq(batchCalls, 1);
+    ck_assert_uint_eq(batchNodes, 1);
+    UA_Variant_clear(&value);
+} END_TEST
+
+START_TEST(ReadBatchedDataSourceNotReadable) {
+    addBatchedNodes(UA_ACCESSLEVELMASK_WRITE);
+    UA_ReadValueId rvi[2];
+    for(size_t i = 0; i < 2; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].nodeId = UA_NODEID_NUMERIC(1, 5000 + (UA_UInt32)i);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_NEITHER;
+    request.nodesToRead = rvi;
+    request.nodesToReadSize = 2;
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    UA_Session session; /* The admin session has all access rights */
+    UA_Session_init(&session);
+    UA_LOCK(&server->serviceMutex);
+    Service_Read(server, &session, &request, &response);
+    UA_Session_clear(&session, server);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(batchCalls, 0);
+    ck_assert_uint_eq(response.results[0].status, UA_STATUSCODE_BADNOTREADABLE);
+    ck_assert_uint_eq(response.results[1].status, UA_STATUSCODE_BADNOTREADABLE);
+    UA_ReadResponse_clear(&response);
+} END_TEST
+
+/* The values for all nodes with the same batched DataSource are written with
+ * one call. The checks before the callback are done per operation. */
+START_TEST(WriteBatchedDataSource) {
+    addBatchedNodes(UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE);
+
+    UA_UInt32 values[BATCHNODES];
+    UA_Int32 answer = 43;
+    UA_WriteValue wv[2 * BATCHNODES];
+    for(size_t i = 0; i < BATCHNODES; i++) {
+        values[i] = 100 + (UA_UInt32)i;
+        UA_WriteValue_init(&wv[2*i]);
+        wv[2*i].nodeId = UA_NODEID_NUMERIC(1, 5000 + (UA_UInt32)i);
+        wv[2*i].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[2*i].value.hasValue = true;
+        UA_Variant_setScalar(&wv[2*i].value.value, &values[i],
+                             &UA_TYPES[UA_TYPES_UINT32]);
+        UA_WriteValue_init(&wv[2*i+1]);
+        wv[2*i+1].nodeId = UA_NODEID_STRING(1, "the.answer");
+        wv[2*i+1].attributeId = UA_ATTRIBUTEID_VALUE;
+        wv[2*i+1].value.hasValue = true;
+        UA_Variant_setScalar(&wv[2*i+1].value.value, &answer,
+                             &UA_TYPES[UA_TYPES_INT32]);
+    }
+    wv[6].indexRange = UA_STRING("invalid"); /* Fails before the callback */
+
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = wv;
+    request.nodesToWriteSize = 2 * BATCHNODES;
+    UA_WriteResponse response;
+    UA_WriteResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_Write(server, &server->adminSession, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(batchCalls, 1);
+    ck_assert_uint_eq(batchNodes, BATCHNODES - 1);
+    ck_assert_ptr_eq(batchAsyncContext, NULL); /* Cannot complete async */
+    ck_assert_uint_eq(response.resultsSize, 2 * BATCHNODES);
+    for(size_t i = 0; i < BATCHNODES; i++) {
+        ck_assert_uint_eq(response.results[2*i+1], UA_STATUSCODE_GOOD);
+        if(i == 3) {
+            ck_assert_uint_eq(response.results[2*i], UA_STATUSCODE_BADINDEXRANGEINVALID);
+            ck_assert_uint_eq(batchWritten[i], 0);
+        } else if(i == 5) {
+            ck_assert_uint_eq(response.results[2*i], UA_STATUSCODE_BADOUTOFRANGE);
+        } else {
+            ck_assert_uint_eq(response.results[2*i], UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq(batchWritten[i], 100 + i);
+        }
+    }
+    UA_WriteResponse_clear(&response);
+} END_TEST
+
+/* Single writes call the batched DataSource with one node */
+START_TEST(WriteBatchedDataSourceSingle) {
+    addBatchedNodes(UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE);
+    UA_UInt32 value = 7;
+    UA_Variant var;
+    UA_Variant_setScalar(&var, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode retval = UA_Server_writeValue(server, UA_NODEID_NUMERIC(1, 5002), var);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(batchCalls, 1);
+    ck_assert_uint_eq(batchNodes, 1);
+    ck_assert_uint_eq(batchWritten[2], 7);
+    retval = UA_Server_writeValue(server, UA_NODEID_NUMERIC(1, 5005), var);
+    ck_assert_int_eq(retval, UA_STATUSCODE_BADOUTOFRANGE);
+} END_TEST
+
+START_TEST(WriteBatchedDataSourceNotWritable) {
+    addBatchedNodes(UA_ACCESSLEVELMASK_READ);
+    UA_UInt32 value = 7;
+    UA_WriteValue wv;
+    UA_WriteValue_init(&wv);
+    wv.nodeId = UA_NODEID_NUMERIC(1, 5000);
+    wv.attributeId = UA_ATTRIBUTEID_VALUE;
+    wv.value.hasValue = true;
+    UA_Variant_setScalar(&wv.value.value, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_WriteRequest request;
+    UA_WriteRequest_init(&request);
+    request.nodesToWrite = &wv;
+    request.nodesToWriteSize = 1;
+    UA_WriteResponse response;
+    UA_WriteResponse_init(&response);
+    UA_Session session; /* The admin session has all access rights */
+    UA_Session_init(&session);
+    UA_LOCK(&server->serviceMutex);
+    Service_Write(server, &session, &request, &response);
+    UA_Session_clear(&session, server);
+    UA_UNLOCK(&server->serviceMutex);
+
+    ck_assert_uint_eq(batchCalls, 0);
+    ck_assert_uint_eq(response.results[0], UA_STATUSCODE_BADNOTWRITABLE);
+    UA_WriteResponse_clear(&response);
+} END_TEST
+
 static Suite * testSuite_services_attributes(void) {
     Suite *s = suite_create("services_attributes_read");
 
@@ -1194,6 +1597,27 @@ static Suite * testSuite_services_attributes(void) {
     tcase_add_test(tc_localization, CheckDescriptionLocalization);
     suite_add_tcase(s, tc_localization);
 
+    TCase *tc_sharedValues = tcase_create("sharedValues");
+    tcase_add_checked_fixture(tc_sharedValues, setup, teardown);
+    tcase_add_test(tc_sharedValues, ReadSharedValue);
+    tcase_add_test(tc_sharedValues, WriteRangeSharedValue);
+    suite_add_tcase(s, tc_sharedValues);
+
+    TCase *tc_readBatched = tcase_create("readBatched");
+    tcase_add_checked_fixture(tc_readBatched, setup, teardown);
+    tcase_add_test(tc_readBatched, ReadBatchedDataSource);
+    tcase_add_test(tc_readBatched, ReadAttributesOfSameNode);
+    tcase_add_test(tc_readBatched, ReadBatchedDataSourceSingle);
+    tcase_add_test(tc_readBatched, ReadBatchedDataSourceNotReadable);
+    suite_add_tcase(s, tc_readBatched);
+
+    TCase *tc_writeBatched = tcase_create("writeBatched");
+    tcase_add_checked_fixture(tc_writeBatched, setup, teardown);
+    tcase_add_test(tc_writeBatched, WriteBatchedDataSource);
+    tcase_add_test(tc_writeBatched, WriteBatchedDataSourceSingle);
+    tcase_add_test(tc_writeBatched, WriteBatchedDataSourceNotWritable);
+    suite_add_tcase(s, tc_writeBatched);
+
     return s;
 }
 
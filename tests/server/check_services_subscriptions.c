@@ -625,6 +625,335 @@ START_TEST(Server_deleteMonitoredItems) {
 }
 END_TEST
 
+#ifdef UA_ENABLE_DIAGNOSTICS
+START_TEST(Server_samplingGroups) {
+    createSubscription();
+
+    /* Two MonitoredItems share the sampling interval */
+    UA_Double intervals[3] = {250.0, 250.0, 500.0};
+    UA_MonitoredItemCreateRequest items[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_MonitoredItemCreateRequest_init(&items[i]);
+        items[i].itemToMonitor.nodeId =
+            UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_CURRENTTIME);
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_REPORTING;
+        items[i].requestedParameters.samplingInterval = intervals[i];
+        items[i].requestedParameters.queueSize = 1;
+    }
+
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    request.itemsToCreateSize = 3;
+    request.itemsToCreate = items;
+
+    UA_CreateMonitoredItemsResponse response;
+    UA_CreateMonitoredItemsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateMonitoredItems(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.resultsSize, 3);
+    UA_UInt32 ids[3];
+    for(size_t i = 0; i < 3; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ids[i] = response.results[i].monitoredItemId;
+    }
+    UA_CreateMonitoredItemsResponse_clear(&response);
+
+    /* One timer per sampling interval */
+    UA_SamplingStatistics stats;
+    UA_Server_getSamplingStatistics(server, &stats);
+    ck_assert_uint_eq(stats.samplingTimers, 2);
+    ck_assert_uint_eq(stats.monitoredItems, 3);
+    ck_assert_uint_eq(stats.batches, 0);
+
+    /* Sample three times with the 250ms interval and once with 500ms */
+    for(size_t i = 0; i < 2; i++) {
+        UA_fakeSleep(250);
+        UA_Server_run_iterate(server, false);
+    }
+    UA_Server_getSamplingStatistics(server, &stats);
+    ck_assert_uint_eq(stats.batches, 3);
+    ck_assert_uint_ge(stats.maxBatchTime, stats.lastBatchTime);
+
+    /* Removing the last MonitoredItem of an interval removes the timer */
+    UA_DeleteMonitoredItemsRequest deleteRequest;
+    UA_DeleteMonitoredItemsRequest_init(&deleteRequest);
+    deleteRequest.subscriptionId = subscriptionId;
+    deleteRequest.monitoredItemIdsSize = 2;
+    deleteRequest.monitoredItemIds = &ids[1];
+
+    UA_DeleteMonitoredItemsResponse deleteResponse;
+    UA_DeleteMonitoredItemsResponse_init(&deleteResponse);
+    UA_LOCK(&server->serviceMutex);
+    Service_DeleteMonitoredItems(server, session, &deleteRequest, &deleteResponse);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(deleteResponse.resultsSize, 2);
+    UA_DeleteMonitoredItemsResponse_clear(&deleteResponse);
+
+    UA_Server_getSamplingStatistics(server, &stats);
+    ck_assert_uint_eq(stats.samplingTimers, 1);
+    ck_assert_uint_eq(stats.monitoredItems, 1);
+}
+END_TEST
+
+static UA_UInt32 samplingIds[3];
+static enum {SAMPLING_IDLE, SAMPLING_MODIFY, SAMPLING_REMOVE} samplingAction;
+static size_t samplingReads;
+static UA_Boolean samplingChanging;
+
+/* Move the first two MonitoredItems to the interval of the third */
+static void
+modifySampling(void) {
+    UA_MonitoredItemModifyRequest items[2];
+    for(size_t i = 0; i < 2; i++) {
+        UA_MonitoredItemModifyRequest_init(&items[i]);
+        items[i].monitoredItemId = samplingIds[i];
+        items[i].requestedParameters.samplingInterval = 500.0;
+        items[i].requestedParameters.queueSize = 1;
+    }
+    UA_ModifyMonitoredItemsRequest request;
+    UA_ModifyMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    request.itemsToModifySize = 2;
+    request.itemsToModify = items;
+    UA_ModifyMonitoredItemsResponse response;
+    UA_ModifyMonitoredItemsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_ModifyMonitoredItems(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.resultsSize, 2);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.results[1].statusCode, UA_STATUSCODE_GOOD);
+    UA_ModifyMonitoredItemsResponse_clear(&response);
+}
+
+static void
+removeSampling(void) {
+    UA_DeleteMonitoredItemsRequest request;
+    UA_DeleteMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.monitoredItemIdsSize = 3;
+    request.monitoredItemIds = samplingIds;
+    UA_DeleteMonitoredItemsResponse response;
+    UA_DeleteMonitoredItemsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_DeleteMonitoredItems(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.resultsSize, 3);
+    for(size_t i = 0; i < 3; i++)
+        ck_assert_uint_eq(response.results[i], UA_STATUSCODE_GOOD);
+    UA_DeleteMonitoredItemsResponse_clear(&response);
+}
+
+/* The first read of a sampling batch changes the MonitoredItems. The lock is
+ * released while the DataSource is read. The reads during the change itself
+ * are not counted. */
+static UA_StatusCode
+readAndChangeSampling(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+                      const UA_NodeId *nodeId, void *nodeContext,
+                      UA_Boolean sourceTimeStamp, const UA_NumericRange *range,
+                      UA_DataValue *value) {
+    if(!samplingChanging && samplingAction != SAMPLING_IDLE &&
+       samplingReads++ == 0) {
+        samplingChanging = true;
+        if(samplingAction == SAMPLING_MODIFY)
+            modifySampling();
+        else
+            removeSampling();
+        samplingChanging = false;
+    }
+    UA_Int32 zero = 0;
+    value->hasValue = true;
+    return UA_Variant_setScalarCopy(&value->value, &zero, &UA_TYPES[UA_TYPES_INT32]);
+}
+
+START_TEST(Server_samplingGroupChangeWhileSampling) {
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 4711);
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    attr.displayName = UA_LOCALIZEDTEXT("en-US", "Change while sampling");
+    UA_DataSource dataSource;
+    dataSource.read = readAndChangeSampling;
+    dataSource.write = NULL;
+    UA_StatusCode res =
+        UA_Server_addDataSourceVariableNode(server, nodeId,
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, "ChangeWhileSampling"),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            attr, dataSource, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    createSubscription();
+
+    /* Two MonitoredItems share the interval */
+    samplingAction = SAMPLING_IDLE;
+    UA_Double intervals[3] = {250.0, 250.0, 500.0};
+    UA_MonitoredItemCreateRequest items[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_MonitoredItemCreateRequest_init(&items[i]);
+        items[i].itemToMonitor.nodeId = nodeId;
+        items[i].itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+        items[i].monitoringMode = UA_MONITORINGMODE_REPORTING;
+        items[i].requestedParameters.samplingInterval = intervals[i];
+        items[i].requestedParameters.queueSize = 1;
+    }
+
+    UA_CreateMonitoredItemsRequest request;
+    UA_CreateMonitoredItemsRequest_init(&request);
+    request.subscriptionId = subscriptionId;
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SERVER;
+    request.itemsToCreateSize = 3;
+    request.itemsToCreate = items;
+
+    UA_CreateMonitoredItemsResponse response;
+    UA_CreateMonitoredItemsResponse_init(&response);
+    UA_LOCK(&server->serviceMutex);
+    Service_CreateMonitoredItems(server, session, &request, &response);
+    UA_UNLOCK(&server->serviceMutex);
+    ck_assert_uint_eq(response.resultsSize, 3);
+    for(size_t i = 0; i < 3; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        samplingIds[i] = response.results[i].monitoredItemId;
+    }
+    UA_CreateMonitoredItemsResponse_clear(&response);
+
+    /* The first sampled item moves both items to the other interval. The
+     * iteration does not continue in the list of the other SamplingGroup. */
+    samplingAction = SAMPLING_MODIFY;
+    samplingReads = 0;
+    UA_fakeSleep(250);
+    UA_Server_run_iterate(server, false);
+    samplingAction = SAMPLING_IDLE;
+    ck_assert_uint_eq(samplingReads, 1);
+
+    UA_SamplingStatistics stats;
+    UA_Server_getSamplingStatistics(server, &stats);
+    ck_assert_uint_eq(stats.samplingTimers, 1);
+    ck_assert_uint_eq(stats.monitoredItems, 3);
+
+    /* The first sampled item removes all. The others are not sampled. */
+    samplingAction = SAMPLING_REMOVE;
+    samplingReads = 0;
+    UA_fakeSleep(250);
+    UA_Server_run_iterate(server, false);
+    samplingAction = SAMPLING_IDLE;
+    ck_assert_uint_eq(samplingReads, 1);
+
+    UA_Server_getSamplingStatistics(server, &stats);
+    ck_assert_uint_eq(stats.samplingTimers, 0);
+    ck_assert_uint_eq(stats.monitoredItems, 0);
+}
+END_TEST
+#endif
+
+static UA_UInt32 dataChangeCount = 0;
+
+static void
+countDataChanges(UA_Server *s, UA_UInt32 monId, void *monContext,
+                 const UA_NodeId *nodeId, void *nodeContext,
+                 UA_UInt32 attributeId, const UA_DataValue *value) {
+    dataChangeCount++;
+}
+
+START_TEST(Server_valueVersion) {
+    /* Add a variable with an internal value */
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_Int32 value = 0;
+    UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId nodeId = UA_NODEID_STRING(1, "versioned");
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, nodeId,
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "versioned"),
+                                  UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                  attr, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The read is skipped while the version is unchanged */
+    UA_ReadValueId rvi;
+    UA_ReadValueId_init(&rvi);
+    rvi.nodeId = nodeId;
+    rvi.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_UInt64 version = 0;
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(readWithSessionIfChanged(server, &server->adminSession, &rvi,
+                                       UA_TIMESTAMPSTORETURN_NEITHER,
+                                       &version, &dv));
+    ck_assert(version != 0);
+    ck_assert(dv.hasValue);
+    UA_DataValue_clear(&dv);
+    UA_UInt64 firstVersion = version;
+    ck_assert(!readWithSessionIfChanged(server, &server->adminSession, &rvi,
+                                        UA_TIMESTAMPSTORETURN_NEITHER,
+                                        &version, &dv));
+    ck_assert(!dv.hasValue);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Every write creates a new version */
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_INT32]);
+    res = UA_Server_writeValue(server, nodeId, v);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_LOCK(&server->serviceMutex);
+    ck_assert(readWithSessionIfChanged(server, &server->adminSession, &rvi,
+                                       UA_TIMESTAMPSTORETURN_NEITHER,
+                                       &version, &dv));
+    ck_assert(version > firstVersion);
+    UA_DataValue_clear(&dv);
+    UA_UNLOCK(&server->serviceMutex);
+
+    /* Sample with a MonitoredItem */
+    dataChangeCount = 0;
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = nodeId;
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_VALUE;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item.requestedParameters.samplingInterval = 100.0;
+    item.requestedParameters.queueSize = 1;
+    UA_MonitoredItemCreateResult result =
+        UA_Server_createDataChangeMonitoredItem(server, UA_TIMESTAMPSTORETURN_NEITHER,
+                                                item, NULL, countDataChanges);
+    ck_assert_uint_eq(result.statusCode, UA_STATUSCODE_GOOD);
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(dataChangeCount, 1);
+
+    /* No notification for unchanged samples */
+    for(size_t i = 0; i < 3; i++) {
+        UA_fakeSleep(100);
+        UA_Server_run_iterate(server, false);
+    }
+    ck_assert_uint_eq(dataChangeCount, 1);
+
+    /* Writing the same value creates a new version but no notification */
+    res = UA_Server_writeValue(server, nodeId, v);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(dataChangeCount, 1);
+
+    /* A changed value is reported */
+    value = 42;
+    res = UA_Server_writeValue(server, nodeId, v);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(dataChangeCount, 2);
+
+    res = UA_Server_deleteMonitoredItem(server, result.monitoredItemId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+END_TEST
+
 START_TEST(Server_lifeTimeCount) {
     /* Create a subscription */
     UA_CreateSubscriptionRequest request;
@@ -871,6 +1200,11 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_server, Server_overflow);
     tcase_add_test(tc_server, Server_setMonitoringMode);
     tcase_add_test(tc_server, Server_deleteMonitoredItems);
+#ifdef UA_ENABLE_DIAGNOSTICS
+    tcase_add_test(tc_server, Server_samplingGroups);
+    tcase_add_test(tc_server, Server_samplingGroupChangeWhileSampling);
+#endif
+    tcase_add_test(tc_server, Server_valueVersion);
     tcase_add_test(tc_server, Server_republish);
     tcase_add_test(tc_server, Server_republish_invalid);
     tcase_add_test(tc_server, Server_deleteSubscription);
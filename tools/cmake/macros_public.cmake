@@ -95,6 +95,8 @@ endfunction()
 #   [INTERNAL]      Optional argument. If given, then the given types file is seen as internal file (e.g. does not require a .csv)
 #   [AUTOLOAD]      Optional argument. If given, the nodeset is automatically attached to the server.
 #   [GEN_DOC]       Optional argument. If given, a .rst file for documenting the generated datatypes is generated.
+#   [GEN_BINARY_ENCODING] Optional argument. If given, specialized binary en-/decoding functions for the
+#                   structures are generated into <NAME>_generated_encoding_binary.h. Only used for the builtin types.
 #
 #   Arguments taking one value:
 #
@@ -121,7 +123,7 @@ endfunction()
 #
 #
 function(ua_generate_datatypes)
-    set(options BUILTIN INTERNAL AUTOLOAD GEN_DOC)
+    set(options BUILTIN INTERNAL AUTOLOAD GEN_DOC GEN_BINARY_ENCODING)
     set(oneValueArgs NAME TARGET_SUFFIX TARGET_PREFIX OUTPUT_DIR FILE_XML FILE_CSV)
     set(multiValueArgs FILES_BSD IMPORT_BSD FILES_SELECTED)
     cmake_parse_arguments(UA_GEN_DT "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
@@ -173,6 +175,13 @@ function(ua_generate_datatypes)
         set(UA_GEN_DOC_ARG "--gen-doc")
     endif()
 
+    set(UA_GEN_BINARY_ENCODING_ARG "")
+    set(UA_GEN_BINARY_ENCODING_OUTPUT "")
+    if(UA_GEN_DT_GEN_BINARY_ENCODING)
+        set(UA_GEN_BINARY_ENCODING_ARG "--gen-binary-encoding")
+        set(UA_GEN_BINARY_ENCODING_OUTPUT ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_encoding_binary.h)
+    endif()
+
     set(UA_GEN_DT_INTERNAL_ARG "")
     if (UA_GEN_DT_INTERNAL)
         set(UA_GEN_DT_INTERNAL_ARG "--internal")
@@ -216,6 +225,7 @@ function(ua_generate_datatypes)
     add_custom_command(OUTPUT ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.c
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.h
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_handling.h
+        ${UA_GEN_BINARY_ENCODING_OUTPUT}
         PRE_BUILD
         COMMAND ${ARG_CONV_EXCL_ENV} ${Python3_EXECUTABLE} ${open62541_TOOLS_DIR}/generate_datatypes.py
         ${NAMESPACE_MAP_TMP}
@@ -228,6 +238,7 @@ function(ua_generate_datatypes)
         ${UA_GEN_DT_INTERNAL_ARG}
         ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}
         ${UA_GEN_DOC_ARG}
+        ${UA_GEN_BINARY_ENCODING_ARG}
         DEPENDS ${open62541_TOOLS_DIR}/generate_datatypes.py
                 ${open62541_TOOLS_DIR}/nodeset_compiler/backend_open62541_typedefinitions.py
         ${UA_GEN_DT_FILES_BSD}
@@ -238,7 +249,8 @@ function(ua_generate_datatypes)
         add_custom_target(${UA_GEN_DT_TARGET_PREFIX}-${UA_GEN_DT_TARGET_SUFFIX} DEPENDS
                           ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.c
                           ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated.h
-                          ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_handling.h)
+                          ${UA_GEN_DT_OUTPUT_DIR}/${UA_GEN_DT_NAME}_generated_handling.h
+                          ${UA_GEN_BINARY_ENCODING_OUTPUT})
     endif()
 
     if(UA_GEN_DT_AUTOLOAD AND UA_ENABLE_NODESET_INJECTOR)
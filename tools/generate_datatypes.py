@@ -70,6 +70,11 @@ parser.add_argument('--gen-doc',
                     dest="gen_doc",
                     help='Generate a .rst documentation version of the type definition')
 
+parser.add_argument('--gen-binary-encoding',
+                    action='store_true',
+                    dest="gen_binary_encoding",
+                    help='Generate precompiled binary en-/decoding functions for the structures. Only for the builtin types of the library.')
+
 parser.add_argument('-t', '--type-bsd',
                     metavar="<typeBsds>",
                     type=argparse.FileType('r'),
@@ -107,5 +112,6 @@ parser = CSVBSDTypeParser(args.opaque_map, args.selected_types, args.no_builtin,
                           args.type_bsd, args.type_csv, args.type_xml, namespaceMap)
 parser.create_types()
 
-generator = backend.CGenerator(parser, inname, args.outfile, args.internal, args.gen_doc, namespaceMap)
+generator = backend.CGenerator(parser, inname, args.outfile, args.internal, args.gen_doc, namespaceMap,
+                               args.gen_binary_encoding)
 generator.write_definitions()
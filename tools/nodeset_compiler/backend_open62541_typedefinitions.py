@@ -62,12 +62,14 @@ def getNodeidTypeAndId(nodeId):
         return "UA_NODEIDTYPE_STRING, {{ .string = UA_STRING_STATIC(\"{id}\") }}".format(id=strId.replace("\"", "\\\""))
 
 class CGenerator(object):
-    def __init__(self, parser, inname, outfile, is_internal_types, gen_doc, namespaceMap):
+    def __init__(self, parser, inname, outfile, is_internal_types, gen_doc, namespaceMap,
+                 gen_binary_encoding=False):
         self.parser = parser
         self.inname = inname
         self.outfile = outfile
         self.is_internal_types = is_internal_types
         self.gen_doc = gen_doc
+        self.gen_binary_encoding = gen_binary_encoding
         self.filtered_types = None
         self.namespaceMap = namespaceMap
         self.fh = None
@@ -359,6 +361,11 @@ class CGenerator(object):
             self.print_doc()
             self.fd.close()
 
+        if self.gen_binary_encoding:
+            self.fe = open(self.outfile + "_generated_encoding_binary.h", 'w')
+            self.print_binary_encoding()
+            self.fe.close()
+
     def printh(self, string):
         print(string, end='\n', file=self.fh)
 
@@ -371,6 +378,9 @@ class CGenerator(object):
     def printd(self, string):
         print(string, end='\n', file=self.fd)
 
+    def printe(self, string):
+        print(string, end='\n', file=self.fe)
+
     def iter_types(self, v):
         # Make a copy. We cannot delete from the map that is iterated over at
         # the same time.
@@ -543,3 +553,138 @@ _UA_END_DECLS
                     self.printc("/* " + t.name + " */")
                     self.printc(self.print_datatype(t, self.namespaceMap) + ",")
             self.printc("};\n")
+
+    # Functions of ua_types_encoding_binary.c for the builtin type kinds. Float
+    # and Double use the jumptable as their functions are aliased to the
+    # integer functions on IEEE 754 platforms.
+    binary_encoding_functions = {
+        "UA_DATATYPEKIND_BOOLEAN": "Boolean",
+        "UA_DATATYPEKIND_SBYTE": "Byte",
+        "UA_DATATYPEKIND_BYTE": "Byte",
+        "UA_DATATYPEKIND_INT16": "UInt16",
+        "UA_DATATYPEKIND_UINT16": "UInt16",
+        "UA_DATATYPEKIND_INT32": "UInt32",
+        "UA_DATATYPEKIND_UINT32": "UInt32",
+        "UA_DATATYPEKIND_INT64": "UInt64",
+        "UA_DATATYPEKIND_UINT64": "UInt64",
+        "UA_DATATYPEKIND_STRING": "String",
+        "UA_DATATYPEKIND_DATETIME": "UInt64",
+        "UA_DATATYPEKIND_GUID": "Guid",
+        "UA_DATATYPEKIND_BYTESTRING": "String",
+        "UA_DATATYPEKIND_XMLELEMENT": "String",
+        "UA_DATATYPEKIND_NODEID": "NodeId",
+        "UA_DATATYPEKIND_EXPANDEDNODEID": "ExpandedNodeId",
+        "UA_DATATYPEKIND_STATUSCODE": "UInt32",
+        "UA_DATATYPEKIND_QUALIFIEDNAME": "QualifiedName",
+        "UA_DATATYPEKIND_LOCALIZEDTEXT": "LocalizedText",
+        "UA_DATATYPEKIND_EXTENSIONOBJECT": "ExtensionObject",
+        "UA_DATATYPEKIND_DATAVALUE": "DataValue",
+        "UA_DATATYPEKIND_VARIANT": "Variant",
+        "UA_DATATYPEKIND_DIAGNOSTICINFO": "DiagnosticInfo",
+        "UA_DATATYPEKIND_ENUM": "UInt32"
+    }
+
+    def is_precompiled_struct(self, datatype):
+        return isinstance(datatype, StructType) and len(datatype.members) > 0 and \
+            self.get_type_kind(datatype) == "UA_DATATYPEKIND_STRUCTURE"
+
+    def print_binary_member(self, member, precompiled, encode):
+        # Structures without members are encoded as an ExtensionObject
+        member_type = member.member_type
+        if not member_type.members and isinstance(member_type, StructType):
+            member_type = BuiltinType("ExtensionObject")
+        type_ptr = "&UA_%s[UA_%s_%s]" % (member_type.outname.upper(), member_type.outname.upper(),
+                                         makeCIdentifier(member_type.name.upper()))
+        name = makeCIdentifier(member.name)
+        if member.is_array:
+            if encode:
+                return "    ENCODE_MEMBER_ARRAY(src->%s, src->%sSize, %s);" % (name, name, type_ptr)
+            return "    DECODE_MEMBER_ARRAY(&dst->%s, &dst->%sSize, %s);" % (name, name, type_ptr)
+
+        # Call the function for the member type directly. Fall back to the
+        # jumptable for the type kinds without a dedicated function.
+        kind = self.get_type_kind(member_type)
+        if kind in self.binary_encoding_functions:
+            func_type = self.binary_encoding_functions[kind]
+            func = func_type + ("_encodeBinary" if encode else "_decodeBinary")
+            if encode:
+                ptr = "(const UA_%s*)&src->%s" % (func_type, name)
+            else:
+                ptr = "(UA_%s*)&dst->%s" % (func_type, name)
+        elif makeCIdentifier(member_type.name) in precompiled:
+            func = makeCIdentifier(member_type.name) + \
+                ("_encodeBinaryPrecompiled" if encode else "_decodeBinaryPrecompiled")
+            ptr = ("&src->%s" if encode else "&dst->%s") % name
+        else:
+            func = "encodeBinaryJumpTable[%s]" % kind if encode else \
+                "decodeBinaryJumpTable[%s]" % kind
+            ptr = ("&src->%s" if encode else "&dst->%s") % name
+        if encode:
+            return "    ENCODE_MEMBER(%s, %s, %s);" % (func, ptr, type_ptr)
+        return "    DECODE_MEMBER(%s, %s, %s);" % (func, ptr, type_ptr)
+
+    def print_binary_encoding(self):
+        self.printe(u'''/**********************************
+ * Autogenerated -- do not modify *
+ **********************************/
+
+/* Precompiled binary en-/decoding for the structures in UA_%s. This is
+ * included at the end of ua_types_encoding_binary.c and uses its internal
+ * definitions. Structures with optional fields and unions are not precompiled.
+ * They are handled by the generic en-/decoding. */''' % self.parser.outname.upper())
+
+        structs = []
+        for ns in self.filtered_types:
+            for t_name in self.filtered_types[ns]:
+                t = self.filtered_types[ns][t_name]
+                if self.is_precompiled_struct(t):
+                    structs.append(t)
+        precompiled = set([makeCIdentifier(t.name) for t in structs])
+
+        # Forward declarations for nested structures
+        self.printe("")
+        for t in structs:
+            idName = makeCIdentifier(t.name)
+            self.printe("static status %s_encodeBinaryPrecompiled(const UA_%s *src, const UA_DataType *type, Ctx *ctx);" % (idName, idName))
+            self.printe("static status %s_decodeBinaryPrecompiled(UA_%s *dst, const UA_DataType *type, Ctx *ctx);" % (idName, idName))
+
+        for t in structs:
+            idName = makeCIdentifier(t.name)
+            self.printe("\n/* %s */" % t.name)
+            self.printe("static status\n%s_encodeBinaryPrecompiled(const UA_%s *src, const UA_DataType *type, Ctx *ctx) {" % (idName, idName))
+            self.printe("    PRECOMPILED_BEGIN;")
+            for m in t.members:
+                self.printe(self.print_binary_member(m, precompiled, True))
+            self.printe("    PRECOMPILED_END;\n}\n")
+            self.printe("static status\n%s_decodeBinaryPrecompiled(UA_%s *dst, const UA_DataType *type, Ctx *ctx) {" % (idName, idName))
+            self.printe("    PRECOMPILED_BEGIN;")
+            for m in t.members:
+                self.printe(self.print_binary_member(m, precompiled, False))
+            self.printe("    PRECOMPILED_END;\n}")
+
+        # Lookup tables indexed like UA_TYPES
+        for encode in [True, False]:
+            sig = "encodeBinarySignature" if encode else "decodeBinarySignature"
+            suffix = "_encodeBinaryPrecompiled" if encode else "_decodeBinaryPrecompiled"
+            self.printe("\nstatic const %s precompiled%sr[UA_%s_COUNT] = {" %
+                        (sig, "Encode" if encode else "Decode", self.parser.outname.upper()))
+            for ns in self.filtered_types:
+                for t_name in self.filtered_types[ns]:
+                    t = self.filtered_types[ns][t_name]
+                    if makeCIdentifier(t.name) in precompiled:
+                        self.printe("    (%s)%s%s, /* %s */" % (sig, makeCIdentifier(t.name), suffix, t.name))
+                    else:
+                        self.printe("    NULL, /* %s */" % t.name)
+            self.printe("};")
+
+        for encode in [True, False]:
+            sig = "encodeBinarySignature" if encode else "decodeBinarySignature"
+            name = "Encode" if encode else "Decode"
+            self.printe('''
+static %s
+getPrecompiled%sr(const UA_DataType *type) {
+    uintptr_t offset = (uintptr_t)type - (uintptr_t)UA_%s;
+    if(offset >= sizeof(UA_%s))
+        return NULL;
+    return precompiled%sr[offset / sizeof(UA_DataType)];
+}''' % (sig, name, self.parser.outname.upper(), self.parser.outname.upper(), name))